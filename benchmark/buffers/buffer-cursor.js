@@ -0,0 +1,72 @@
+'use strict';
+const common = require('../common.js');
+const { BufferCursor, BufferSchema } = require('buffer');
+
+const bench = common.createBenchmark(main, {
+  method: ['cursor', 'methods'],
+  direction: ['read', 'write'],
+  n: [1e6]
+});
+
+const fields = ['uint8', 'uint16le', 'uint32le', 'int32be', 'doublele',
+                'floatbe', 'uint32be', 'doublebe'];
+const values = [1, 2, 3, -4, 0.5, 1.5, 7, 8.25];
+
+function writeMethods(buf) {
+  var offset = buf.writeUInt8(values[0], 0);
+  offset = buf.writeUInt16LE(values[1], offset);
+  offset = buf.writeUInt32LE(values[2], offset);
+  offset = buf.writeInt32BE(values[3], offset);
+  offset = buf.writeDoubleLE(values[4], offset);
+  offset = buf.writeFloatBE(values[5], offset);
+  offset = buf.writeUInt32BE(values[6], offset);
+  return buf.writeDoubleBE(values[7], offset);
+}
+
+function readMethods(buf) {
+  return [
+    buf.readUInt8(0),
+    buf.readUInt16LE(1),
+    buf.readUInt32LE(3),
+    buf.readInt32BE(7),
+    buf.readDoubleLE(11),
+    buf.readFloatBE(19),
+    buf.readUInt32BE(23),
+    buf.readDoubleBE(27)
+  ];
+}
+
+function main({ n, method, direction }) {
+  const schema = new BufferSchema(fields);
+  const buf = Buffer.alloc(BufferCursor.byteLength(schema, values));
+  writeMethods(buf);
+  var i;
+
+  if (method === 'cursor') {
+    const cursor = new BufferCursor(buf);
+    bench.start();
+    if (direction === 'read') {
+      for (i = 0; i < n; i++) {
+        cursor.offset = 0;
+        cursor.read(schema);
+      }
+    } else {
+      for (i = 0; i < n; i++) {
+        cursor.offset = 0;
+        cursor.write(schema, values);
+      }
+    }
+    bench.end(n);
+    return;
+  }
+
+  bench.start();
+  if (direction === 'read') {
+    for (i = 0; i < n; i++)
+      readMethods(buf);
+  } else {
+    for (i = 0; i < n; i++)
+      writeMethods(buf);
+  }
+  bench.end(n);
+}
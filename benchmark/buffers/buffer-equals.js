@@ -0,0 +1,24 @@
+'use strict';
+const common = require('../common.js');
+
+const bench = common.createBenchmark(main, {
+  size: [16, 512, 4096, 65536],
+  constantTime: ['true', 'false'],
+  difference: ['none', 'start', 'end'],
+  n: [1e6]
+});
+
+function main({ n, size, constantTime, difference }) {
+  const a = Buffer.alloc(size, 'a');
+  const b = Buffer.alloc(size, 'a');
+  if (difference === 'start')
+    b[0] = 0x62;
+  else if (difference === 'end')
+    b[size - 1] = 0x62;
+  const options = { constantTime: constantTime === 'true' };
+
+  bench.start();
+  for (var i = 0; i < n; i++)
+    a.equals(b, options);
+  bench.end(n);
+}
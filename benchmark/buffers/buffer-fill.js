@@ -0,0 +1,20 @@
+'use strict';
+const common = require('../common.js');
+
+const bench = common.createBenchmark(main, {
+  patternLength: [1, 2, 4, 8, 16, 3, 24],
+  size: [256, 4096, 65536, 1048576],
+  n: [1e4]
+});
+
+function main({ n, patternLength, size }) {
+  const buf = Buffer.allocUnsafe(size);
+  const pattern = Buffer.alloc(patternLength);
+  for (var i = 0; i < patternLength; i++)
+    pattern[i] = i + 1;
+
+  bench.start();
+  for (i = 0; i < n; i++)
+    buf.fill(pattern);
+  bench.end(n);
+}
@@ -5,16 +5,26 @@ const path = require('path');
 
 const bench = common.createBenchmark(main, {
   value: ['@'.charCodeAt(0)],
+  method: ['indexOf', 'lastIndexOf'],
   n: [1e7]
 });
 
-function main({ n, value }) {
+function main({ n, value, method }) {
   const aliceBuffer = fs.readFileSync(
     path.resolve(__dirname, '../fixtures/alice.html')
   );
 
+  if (method === 'lastIndexOf') {
+    bench.start();
+    for (var i = 0; i < n; i++) {
+      aliceBuffer.lastIndexOf(value, undefined, undefined);
+    }
+    bench.end(n);
+    return;
+  }
+
   bench.start();
-  for (var i = 0; i < n; i++) {
+  for (i = 0; i < n; i++) {
     aliceBuffer.indexOf(value, 0, undefined);
   }
   bench.end(n);
@@ -0,0 +1,66 @@
+// test UDP send/recv throughput of sendBatch() and batched receives
+'use strict';
+
+const common = require('../common.js');
+const dgram = require('dgram');
+const PORT = common.PORT;
+
+// `num` is the number of datagrams to queue up each time, one send() each or
+// one sendBatch() for all of them.
+const bench = common.createBenchmark(main, {
+  len: [1, 64, 1024],
+  num: [100],
+  batch: ['true', 'false'],
+  type: ['send', 'recv'],
+  dur: [5]
+});
+
+function main({ dur, len, num, batch, type }) {
+  const chunk = Buffer.allocUnsafe(len);
+  const messages = [];
+  for (var i = 0; i < num; i++)
+    messages.push({ msg: chunk, port: PORT, address: '127.0.0.1' });
+  var sent = 0;
+  var received = 0;
+  const socket = batch === 'true' ?
+    dgram.createSocket({ type: 'udp4', recvBatchSize: 64 }) :
+    dgram.createSocket('udp4');
+
+  function onsendbatch() {
+    sent += num;
+    socket.sendBatch(messages, onsendbatch);
+  }
+
+  function onsend() {
+    if (sent++ % num === 0) {
+      for (var i = 0; i < num; i++) {
+        socket.send(chunk, PORT, '127.0.0.1', onsend);
+      }
+    }
+  }
+
+  socket.on('listening', function() {
+    bench.start();
+    if (batch === 'true')
+      socket.sendBatch(messages, onsendbatch);
+    else
+      onsend();
+
+    setTimeout(function() {
+      const bytes = (type === 'send' ? sent : received) * chunk.length;
+      const gbits = (bytes * 8) / (1024 * 1024 * 1024);
+      bench.end(gbits);
+      process.exit(0);
+    }, dur * 1000);
+  });
+
+  socket.on('message', function() {
+    received++;
+  });
+
+  socket.on('messages', function(data, offsets, rinfos) {
+    received += rinfos.length;
+  });
+
+  socket.bind(PORT);
+}
@@ -26,5 +26,9 @@ exports.searchParams = {
                   'foo=ghi&foo=jkl&foo=mno&foo=pqr&foo=stu&foo=vwxyz',
   manypairs: 'a&b&c&d&e&f&g&h&i&j&k&l&m&n&o&p&q&r&s&t&u&v&w&x&y&z',
   manyblankpairs: '&&&&&&&&&&&&&&&&&&&&&&&&',
-  altspaces: 'foo+bar=baz+quux&xyzzy+thud=quuy+quuz&abc=def+ghi'
+  altspaces: 'foo+bar=baz+quux&xyzzy+thud=quuy+quuz&abc=def+ghi',
+  form: 'name=John+Doe&email=john.doe%40example.com&phone=%2B1+555+0100&' +
+        'address=221B+Baker+Street%2C+London&message=Hello%2C+world%21+' +
+        'This+is+a+longer+form+submission+with+several+encoded+' +
+        'characters+%26+symbols.&subscribe=on&source=landing%2Fpage'
 };
@@ -0,0 +1,29 @@
+'use strict';
+
+const common = require('../common');
+const fs = require('fs');
+
+const bench = common.createBenchmark(main, {
+  n: [20e4],
+  concurrent: [1, 10]
+});
+
+
+function main({ n, concurrent }) {
+  var done = 0;
+
+  bench.start();
+  for (var i = 0; i < concurrent; i++)
+    access(n / concurrent);
+
+  function access(cntr) {
+    if (cntr-- <= 0) {
+      if (++done === concurrent)
+        bench.end(n);
+      return;
+    }
+    fs.access(__filename, function() {
+      access(cntr);
+    });
+  }
+}
@@ -3,7 +3,9 @@ const common = require('../common.js');
 const StringDecoder = require('string_decoder').StringDecoder;
 
 const bench = common.createBenchmark(main, {
-  encoding: ['ascii', 'utf8', 'base64-utf8', 'base64-ascii', 'utf16le'],
+  encoding: [
+    'ascii', 'utf8', 'utf8-ascii', 'base64-utf8', 'base64-ascii', 'utf16le'
+  ],
   inLen: [32, 128, 1024, 4096],
   chunkLen: [16, 64, 256, 1024],
   n: [25e5]
@@ -21,7 +23,11 @@ function main({ encoding, inLen, chunkLen, n }) {
   const isBase64 = (encoding === 'base64-ascii' || encoding === 'base64-utf8');
   var i;
 
-  if (encoding === 'ascii' || encoding === 'base64-ascii')
+  if (encoding === 'utf8-ascii') {
+    // ASCII text fed to a UTF-8 decoder.
+    alpha = ASC_ALPHA;
+    encoding = 'utf8';
+  } else if (encoding === 'ascii' || encoding === 'base64-ascii')
     alpha = ASC_ALPHA;
   else if (encoding === 'utf8' || encoding === 'base64-utf8')
     alpha = UTF8_ALPHA;
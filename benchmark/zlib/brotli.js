@@ -0,0 +1,60 @@
+'use strict';
+const common = require('../common.js');
+const zlib = require('zlib');
+
+// Compares brotli with gzip on the same data, through the convenience
+// methods. Requires a build with brotli support.
+const bench = common.createBenchmark(main, {
+  method: [
+    'brotliCompress', 'brotliCompressSync',
+    'brotliDecompress', 'brotliDecompressSync',
+    'gzip', 'gunzip'
+  ],
+  quality: [4, 11],
+  inputLen: [1024 * 1024],
+  n: [10]
+});
+
+function main({ n, method, quality, inputLen }) {
+  if (typeof zlib[method] !== 'function')
+    throw new Error(`zlib.${method}() is not available in this build`);
+
+  // Text-like data with some repetition.
+  const input = Buffer.alloc(inputLen);
+  for (var j = 0, x = 1; j < inputLen; j++) {
+    x = (Math.imul(x, 1103515245) + 12345) >>> 0;
+    input[j] = j > 64 && (x >>> 30) !== 0 ?
+      input[j - 1 - ((x >>> 16) & 63)] : 0x61 + (x >>> 27);
+  }
+
+  var options = {};
+  var data = input;
+  if (method.startsWith('brotli')) {
+    options = { params: {
+      [zlib.constants.BROTLI_PARAM_QUALITY]: quality
+    } };
+    if (method.startsWith('brotliDecompress'))
+      data = zlib.brotliCompressSync(input, options);
+  } else if (method === 'gunzip') {
+    data = zlib.gzipSync(input);
+  }
+  const fn = zlib[method];
+
+  var i = 0;
+  if (method.endsWith('Sync')) {
+    bench.start();
+    for (; i < n; ++i)
+      fn(data, options);
+    bench.end(n);
+    return;
+  }
+
+  bench.start();
+  (function next(err) {
+    if (err)
+      throw err;
+    if (i++ === n)
+      return bench.end(n);
+    fn(data, options, next);
+  })();
+}
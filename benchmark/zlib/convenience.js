@@ -0,0 +1,40 @@
+'use strict';
+const common = require('../common.js');
+const zlib = require('zlib');
+
+// Compresses or decompresses a whole buffer with the convenience methods,
+// which do all of the work in a single binding call.
+const bench = common.createBenchmark(main, {
+  method: ['gzip', 'gzipSync', 'gunzip', 'gunzipSync'],
+  inputLen: [1024 * 1024, 10 * 1024 * 1024],
+  n: [20]
+});
+
+function main({ n, method, inputLen }) {
+  // Somewhat compressible data, so that decompression has to grow its output
+  // a few times.
+  const input = Buffer.alloc(inputLen);
+  for (var j = 0; j < inputLen; j++)
+    input[j] = (j * 7 + (j >> 10)) & 0x3f;
+  const gunzip = method.startsWith('gunzip');
+  const data = gunzip ? zlib.gzipSync(input) : input;
+  const fn = zlib[method];
+
+  var i = 0;
+  if (method.endsWith('Sync')) {
+    bench.start();
+    for (; i < n; ++i)
+      fn(data);
+    bench.end(n);
+    return;
+  }
+
+  bench.start();
+  (function next(err) {
+    if (err)
+      throw err;
+    if (i++ === n)
+      return bench.end(n);
+    fn(data, next);
+  })();
+}
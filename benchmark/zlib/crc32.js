@@ -0,0 +1,45 @@
+'use strict';
+const common = require('../common.js');
+const zlib = require('zlib');
+
+// zlib.crc32() on its own, and gunzip, which computes a CRC32 of its output.
+const bench = common.createBenchmark(main, {
+  type: ['crc32-buffer', 'crc32-string', 'gunzip'],
+  len: [64, 16 * 1024, 1024 * 1024],
+  n: [1e3]
+});
+
+function main({ n, type, len }) {
+  const buf = Buffer.alloc(len);
+  for (var i = 0, x = 1; i < len; i++) {
+    x = (Math.imul(x, 1103515245) + 12345) >>> 0;
+    buf[i] = 0x61 + (x >>> 29);
+  }
+
+  switch (type) {
+    case 'crc32-buffer':
+      bench.start();
+      for (i = 0; i < n; i++)
+        zlib.crc32(buf);
+      bench.end(n);
+      break;
+    case 'crc32-string': {
+      const str = buf.toString('latin1');
+      bench.start();
+      for (i = 0; i < n; i++)
+        zlib.crc32(str);
+      bench.end(n);
+      break;
+    }
+    case 'gunzip': {
+      const compressed = zlib.gzipSync(buf);
+      bench.start();
+      for (i = 0; i < n; i++)
+        zlib.gunzipSync(compressed);
+      bench.end(n);
+      break;
+    }
+    default:
+      throw new Error(`Unsupported type: ${type}`);
+  }
+}
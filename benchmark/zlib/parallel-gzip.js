@@ -0,0 +1,47 @@
+'use strict';
+const common = require('../common.js');
+const zlib = require('zlib');
+
+// Gzips a large buffer with and without the `parallel` option, through the
+// convenience methods or a stream fed with 64 KiB chunks.
+const bench = common.createBenchmark(main, {
+  method: ['gzip', 'gzipSync', 'stream'],
+  parallel: ['true', 'false'],
+  inputLen: [16 * 1024 * 1024],
+  n: [5]
+});
+
+function main({ n, method, parallel, inputLen }) {
+  const input = Buffer.alloc(inputLen);
+  for (var j = 0; j < inputLen; j++)
+    input[j] = (j * 7 + (j >> 10)) & 0x3f;
+  const options = { parallel: parallel === 'true' };
+
+  var i = 0;
+  if (method.endsWith('Sync')) {
+    bench.start();
+    for (; i < n; ++i)
+      zlib[method](input, options);
+    bench.end(n);
+    return;
+  }
+
+  const fn = method === 'stream' ? streamed : zlib[method];
+  bench.start();
+  (function next(err) {
+    if (err)
+      throw err;
+    if (i++ === n)
+      return bench.end(n);
+    fn(input, options, next);
+  })();
+}
+
+function streamed(input, options, callback) {
+  const gzip = zlib.createGzip(options);
+  gzip.on('data', () => {});
+  gzip.on('end', callback);
+  for (var offset = 0; offset < input.length; offset += 65536)
+    gzip.write(input.slice(offset, offset + 65536));
+  gzip.end();
+}
@@ -7,6 +7,11 @@
 
 #include "zutil.h"
 
+#ifdef ADLER32_SIMD_SSSE3
+#  include "adler32_simd.h"
+#  include "x86.h"
+#endif
+
 local uLong adler32_combine_ OF((uLong adler1, uLong adler2, z_off64_t len2));
 
 #define BASE 65521U     /* largest prime smaller than 65536 */
@@ -68,6 +73,12 @@ uLong ZEXPORT adler32_z(adler, buf, len)
     unsigned long sum2;
     unsigned n;
 
+#ifdef ADLER32_SIMD_SSSE3
+    if (buf != Z_NULL && len >= Z_ADLER32_SIMD_MINIMUM_LENGTH &&
+        x86_cpu_enable_ssse3)
+        return adler32_simd_(adler, buf, len);
+#endif
+
     /* split Adler-32 into component sums */
     sum2 = (adler >> 16) & 0xffff;
     adler &= 0xffff;
@@ -0,0 +1,109 @@
+/* adler32_simd.c -- Adler-32 using SSSE3
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * For a block of n bytes b[0..n-1], the sums are updated as
+ *
+ *   s1' = s1 + b[0] + ... + b[n-1]
+ *   s2' = s2 + n * s1 + n * b[0] + (n - 1) * b[1] + ... + 1 * b[n-1]
+ *
+ * This code takes 32 bytes at a time: the byte sums come from PSADBW, and the
+ * weighted sums from PMADDUBSW with the weights 32..1 followed by PMADDWD.
+ * The n * s1 terms of a run of blocks are collected separately and added in
+ * at the end of the run. Runs are at most NMAX bytes long, so that none of
+ * the 32-bit sums can overflow before they are reduced modulo BASE.
+ */
+
+#include "adler32_simd.h"
+
+#if defined(ADLER32_SIMD_SSSE3)
+
+#include <tmmintrin.h>
+
+#define BASE 65521U     /* largest prime smaller than 65536 */
+#define NMAX 5552       /* see adler32.c */
+#define BLOCK_SIZE 32
+
+uLong ZLIB_INTERNAL adler32_simd_(adler, buf, len)
+    uLong adler;
+    const Bytef *buf;
+    z_size_t len;
+{
+    unsigned long s1 = adler & 0xffff;
+    unsigned long s2 = adler >> 16;
+    z_size_t blocks = len / BLOCK_SIZE;
+
+    const __m128i tap1 =
+        _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                      24, 23, 22, 21, 20, 19, 18, 17);
+    const __m128i tap2 =
+        _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9,
+                      8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+
+    len -= blocks * BLOCK_SIZE;
+
+    while (blocks) {
+        unsigned n = NMAX / BLOCK_SIZE;
+        __m128i v_ps, v_s1, v_s2;
+
+        if (n > blocks)
+            n = (unsigned)blocks;
+        blocks -= n;
+
+        /* s1 as it was at the start of each block of the run, summed */
+        v_ps = _mm_set_epi32(0, 0, 0, (int)(s1 * n));
+        v_s1 = zero;
+        v_s2 = _mm_set_epi32(0, 0, 0, (int)s2);
+
+        do {
+            const __m128i bytes1 = _mm_loadu_si128((const __m128i *)buf);
+            const __m128i bytes2 =
+                _mm_loadu_si128((const __m128i *)(buf + 16));
+            __m128i mad;
+
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+            mad = _mm_maddubs_epi16(bytes1, tap1);
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(mad, ones));
+
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+            mad = _mm_maddubs_epi16(bytes2, tap2);
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(mad, ones));
+
+            buf += BLOCK_SIZE;
+        } while (--n);
+
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+        /* add up the four 32-bit lanes */
+        v_s1 = _mm_add_epi32(v_s1,
+                             _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s1 = _mm_add_epi32(v_s1,
+                             _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += (unsigned)_mm_cvtsi128_si32(v_s1);
+
+        v_s2 = _mm_add_epi32(v_s2,
+                             _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s2 = _mm_add_epi32(v_s2,
+                             _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = (unsigned)_mm_cvtsi128_si32(v_s2);
+
+        s1 %= BASE;
+        s2 %= BASE;
+    }
+
+    /* the rest, fewer than BLOCK_SIZE bytes */
+    while (len--) {
+        s1 += *buf++;
+        s2 += s1;
+    }
+    if (s1 >= BASE)
+        s1 -= BASE;
+    s2 %= BASE;
+
+    return s1 | (s2 << 16);
+}
+
+#endif /* ADLER32_SIMD_SSSE3 */
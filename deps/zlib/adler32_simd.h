@@ -0,0 +1,16 @@
+/* adler32_simd.h -- Adler-32 using SSSE3
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef ADLER32_SIMD_H
+#define ADLER32_SIMD_H
+
+#include "zutil.h"
+
+/* Below this many bytes the scalar code in adler32.c is as fast. */
+#define Z_ADLER32_SIMD_MINIMUM_LENGTH 64
+
+uLong ZLIB_INTERNAL adler32_simd_ OF((uLong adler, const Bytef *buf,
+                                      z_size_t len));
+
+#endif /* ADLER32_SIMD_H */
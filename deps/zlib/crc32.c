@@ -30,6 +30,11 @@
 
 #include "zutil.h"      /* for STDC and FAR definitions */
 
+#ifdef CRC32_SIMD_SSE42_PCLMUL
+#  include "crc32_simd.h"
+#  include "x86.h"
+#endif
+
 /* Definitions for doing the crc four data bytes at a time. */
 #if !defined(NOBYFOUR) && defined(Z_U4)
 #  define BYFOUR
@@ -204,13 +209,32 @@ unsigned long ZEXPORT crc32_z(crc, buf, len)
     const unsigned char FAR *buf;
     z_size_t len;
 {
-    if (buf == Z_NULL) return 0UL;
+    if (buf == Z_NULL) {
+#ifdef CRC32_SIMD_SSE42_PCLMUL
+        /* crc32(0L, Z_NULL, 0) is the documented way to get the initial
+           value, which makes it a good place to look at the CPU. */
+        x86_check_features();
+#endif
+        return 0UL;
+    }
 
 #ifdef DYNAMIC_CRC_TABLE
     if (crc_table_empty)
         make_crc_table();
 #endif /* DYNAMIC_CRC_TABLE */
 
+#ifdef CRC32_SIMD_SSE42_PCLMUL
+    if (x86_cpu_enable_simd && len >= Z_CRC32_SSE42_MINIMUM_LENGTH) {
+        z_size_t chunk = len - len % Z_CRC32_SSE42_CHUNKSIZE;
+
+        crc = (z_crc_t)~crc32_sse42_simd_(buf, chunk, (z_crc_t)~crc);
+        buf += chunk;
+        len -= chunk;
+        if (len == 0)
+            return crc;
+    }
+#endif /* CRC32_SIMD_SSE42_PCLMUL */
+
 #ifdef BYFOUR
     if (sizeof(void *) == sizeof(ptrdiff_t)) {
         z_crc_t endian;
@@ -0,0 +1,20 @@
+/* crc32_simd.h -- CRC-32 using SSE4.2 and PCLMULQDQ
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef CRC32_SIMD_H
+#define CRC32_SIMD_H
+
+#include "zutil.h"
+
+/* crc32_sse42_simd_() needs at least this many bytes, in multiples of
+   Z_CRC32_SSE42_CHUNKSIZE. */
+#define Z_CRC32_SSE42_MINIMUM_LENGTH 64
+#define Z_CRC32_SSE42_CHUNKSIZE 16
+
+/* Updates |crc|, which is not pre- or post-conditioned, i.e. the value
+   crc32() keeps between its two exclusive-ors with 0xffffffff. */
+z_crc_t ZLIB_INTERNAL crc32_sse42_simd_ OF((const unsigned char *buf,
+                                            z_size_t len, z_crc_t crc));
+
+#endif /* CRC32_SIMD_H */
@@ -51,6 +51,13 @@
 
 #include "deflate.h"
 
+#ifdef X86_SIMD
+#  include "x86.h"
+#endif
+#ifdef DEFLATE_SLIDE_HASH_SSE2
+#  include "slide_hash_simd.h"
+#endif
+
 const char deflate_copyright[] =
    " deflate 1.2.11 Copyright 1995-2017 Jean-loup Gailly and Mark Adler ";
 /*
@@ -208,6 +215,16 @@ local void slide_hash(s)
     Posf *p;
     uInt wsize = s->w_size;
 
+#ifdef DEFLATE_SLIDE_HASH_SSE2
+    if (x86_cpu_enable_sse2) {
+        slide_hash_sse2(s->head, s->hash_size, wsize);
+#ifndef FASTEST
+        slide_hash_sse2(s->prev, wsize, wsize);
+#endif
+        return;
+    }
+#endif
+
     n = s->hash_size;
     p = &s->head[n];
     do {
@@ -260,6 +277,10 @@ int ZEXPORT deflateInit2_(strm, level, method, windowBits, memLevel, strategy,
      * output size for (length,distance) codes is <= 24 bits.
      */
 
+#ifdef X86_SIMD
+    x86_check_features();
+#endif
+
     if (version == Z_NULL || version[0] != my_version[0] ||
         stream_size != sizeof(z_stream)) {
         return Z_VERSION_ERROR;
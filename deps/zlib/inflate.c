@@ -85,6 +85,10 @@
 #include "inflate.h"
 #include "inffast.h"
 
+#ifdef X86_SIMD
+#  include "x86.h"
+#endif
+
 #ifdef MAKEFIXED
 #  ifndef BUILDFIXED
 #    define BUILDFIXED
@@ -201,6 +205,10 @@ int stream_size;
     int ret;
     struct inflate_state FAR *state;
 
+#ifdef X86_SIMD
+    x86_check_features();
+#endif
+
     if (version == Z_NULL || version[0] != ZLIB_VERSION[0] ||
         stream_size != (int)(sizeof(z_stream)))
         return Z_VERSION_ERROR;
@@ -0,0 +1,32 @@
+/* slide_hash_simd.c -- slide the deflate hash tables using SSE2
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * When the window slides, every position in the hash tables moves down by
+ * wsize, and positions that fall out of the window become NIL. That is an
+ * unsigned saturating subtraction, which SSE2 does for eight entries at once.
+ */
+
+#include "slide_hash_simd.h"
+
+#if defined(DEFLATE_SLIDE_HASH_SSE2)
+
+#include <emmintrin.h>
+
+void ZLIB_INTERNAL slide_hash_sse2(table, entries, wsize)
+    Posf *table;
+    unsigned entries;
+    unsigned wsize;
+{
+    const __m128i v_wsize = _mm_set1_epi16((short)wsize);
+    __m128i *p = (__m128i *)table;
+    unsigned n;
+
+    Assert(sizeof(Pos) == 2, "Pos is not 16 bits wide");
+    Assert(NIL == 0, "NIL is not 0");
+    Assert(entries % 8 == 0, "entries is not a multiple of 8");
+
+    for (n = entries / 8; n; n--, p++)
+        _mm_storeu_si128(p, _mm_subs_epu16(_mm_loadu_si128(p), v_wsize));
+}
+
+#endif /* DEFLATE_SLIDE_HASH_SSE2 */
@@ -0,0 +1,15 @@
+/* slide_hash_simd.h -- slide the deflate hash tables using SSE2
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef SLIDE_HASH_SIMD_H
+#define SLIDE_HASH_SIMD_H
+
+#include "deflate.h"
+
+/* Does what slide_hash() in deflate.c does to one of s->head and s->prev.
+   |entries| must be a multiple of 8. */
+void ZLIB_INTERNAL slide_hash_sse2 OF((Posf *table, unsigned entries,
+                                       unsigned wsize));
+
+#endif /* SLIDE_HASH_SIMD_H */
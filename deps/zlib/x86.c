@@ -0,0 +1,73 @@
+/* x86.c -- runtime detection of the x86 SIMD extensions zlib can use
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "x86.h"
+
+int ZLIB_INTERNAL x86_cpu_enable_sse2 = 0;
+int ZLIB_INTERNAL x86_cpu_enable_ssse3 = 0;
+int ZLIB_INTERNAL x86_cpu_enable_simd = 0;
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <windows.h>
+#else
+#include <cpuid.h>
+#include <pthread.h>
+#endif
+
+local void x86_probe_features OF((void));
+
+#if defined(_MSC_VER)
+
+static INIT_ONCE cpu_check_inited_once = INIT_ONCE_STATIC_INIT;
+
+local BOOL CALLBACK x86_check_features_once(PINIT_ONCE once, PVOID param,
+                                             PVOID *context)
+{
+    x86_probe_features();
+    return TRUE;
+}
+
+void ZLIB_INTERNAL x86_check_features(void)
+{
+    InitOnceExecuteOnce(&cpu_check_inited_once, x86_check_features_once,
+                        NULL, NULL);
+}
+
+#else
+
+static pthread_once_t cpu_check_inited_once = PTHREAD_ONCE_INIT;
+
+void ZLIB_INTERNAL x86_check_features(void)
+{
+    pthread_once(&cpu_check_inited_once, x86_probe_features);
+}
+
+#endif
+
+local void x86_probe_features(void)
+{
+    unsigned int ecx;
+    unsigned int edx;
+#if defined(_MSC_VER)
+    int regs[4];
+
+    __cpuid(regs, 1);
+    ecx = (unsigned int)regs[2];
+    edx = (unsigned int)regs[3];
+#else
+    unsigned int eax;
+    unsigned int ebx;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return;
+#endif
+
+    x86_cpu_enable_sse2 = (edx & 0x04000000) != 0;          /* SSE2 */
+    x86_cpu_enable_ssse3 = x86_cpu_enable_sse2 &&
+                           (ecx & 0x00000200) != 0;         /* SSSE3 */
+    x86_cpu_enable_simd = x86_cpu_enable_ssse3 &&
+                          (ecx & 0x00100000) != 0 &&        /* SSE4.2 */
+                          (ecx & 0x00000002) != 0;          /* PCLMULQDQ */
+}
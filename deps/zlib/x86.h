@@ -0,0 +1,20 @@
+/* x86.h -- runtime detection of the x86 SIMD extensions zlib can use
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef X86_H
+#define X86_H
+
+#include "zutil.h"
+
+/* Nonzero once x86_check_features() found the instructions that
+   adler32_simd.c, crc32_simd.c and slide_hash_simd.c need. */
+extern int ZLIB_INTERNAL x86_cpu_enable_sse2;
+extern int ZLIB_INTERNAL x86_cpu_enable_ssse3;
+extern int ZLIB_INTERNAL x86_cpu_enable_simd;   /* SSE4.2 and PCLMULQDQ */
+
+/* Fills in the flags above. Safe to call from several threads and more than
+   once; only the first call does any work. */
+void ZLIB_INTERNAL x86_check_features OF((void));
+
+#endif /* X86_H */
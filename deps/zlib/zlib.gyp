@@ -6,7 +6,57 @@
   'variables': {
     'use_system_zlib%': 0
   },
+  'target_defaults': {
+    'conditions': [
+      ['OS!="win"', {
+        'defines': [ 'Z_HAVE_UNISTD_H', 'HAVE_HIDDEN' ],
+      }],
+    ],
+  },
   'conditions': [
+    ['use_system_zlib==0 and (target_arch=="ia32" or target_arch=="x64")', {
+      # The SIMD code lives in separate targets because it has to be compiled
+      # for instruction set extensions that the rest of zlib must not use.
+      # x86.c checks at runtime which of them the CPU supports.
+      'targets': [
+        {
+          'target_name': 'zlib_adler32_simd',
+          'type': 'static_library',
+          'sources': [
+            'adler32_simd.c',
+            'adler32_simd.h',
+          ],
+          'include_dirs': [ '.' ],
+          'defines': [ 'ADLER32_SIMD_SSSE3' ],
+          'cflags': [ '-mssse3' ],
+          'xcode_settings': { 'OTHER_CFLAGS': [ '-mssse3' ] },
+        },
+        {
+          'target_name': 'zlib_crc32_simd',
+          'type': 'static_library',
+          'sources': [
+            'crc32_simd.c',
+            'crc32_simd.h',
+          ],
+          'include_dirs': [ '.' ],
+          'defines': [ 'CRC32_SIMD_SSE42_PCLMUL' ],
+          'cflags': [ '-msse4.2', '-mpclmul' ],
+          'xcode_settings': { 'OTHER_CFLAGS': [ '-msse4.2', '-mpclmul' ] },
+        },
+        {
+          'target_name': 'zlib_slide_hash_simd',
+          'type': 'static_library',
+          'sources': [
+            'slide_hash_simd.c',
+            'slide_hash_simd.h',
+          ],
+          'include_dirs': [ '.' ],
+          'defines': [ 'DEFLATE_SLIDE_HASH_SSE2' ],
+          'cflags': [ '-msse2' ],
+          'xcode_settings': { 'OTHER_CFLAGS': [ '-msse2' ] },
+        },
+      ],
+    }],
     ['use_system_zlib==0', {
       'targets': [
         {
@@ -51,7 +101,23 @@
           'conditions': [
             ['OS!="win"', {
               'cflags!': [ '-ansi' ],
-              'defines': [ 'Z_HAVE_UNISTD_H', 'HAVE_HIDDEN' ],
+            }],
+            ['target_arch=="ia32" or target_arch=="x64"', {
+              'sources': [
+                'x86.c',
+                'x86.h',
+              ],
+              'defines': [
+                'X86_SIMD',
+                'ADLER32_SIMD_SSSE3',
+                'CRC32_SIMD_SSE42_PCLMUL',
+                'DEFLATE_SLIDE_HASH_SSE2',
+              ],
+              'dependencies': [
+                'zlib_adler32_simd',
+                'zlib_crc32_simd',
+                'zlib_slide_hash_simd',
+              ],
             }],
             ['OS=="mac" or OS=="ios" or OS=="freebsd" or OS=="android"', {
               # Mac, Android and the BSDs don't have fopen64, ftello64, or
@@ -23,21 +23,28 @@
 
 const {
   byteLengthUtf8,
+  concat: _concat,
   copy: _copy,
   compare: _compare,
   compareOffset,
   createFromString,
   fill: bindingFill,
+  getAllocatorStatistics: _getAllocatorStatistics,
   indexOfBuffer,
   indexOfNumber,
   indexOfString,
+  poolAcquire,
+  poolRelease,
   swap16: _swap16,
   swap32: _swap32,
   swap64: _swap64,
+  timingSafeEquals: _timingSafeEquals,
   writeDoubleBE: _writeDoubleBE,
   writeDoubleLE: _writeDoubleLE,
   writeFloatBE: _writeFloatBE,
   writeFloatLE: _writeFloatLE,
+  setAllocatorRetentionLimit: _setAllocatorRetentionLimit,
+  kAllocatorStatisticsLength,
   kMaxLength,
   kStringMaxLength
 } = process.binding('buffer');
@@ -57,6 +64,7 @@ const {
 const errors = require('internal/errors');
 
 const internalBuffer = require('internal/buffer');
+const { BufferCursor, BufferSchema } = require('internal/buffer_cursor');
 
 const { setupBufferJS } = internalBuffer;
 
@@ -301,6 +309,28 @@ Object.setPrototypeOf(SlowBuffer.prototype, Uint8Array.prototype);
 Object.setPrototypeOf(SlowBuffer, Uint8Array);
 
 
+// Explicitly managed Buffers for hot I/O paths. Released Buffers are detached
+// and their memory is handed out again by later acquire() calls.
+Buffer.pool = {
+  acquire(size) {
+    assertSize(size);
+    const length = size >>> 0;
+    if (length === 0)
+      return new FastBuffer();
+    return poolAcquire(length) || createUnsafeBuffer(length);
+  },
+
+  release(buf) {
+    if (!isUint8Array(buf)) {
+      throw new errors.TypeError(
+        'ERR_INVALID_ARG_TYPE', 'buf', ['Buffer', 'Uint8Array']
+      );
+    }
+    return poolRelease(buf);
+  }
+};
+
+
 function allocate(size) {
   if (size <= 0) {
     return new FastBuffer();
@@ -460,16 +490,12 @@ Buffer.concat = function concat(list, length) {
   }
 
   var buffer = Buffer.allocUnsafe(length);
-  var pos = 0;
-  for (i = 0; i < list.length; i++) {
-    var buf = list[i];
-    if (!isUint8Array(buf)) {
-      throw new errors.TypeError(
-        'ERR_INVALID_ARG_TYPE', 'list', ['Array', 'Buffer', 'Uint8Array']
-      );
-    }
-    _copy(buf, buffer, pos);
-    pos += buf.length;
+  // Copy every chunk with a single binding call instead of one per chunk.
+  var pos = _concat(buffer, list);
+  if (pos === -1) {
+    throw new errors.TypeError(
+      'ERR_INVALID_ARG_TYPE', 'list', ['Array', 'Buffer', 'Uint8Array']
+    );
   }
 
   // Note: `length` is always equal to `buffer.length` at this point
@@ -662,15 +688,26 @@ Buffer.prototype.toString = function toString(encoding, start, end) {
 };
 
 
-Buffer.prototype.equals = function equals(b) {
+Buffer.prototype.equals = function equals(b, options) {
   if (!isUint8Array(b)) {
     throw new errors.TypeError(
       'ERR_INVALID_ARG_TYPE', 'otherBuffer',
       ['Buffer', 'Uint8Array'], b
     );
   }
+  if (options !== undefined) {
+    if (options === null || typeof options !== 'object') {
+      throw new errors.TypeError(
+        'ERR_INVALID_ARG_TYPE', 'options', 'Object', options
+      );
+    }
+    if (options.constantTime)
+      return _timingSafeEquals(this, b);
+  }
   if (this === b)
     return true;
+  if (this.length !== b.length)
+    return false;
 
   return _compare(this, b) === 0;
 };
@@ -1623,12 +1660,22 @@ Buffer.prototype.swap64 = function swap64() {
 Buffer.prototype.toLocaleString = Buffer.prototype.toString;
 
 let transcode;
+let transcodeMany;
 if (process.binding('config').hasIntl) {
   const {
     icuErrName,
-    transcode: _transcode
+    transcode: _transcode,
+    transcodeMany: _transcodeMany
   } = process.binding('icu');
 
+  function transcodeException(result) {
+    const code = icuErrName(result);
+    const err = new Error(`Unable to transcode Buffer [${code}]`);
+    err.code = code;
+    err.errno = result;
+    return err;
+  }
+
   // Transcodes the Buffer from one encoding to another, returning a new
   // Buffer instance.
   transcode = function transcode(source, fromEncoding, toEncoding) {
@@ -1644,18 +1691,84 @@ if (process.binding('config').hasIntl) {
     if (typeof result !== 'number')
       return result;
 
-    const code = icuErrName(result);
-    const err = new Error(`Unable to transcode Buffer [${code}]`);
-    err.code = code;
-    err.errno = result;
-    throw err;
+    throw transcodeException(result);
   };
+
+  // Transcodes an array of Buffers from one encoding to another in a single
+  // call, returning an array of new Buffer instances.
+  transcodeMany = function transcodeMany(sources, fromEncoding, toEncoding) {
+    if (!Array.isArray(sources)) {
+      throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'sources', 'Array',
+                                 sources);
+    }
+    for (var i = 0; i < sources.length; i++) {
+      if (!isUint8Array(sources[i])) {
+        throw new errors.TypeError('ERR_INVALID_ARG_TYPE', `sources[${i}]`,
+                                   ['Buffer', 'Uint8Array'], sources[i]);
+      }
+    }
+
+    fromEncoding = normalizeEncoding(fromEncoding) || fromEncoding;
+    toEncoding = normalizeEncoding(toEncoding) || toEncoding;
+    const result = _transcodeMany(sources, fromEncoding, toEncoding);
+    if (typeof result !== 'number')
+      return result;
+
+    throw transcodeException(result);
+  };
+}
+
+// Mirrors SizeClassAllocator::StatisticsFields in src/node_buffer_allocator.h.
+const kAllocatorClassFieldsStart = 6;
+const kAllocatorClassFieldCount = 5;
+
+function getAllocatorStatistics() {
+  const fields = new Float64Array(kAllocatorStatisticsLength);
+  if (!_getAllocatorStatistics(fields))
+    return undefined;
+
+  const sizeClasses = [];
+  for (var i = kAllocatorClassFieldsStart;
+    i < kAllocatorStatisticsLength;
+    i += kAllocatorClassFieldCount) {
+    sizeClasses.push({
+      size: fields[i],
+      slabs: fields[i + 1],
+      blocksInUse: fields[i + 2],
+      blocksFree: fields[i + 3],
+      allocations: fields[i + 4]
+    });
+  }
+  return {
+    retentionLimit: fields[0],
+    slabSize: fields[1],
+    slabs: fields[2],
+    retainedSlabs: fields[3],
+    poolBlocksInUse: fields[4],
+    poolRetainedBytes: fields[5],
+    sizeClasses
+  };
+}
+
+function setAllocatorRetentionLimit(limit) {
+  if (typeof limit !== 'number')
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'limit', 'number');
+  if (!Number.isSafeInteger(limit) || limit < 0) {
+    throw new errors.RangeError('ERR_OUT_OF_RANGE', 'limit',
+                                '>= 0 and <= Number.MAX_SAFE_INTEGER', limit);
+  }
+  _setAllocatorRetentionLimit(limit);
 }
 
 module.exports = exports = {
   Buffer,
+  BufferCursor,
+  BufferSchema,
   SlowBuffer,
+  getAllocatorStatistics,
+  setAllocatorRetentionLimit,
   transcode,
+  transcodeMany,
   INSPECT_MAX_BYTES: 50,
 
   // Legacy
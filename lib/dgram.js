@@ -41,9 +41,17 @@ const BIND_STATE_UNBOUND = 0;
 const BIND_STATE_BINDING = 1;
 const BIND_STATE_BOUND = 2;
 
+const CONNECT_STATE_DISCONNECTED = 0;
+const CONNECT_STATE_CONNECTING = 1;
+const CONNECT_STATE_CONNECTED = 2;
+
 const RECV_BUFFER = true;
 const SEND_BUFFER = false;
 
+// The most datagrams a single recvmmsg() call takes.
+const kMaxRecvBatchSize = 1024;
+const kMaxDatagramSize = 64 * 1024;
+
 // Lazily loaded
 var cluster = null;
 
@@ -78,6 +86,8 @@ function newHandle(type, lookup) {
     handle.lookup = lookup6.bind(handle, lookup);
     handle.bind = handle.bind6;
     handle.send = handle.send6;
+    handle.sendBatch = handle.sendBatch6;
+    handle.connect = handle.connect6;
     return handle;
   }
 
@@ -115,6 +125,10 @@ function Socket(type, listener) {
     lookup = options.lookup;
     this[kOptionSymbol].recvBufferSize = options.recvBufferSize;
     this[kOptionSymbol].sendBufferSize = options.sendBufferSize;
+    this[kOptionSymbol].recvBatchSize =
+      validateSizeOption(options, 'recvBatchSize', kMaxRecvBatchSize);
+    this[kOptionSymbol].maxDatagramSize =
+      validateSizeOption(options, 'maxDatagramSize', kMaxDatagramSize);
   }
 
   var handle = newHandle(type, lookup);
@@ -123,6 +137,7 @@ function Socket(type, listener) {
   this._handle = handle;
   this._receiving = false;
   this._bindState = BIND_STATE_UNBOUND;
+  this._connectState = CONNECT_STATE_DISCONNECTED;
   this[async_id_symbol] = this._handle.getAsyncId();
   this.type = type;
   this.fd = null; // compatibility hack
@@ -136,6 +151,22 @@ function Socket(type, listener) {
 util.inherits(Socket, EventEmitter);
 
 
+function validateSizeOption(options, name, max) {
+  const size = options[name];
+  if (size === undefined)
+    return size;
+  if (typeof size !== 'number') {
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', `options.${name}`,
+                               'number', size);
+  }
+  if (!Number.isInteger(size) || size < 1 || size > max) {
+    throw new errors.RangeError('ERR_OUT_OF_RANGE', `options.${name}`,
+                                `an integer >= 1 and <= ${max}`, size);
+  }
+  return size;
+}
+
+
 function createSocket(type, listener) {
   return new Socket(type, listener);
 }
@@ -143,6 +174,11 @@ function createSocket(type, listener) {
 
 function startListening(socket) {
   socket._handle.onmessage = onMessage;
+  socket._handle.onbatch = onMessageBatch;
+  if (socket[kOptionSymbol].maxDatagramSize)
+    socket._handle.setMaxDatagramSize(socket[kOptionSymbol].maxDatagramSize);
+  if (socket[kOptionSymbol].recvBatchSize)
+    socket._handle.setRecvBatchSize(socket[kOptionSymbol].recvBatchSize);
   // Todo: handle errors
   socket._handle.recvStart();
   socket._receiving = true;
@@ -164,6 +200,8 @@ function replaceHandle(self, newHandle) {
   newHandle.lookup = self._handle.lookup;
   newHandle.bind = self._handle.bind;
   newHandle.send = self._handle.send;
+  newHandle.sendBatch = self._handle.sendBatch;
+  newHandle.connect = self._handle.connect;
   newHandle.owner = self;
 
   // Replace the existing handle by the handle we got from master.
@@ -282,6 +320,97 @@ Socket.prototype.bind = function(port_, address_ /*, callback*/) {
 };
 
 
+Socket.prototype.connect = function(port, address, callback) {
+  port = port >>> 0;
+  if (port === 0 || port > 65535)
+    throw new errors.RangeError('ERR_SOCKET_BAD_PORT', port);
+
+  if (typeof address === 'function') {
+    callback = address;
+    address = '';
+  } else if (address === undefined) {
+    address = '';
+  } else if (typeof address !== 'string') {
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'address', 'string',
+                               address);
+  }
+
+  this._healthCheck();
+
+  if (this._connectState !== CONNECT_STATE_DISCONNECTED)
+    throw new errors.Error('ERR_SOCKET_DGRAM_IS_CONNECTED');
+
+  this._connectState = CONNECT_STATE_CONNECTING;
+  if (typeof callback === 'function')
+    this.once('connect', callback);
+
+  if (this._bindState === BIND_STATE_UNBOUND)
+    this.bind({ port: 0, exclusive: true }, null);
+
+  if (this._bindState !== BIND_STATE_BOUND) {
+    enqueue(this, lookupConnect.bind(null, this, port, address, callback));
+    return;
+  }
+
+  lookupConnect(this, port, address, callback);
+};
+
+
+function lookupConnect(self, port, address, callback) {
+  const afterDns = (ex, ip) => {
+    defaultTriggerAsyncIdScope(
+      self[async_id_symbol],
+      doConnect,
+      ex, self, ip, address, port, callback
+    );
+  };
+
+  self._handle.lookup(address, afterDns);
+}
+
+
+function doConnect(ex, self, ip, address, port, callback) {
+  if (!self._handle)
+    return;
+
+  if (!ex) {
+    const err = self._handle.connect(ip, port);
+    if (err)
+      ex = exceptionWithHostPort(err, 'connect', address, port);
+  }
+
+  if (ex) {
+    self._connectState = CONNECT_STATE_DISCONNECTED;
+    process.nextTick(() => {
+      if (typeof callback === 'function') {
+        self.removeListener('connect', callback);
+        callback(ex);
+      } else {
+        self.emit('error', ex);
+      }
+    });
+    return;
+  }
+
+  self._connectState = CONNECT_STATE_CONNECTED;
+  process.nextTick(() => self.emit('connect'));
+}
+
+
+Socket.prototype.disconnect = function() {
+  this._healthCheck();
+
+  if (this._connectState !== CONNECT_STATE_CONNECTED)
+    throw new errors.Error('ERR_SOCKET_DGRAM_NOT_CONNECTED');
+
+  const err = this._handle.disconnect();
+  if (err)
+    throw errnoException(err, 'connect');
+
+  this._connectState = CONNECT_STATE_DISCONNECTED;
+};
+
+
 // thin wrapper around `send`, here for compatibility with dgram_legacy.js
 Socket.prototype.sendto = function(buffer,
                                    offset,
@@ -386,6 +515,11 @@ function clearQueue() {
 // send(bufferOrList, port, address)
 // send(bufferOrList, port, callback)
 // send(bufferOrList, port)
+// and on a connected socket
+// send(buffer, offset, length, callback)
+// send(buffer, offset, length)
+// send(bufferOrList, callback)
+// send(bufferOrList)
 Socket.prototype.send = function(buffer,
                                  offset,
                                  length,
@@ -393,13 +527,29 @@ Socket.prototype.send = function(buffer,
                                  address,
                                  callback) {
   let list;
+  const connected = this._connectState === CONNECT_STATE_CONNECTED;
 
-  if (address || (port && typeof port !== 'function')) {
-    buffer = sliceBuffer(buffer, offset, length);
+  if (!connected) {
+    if (address || (port && typeof port !== 'function')) {
+      buffer = sliceBuffer(buffer, offset, length);
+    } else {
+      callback = port;
+      port = offset;
+      address = length;
+    }
   } else {
-    callback = port;
-    port = offset;
-    address = length;
+    if (typeof length === 'number') {
+      buffer = sliceBuffer(buffer, offset, length);
+      if (typeof port === 'function') {
+        callback = port;
+        port = null;
+      }
+    } else {
+      callback = offset;
+    }
+
+    if (port || address)
+      throw new errors.Error('ERR_SOCKET_DGRAM_IS_CONNECTED');
   }
 
   if (!Array.isArray(buffer)) {
@@ -418,9 +568,11 @@ Socket.prototype.send = function(buffer,
                                ['Buffer', 'string']);
   }
 
-  port = port >>> 0;
-  if (port === 0 || port > 65535)
-    throw new errors.RangeError('ERR_SOCKET_BAD_PORT', port);
+  if (!connected) {
+    port = port >>> 0;
+    if (port === 0 || port > 65535)
+      throw new errors.RangeError('ERR_SOCKET_BAD_PORT', port);
+  }
 
   // Normalize callback so it's either a function or undefined but not anything
   // else.
@@ -451,6 +603,16 @@ Socket.prototype.send = function(buffer,
     return;
   }
 
+  // Connected sockets already know where datagrams go.
+  if (connected) {
+    defaultTriggerAsyncIdScope(
+      this[async_id_symbol],
+      doSend,
+      null, this, null, list, address, port, callback
+    );
+    return;
+  }
+
   const afterDns = (ex, ip) => {
     defaultTriggerAsyncIdScope(
       this[async_id_symbol],
@@ -484,12 +646,12 @@ function doSend(ex, self, ip, list, address, port, callback) {
     req.oncomplete = afterSend;
   }
 
-  var err = self._handle.send(req,
-                              list,
-                              list.length,
-                              port,
-                              ip,
-                              !!callback);
+  var err;
+  if (port) {
+    err = self._handle.send(req, list, list.length, port, ip, !!callback);
+  } else {
+    err = self._handle.send(req, list, list.length, !!callback);
+  }
 
   if (err && callback) {
     // don't emit as error, dgram_legacy.js compatibility
@@ -508,6 +670,160 @@ function afterSend(err, sent) {
   this.callback(err, sent);
 }
 
+// sendBatch([{ msg, port, address }, ...], callback)
+// sendBatch([{ msg }, ...], callback) on a connected socket
+Socket.prototype.sendBatch = function(messages, callback) {
+  if (!Array.isArray(messages)) {
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'messages', 'Array',
+                               messages);
+  }
+
+  const connected = this._connectState === CONNECT_STATE_CONNECTED;
+  const buffers = new Array(messages.length);
+  const ports = connected ? null : new Array(messages.length);
+  const addresses = connected ? null : new Array(messages.length);
+
+  for (var i = 0; i < messages.length; i++) {
+    const message = messages[i];
+    if (message === null || typeof message !== 'object') {
+      throw new errors.TypeError('ERR_INVALID_ARG_TYPE', `messages[${i}]`,
+                                 'Object', message);
+    }
+
+    const { msg, address } = message;
+    if (typeof msg === 'string') {
+      buffers[i] = Buffer.from(msg);
+    } else if (isUint8Array(msg)) {
+      buffers[i] = msg;
+    } else {
+      throw new errors.TypeError('ERR_INVALID_ARG_TYPE', `messages[${i}].msg`,
+                                 ['Buffer', 'Uint8Array', 'string'], msg);
+    }
+
+    if (connected) {
+      if (message.port || address)
+        throw new errors.Error('ERR_SOCKET_DGRAM_IS_CONNECTED');
+      continue;
+    }
+
+    const port = message.port >>> 0;
+    if (port === 0 || port > 65535)
+      throw new errors.RangeError('ERR_SOCKET_BAD_PORT', port);
+    ports[i] = port;
+
+    if (address && typeof address !== 'string') {
+      throw new errors.TypeError('ERR_INVALID_ARG_TYPE',
+                                 `messages[${i}].address`,
+                                 ['string', 'falsy'], address);
+    }
+    addresses[i] = address || undefined;
+  }
+
+  if (typeof callback !== 'function')
+    callback = undefined;
+
+  this._healthCheck();
+
+  if (this._bindState === BIND_STATE_UNBOUND)
+    this.bind({ port: 0, exclusive: true }, null);
+
+  if (this._bindState !== BIND_STATE_BOUND) {
+    enqueue(this, lookupBatch.bind(null, this, buffers, ports, addresses,
+                                   callback));
+    return;
+  }
+
+  if (connected) {
+    defaultTriggerAsyncIdScope(
+      this[async_id_symbol],
+      doSendBatch,
+      null, this, buffers, null, null, null, callback
+    );
+    return;
+  }
+
+  lookupBatch(this, buffers, ports, addresses, callback);
+};
+
+// Resolves every distinct address of a batch once, then sends the batch.
+function lookupBatch(self, buffers, ports, addresses, callback) {
+  const unique = Array.from(new Set(addresses));
+  const ips = new Map();
+  var pending = unique.length;
+  var failed = false;
+
+  const afterDns = (ex) => {
+    defaultTriggerAsyncIdScope(
+      self[async_id_symbol],
+      doSendBatch,
+      ex, self, buffers, ports, addresses, ips, callback
+    );
+  };
+
+  if (pending === 0)
+    return afterDns(null);
+
+  for (var i = 0; i < unique.length; i++) {
+    const address = unique[i];
+    self._handle.lookup(address, (ex, ip) => {
+      if (failed)
+        return;
+      if (ex) {
+        failed = true;
+        return afterDns(ex);
+      }
+      ips.set(address, ip);
+      if (--pending === 0)
+        afterDns(null);
+    });
+  }
+}
+
+function doSendBatch(ex, self, buffers, ports, addresses, ips, callback) {
+  if (ex) {
+    if (typeof callback === 'function') {
+      process.nextTick(callback, ex);
+      return;
+    }
+
+    process.nextTick(() => self.emit('error', ex));
+    return;
+  } else if (!self._handle) {
+    return;
+  }
+
+  var req = new SendWrap();
+  req.list = buffers;  // Keep reference alive.
+  if (callback) {
+    req.callback = callback;
+    req.oncomplete = afterSendBatch;
+  }
+
+  var err;
+  if (ports) {
+    const ipList = new Array(addresses.length);
+    for (var i = 0; i < addresses.length; i++)
+      ipList[i] = ips.get(addresses[i]);
+    err = self._handle.sendBatch(req, buffers, ports, ipList, buffers.length,
+                                 !!callback);
+  } else {
+    err = self._handle.sendBatch(req, buffers, buffers.length, !!callback);
+  }
+
+  if (err && callback)
+    process.nextTick(callback, errnoException(err, 'send'));
+}
+
+function afterSendBatch(err, sent) {
+  if (err) {
+    err = errnoException(err, 'send');
+  } else {
+    err = null;
+  }
+
+  this.callback(err, sent);
+}
+
 Socket.prototype.close = function(callback) {
   if (typeof callback === 'function')
     this.on('close', callback);
@@ -545,6 +861,22 @@ Socket.prototype.address = function() {
 };
 
 
+Socket.prototype.remoteAddress = function() {
+  this._healthCheck();
+
+  if (this._connectState !== CONNECT_STATE_CONNECTED)
+    throw new errors.Error('ERR_SOCKET_DGRAM_NOT_CONNECTED');
+
+  var out = {};
+  var err = this._handle.getpeername(out);
+  if (err) {
+    throw errnoException(err, 'getpeername');
+  }
+
+  return out;
+};
+
+
 Socket.prototype.setBroadcast = function(arg) {
   var err = this._handle.setBroadcast(arg ? 1 : 0);
   if (err) {
@@ -567,6 +899,36 @@ Socket.prototype.setTTL = function(ttl) {
 };
 
 
+Socket.prototype.setGSO = function(segmentSize) {
+  if (typeof segmentSize !== 'number') {
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'segmentSize', 'number',
+                               segmentSize);
+  }
+  if (!Number.isInteger(segmentSize) || segmentSize < 0 ||
+      segmentSize > 65535) {
+    throw new errors.RangeError('ERR_OUT_OF_RANGE', 'segmentSize',
+                                'an integer >= 0 and <= 65535', segmentSize);
+  }
+
+  this._healthCheck();
+
+  var err = this._handle.setGSO(segmentSize);
+  if (err) {
+    throw errnoException(err, 'setGSO');
+  }
+};
+
+
+Socket.prototype.setGRO = function(flag) {
+  this._healthCheck();
+
+  var err = this._handle.setGRO(!!flag);
+  if (err) {
+    throw errnoException(err, 'setGRO');
+  }
+};
+
+
 Socket.prototype.setMulticastTTL = function(ttl) {
   if (typeof ttl !== 'number') {
     throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'ttl', 'number', ttl);
@@ -664,6 +1026,11 @@ function onMessage(nread, handle, buf, rinfo) {
 }
 
 
+function onMessageBatch(count, handle, buf, offsets, rinfos) {
+  handle.owner.emit('messages', buf, offsets, rinfos);
+}
+
+
 Socket.prototype.ref = function() {
   if (this._handle)
     this._handle.ref();
@@ -36,6 +36,16 @@ const {
 const IANA_DNS_PORT = 53;
 const dnsException = errors.dnsException;
 
+// How dns.lookup() resolves names when no mode is passed to it.
+let lookupMode = 'getaddrinfo';
+
+function validateLookupMode(name, mode) {
+  if (mode !== 'getaddrinfo' && mode !== 'cares') {
+    throw new errors.TypeError('ERR_INVALID_ARG_VALUE', name, mode,
+                               "must be 'getaddrinfo' or 'cares'");
+  }
+}
+
 function onlookup(err, addresses) {
   if (err) {
     return this.callback(dnsException(err, 'getaddrinfo', this.hostname));
@@ -73,6 +83,7 @@ function lookup(hostname, options, callback) {
   var family = -1;
   var all = false;
   var verbatim = false;
+  var mode = lookupMode;
 
   // Parse arguments
   if (hostname && typeof hostname !== 'string') {
@@ -88,6 +99,10 @@ function lookup(hostname, options, callback) {
     family = options.family >>> 0;
     all = options.all === true;
     verbatim = options.verbatim === true;
+    if (options.mode !== undefined) {
+      validateLookupMode('options.mode', options.mode);
+      mode = options.mode;
+    }
 
     if (hints !== 0 &&
         hints !== cares.AI_ADDRCONFIG &&
@@ -128,7 +143,13 @@ function lookup(hostname, options, callback) {
   req.hostname = hostname;
   req.oncomplete = all ? onlookupall : onlookup;
 
-  var err = cares.getaddrinfo(req, hostname, family, hints, verbatim);
+  var err;
+  if (mode === 'cares') {
+    err = defaultResolver._handle.getaddrinfo(req, hostname, family, hints,
+                                              verbatim);
+  } else {
+    err = cares.getaddrinfo(req, hostname, family, hints, verbatim);
+  }
   if (err) {
     process.nextTick(callback, dnsException(err, 'getaddrinfo', hostname));
     return {};
@@ -140,6 +161,12 @@ Object.defineProperty(lookup, customPromisifyArgs,
                       { value: ['address', 'family'], enumerable: false });
 
 
+function setLookupMode(mode) {
+  validateLookupMode('mode', mode);
+  lookupMode = mode;
+}
+
+
 function onlookupservice(err, host, service) {
   if (err)
     return this.callback(dnsException(err, 'getnameinfo', this.host));
@@ -179,6 +206,49 @@ Object.defineProperty(lookupService, customPromisifyArgs,
                       { value: ['hostname', 'service'], enumerable: false });
 
 
+function validateCacheOption(options, name, defaultValue, range, max) {
+  const value = options[name];
+  if (value === undefined)
+    return defaultValue;
+  if (typeof value !== 'number') {
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', `options.${name}`,
+                               'number', value);
+  }
+  if (!(value >= 0 && value <= max) ||
+      (name === 'maxEntries' && !Number.isInteger(value))) {
+    throw new errors.RangeError('ERR_OUT_OF_RANGE', `options.${name}`,
+                                range, value);
+  }
+  return value;
+}
+
+// The cache is disabled until it is given a maximum TTL. TTLs are in seconds,
+// like the ones of DNS records.
+function setCacheOptions(options) {
+  if (options === null || typeof options !== 'object') {
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'options', 'Object',
+                               options);
+  }
+  const maxTtl = validateCacheOption(options, 'maxTtl', 0,
+                                     '>= 0 and <= 2^31 - 1', 2 ** 31 - 1);
+  const negativeTtl = validateCacheOption(options, 'negativeTtl', 0,
+                                          '>= 0 and <= 2^31 - 1', 2 ** 31 - 1);
+  const maxEntries = validateCacheOption(options, 'maxEntries', 1000,
+                                         'an integer >= 0 and <= 2^32 - 1',
+                                         2 ** 32 - 1);
+  cares.setCacheOptions(maxTtl * 1000, negativeTtl * 1000, maxEntries);
+}
+
+function clearCache() {
+  cares.clearCache();
+}
+
+function getCacheStats() {
+  const [hits, misses, coalesced, evictions, entries] = cares.getCacheStats();
+  return { hits, misses, coalesced, evictions, entries };
+}
+
+
 function onresolve(err, result, ttls) {
   if (ttls && this.ttl)
     result = result.map((address, index) => ({ address, ttl: ttls[index] }));
@@ -359,10 +429,15 @@ function defaultResolverSetServers(servers) {
 module.exports = {
   lookup,
   lookupService,
+  setLookupMode,
 
   Resolver,
   setServers: defaultResolverSetServers,
 
+  setCacheOptions,
+  clearCache,
+  getCacheStats,
+
   // uv_getaddrinfo flags
   ADDRCONFIG: cares.AI_ADDRCONFIG,
   V4MAPPED: cares.AI_V4MAPPED,
@@ -201,9 +201,9 @@ fs.access = function(path, mode, callback) {
   validatePath(path);
 
   mode = mode | 0;
-  var req = new FSReqWrap();
-  req.oncomplete = makeCallback(callback);
-  binding.access(pathModule.toNamespacedPath(path), mode, req);
+  // Passing the callback itself lets the binding use a pooled request
+  // instead of a fresh FSReqWrap; it is invoked with an undefined receiver.
+  binding.access(pathModule.toNamespacedPath(path), mode, callback);
 };
 fs.access = stackContext.wrapFunction(
   { [FILE_ACCESS]: { list: '{0}' } },
@@ -933,9 +933,7 @@ fs.readdirSync = stackContext.wrapFunction(
 
 fs.fstat = function(fd, callback) {
   validateUint32(fd, 'fd');
-  const req = new FSReqWrap();
-  req.oncomplete = makeStatsCallback(callback);
-  binding.fstat(fd, req);
+  binding.fstat(fd, makeStatsCallback(callback));
 };
 // Explicitly no security check, because it's working  on a fd.
 
@@ -943,9 +941,7 @@ fs.lstat = function(path, callback) {
   callback = makeStatsCallback(callback);
   path = getPathFromURL(path);
   validatePath(path);
-  const req = new FSReqWrap();
-  req.oncomplete = callback;
-  binding.lstat(pathModule.toNamespacedPath(path), req);
+  binding.lstat(pathModule.toNamespacedPath(path), callback);
 };
 fs.lstat = stackContext.wrapFunction(
   { [FILE_ACCESS]: { list: '{0}' } },
@@ -955,9 +951,7 @@ fs.stat = function(path, callback) {
   callback = makeStatsCallback(callback);
   path = getPathFromURL(path);
   validatePath(path);
-  const req = new FSReqWrap();
-  req.oncomplete = callback;
-  binding.stat(pathModule.toNamespacedPath(path), req);
+  binding.stat(pathModule.toNamespacedPath(path), callback);
 };
 fs.stat = stackContext.wrapFunction(
   { [FILE_ACCESS]: { list: '{0}' } },
@@ -1481,6 +1475,20 @@ function FSWatcher() {
       self.emit('change', eventType, filename);
     }
   };
+
+  // Only used when events are batched, see the `batchWindow` option.
+  this._handle.onbatch = function(events, overflow) {
+    const changes = new Array(events.length / 2);
+    for (var i = 0; i < events.length; i += 2)
+      changes[i / 2] = { eventType: events[i], filename: events[i + 1] };
+    self.emit('changes', changes, overflow);
+    if (overflow)
+      self.emit('overflow');
+  };
+
+  this._handle.onoverflow = function() {
+    self.emit('overflow');
+  };
 }
 util.inherits(FSWatcher, EventEmitter);
 
@@ -1492,13 +1500,17 @@ util.inherits(FSWatcher, EventEmitter);
 FSWatcher.prototype.start = function(filename,
                                      persistent,
                                      recursive,
-                                     encoding) {
+                                     encoding,
+                                     batchWindow,
+                                     maxBatchSize) {
   filename = getPathFromURL(filename);
   nullCheck(filename, 'filename');
   var err = this._handle.start(pathModule.toNamespacedPath(filename),
                                persistent,
                                recursive,
-                               encoding);
+                               encoding,
+                               batchWindow,
+                               maxBatchSize);
   if (err) {
     this._handle.close();
     const error = errnoException(err, `watch ${filename}`);
@@ -1523,14 +1535,32 @@ fs.watch = function(filename, options, listener) {
   if (options.persistent === undefined) options.persistent = true;
   if (options.recursive === undefined) options.recursive = false;
 
+  const batched = options.batchWindow !== undefined;
+  if (batched) {
+    validateUint32(options.batchWindow, 'options.batchWindow');
+    if (options.maxBatchSize === undefined) {
+      options.maxBatchSize = 1024;
+    } else {
+      validateUint32(options.maxBatchSize, 'options.maxBatchSize');
+      if (options.maxBatchSize === 0) {
+        throw new errors.RangeError('ERR_OUT_OF_RANGE',
+                                    'options.maxBatchSize',
+                                    '> 0',
+                                    options.maxBatchSize);
+      }
+    }
+  }
+
   const watcher = new FSWatcher();
   watcher.start(filename,
                 options.persistent,
                 options.recursive,
-                options.encoding);
+                options.encoding,
+                options.batchWindow,
+                options.maxBatchSize);
 
   if (listener) {
-    watcher.addListener('change', listener);
+    watcher.addListener(batched ? 'changes' : 'change', listener);
   }
 
   return watcher;
@@ -2033,7 +2063,11 @@ fs.mkdtempSync = function(prefix, options) {
 
 // Define copyFile() flags.
 Object.defineProperties(fs.constants, {
-  COPYFILE_EXCL: { enumerable: true, value: constants.UV_FS_COPYFILE_EXCL }
+  COPYFILE_EXCL: { enumerable: true, value: constants.UV_FS_COPYFILE_EXCL },
+  COPYFILE_FICLONE_FORCE: {
+    enumerable: true,
+    value: constants.UV_FS_COPYFILE_FICLONE_FORCE
+  }
 });
 
 
@@ -2078,6 +2112,72 @@ fs.copyFileSync = stackContext.wrapFunction(
   fs.copyFileSync);
 
 
+fs.copy = function(src, dest, options, callback) {
+  if (typeof options === 'function') {
+    callback = options;
+    options = {};
+  } else if (typeof callback !== 'function') {
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'callback', 'Function');
+  } else if (options === undefined) {
+    options = {};
+  }
+  if (options === null || typeof options !== 'object') {
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'options', 'Object');
+  }
+
+  src = getPathFromURL(src);
+  dest = getPathFromURL(dest);
+  validatePath(src, 'src');
+  validatePath(dest, 'dest');
+
+  const flags = options.flags === undefined ? 0 : options.flags | 0;
+  const recursive = options.recursive === true;
+  let concurrency = 0;  // The size of the threadpool, see CopyTree().
+  if (options.concurrency !== undefined) {
+    validateUint32(options.concurrency, 'options.concurrency');
+    if (options.concurrency === 0) {
+      throw new errors.RangeError('ERR_OUT_OF_RANGE',
+                                  'options.concurrency',
+                                  '> 0',
+                                  options.concurrency);
+    }
+    concurrency = options.concurrency;
+  }
+  let progressInterval = 100;
+  if (options.progressInterval !== undefined) {
+    validateUint32(options.progressInterval, 'options.progressInterval');
+    progressInterval = options.progressInterval;
+  }
+
+  src = pathModule.resolve(src);
+  dest = pathModule.resolve(dest);
+  if (recursive && dest.startsWith(src + pathModule.sep)) {
+    throw new errors.TypeError('ERR_INVALID_ARG_VALUE', 'dest', dest,
+                               'must not be inside of src');
+  }
+
+  const emitter = new EventEmitter();
+  const onprogress = (bytesCopied, totalBytes, filesCopied, totalFiles) => {
+    emitter.emit('progress',
+                 { bytesCopied, totalBytes, filesCopied, totalFiles });
+  };
+  const req = new FSReqWrap();
+  req.oncomplete = makeCallback(callback);
+  binding.copyTree(pathModule.toNamespacedPath(src),
+                   pathModule.toNamespacedPath(dest),
+                   flags,
+                   recursive,
+                   concurrency,
+                   progressInterval,
+                   onprogress,
+                   req);
+  return emitter;
+};
+fs.copy = stackContext.wrapFunction(
+  { [FILE_ACCESS]: { read: '{0}', write: '{1}' } },
+  fs.copy);
+
+
 var pool;
 
 function allocNewPool(poolSize) {
@@ -0,0 +1,185 @@
+'use strict';
+
+const {
+  read: _read,
+  write: _write,
+  byteLength: _byteLength,
+  kUInt8,
+  kInt8,
+  kUInt16LE,
+  kUInt16BE,
+  kInt16LE,
+  kInt16BE,
+  kUInt32LE,
+  kUInt32BE,
+  kInt32LE,
+  kInt32BE,
+  kFloatLE,
+  kFloatBE,
+  kDoubleLE,
+  kDoubleBE,
+  kVarUInt,
+  kVarInt,
+  kString,
+  kBytes,
+  kOk,
+  kOutOfBounds,
+  kInvalidType,
+  kOutOfRange,
+  kEndOffsetField,
+  kFieldIndexField,
+  kStateLength
+} = process.binding('buffer_cursor');
+const errors = require('internal/errors');
+const { isUint8Array } = require('internal/util/types');
+
+const kBuffer = Symbol('buffer');
+const kOps = Symbol('ops');
+const kSafeRange = '>= -(2^53 - 1) and <= 2^53 - 1';
+
+// Filled in by the binding: the end offset (or encoded length) of the last
+// record, and the index of the field that made a call fail.
+const state = new Float64Array(kStateLength);
+
+function fieldType(code, expected, range) {
+  return { code, expected, range };
+}
+
+const fieldTypes = Object.create(null);
+fieldTypes.uint8 = fieldType(kUInt8, 'number', '>= 0 and <= 255');
+fieldTypes.int8 = fieldType(kInt8, 'number', '>= -128 and <= 127');
+fieldTypes.uint16le = fieldType(kUInt16LE, 'number', '>= 0 and <= 65535');
+fieldTypes.uint16be = fieldType(kUInt16BE, 'number', '>= 0 and <= 65535');
+fieldTypes.int16le = fieldType(kInt16LE, 'number', '>= -32768 and <= 32767');
+fieldTypes.int16be = fieldType(kInt16BE, 'number', '>= -32768 and <= 32767');
+fieldTypes.uint32le = fieldType(kUInt32LE, 'number', '>= 0 and <= 2^32 - 1');
+fieldTypes.uint32be = fieldType(kUInt32BE, 'number', '>= 0 and <= 2^32 - 1');
+fieldTypes.int32le = fieldType(kInt32LE, 'number', '>= -2^31 and <= 2^31 - 1');
+fieldTypes.int32be = fieldType(kInt32BE, 'number', '>= -2^31 and <= 2^31 - 1');
+fieldTypes.floatle = fieldType(kFloatLE, 'number');
+fieldTypes.floatbe = fieldType(kFloatBE, 'number');
+fieldTypes.doublele = fieldType(kDoubleLE, 'number');
+fieldTypes.doublebe = fieldType(kDoubleBE, 'number');
+fieldTypes.varuint = fieldType(kVarUInt, 'number',
+                               'an integer >= 0 and <= 2^53 - 1');
+fieldTypes.varint = fieldType(kVarInt, 'number', `an integer ${kSafeRange}`);
+fieldTypes.string = fieldType(kString, 'string');
+fieldTypes.bytes = fieldType(kBytes, ['Buffer', 'Uint8Array']);
+
+class BufferSchema {
+  constructor(fields) {
+    if (!Array.isArray(fields))
+      throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'fields', 'Array');
+    const ops = new Uint8Array(fields.length);
+    for (var i = 0; i < fields.length; i++) {
+      const type = typeof fields[i] === 'string' ?
+        fieldTypes[fields[i]] : undefined;
+      if (type === undefined) {
+        throw new errors.TypeError('ERR_INVALID_ARG_VALUE',
+                                   `fields[${i}]`, fields[i]);
+      }
+      ops[i] = type.code;
+    }
+    this.fields = Object.freeze(fields.slice());
+    this[kOps] = ops;
+  }
+}
+
+function toSchema(schema) {
+  if (schema instanceof BufferSchema)
+    return schema;
+  if (Array.isArray(schema))
+    return new BufferSchema(schema);
+  throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'schema',
+                             ['BufferSchema', 'Array'], schema);
+}
+
+function validateValues(values) {
+  if (!Array.isArray(values))
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'values', 'Array');
+}
+
+function cursorException(status, schema, values, reading) {
+  const index = state[kFieldIndexField];
+  if (index === -1) {
+    return new errors.RangeError('ERR_OUT_OF_RANGE', 'offset',
+                                 '>= 0 and <= buffer.length');
+  }
+  const type = fieldTypes[schema.fields[index]];
+  switch (status) {
+    case kOutOfBounds:
+      return new errors.RangeError('ERR_BUFFER_OUT_OF_BOUNDS',
+                                   `fields[${index}]`, !reading);
+    case kInvalidType:
+      return new errors.TypeError('ERR_INVALID_ARG_TYPE', `values[${index}]`,
+                                  type.expected, values[index]);
+    case kOutOfRange:
+      if (reading) {
+        return new errors.RangeError('ERR_OUT_OF_RANGE', `fields[${index}]`,
+                                     type.range);
+      }
+      return new errors.RangeError('ERR_OUT_OF_RANGE', `values[${index}]`,
+                                   type.range, values[index]);
+  }
+  return new errors.TypeError('ERR_INVALID_ARG_VALUE', 'schema', schema);
+}
+
+// Reads and writes whole records described by a BufferSchema, advancing
+// `offset` past each record. A record is decoded or encoded by a single
+// binding call, however many fields it has.
+class BufferCursor {
+  constructor(buffer, offset = 0) {
+    if (!isUint8Array(buffer)) {
+      throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'buffer',
+                                 ['Buffer', 'Uint8Array'], buffer);
+    }
+    if (!Number.isInteger(offset) || offset < 0 || offset > buffer.length) {
+      throw new errors.RangeError('ERR_OUT_OF_RANGE', 'offset',
+                                  `>= 0 and <= ${buffer.length}`, offset);
+    }
+    this[kBuffer] = buffer;
+    this.offset = offset;
+  }
+
+  get buffer() {
+    return this[kBuffer];
+  }
+
+  get remaining() {
+    return this[kBuffer].length - this.offset;
+  }
+
+  read(schema) {
+    schema = toSchema(schema);
+    const result = _read(this[kBuffer], this.offset, schema[kOps], state);
+    if (typeof result === 'number')
+      throw cursorException(result, schema, undefined, true);
+    this.offset = state[kEndOffsetField];
+    return result;
+  }
+
+  write(schema, values) {
+    schema = toSchema(schema);
+    validateValues(values);
+    const status =
+      _write(this[kBuffer], this.offset, schema[kOps], values, state);
+    if (status !== kOk)
+      throw cursorException(status, schema, values, false);
+    this.offset = state[kEndOffsetField];
+    return this;
+  }
+
+  static byteLength(schema, values) {
+    schema = toSchema(schema);
+    validateValues(values);
+    const status = _byteLength(schema[kOps], values, state);
+    if (status !== kOk)
+      throw cursorException(status, schema, values, false);
+    return state[kEndOffsetField];
+  }
+}
+
+module.exports = {
+  BufferCursor,
+  BufferSchema
+};
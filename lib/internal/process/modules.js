@@ -5,16 +5,15 @@ const {
   setInitializeImportMetaObjectCallback
 } = internalBinding('module_wrap');
 
-const { getURLFromFilePath } = require('internal/url');
+const { getURLFromFilePath, toHref } = require('internal/url');
 const Loader = require('internal/loader/Loader');
 const path = require('path');
-const { URL } = require('url');
 
 function normalizeReferrerURL(referrer) {
   if (typeof referrer === 'string' && path.isAbsolute(referrer)) {
     return getURLFromFilePath(referrer).href;
   }
-  return new URL(referrer).href;
+  return toHref(referrer);
 }
 
 function initializeImportMetaObject(wrap, meta) {
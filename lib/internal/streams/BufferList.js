@@ -2,9 +2,17 @@
 
 const { Buffer } = require('buffer');
 const { inspect } = require('util');
+const errors = require('internal/errors');
+const { concat } = process.binding('buffer');
 
-function copyBuffer(src, target, offset) {
-  Buffer.prototype.copy.call(src, target, offset);
+// Copies `chunks` into `target` with a single binding call. The binding
+// returns -1 when one of the chunks is not a Buffer or Uint8Array.
+function copyChunks(target, chunks) {
+  if (concat(target, chunks) === -1) {
+    throw new errors.TypeError(
+      'ERR_INVALID_ARG_TYPE', 'chunk', ['Buffer', 'Uint8Array']
+    );
+  }
 }
 
 module.exports = class BufferList {
@@ -63,13 +71,14 @@ module.exports = class BufferList {
     if (this.length === 0)
       return Buffer.alloc(0);
     const ret = Buffer.allocUnsafe(n >>> 0);
+    const chunks = new Array(this.length);
     var p = this.head;
     var i = 0;
     while (p) {
-      copyBuffer(p.data, ret, i);
-      i += p.data.length;
+      chunks[i++] = p.data;
       p = p.next;
     }
+    copyChunks(ret, chunks);
     return ret;
   }
 
@@ -130,30 +139,31 @@ module.exports = class BufferList {
   // Consumes a specified amount of bytes from the buffered data.
   _getBuffer(n) {
     const ret = Buffer.allocUnsafe(n);
+    const chunks = [];
     var p = this.head;
-    var c = 1;
-    p.data.copy(ret);
-    n -= p.data.length;
-    while (p = p.next) {
+    var c = 0;
+    // Collect the chunks that make up the result and copy them in one pass;
+    // the copy stops once `ret` is full, so the last chunk may be partial.
+    while (p) {
       const buf = p.data;
-      const nb = (n > buf.length ? buf.length : n);
-      buf.copy(ret, ret.length - n, 0, nb);
-      n -= nb;
-      if (n === 0) {
-        if (nb === buf.length) {
-          ++c;
-          if (p.next)
-            this.head = p.next;
-          else
-            this.head = this.tail = null;
-        } else {
-          this.head = p;
-          p.data = buf.slice(nb);
-        }
+      chunks.push(buf);
+      if (n < buf.length) {
+        this.head = p;
+        p.data = buf.slice(n);
         break;
       }
       ++c;
+      n -= buf.length;
+      if (n === 0) {
+        if (p.next)
+          this.head = p.next;
+        else
+          this.head = this.tail = null;
+        break;
+      }
+      p = p.next;
     }
+    copyChunks(ret, chunks);
     this.length -= c;
     return ret;
   }
@@ -18,6 +18,7 @@ const {
   domainToUnicode: _domainToUnicode,
   encodeAuth,
   toUSVString: _toUSVString,
+  href: _href,
   parse: _parse,
   setURLConstructor,
   URL_FLAGS_CANNOT_BE_BASE,
@@ -219,14 +220,24 @@ function onParseError(flags, input) {
   throw error;
 }
 
-// Reused by URL constructor and URL#href setter.
+// Reused by URL constructor and URL#href setter. `base` is either a URL or
+// a string that the binding parses (and caches) on its own.
 function parse(url, input, base) {
-  const base_context = base ? base[context] : undefined;
+  const base_context = typeof base === 'string' ? base :
+    base ? base[context] : undefined;
   url[context] = new URLContext();
   _parse(input.trim(), -1, base_context, undefined,
          onParseComplete.bind(url), onParseError);
 }
 
+// Returns `new URL(input, base).href` without creating a URL object or
+// strings for the individual components.
+function toHref(input, base) {
+  if (base !== undefined)
+    base = `${base}`.trim();
+  return _href(`${input}`.trim(), base, onParseError);
+}
+
 function onParseProtocolComplete(flags, protocol, username, password,
                                  host, port, path, query, fragment) {
   const ctx = this[context];
@@ -304,7 +315,7 @@ class URL {
     input = `${input}`;
     if (base !== undefined &&
         (!base[searchParams] || !base[searchParams][searchParams])) {
-      base = new URL(base);
+      base = `${base}`.trim();
     }
     parse(this, input, base);
   }
@@ -1414,6 +1425,7 @@ setURLConstructor(constructUrl);
 
 module.exports = {
   toUSVString,
+  toHref,
   getPathFromURL,
   getURLFromFilePath,
   URL,
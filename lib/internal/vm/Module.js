@@ -1,7 +1,7 @@
 'use strict';
 
 const { emitExperimentalWarning } = require('internal/util');
-const { URL } = require('internal/url');
+const { toHref } = require('internal/url');
 const { kParsingContext, isContext } = process.binding('contextify');
 const errors = require('internal/errors');
 const {
@@ -62,7 +62,7 @@ class Module {
         throw new errors.TypeError(
           'ERR_INVALID_ARG_TYPE', 'options.url', 'string', url);
       }
-      url = new URL(url).href;
+      url = toHref(url);
     } else if (context === undefined) {
       url = `vm:module(${globalModuleId++})`;
     } else if (perContextModuleId.has(context)) {
@@ -136,20 +136,24 @@ function readPackage(requestPath) {
     return entry;
 
   const jsonPath = path.resolve(requestPath, 'package.json');
-  const json = internalModuleReadJSON(path.toNamespacedPath(jsonPath));
+  // Returns [main], or the source text if it is invalid JSON.
+  const pkg = internalModuleReadJSON(path.toNamespacedPath(jsonPath));
 
-  if (json === undefined) {
+  if (pkg === undefined) {
     return false;
   }
 
-  try {
-    var pkg = packageMainCache[requestPath] = JSON.parse(json).main;
-  } catch (e) {
-    e.path = jsonPath;
-    e.message = 'Error parsing ' + jsonPath + ': ' + e.message;
-    throw e;
+  if (typeof pkg === 'string') {
+    try {
+      JSON.parse(pkg);
+    } catch (e) {
+      e.path = jsonPath;
+      e.message = 'Error parsing ' + jsonPath + ': ' + e.message;
+      throw e;
+    }
   }
-  return pkg;
+
+  return packageMainCache[requestPath] = pkg[0];
 }
 
 function tryPackage(requestPath, exts, isMain) {
@@ -29,6 +29,7 @@ const {
   hexTable,
   isHexTable
 } = require('internal/querystring');
+const { parse: _parse } = process.binding('querystring');
 const QueryString = module.exports = {
   unescapeBuffer,
   // `unescape()` is a JS global, so we need to use a different local name
@@ -257,6 +258,29 @@ function charCodes(str) {
 const defSepCodes = [38]; // &
 const defEqCodes = [61]; // =
 
+// Below this length the JS parser is faster than crossing into the binding.
+const kMinNativeParseLength = 32;
+
+// Whether `code` can be used as a separator by the native parser.
+function isNativeSeparator(code) {
+  return code < 128 && code !== 37/*%*/ && code !== 43/*+*/;
+}
+
+// Adds the flat [key, value, ...] list returned by the binding to `obj`.
+function addPairs(obj, list) {
+  for (var i = 0; i < list.length; i += 2) {
+    const key = list[i];
+    const curValue = obj[key];
+    if (curValue === undefined)
+      obj[key] = list[i + 1];
+    else if (curValue.pop)
+      curValue[curValue.length] = list[i + 1];
+    else
+      obj[key] = [curValue, list[i + 1]];
+  }
+  return obj;
+}
+
 // Parse a key/val string.
 function parse(qs, sep, eq, options) {
   const obj = Object.create(null);
@@ -287,6 +311,18 @@ function parse(qs, sep, eq, options) {
   }
   const customDecode = (decode !== qsUnescape);
 
+  if (!customDecode && sepLen === 1 && eqLen === 1 &&
+      qs.length >= kMinNativeParseLength &&
+      sepCodes[0] !== eqCodes[0] &&
+      isNativeSeparator(sepCodes[0]) && isNativeSeparator(eqCodes[0])) {
+    // Pure ASCII input is split and decoded natively in a single call. A
+    // `pairs` count that can never reach 0 is the same as no limit at all.
+    const maxPairs = (pairs | 0) === pairs ? pairs : -1;
+    const list = _parse(qs, sepCodes[0], eqCodes[0], maxPairs);
+    if (list !== undefined)
+      return addPairs(obj, list);
+  }
+
   var lastPos = 0;
   var sepIdx = 0;
   var eqIdx = 0;
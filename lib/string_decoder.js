@@ -30,6 +30,7 @@ const {
   kEncodingField,
   kSize,
   decode,
+  decodeInto,
   flush,
   encodings
 } = internalBinding('string_decoder');
@@ -71,6 +72,23 @@ StringDecoder.prototype.write = function write(buf) {
   return decode(this[kNativeDecoder], buf);
 };
 
+// Appends the decoded pieces of `buf` to `rope` rather than returning them
+// as one string, so that callers collecting many chunks can join them once.
+StringDecoder.prototype.writeInto = function writeInto(buf, rope) {
+  if (!Array.isArray(rope))
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'rope', 'Array', rope);
+  if (typeof buf === 'string') {
+    if (buf.length > 0)
+      rope.push(buf);
+    return rope;
+  }
+  if (!ArrayBuffer.isView(buf))
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'buf',
+                               ['Buffer', 'Uint8Array', 'ArrayBufferView']);
+  decodeInto(this[kNativeDecoder], buf, rope);
+  return rope;
+};
+
 StringDecoder.prototype.end = function end(buf) {
   let ret = '';
   if (buf !== undefined)
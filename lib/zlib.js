@@ -39,10 +39,19 @@ const {
   Z_MIN_CHUNK, Z_MIN_WINDOWBITS, Z_MAX_WINDOWBITS, Z_MIN_LEVEL, Z_MAX_LEVEL,
   Z_MIN_MEMLEVEL, Z_MAX_MEMLEVEL, Z_DEFAULT_CHUNK, Z_DEFAULT_COMPRESSION,
   Z_DEFAULT_STRATEGY, Z_DEFAULT_WINDOWBITS, Z_DEFAULT_MEMLEVEL, Z_FIXED,
-  DEFLATE, DEFLATERAW, INFLATE, INFLATERAW, GZIP, GUNZIP, UNZIP
+  DEFLATE, DEFLATERAW, INFLATE, INFLATERAW, GZIP, GUNZIP, UNZIP,
+  BROTLI_DECODE, BROTLI_ENCODE, BROTLI_OPERATION_PROCESS,
+  BROTLI_OPERATION_FLUSH, BROTLI_OPERATION_FINISH,
+  BROTLI_OPERATION_EMIT_METADATA
 } = constants;
 const { inherits } = require('util');
 
+// Parallel gzip compresses blocks of this size concurrently, and a stream
+// collects this many blocks of input before handing them to the binding.
+const kMinParallelBlockSize = 32 * 1024;
+const kDefaultParallelBlockSize = 128 * 1024;
+const kParallelWriteBlocks = 8;
+
 // translation table for return codes.
 const codes = {
   Z_OK: constants.Z_OK,
@@ -62,6 +71,20 @@ for (var ck = 0; ck < ckeys.length; ck++) {
   codes[codes[ckey]] = ckey;
 }
 
+function crc32(data, value = 0) {
+  if (typeof data !== 'string' && !isArrayBufferView(data)) {
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'data',
+                               ['string', 'Buffer', 'TypedArray', 'DataView']);
+  }
+  if (typeof value !== 'number')
+    throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'value', 'number');
+  if (!Number.isInteger(value) || value < 0 || value > 0xffffffff) {
+    throw new errors.RangeError('ERR_OUT_OF_RANGE', 'value',
+                                'an integer >= 0 and <= 2^32 - 1', value);
+  }
+  return binding.crc32(data, value);
+}
+
 function zlibBuffer(engine, buffer, callback) {
   // Streams do not support non-Buffer ArrayBufferViews yet. Convert it to a
   // Buffer without copying.
@@ -70,16 +93,43 @@ function zlibBuffer(engine, buffer, callback) {
     buffer = Buffer.from(buffer.buffer, buffer.byteOffset, buffer.byteLength);
   } else if (isAnyArrayBuffer(buffer)) {
     buffer = Buffer.from(buffer);
+  } else if (typeof buffer === 'string') {
+    buffer = Buffer.from(buffer);
   }
+  engine.cb = callback;
+  engine.on('error', zlibBufferOnError);
+
+  // Compress or decompress the whole buffer as a single job on the
+  // threadpool.
+  if (buffer instanceof Buffer) {
+    const handle = engine._handle;
+    handle.buffer = buffer;
+    handle.oncomplete = zlibBufferOnComplete;
+    handle.writeAll(engine._finishFlushFlag, buffer, 0, buffer.byteLength);
+    return;
+  }
+
   engine.buffers = null;
   engine.nread = 0;
-  engine.cb = callback;
   engine.on('data', zlibBufferOnData);
-  engine.on('error', zlibBufferOnError);
   engine.on('end', zlibBufferOnEnd);
   engine.end(buffer);
 }
 
+function zlibBufferOnComplete(buf) {
+  // This callback's context (`this`) is the `_handle` (ZCtx) object.
+  const engine = this.jsref;
+  engine.bytesRead = this.buffer.byteLength - engine._writeState[1];
+  this.buffer = null;
+  engine.close();
+  if (buf === undefined)
+    engine.cb(new errors.RangeError('ERR_BUFFER_TOO_LARGE'));
+  else if (engine._info)
+    engine.cb(null, { buffer: buf, engine });
+  else
+    engine.cb(null, buf);
+}
+
 function zlibBufferOnData(chunk) {
   if (!this.buffers)
     this.buffers = [chunk];
@@ -126,13 +176,13 @@ function zlibBufferSync(engine, buffer) {
                                   'ArrayBuffer']);
     }
   }
-  buffer = processChunkSync(engine, buffer, engine._finishFlushFlag);
+  buffer = processAllSync(engine, buffer, engine._finishFlushFlag);
   if (engine._info)
     return { buffer, engine };
   return buffer;
 }
 
-function zlibOnError(message, errno) {
+function zlibOnError(message, errno, code) {
   var self = this.jsref;
   // there is no way to cleanly recover.
   // continuing only obscures problems.
@@ -141,7 +191,8 @@ function zlibOnError(message, errno) {
 
   const error = new Error(message);
   error.errno = errno;
-  error.code = codes[errno];
+  // Brotli decoder errors come with their own code.
+  error.code = code !== undefined ? code : codes[errno];
   self.emit('error', error);
 }
 
@@ -169,6 +220,8 @@ function Zlib(opts, mode) {
   var memLevel = Z_DEFAULT_MEMLEVEL;
   var strategy = Z_DEFAULT_STRATEGY;
   var dictionary;
+  var parallel = false;
+  var blockSize = kDefaultParallelBlockSize;
 
   if (typeof mode !== 'number')
     throw new errors.TypeError('ERR_INVALID_ARG_TYPE', 'mode', 'number');
@@ -262,6 +315,19 @@ function Zlib(opts, mode) {
       }
     }
 
+    parallel = mode === GZIP && opts.parallel === true;
+    if (parallel && opts.blockSize !== undefined &&
+        !Number.isNaN(opts.blockSize)) {
+      blockSize = opts.blockSize;
+      if (blockSize < kMinParallelBlockSize || blockSize > kMaxLength ||
+          !Number.isFinite(blockSize)) {
+        throw new errors.RangeError('ERR_INVALID_OPT_VALUE',
+                                    'blockSize',
+                                    blockSize);
+      }
+      blockSize = Math.floor(blockSize);
+    }
+
     if (opts.encoding || opts.objectMode || opts.writableObjectMode) {
       opts = _extend({}, opts);
       opts.encoding = null;
@@ -271,19 +337,32 @@ function Zlib(opts, mode) {
   }
   Transform.call(this, opts);
   this.bytesRead = 0;
-  this._handle = new binding.Zlib(mode);
-  this._handle.jsref = this; // Used by processCallback() and zlibOnError()
-  this._handle.onerror = zlibOnError;
   this._hadError = false;
   this._writeState = new Uint32Array(2);
+  this._parallelState = null;
+
+  if (parallel) {
+    this._handle = new binding.ParallelGzip(level, memLevel, strategy,
+                                            blockSize);
+    this._parallelState = {
+      chunks: [],
+      length: 0,
+      writeSize: Math.min(blockSize * kParallelWriteBlocks, kMaxLength),
+      finished: false
+    };
+  } else {
+    this._handle = new binding.Zlib(mode);
+  }
+  this._handle.jsref = this; // Used by processCallback() and zlibOnError()
+  this._handle.onerror = zlibOnError;
 
-  if (!this._handle.init(windowBits,
-                         level,
-                         memLevel,
-                         strategy,
-                         this._writeState,
-                         processCallback,
-                         dictionary)) {
+  if (!parallel && !this._handle.init(windowBits,
+                                      level,
+                                      memLevel,
+                                      strategy,
+                                      this._writeState,
+                                      processCallback,
+                                      dictionary)) {
     throw new errors.Error('ERR_ZLIB_INITIALIZATION_FAILED');
   }
 
@@ -296,6 +375,7 @@ function Zlib(opts, mode) {
   this._scheduledFlushFlag = Z_NO_FLUSH;
   this._origFlushFlag = flush;
   this._finishFlushFlag = finishFlush;
+  this._defaultFullFlushFlag = Z_FULL_FLUSH;
   this._info = opts && opts.info;
   this.once('end', this.close);
 }
@@ -309,6 +389,14 @@ Object.defineProperty(Zlib.prototype, '_closed', {
   }
 });
 
+Object.defineProperty(Zlib.prototype, 'bytesAllocated', {
+  configurable: true,
+  enumerable: true,
+  get() {
+    return this._handle ? this._handle.getAllocatedBytes() : 0;
+  }
+});
+
 Zlib.prototype.params = function params(level, strategy, callback) {
   if (level < Z_MIN_LEVEL || level > Z_MAX_LEVEL)
     throw new errors.RangeError('ERR_INVALID_ARG_VALUE', 'level', level);
@@ -330,6 +418,11 @@ Zlib.prototype.params = function params(level, strategy, callback) {
 Zlib.prototype.reset = function reset() {
   if (!this._handle)
     assert(false, 'zlib binding closed');
+  if (this._parallelState) {
+    this._parallelState.chunks = [];
+    this._parallelState.length = 0;
+    this._parallelState.finished = false;
+  }
   return this._handle.reset();
 };
 
@@ -360,7 +453,7 @@ Zlib.prototype.flush = function flush(kind, callback) {
 
   if (typeof kind === 'function' || (kind === undefined && !callback)) {
     callback = kind;
-    kind = Z_FULL_FLUSH;
+    kind = this._defaultFullFlushFlag;
   }
 
   if (ws.ended) {
@@ -408,15 +501,24 @@ Zlib.prototype._transform = function _transform(chunk, encoding, cb) {
     if (chunk.byteLength >= ws.length)
       this._flushFlag = this._origFlushFlag;
   }
-  processChunk(this, chunk, flushFlag, cb);
+  if (this._parallelState)
+    processChunkParallel(this, chunk, flushFlag, cb);
+  else
+    processChunk(this, chunk, flushFlag, cb);
 };
 
 Zlib.prototype._processChunk = function _processChunk(chunk, flushFlag, cb) {
   // _processChunk() is left for backwards compatibility
-  if (typeof cb === 'function')
-    processChunk(this, chunk, flushFlag, cb);
-  else
+  if (typeof cb === 'function') {
+    if (this._parallelState)
+      processChunkParallel(this, chunk, flushFlag, cb);
+    else
+      processChunk(this, chunk, flushFlag, cb);
+  } else if (this._parallelState) {
+    return processAllSync(this, chunk, flushFlag);
+  } else {
     return processChunkSync(this, chunk, flushFlag);
+  }
 };
 
 function processChunkSync(self, chunk, flushFlag) {
@@ -504,6 +606,29 @@ function processChunkSync(self, chunk, flushFlag) {
   return (buffers.length === 1 ? buffers[0] : Buffer.concat(buffers, nread));
 }
 
+// Like processChunkSync(), but the binding produces all of the output in one
+// call.
+function processAllSync(self, chunk, flushFlag) {
+  var error;
+  self.on('error', function(er) {
+    error = er;
+  });
+
+  const buffer = self._handle.writeAllSync(flushFlag,
+                                           chunk,
+                                           0,
+                                           chunk.byteLength);
+  if (error)
+    throw error;
+
+  self.bytesRead = chunk.byteLength - self._writeState[1];
+  _close(self);
+
+  if (buffer === undefined)
+    throw new errors.RangeError('ERR_BUFFER_TOO_LARGE');
+  return buffer;
+}
+
 function processChunk(self, chunk, flushFlag, cb) {
   var handle = self._handle;
   if (!handle)
@@ -588,6 +713,64 @@ function processCallback() {
   this.cb();
 }
 
+// Streams with the `parallel` option collect their input until there is
+// enough of it to keep several threads busy, or until a flush or the end of
+// the stream. All of the output of a write is produced at once.
+function processChunkParallel(self, chunk, flushFlag, cb) {
+  var handle = self._handle;
+  if (!handle)
+    return cb(new errors.Error('ERR_ZLIB_BINDING_CLOSED'));
+
+  const state = self._parallelState;
+  const final = flushFlag === Z_FINISH;
+  // Both the last chunk and _flush() finish the stream.
+  if (final && state.finished)
+    return cb();
+
+  if (chunk.byteLength > 0) {
+    state.chunks.push(chunk);
+    state.length += chunk.byteLength;
+  }
+  if (!final &&
+      (state.length === 0 ||
+       (flushFlag === Z_NO_FLUSH && state.length < state.writeSize))) {
+    // The writer may reuse the chunk once cb() has been called.
+    if (chunk.byteLength > 0)
+      state.chunks[state.chunks.length - 1] = Buffer.from(chunk);
+    return cb();
+  }
+
+  const input = state.chunks.length === 1 ?
+    state.chunks[0] : Buffer.concat(state.chunks, state.length);
+  state.chunks = [];
+  state.length = 0;
+  state.finished = final;
+
+  handle.buffer = input;
+  handle.cb = cb;
+  handle.oncomplete = processParallelCallback;
+  handle.writeAll(flushFlag, input, 0, input.byteLength);
+}
+
+function processParallelCallback(output) {
+  // This callback's context (`this`) is the `_handle` (ParallelGzip) object.
+  var self = this.jsref;
+  const input = this.buffer;
+  const cb = this.cb;
+  this.buffer = null;
+  this.cb = null;
+
+  if (self._hadError || self.destroyed)
+    return;
+
+  self.bytesRead += input.byteLength;
+  if (output === undefined)
+    return cb(new errors.RangeError('ERR_BUFFER_TOO_LARGE'));
+  if (output.byteLength > 0)
+    self.push(output);
+  cb();
+}
+
 function _close(engine, callback) {
   if (callback)
     process.nextTick(callback);
@@ -656,6 +839,122 @@ function Unzip(opts) {
 }
 inherits(Unzip, Zlib);
 
+// Brotli streams share the stream and binding logic with the zlib ones; their
+// handle has the same interface, with brotli operations as flush values.
+function Brotli(opts, mode) {
+  var chunkSize = Z_DEFAULT_CHUNK;
+  var flush = BROTLI_OPERATION_PROCESS;
+  var finishFlush = BROTLI_OPERATION_FINISH;
+  var params;
+
+  if (opts) {
+    chunkSize = opts.chunkSize;
+    if (chunkSize !== undefined && !Number.isNaN(chunkSize)) {
+      if (chunkSize < Z_MIN_CHUNK || !Number.isFinite(chunkSize))
+        throw new errors.RangeError('ERR_INVALID_OPT_VALUE',
+                                    'chunkSize',
+                                    chunkSize);
+    } else {
+      chunkSize = Z_DEFAULT_CHUNK;
+    }
+
+    flush = opts.flush;
+    if (flush !== undefined && !Number.isNaN(flush)) {
+      if (flush < BROTLI_OPERATION_PROCESS ||
+          flush > BROTLI_OPERATION_EMIT_METADATA ||
+          !Number.isFinite(flush)) {
+        throw new errors.RangeError('ERR_INVALID_OPT_VALUE', 'flush', flush);
+      }
+    } else {
+      flush = BROTLI_OPERATION_PROCESS;
+    }
+
+    finishFlush = opts.finishFlush;
+    if (finishFlush !== undefined && !Number.isNaN(finishFlush)) {
+      if (finishFlush < BROTLI_OPERATION_PROCESS ||
+          finishFlush > BROTLI_OPERATION_EMIT_METADATA ||
+          !Number.isFinite(finishFlush)) {
+        throw new errors.RangeError('ERR_INVALID_OPT_VALUE',
+                                    'finishFlush',
+                                    finishFlush);
+      }
+    } else {
+      finishFlush = BROTLI_OPERATION_FINISH;
+    }
+
+    params = opts.params;
+    if (params !== undefined &&
+        (params === null || typeof params !== 'object')) {
+      throw new errors.TypeError('ERR_INVALID_OPT_VALUE', 'params', params);
+    }
+
+    if (opts.encoding || opts.objectMode || opts.writableObjectMode) {
+      opts = _extend({}, opts);
+      opts.encoding = null;
+      opts.objectMode = false;
+      opts.writableObjectMode = false;
+    }
+  }
+  Transform.call(this, opts);
+  this.bytesRead = 0;
+  this._handle = new binding.BrotliCtx(mode);
+  this._handle.jsref = this; // Used by processCallback() and zlibOnError()
+  this._handle.onerror = zlibOnError;
+  this._hadError = false;
+  this._writeState = new Uint32Array(2);
+  this._parallelState = null;
+
+  if (!this._handle.init(this._writeState, processCallback))
+    throw new errors.Error('ERR_ZLIB_INITIALIZATION_FAILED');
+
+  if (params !== undefined) {
+    const keys = Object.keys(params);
+    for (var i = 0; i < keys.length; i++) {
+      const key = Number(keys[i]);
+      const value = params[keys[i]];
+      if (!isUint32(key) || !isUint32(value) ||
+          !this._handle.params(key, value)) {
+        throw new errors.RangeError('ERR_BROTLI_INVALID_PARAM', keys[i]);
+      }
+    }
+  }
+
+  this._outBuffer = Buffer.allocUnsafe(chunkSize);
+  this._outOffset = 0;
+  this._chunkSize = chunkSize;
+  this._flushFlag = flush;
+  this._scheduledFlushFlag = BROTLI_OPERATION_PROCESS;
+  this._origFlushFlag = flush;
+  this._finishFlushFlag = finishFlush;
+  this._defaultFullFlushFlag = BROTLI_OPERATION_FLUSH;
+  this._info = opts && opts.info;
+  this.once('end', this.close);
+}
+inherits(Brotli, Zlib);
+
+// Brotli parameters can only be set when the stream is created.
+Brotli.prototype.params = function params() {
+  throw new errors.Error('ERR_METHOD_NOT_IMPLEMENTED', 'params');
+};
+
+function isUint32(value) {
+  return typeof value === 'number' && value >>> 0 === value;
+}
+
+function BrotliCompress(opts) {
+  if (!(this instanceof BrotliCompress))
+    return new BrotliCompress(opts);
+  Brotli.call(this, opts, BROTLI_ENCODE);
+}
+inherits(BrotliCompress, Brotli);
+
+function BrotliDecompress(opts) {
+  if (!(this instanceof BrotliDecompress))
+    return new BrotliDecompress(opts);
+  Brotli.call(this, opts, BROTLI_DECODE);
+}
+inherits(BrotliDecompress, Brotli);
+
 function createConvenienceMethod(ctor, sync) {
   if (sync) {
     return function(buffer, opts) {
@@ -706,7 +1005,9 @@ module.exports = {
   gunzip: createConvenienceMethod(Gunzip, false),
   gunzipSync: createConvenienceMethod(Gunzip, true),
   inflateRaw: createConvenienceMethod(InflateRaw, false),
-  inflateRawSync: createConvenienceMethod(InflateRaw, true)
+  inflateRawSync: createConvenienceMethod(InflateRaw, true),
+
+  crc32
 };
 
 Object.defineProperties(module.exports, {
@@ -729,6 +1030,22 @@ Object.defineProperties(module.exports, {
   }
 });
 
+// Only available when built with brotli support.
+if (binding.BrotliCtx !== undefined) {
+  Object.assign(module.exports, {
+    BrotliCompress,
+    BrotliDecompress,
+    brotliCompress: createConvenienceMethod(BrotliCompress, false),
+    brotliCompressSync: createConvenienceMethod(BrotliCompress, true),
+    brotliDecompress: createConvenienceMethod(BrotliDecompress, false),
+    brotliDecompressSync: createConvenienceMethod(BrotliDecompress, true)
+  });
+  Object.defineProperties(module.exports, {
+    createBrotliCompress: createProperty(BrotliCompress),
+    createBrotliDecompress: createProperty(BrotliDecompress)
+  });
+}
+
 // These should be considered deprecated
 // expose all the zlib constants
 const bkeys = Object.keys(constants);
@@ -17,6 +17,7 @@
     'node_shared_cares%': 'false',
     'node_shared_libuv%': 'false',
     'node_shared_nghttp2%': 'false',
+    'node_shared_brotli%': 'false',
     'node_use_openssl%': 'true',
     'node_shared_openssl%': 'false',
     'node_v8_options%': '',
@@ -84,6 +85,7 @@
       'lib/zlib.js',
       'lib/internal/async_hooks.js',
       'lib/internal/buffer.js',
+      'lib/internal/buffer_cursor.js',
       'lib/internal/child_process.js',
       'lib/internal/cluster/child.js',
       'lib/internal/cluster/master.js',
@@ -310,6 +312,9 @@
         'src/node_api.h',
         'src/node_api_types.h',
         'src/node_buffer.cc',
+        'src/node_buffer_allocator.cc',
+        'src/node_buffer_cursor.cc',
+        'src/node_buffer_simd.cc',
         'src/node_config.cc',
         'src/node_constants.cc',
         'src/node_contextify.cc',
@@ -322,6 +327,7 @@
         'src/node_platform.cc',
         'src/node_perf.cc',
         'src/node_postmortem_metadata.cc',
+        'src/node_querystring.cc',
         'src/node_serdes.cc',
         'src/node_trace_events.cc',
         'src/node_url.cc',
@@ -366,6 +372,8 @@
         'src/module_wrap.h',
         'src/node.h',
         'src/node_buffer.h',
+        'src/node_buffer_allocator.h',
+        'src/node_buffer_simd.h',
         'src/node_constants.h',
         'src/node_contextify.h',
         'src/node_debug_options.h',
@@ -423,6 +431,9 @@
         # Warn when using deprecated V8 APIs.
         'V8_DEPRECATION_WARNINGS=1',
         'NODE_OPENSSL_SYSTEM_CERT_PATH="<(openssl_system_ca_path)"',
+        # Either the bundled deps/brotli or, with --shared-brotli, the
+        # system's copy.
+        'NODE_HAVE_BROTLI=1',
       ],
       'conditions': [
         [ 'node_shared=="true" and node_module_version!="" and OS!="win"', {
@@ -623,10 +623,18 @@ AsyncWrap::AsyncWrap(Environment* env,
 
 
 AsyncWrap::~AsyncWrap() {
+  if (async_id_ == -1)
+    return;  // Already emitted by EmitDestroy().
   EmitTraceEventDestroy();
   EmitDestroy(env(), get_async_id());
 }
 
+void AsyncWrap::EmitDestroy() {
+  EmitTraceEventDestroy();
+  EmitDestroy(env(), get_async_id());
+  async_id_ = -1;
+}
+
 void AsyncWrap::EmitTraceEventDestroy() {
   switch (provider_type()) {
   #define V(PROVIDER)                                                         \
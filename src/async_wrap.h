@@ -144,6 +144,11 @@ class AsyncWrap : public BaseObject {
   void EmitTraceEventAfter();
   void EmitTraceEventDestroy();
 
+  // For resources that are kept around for reuse: emits destroy() for the
+  // current async id right away rather than from the destructor, which then
+  // emits nothing unless AsyncReset() has assigned a new id in the meantime.
+  void EmitDestroy();
+
 
   inline ProviderType provider_type() const;
 
@@ -31,7 +31,11 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <list>
+#include <memory>
+#include <string>
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 
 #ifdef __POSIX__
@@ -64,10 +68,183 @@ using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
 using v8::Null;
+using v8::Number;
 using v8::Object;
 using v8::String;
 using v8::Value;
 
+namespace {
+class GetAddrInfoReqWrap;
+class QueryWrap;
+}  // anonymous namespace
+
+// Recent answers of dns.lookup() and of the c-ares resolvers, so that hot
+// hostnames are not resolved again for every new connection, and the
+// requests in flight, which identical later requests wait for instead of
+// starting their own. getaddrinfo() does not report TTLs, so its results are
+// kept for the maximum TTL; resolver answers are kept for the smallest TTL of
+// their records, but no longer than that. Failures that mean the name or the
+// records do not exist are kept for the negative TTL. Disabled as long as the
+// maximum TTL is 0. Only used on the main thread.
+class LookupCache {
+ public:
+  struct Entry {
+    // 0 or ARES_SUCCESS, or the error the request failed with.
+    int status;
+    // The addresses getaddrinfo() returned, in the order it returned them.
+    std::vector<std::string> addresses;
+    // The raw reply to a c-ares query.
+    std::vector<unsigned char> answer;
+    uint64_t expires;
+  };
+
+  explicit LookupCache(uv_loop_t* loop) : loop_(loop) {}
+
+  bool enabled() const { return max_ttl_ > 0; }
+  uint64_t max_ttl() const { return max_ttl_; }
+  uint64_t negative_ttl() const { return negative_ttl_; }
+
+  // TTLs are in milliseconds. Drops all entries.
+  void Configure(uint64_t max_ttl, uint64_t negative_ttl, size_t max_entries) {
+    max_ttl_ = max_ttl;
+    negative_ttl_ = negative_ttl;
+    max_entries_ = max_entries;
+    Clear();
+  }
+
+  void Clear() {
+    entries_.clear();
+    index_.clear();
+  }
+
+  // Channels get a new id whenever their servers may have changed, which
+  // keeps them from seeing answers of other servers. Lookups that use
+  // getaddrinfo() use channel id 0.
+  static std::string LookupKey(uint32_t channel_id,
+                               int family,
+                               int flags,
+                               const char* hostname) {
+    return "L" + std::to_string(channel_id) + ":" + std::to_string(family) +
+           ":" + std::to_string(flags) + ":" + hostname;
+  }
+
+  static std::string QueryKey(uint32_t channel_id, int type, const char* name) {
+    return "Q" + std::to_string(channel_id) + ":" + std::to_string(type) +
+           ":" + name;
+  }
+
+  uint32_t NewChannelId() { return ++last_channel_id_; }
+
+  // Returns the entry for |key| if it has not expired yet, or nullptr.
+  Entry* Find(const std::string& key) {
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      misses_++;
+      return nullptr;
+    }
+    if (it->second->second.expires <= uv_now(loop_)) {
+      entries_.erase(it->second);
+      index_.erase(it);
+      misses_++;
+      return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    hits_++;
+    return &it->second->second;
+  }
+
+  // Keeps |entry| for |ttl| milliseconds, replacing the least recently used
+  // entry if the cache is full.
+  void Store(const std::string& key, Entry&& entry, uint64_t ttl) {
+    if (!enabled() || ttl == 0 || max_entries_ == 0)
+      return;
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      entries_.erase(it->second);
+      index_.erase(it);
+    }
+    while (index_.size() >= max_entries_) {
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+      evictions_++;
+    }
+    entry.expires = uv_now(loop_) + ttl;
+    entries_.emplace_front(key, std::move(entry));
+    index_.emplace(key, entries_.begin());
+  }
+
+  // Returns true if an identical request is in flight, in which case
+  // |waiter| is completed together with it. Otherwise the caller becomes the
+  // request in flight for |key| and has to call Finish() once it is done.
+  bool Join(const std::string& key, GetAddrInfoReqWrap* waiter) {
+    return Join(&lookups_in_flight_, key, waiter);
+  }
+
+  bool Join(const std::string& key, QueryWrap* waiter) {
+    return Join(&queries_in_flight_, key, waiter);
+  }
+
+  void Finish(const std::string& key,
+              std::vector<GetAddrInfoReqWrap*>* waiters) {
+    Finish(&lookups_in_flight_, key, waiters);
+  }
+
+  void Finish(const std::string& key, std::vector<QueryWrap*>* waiters) {
+    Finish(&queries_in_flight_, key, waiters);
+  }
+
+  size_t size() const { return index_.size(); }
+  uint64_t hits() const { return hits_; }
+  uint64_t misses() const { return misses_; }
+  uint64_t coalesced() const { return coalesced_; }
+  uint64_t evictions() const { return evictions_; }
+
+ private:
+  template <typename T>
+  using InFlight = std::unordered_map<std::string, std::vector<T*>>;
+
+  template <typename T>
+  bool Join(InFlight<T>* in_flight, const std::string& key, T* waiter) {
+    auto it = in_flight->find(key);
+    if (it == in_flight->end()) {
+      in_flight->emplace(key, std::vector<T*>());
+      return false;
+    }
+    it->second.push_back(waiter);
+    coalesced_++;
+    return true;
+  }
+
+  template <typename T>
+  void Finish(InFlight<T>* in_flight,
+              const std::string& key,
+              std::vector<T*>* waiters) {
+    auto it = in_flight->find(key);
+    CHECK(it != in_flight->end());
+    waiters->swap(it->second);
+    in_flight->erase(it);
+  }
+
+  uv_loop_t* const loop_;
+  uint64_t max_ttl_ = 0;
+  uint64_t negative_ttl_ = 0;
+  size_t max_entries_ = 1000;
+  uint32_t last_channel_id_ = 0;
+
+  // Most recently used first.
+  std::list<std::pair<std::string, Entry>> entries_;
+  std::unordered_map<std::string,
+                     std::list<std::pair<std::string, Entry>>::iterator>
+      index_;
+  InFlight<GetAddrInfoReqWrap> lookups_in_flight_;
+  InFlight<QueryWrap> queries_in_flight_;
+
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t coalesced_ = 0;
+  uint64_t evictions_ = 0;
+};
+
 namespace {
 
 inline uint16_t cares_get_16bit(const unsigned char* p) {
@@ -83,6 +260,41 @@ inline uint32_t cares_get_32bit(const unsigned char* p) {
 
 const int ns_t_cname_or_a = -1;
 
+// The parsed hosts file, for c-ares mode lookups. Rather than reading the
+// file for every lookup, it is stat()ed at most once every kCheckInterval
+// milliseconds and parsed again when its modification time or size changed.
+class HostsFile {
+ public:
+  explicit HostsFile(uv_loop_t* loop) : loop_(loop) {}
+
+  // Appends the addresses of the wanted families that the file lists for
+  // |hostname| to |addresses|, in the order of the file, like the "files"
+  // source of getaddrinfo() does.
+  void Lookup(const char* hostname,
+              bool want_ipv4,
+              bool want_ipv6,
+              std::vector<std::string>* addresses);
+
+ private:
+  struct Address {
+    int version;
+    std::string address;
+  };
+
+  void Refresh();
+  void Parse(const std::string& contents);
+
+  static const uint64_t kCheckInterval = 5000;
+
+  uv_loop_t* const loop_;
+  bool checked_ = false;
+  uint64_t last_check_ = 0;
+  uv_timespec_t mtime_ = { 0, 0 };
+  uint64_t size_ = 0;
+  // Lower-cased names, mapped to their addresses in the order of the file.
+  std::unordered_map<std::string, std::vector<Address>> names_;
+};
+
 #define DNS_ESETSRVPENDING -1000
 inline const char* ToErrorCodeString(int status) {
   switch (status) {
@@ -163,6 +375,9 @@ class ChannelWrap : public AsyncWrap {
   }
   inline int active_query_count() { return active_query_count_; }
   inline node_ares_task_list* task_list() { return &task_list_; }
+  inline HostsFile* hosts_file() { return &hosts_file_; }
+  inline uint32_t cache_id() const { return cache_id_; }
+  inline void set_cache_id(uint32_t id) { cache_id_ = id; }
 
   size_t self_size() const override { return sizeof(*this); }
 
@@ -175,7 +390,9 @@ class ChannelWrap : public AsyncWrap {
   bool is_servers_default_;
   bool library_inited_;
   int active_query_count_;
+  uint32_t cache_id_;
   node_ares_task_list task_list_;
+  HostsFile hosts_file_;
 };
 
 ChannelWrap::ChannelWrap(Environment* env,
@@ -186,7 +403,9 @@ ChannelWrap::ChannelWrap(Environment* env,
     query_last_ok_(true),
     is_servers_default_(true),
     library_inited_(false),
-    active_query_count_(0) {
+    active_query_count_(0),
+    cache_id_(0),
+    hosts_file_(env->event_loop()) {
   MakeWeak<ChannelWrap>(this);
 
   Setup();
@@ -210,8 +429,13 @@ class GetAddrInfoReqWrap : public ReqWrap<uv_getaddrinfo_t> {
   size_t self_size() const override { return sizeof(*this); }
   bool verbatim() const { return verbatim_; }
 
+  // Set while the request is the one in flight for its LookupCache key.
+  const std::string& cache_key() const { return cache_key_; }
+  void set_cache_key(const std::string& key) { cache_key_ = key; }
+
  private:
   const bool verbatim_;
+  std::string cache_key_;
 };
 
 GetAddrInfoReqWrap::GetAddrInfoReqWrap(Environment* env,
@@ -500,6 +724,7 @@ void ChannelWrap::Setup() {
   }
 
   library_inited_ = true;
+  cache_id_ = env()->cares_lookup_cache()->NewChannelId();
 
   /* Initialize the timeout timer. The timer won't be started until the */
   /* first socket is opened. */
@@ -582,6 +807,48 @@ void ChannelWrap::EnsureServers() {
 }
 
 
+// Returns the smallest TTL of the answer records in a reply, in seconds, or
+// 0 if there are none or the reply is malformed.
+uint32_t GetMinimumAnswerTTL(const unsigned char* buf, int len) {
+  if (len < NS_HFIXEDSZ)
+    return 0;
+
+  const unsigned int qdcount = cares_get_16bit(buf + 4);
+  const unsigned int ancount = cares_get_16bit(buf + 6);
+  const unsigned char* ptr = buf + NS_HFIXEDSZ;
+  char* name;
+  long temp_len;  // NOLINT(runtime/int)
+
+  for (unsigned int i = 0; i < qdcount; i++) {
+    if (ares_expand_name(ptr, buf, len, &name, &temp_len) != ARES_SUCCESS)
+      return 0;
+    free(name);
+    if (ptr + temp_len + NS_QFIXEDSZ > buf + len)
+      return 0;
+    ptr += temp_len + NS_QFIXEDSZ;
+  }
+
+  uint32_t ttl = 0;
+  for (unsigned int i = 0; i < ancount; i++) {
+    if (ares_expand_name(ptr, buf, len, &name, &temp_len) != ARES_SUCCESS)
+      return 0;
+    free(name);
+    ptr += temp_len;
+    if (ptr + NS_RRFIXEDSZ > buf + len)
+      return 0;
+    const uint32_t rr_ttl = cares_get_32bit(ptr + 4);
+    const unsigned int rr_len = cares_get_16bit(ptr + 8);
+    if (ptr + NS_RRFIXEDSZ + rr_len > buf + len)
+      return 0;
+    ptr += NS_RRFIXEDSZ + rr_len;
+    if (i == 0 || rr_ttl < ttl)
+      ttl = rr_ttl;
+  }
+
+  return ttl;
+}
+
+
 class QueryWrap : public AsyncWrap {
  public:
   QueryWrap(ChannelWrap* channel, Local<Object> req_wrap_obj)
@@ -615,11 +882,38 @@ class QueryWrap : public AsyncWrap {
   void AresQuery(const char* name,
                  int dnsclass,
                  int type) {
+    LookupCache* cache = env()->cares_lookup_cache();
+    if (cache->enabled()) {
+      std::string key =
+          LookupCache::QueryKey(channel_->cache_id(), type, name);
+      if (LookupCache::Entry* entry = cache->Find(key)) {
+        Callback(this, entry->status, 0, entry->answer.data(),
+                 static_cast<int>(entry->answer.size()));
+        return;
+      }
+      if (cache->Join(key, this))
+        return;
+      cache_key_ = std::move(key);
+    }
+
     channel_->EnsureServers();
     ares_query(channel_->cares_channel(), name, dnsclass, type, Callback,
                static_cast<void*>(this));
   }
 
+  // How long a reply may be cached for, in milliseconds.
+  static uint64_t CacheTTL(LookupCache* cache,
+                           int status,
+                           const unsigned char* answer_buf,
+                           int answer_len) {
+    if (status == ARES_ENOTFOUND || status == ARES_ENODATA)
+      return cache->negative_ttl();
+    if (status != ARES_SUCCESS)
+      return 0;
+    const uint64_t ttl = GetMinimumAnswerTTL(answer_buf, answer_len) * 1000ULL;
+    return ttl < cache->max_ttl() ? ttl : cache->max_ttl();
+  }
+
   static void CaresAsyncClose(uv_handle_t* handle) {
     uv_async_t* async = reinterpret_cast<uv_async_t*>(handle);
     auto data = static_cast<struct CaresAsyncData*>(async->data);
@@ -653,6 +947,26 @@ class QueryWrap : public AsyncWrap {
                        unsigned char* answer_buf, int answer_len) {
     QueryWrap* wrap = static_cast<QueryWrap*>(arg);
 
+    if (!wrap->cache_key_.empty()) {
+      // Complete the identical queries that waited for this one with the
+      // same reply.
+      std::string key = std::move(wrap->cache_key_);
+      wrap->cache_key_.clear();
+      LookupCache* cache = wrap->env()->cares_lookup_cache();
+      LookupCache::Entry entry;
+      entry.status = status;
+      if (status == ARES_SUCCESS)
+        entry.answer.assign(answer_buf, answer_buf + answer_len);
+      cache->Store(key, std::move(entry),
+                   CacheTTL(cache, status, answer_buf, answer_len));
+      std::vector<QueryWrap*> waiters;
+      cache->Finish(key, &waiters);
+      Callback(wrap, status, timeouts, answer_buf, answer_len);
+      for (QueryWrap* waiter : waiters)
+        Callback(waiter, status, timeouts, answer_buf, answer_len);
+      return;
+    }
+
     unsigned char* buf_copy = nullptr;
     if (status == ARES_SUCCESS) {
       buf_copy = node::Malloc<unsigned char>(answer_len);
@@ -735,6 +1049,8 @@ class QueryWrap : public AsyncWrap {
   }
 
   ChannelWrap* channel_;
+  // Set while the query is the one in flight for its LookupCache key.
+  std::string cache_key_;
 };
 
 
@@ -1782,8 +2098,9 @@ static void Query(const FunctionCallbackInfo<Value>& args) {
 }
 
 
-void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
-  GetAddrInfoReqWrap* req_wrap = static_cast<GetAddrInfoReqWrap*>(req->data);
+void CompleteGetAddrInfo(GetAddrInfoReqWrap* req_wrap,
+                         int status,
+                         const std::vector<std::string>& addresses) {
   Environment* env = req_wrap->env();
 
   HandleScope handle_scope(env->isolate());
@@ -1795,30 +2112,18 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
   };
 
   if (status == 0) {
-    int n = 0;
-    Local<Array> results = Array::New(env->isolate());
+    uint32_t n = 0;
+    Local<Array> results = Array::New(env->isolate(), addresses.size());
 
     auto add = [&] (bool want_ipv4, bool want_ipv6) {
-      for (auto p = res; p != nullptr; p = p->ai_next) {
-        CHECK_EQ(p->ai_socktype, SOCK_STREAM);
-
-        const char* addr;
-        if (want_ipv4 && p->ai_family == AF_INET) {
-          addr = reinterpret_cast<char*>(
-              &(reinterpret_cast<struct sockaddr_in*>(p->ai_addr)->sin_addr));
-        } else if (want_ipv6 && p->ai_family == AF_INET6) {
-          addr = reinterpret_cast<char*>(
-              &(reinterpret_cast<struct sockaddr_in6*>(p->ai_addr)->sin6_addr));
-        } else {
-          continue;
-        }
-
-        char ip[INET6_ADDRSTRLEN];
-        if (uv_inet_ntop(p->ai_family, addr, ip, sizeof(ip)))
+      for (const std::string& address : addresses) {
+        const bool ipv6 = address.find(':') != std::string::npos;
+        if (ipv6 ? !want_ipv6 : !want_ipv4)
           continue;
 
-        Local<String> s = OneByteString(env->isolate(), ip);
-        results->Set(n, s);
+        Local<String> s =
+            OneByteString(env->isolate(), address.data(), address.size());
+        results->Set(env->context(), n, s).FromJust();
         n++;
       }
     };
@@ -1828,16 +2133,9 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
     if (verbatim == false)
       add(false, true);
 
-    // No responses were found to return
-    if (n == 0) {
-      argv[0] = Integer::New(env->isolate(), UV_EAI_NODATA);
-    }
-
     argv[1] = results;
   }
 
-  uv_freeaddrinfo(res);
-
   // Make the callback into JavaScript
   req_wrap->MakeCallback(env->oncomplete_string(), arraysize(argv), argv);
 
@@ -1845,6 +2143,122 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
 }
 
 
+// Completes |req_wrap| and the identical lookups that waited for it with the
+// same result, and caches the result, for |ttl| milliseconds if it is a
+// success.
+void FinishGetAddrInfo(GetAddrInfoReqWrap* req_wrap,
+                       int status,
+                       const std::vector<std::string>& addresses,
+                       uint64_t ttl) {
+  std::vector<GetAddrInfoReqWrap*> waiters;
+  if (!req_wrap->cache_key().empty()) {
+    LookupCache* cache = req_wrap->env()->cares_lookup_cache();
+    LookupCache::Entry entry;
+    entry.status = status;
+    entry.addresses = addresses;
+    if (status == 0) {
+      cache->Store(req_wrap->cache_key(), std::move(entry), ttl);
+    } else if (status == UV_EAI_NONAME || status == UV_EAI_NODATA) {
+      cache->Store(req_wrap->cache_key(), std::move(entry),
+                   cache->negative_ttl());
+    }
+    cache->Finish(req_wrap->cache_key(), &waiters);
+  }
+
+  CompleteGetAddrInfo(req_wrap, status, addresses);
+  for (GetAddrInfoReqWrap* waiter : waiters)
+    CompleteGetAddrInfo(waiter, status, addresses);
+}
+
+
+// Answers |req_wrap| from the cache, or makes it wait for an identical
+// lookup that is in flight, and returns true in both cases. Otherwise, if
+// the cache is enabled, |req_wrap| becomes the lookup in flight for |key|
+// and has to be finished with FinishGetAddrInfo() or AbandonGetAddrInfo().
+bool LookupFromCache(GetAddrInfoReqWrap* req_wrap, const std::string& key) {
+  Environment* env = req_wrap->env();
+  LookupCache* cache = env->cares_lookup_cache();
+  if (!cache->enabled())
+    return false;
+
+  if (LookupCache::Entry* entry = cache->Find(key)) {
+    struct CachedAddrInfo {
+      GetAddrInfoReqWrap* req_wrap;
+      int status;
+      std::vector<std::string> addresses;
+    };
+    req_wrap->Dispatched();
+    env->SetImmediate([](Environment* env, void* data) {
+      std::unique_ptr<CachedAddrInfo> cached(
+          static_cast<CachedAddrInfo*>(data));
+      CompleteGetAddrInfo(cached->req_wrap,
+                          cached->status,
+                          cached->addresses);
+    }, new CachedAddrInfo { req_wrap, entry->status, entry->addresses },
+       req_wrap->object());
+    return true;
+  }
+  if (cache->Join(key, req_wrap)) {
+    req_wrap->Dispatched();
+    return true;
+  }
+  req_wrap->set_cache_key(key);
+  return false;
+}
+
+
+// For lookups that failed to start, which nothing can have joined yet.
+void AbandonGetAddrInfo(GetAddrInfoReqWrap* req_wrap) {
+  if (!req_wrap->cache_key().empty()) {
+    std::vector<GetAddrInfoReqWrap*> waiters;
+    req_wrap->env()->cares_lookup_cache()->Finish(req_wrap->cache_key(),
+                                                  &waiters);
+    CHECK(waiters.empty());
+  }
+  delete req_wrap;
+}
+
+
+void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
+  GetAddrInfoReqWrap* req_wrap = static_cast<GetAddrInfoReqWrap*>(req->data);
+  Environment* env = req_wrap->env();
+
+  std::vector<std::string> addresses;
+  if (status == 0) {
+    for (auto p = res; p != nullptr; p = p->ai_next) {
+      CHECK_EQ(p->ai_socktype, SOCK_STREAM);
+
+      const char* addr;
+      if (p->ai_family == AF_INET) {
+        addr = reinterpret_cast<char*>(
+            &(reinterpret_cast<struct sockaddr_in*>(p->ai_addr)->sin_addr));
+      } else if (p->ai_family == AF_INET6) {
+        addr = reinterpret_cast<char*>(
+            &(reinterpret_cast<struct sockaddr_in6*>(p->ai_addr)->sin6_addr));
+      } else {
+        continue;
+      }
+
+      char ip[INET6_ADDRSTRLEN];
+      if (uv_inet_ntop(p->ai_family, addr, ip, sizeof(ip)))
+        continue;
+
+      addresses.emplace_back(ip);
+    }
+
+    // No responses were found to return
+    if (addresses.empty())
+      status = UV_EAI_NODATA;
+  }
+
+  uv_freeaddrinfo(res);
+
+  // getaddrinfo() does not report TTLs.
+  FinishGetAddrInfo(req_wrap, status, addresses,
+                    env->cares_lookup_cache()->max_ttl());
+}
+
+
 void AfterGetNameInfo(uv_getnameinfo_t* req,
                       int status,
                       const char* hostname,
@@ -1904,6 +2318,20 @@ void CanonicalizeIP(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(String::NewFromUtf8(isolate, canonical_ip));
 }
 
+int ToAddressFamily(int32_t family) {
+  switch (family) {
+  case 0:
+    return AF_UNSPEC;
+  case 4:
+    return AF_INET;
+  case 6:
+    return AF_INET6;
+  default:
+    CHECK(0 && "bad address family");
+    return AF_UNSPEC;
+  }
+}
+
 void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -1919,24 +2347,16 @@ void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
     flags = args[3]->Int32Value(env->context()).FromJust();
   }
 
-  int family;
-
-  switch (args[2]->Int32Value(env->context()).FromJust()) {
-  case 0:
-    family = AF_UNSPEC;
-    break;
-  case 4:
-    family = AF_INET;
-    break;
-  case 6:
-    family = AF_INET6;
-    break;
-  default:
-    CHECK(0 && "bad address family");
-  }
+  const int family =
+      ToAddressFamily(args[2]->Int32Value(env->context()).FromJust());
 
   auto req_wrap = new GetAddrInfoReqWrap(env, req_wrap_obj, args[4]->IsTrue());
 
+  if (LookupFromCache(req_wrap,
+                      LookupCache::LookupKey(0, family, flags, *hostname))) {
+    return args.GetReturnValue().Set(0);
+  }
+
   struct addrinfo hints;
   memset(&hints, 0, sizeof(struct addrinfo));
   hints.ai_family = family;
@@ -1951,12 +2371,403 @@ void GetAddrInfo(const FunctionCallbackInfo<Value>& args) {
                            &hints);
   req_wrap->Dispatched();
   if (err)
-    delete req_wrap;
+    AbandonGetAddrInfo(req_wrap);
 
   args.GetReturnValue().Set(err);
 }
 
 
+#ifdef _WIN32
+std::string GetHostsFilePath() {
+  const char* root = getenv("SystemRoot");
+  return std::string(root != nullptr ? root : "C:\\Windows") +
+         "\\System32\\drivers\\etc\\hosts";
+}
+#else
+std::string GetHostsFilePath() {
+  return "/etc/hosts";
+}
+#endif
+
+void HostsFile::Lookup(const char* hostname,
+                       bool want_ipv4,
+                       bool want_ipv6,
+                       std::vector<std::string>* addresses) {
+  Refresh();
+  std::string name(hostname);
+  for (char& c : name)
+    c = ToLower(c);
+  auto it = names_.find(name);
+  if (it == names_.end())
+    return;
+  for (const Address& address : it->second) {
+    if ((address.version == 4 && want_ipv4) ||
+        (address.version == 6 && want_ipv6)) {
+      addresses->push_back(address.address);
+    }
+  }
+}
+
+void HostsFile::Refresh() {
+  const uint64_t now = uv_now(loop_);
+  if (checked_ && now - last_check_ < kCheckInterval)
+    return;
+  checked_ = true;
+  last_check_ = now;
+
+  const std::string path = GetHostsFilePath();
+  uv_fs_t req;
+  const int err = uv_fs_stat(loop_, &req, path.c_str(), nullptr);
+  const uv_stat_t stat = req.statbuf;
+  uv_fs_req_cleanup(&req);
+  if (err != 0) {
+    names_.clear();
+    mtime_ = { 0, 0 };
+    size_ = 0;
+    return;
+  }
+  if (stat.st_mtim.tv_sec == mtime_.tv_sec &&
+      stat.st_mtim.tv_nsec == mtime_.tv_nsec &&
+      stat.st_size == size_) {
+    return;
+  }
+
+  FILE* fp = fopen(path.c_str(), "r");
+  if (fp == nullptr)
+    return;
+  std::string contents;
+  char buf[4096];
+  size_t nread;
+  while ((nread = fread(buf, 1, sizeof(buf), fp)) > 0)
+    contents.append(buf, nread);
+  fclose(fp);
+
+  mtime_ = stat.st_mtim;
+  size_ = stat.st_size;
+  Parse(contents);
+}
+
+void HostsFile::Parse(const std::string& contents) {
+  names_.clear();
+
+  auto is_space = [] (char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+  };
+
+  const char* p = contents.c_str();
+  while (*p != '\0') {
+    // An address followed by its names. Everything after a '#' is a comment.
+    std::vector<std::string> fields;
+    while (*p != '\0' && *p != '\n' && *p != '#') {
+      if (is_space(*p)) {
+        p++;
+        continue;
+      }
+      const char* field = p;
+      while (*p != '\0' && *p != '\n' && *p != '#' && !is_space(*p))
+        p++;
+      fields.emplace_back(field, p - field);
+    }
+    while (*p != '\0' && *p != '\n')
+      p++;
+    if (*p == '\n')
+      p++;
+
+    if (fields.size() < 2)
+      continue;
+
+    ParseIPResult ip;
+    const int version = ParseIP(fields[0].c_str(), &ip);
+    if (version != 4 && version != 6)
+      continue;
+    char canonical_ip[INET6_ADDRSTRLEN];
+    const int af = (version == 4 ? AF_INET : AF_INET6);
+    CHECK_EQ(0, uv_inet_ntop(af, &ip, canonical_ip, sizeof(canonical_ip)));
+
+    for (size_t i = 1; i < fields.size(); i++) {
+      std::string& name = fields[i];
+      for (char& c : name)
+        c = ToLower(c);
+      // A line that lists a name more than once still yields one address.
+      std::vector<Address>& addresses = names_[name];
+      bool listed = false;
+      for (size_t j = 1; j < i; j++)
+        listed = listed || fields[j] == name;
+      if (!listed)
+        addresses.push_back(Address { version, canonical_ip });
+    }
+  }
+}
+
+
+// For AI_ADDRCONFIG: whether any interface other than loopback has an IPv4
+// or an IPv6 address.
+void GetConfiguredFamilies(bool* has_ipv4, bool* has_ipv6) {
+  *has_ipv4 = *has_ipv6 = false;
+
+  uv_interface_address_t* interfaces;
+  int count;
+  if (uv_interface_addresses(&interfaces, &count) != 0)
+    return;
+  for (int i = 0; i < count; i++) {
+    if (interfaces[i].is_internal)
+      continue;
+    if (interfaces[i].address.address4.sin_family == AF_INET)
+      *has_ipv4 = true;
+    else if (interfaces[i].address.address4.sin_family == AF_INET6)
+      *has_ipv6 = true;
+  }
+  uv_free_interface_addresses(interfaces, count);
+}
+
+
+// Reports c-ares errors as the getaddrinfo() errors they correspond to, so
+// that lookups fail the same way in both modes.
+int ToGetAddrInfoError(int status) {
+  switch (status) {
+    case ARES_SUCCESS:
+    case ARES_ENODATA:
+    case ARES_ENOTFOUND:
+    case ARES_EBADNAME:
+      return UV_EAI_NONAME;
+    case ARES_ECONNREFUSED:
+    case ARES_EREFUSED:
+    case ARES_ESERVFAIL:
+    case ARES_ETIMEOUT:
+      return UV_EAI_AGAIN;
+    case ARES_ENOMEM:
+      return UV_EAI_MEMORY;
+    case ARES_ECANCELLED:
+    case ARES_EDESTRUCTION:
+      return UV_EAI_CANCELED;
+    default:
+      return UV_EAI_FAIL;
+  }
+}
+
+
+// dns.lookup() in c-ares mode. Consults the hosts file first, and sends A
+// and/or AAAA queries through a channel for names that are not in it, which
+// applies the search domains and options of resolv.conf. Unlike
+// getaddrinfo(), this never occupies a threadpool thread.
+class CaresLookup {
+ public:
+  CaresLookup(ChannelWrap* channel,
+              GetAddrInfoReqWrap* req_wrap,
+              const char* hostname,
+              int family,
+              int flags)
+      : channel_(channel),
+        req_wrap_(req_wrap),
+        hostname_(hostname),
+        family_(family),
+        flags_(flags),
+        ipv4_(this, ns_t_a),
+        ipv6_(this, ns_t_aaaa) {
+    channel_->ModifyActivityQueryCount(1);
+  }
+
+  void Start() {
+    bool want_ipv4 = family_ != AF_INET6;
+    bool want_ipv6 = family_ != AF_INET;
+    if (family_ == AF_UNSPEC && (flags_ & AI_ADDRCONFIG)) {
+      bool has_ipv4, has_ipv6;
+      GetConfiguredFamilies(&has_ipv4, &has_ipv6);
+      // Without any configured address, only loopback is usable, which
+      // the flag does not restrict.
+      if (has_ipv4 || has_ipv6) {
+        want_ipv4 = has_ipv4;
+        want_ipv6 = has_ipv6;
+      }
+    }
+
+    HostsFile* hosts_file = channel_->hosts_file();
+    hosts_file->Lookup(hostname_.c_str(), want_ipv4, want_ipv6, &hosts_);
+    if (hosts_.empty() && MapsIPv4()) {
+      std::vector<std::string> ipv4;
+      hosts_file->Lookup(hostname_.c_str(), true, false, &ipv4);
+      for (const std::string& address : ipv4)
+        hosts_.push_back("::ffff:" + address);
+    }
+    if (!hosts_.empty())
+      return Done();
+
+    // Callback() may run before ares_search() returns.
+    pending_ = want_ipv4 + want_ipv6;
+    channel_->EnsureServers();
+    if (want_ipv6)
+      Search(&ipv6_);
+    if (want_ipv4)
+      Search(&ipv4_);
+  }
+
+ private:
+  struct Query {
+    Query(CaresLookup* lookup, int type) : lookup(lookup), type(type) {}
+
+    CaresLookup* const lookup;
+    const int type;
+    int status = ARES_SUCCESS;
+    std::vector<std::string> addresses;
+    uint32_t ttl = 0;
+  };
+
+  bool MapsIPv4() const {
+    return family_ == AF_INET6 && (flags_ & AI_V4MAPPED);
+  }
+
+  void Search(Query* query) {
+    ares_search(channel_->cares_channel(), hostname_.c_str(), ns_c_in,
+                query->type, Callback, query);
+  }
+
+  static void Callback(void* arg, int status, int timeouts,
+                       unsigned char* answer_buf, int answer_len) {
+    Query* query = static_cast<Query*>(arg);
+    CaresLookup* lookup = query->lookup;
+
+    lookup->channel_->set_query_last_ok(status != ARES_ECONNREFUSED);
+    if (status == ARES_SUCCESS)
+      status = Parse(query, answer_buf, answer_len);
+    query->status = status;
+
+    // Like getaddrinfo() with AI_V4MAPPED, fall back to IPv4-mapped IPv6
+    // addresses if there are no IPv6 ones.
+    if (query == &lookup->ipv6_ && lookup->MapsIPv4() &&
+        query->addresses.empty() &&
+        (status == ARES_SUCCESS || status == ARES_ENODATA ||
+         status == ARES_ENOTFOUND)) {
+      lookup->Search(&lookup->ipv4_);
+      return;
+    }
+
+    if (--lookup->pending_ == 0)
+      lookup->Done();
+  }
+
+  static int Parse(Query* query, unsigned char* buf, int len) {
+    char ip[INET6_ADDRSTRLEN];
+    int status;
+    if (query->type == ns_t_a) {
+      ares_addrttl addrttls[256];
+      int naddrttls = arraysize(addrttls);
+      status = ares_parse_a_reply(buf, len, nullptr, addrttls, &naddrttls);
+      if (status != ARES_SUCCESS)
+        return status;
+      for (int i = 0; i < naddrttls; i++) {
+        if (uv_inet_ntop(AF_INET, &addrttls[i].ipaddr, ip, sizeof(ip)) == 0)
+          Add(query, ip, addrttls[i].ttl);
+      }
+    } else {
+      ares_addr6ttl addrttls[256];
+      int naddrttls = arraysize(addrttls);
+      status = ares_parse_aaaa_reply(buf, len, nullptr, addrttls, &naddrttls);
+      if (status != ARES_SUCCESS)
+        return status;
+      for (int i = 0; i < naddrttls; i++) {
+        if (uv_inet_ntop(AF_INET6, &addrttls[i].ip6addr, ip, sizeof(ip)) == 0)
+          Add(query, ip, addrttls[i].ttl);
+      }
+    }
+    return ARES_SUCCESS;
+  }
+
+  static void Add(Query* query, const char* ip, int ttl) {
+    const uint32_t rr_ttl = ttl < 0 ? 0 : ttl;
+    if (query->addresses.empty() || rr_ttl < query->ttl)
+      query->ttl = rr_ttl;
+    query->addresses.emplace_back(ip);
+  }
+
+  // Callback() may have been called from within Start(), so the lookup is
+  // completed on the next turn of the event loop.
+  void Done() {
+    req_wrap_->env()->SetImmediate([](Environment* env, void* data) {
+      static_cast<CaresLookup*>(data)->Finish();
+    }, this, req_wrap_->object());
+  }
+
+  void Finish() {
+    const uint64_t max_ttl = req_wrap_->env()->cares_lookup_cache()->max_ttl();
+    std::vector<std::string> addresses = std::move(hosts_);
+    uint64_t ttl = max_ttl;
+    int status = 0;
+
+    if (addresses.empty()) {
+      const bool mapped = MapsIPv4() && ipv6_.addresses.empty();
+      int error = ARES_SUCCESS;
+      for (Query* query : { &ipv6_, &ipv4_ }) {
+        for (const std::string& address : query->addresses)
+          addresses.push_back(mapped ? "::ffff:" + address : address);
+        if (!query->addresses.empty() && query->ttl * 1000ULL < ttl)
+          ttl = query->ttl * 1000ULL;
+        if (query->status != ARES_SUCCESS &&
+            query->status != ARES_ENODATA &&
+            query->status != ARES_ENOTFOUND) {
+          error = query->status;
+        }
+      }
+      if (addresses.empty())
+        status = ToGetAddrInfoError(error);
+    }
+
+    channel_->ModifyActivityQueryCount(-1);
+    FinishGetAddrInfo(req_wrap_, status, addresses, ttl);
+    delete this;
+  }
+
+  ChannelWrap* const channel_;
+  GetAddrInfoReqWrap* const req_wrap_;
+  const std::string hostname_;
+  const int family_;
+  const int flags_;
+  std::vector<std::string> hosts_;
+  Query ipv4_;
+  Query ipv6_;
+  int pending_ = 0;
+};
+
+
+// getaddrinfo(req, hostname, family, hints, verbatim) on a channel, for
+// dns.lookup() in c-ares mode. Takes the same arguments as GetAddrInfo().
+void CaresGetAddrInfo(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  ChannelWrap* channel;
+  ASSIGN_OR_RETURN_UNWRAP(&channel, args.Holder());
+
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsString());
+  CHECK(args[2]->IsInt32());
+  CHECK(args[4]->IsBoolean());
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  node::Utf8Value hostname(env->isolate(), args[1]);
+
+  int32_t flags = 0;
+  if (args[3]->IsInt32()) {
+    flags = args[3]->Int32Value(env->context()).FromJust();
+  }
+
+  const int family =
+      ToAddressFamily(args[2]->Int32Value(env->context()).FromJust());
+
+  auto req_wrap = new GetAddrInfoReqWrap(env, req_wrap_obj, args[4]->IsTrue());
+
+  // Make sure the channel object stays alive during the lookup.
+  req_wrap_obj->Set(env->context(),
+                    env->channel_string(),
+                    channel->object()).FromJust();
+
+  const std::string key =
+      LookupCache::LookupKey(channel->cache_id(), family, flags, *hostname);
+  if (!LookupFromCache(req_wrap, key)) {
+    req_wrap->Dispatched();
+    (new CaresLookup(channel, req_wrap, *hostname, family, flags))->Start();
+  }
+
+  args.GetReturnValue().Set(0);
+}
+
+
 void GetNameInfo(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -2029,6 +2840,8 @@ void SetServers(const FunctionCallbackInfo<Value>& args) {
     return args.GetReturnValue().Set(DNS_ESETSRVPENDING);
   }
 
+  channel->set_cache_id(env->cares_lookup_cache()->NewChannelId());
+
   CHECK(args[0]->IsArray());
 
   Local<Array> arr = Local<Array>::Cast(args[0]);
@@ -2119,12 +2932,55 @@ void StrError(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(OneByteString(env->isolate(), errmsg));
 }
 
+// setCacheOptions(maxTtl, negativeTtl, maxEntries), with the TTLs in
+// milliseconds.
+void SetCacheOptions(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsNumber());
+  CHECK(args[1]->IsNumber());
+  CHECK(args[2]->IsUint32());
+  env->cares_lookup_cache()->Configure(
+      args[0]->IntegerValue(env->context()).FromJust(),
+      args[1]->IntegerValue(env->context()).FromJust(),
+      args[2]->Uint32Value(env->context()).FromJust());
+}
+
+void ClearCache(const FunctionCallbackInfo<Value>& args) {
+  Environment::GetCurrent(args)->cares_lookup_cache()->Clear();
+}
+
+// Returns [hits, misses, coalesced, evictions, entries].
+void GetCacheStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  LookupCache* cache = env->cares_lookup_cache();
+  const double stats[] = {
+    static_cast<double>(cache->hits()),
+    static_cast<double>(cache->misses()),
+    static_cast<double>(cache->coalesced()),
+    static_cast<double>(cache->evictions()),
+    static_cast<double>(cache->size())
+  };
+  Local<Array> ret = Array::New(env->isolate(), arraysize(stats));
+  for (size_t i = 0; i < arraysize(stats); i++) {
+    ret->Set(env->context(), i,
+             Number::New(env->isolate(), stats[i])).FromJust();
+  }
+  args.GetReturnValue().Set(ret);
+}
+
 
 void Initialize(Local<Object> target,
                 Local<Value> unused,
                 Local<Context> context) {
   Environment* env = Environment::GetCurrent(context);
 
+  env->set_cares_lookup_cache(new LookupCache(env->event_loop()));
+  env->AtExit([](void* arg) {
+    Environment* env = static_cast<Environment*>(arg);
+    delete env->cares_lookup_cache();
+    env->set_cares_lookup_cache(nullptr);
+  }, env);
+
   env->SetMethod(target, "getaddrinfo", GetAddrInfo);
   env->SetMethod(target, "getnameinfo", GetNameInfo);
   env->SetMethod(target, "isIPv6", IsIPv6);
@@ -2132,6 +2988,10 @@ void Initialize(Local<Object> target,
 
   env->SetMethod(target, "strerror", StrError);
 
+  env->SetMethod(target, "setCacheOptions", SetCacheOptions);
+  env->SetMethod(target, "clearCache", ClearCache);
+  env->SetMethod(target, "getCacheStats", GetCacheStats);
+
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "AF_INET"),
               Integer::New(env->isolate(), AF_INET));
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "AF_INET6"),
@@ -2192,6 +3052,7 @@ void Initialize(Local<Object> target,
   env->SetProtoMethod(channel_wrap, "queryNaptr", Query<QueryNaptrWrap>);
   env->SetProtoMethod(channel_wrap, "querySoa", Query<QuerySoaWrap>);
   env->SetProtoMethod(channel_wrap, "getHostByAddr", Query<GetHostByAddrWrap>);
+  env->SetProtoMethod(channel_wrap, "getaddrinfo", CaresGetAddrInfo);
 
   env->SetProtoMethod(channel_wrap, "getServers", GetServers);
   env->SetProtoMethod(channel_wrap, "setServers", SetServers);
@@ -49,6 +49,10 @@ inline uint32_t* IsolateData::zero_fill_field() const {
   return zero_fill_field_;
 }
 
+inline SizeClassAllocator* IsolateData::size_classes() const {
+  return size_classes_;
+}
+
 inline MultiIsolatePlatform* IsolateData::platform() const {
   return platform_;
 }
@@ -540,6 +544,56 @@ Environment::fs_stats_field_array() {
   return &fs_stats_field_array_;
 }
 
+inline cares_wrap::LookupCache* Environment::cares_lookup_cache() const {
+  return cares_lookup_cache_;
+}
+
+inline void Environment::set_cares_lookup_cache(
+    cares_wrap::LookupCache* cache) {
+  // Should be set only once, and is cleared when the cache is freed at exit.
+  CHECK(cache == nullptr || cares_lookup_cache_ == nullptr);
+  cares_lookup_cache_ = cache;
+}
+
+inline fs::FSReqWrapPool* Environment::fs_req_wrap_pool() const {
+  return fs_req_wrap_pool_;
+}
+
+inline void Environment::set_fs_req_wrap_pool(fs::FSReqWrapPool* pool) {
+  CHECK_EQ(fs_req_wrap_pool_, nullptr);  // Should be set only once.
+  fs_req_wrap_pool_ = pool;
+}
+
+inline i18n::ConverterCache* Environment::i18n_converter_cache() const {
+  return i18n_converter_cache_;
+}
+
+inline void Environment::set_i18n_converter_cache(
+    i18n::ConverterCache* cache) {
+  // Should be set only once, and is cleared when the cache is freed at exit.
+  CHECK(cache == nullptr || i18n_converter_cache_ == nullptr);
+  i18n_converter_cache_ = cache;
+}
+
+inline zlib::StatePool* Environment::zlib_state_pool() const {
+  return zlib_state_pool_;
+}
+
+inline void Environment::set_zlib_state_pool(zlib::StatePool* pool) {
+  // Should be set only once, and is cleared when the pool is freed at exit.
+  CHECK(pool == nullptr || zlib_state_pool_ == nullptr);
+  zlib_state_pool_ = pool;
+}
+
+inline UDPRecvPool* Environment::udp_recv_pool() const {
+  return udp_recv_pool_;
+}
+
+inline void Environment::set_udp_recv_pool(UDPRecvPool* pool) {
+  CHECK_EQ(udp_recv_pool_, nullptr);  // Should be set only once.
+  udp_recv_pool_ = pool;
+}
+
 void Environment::CreateImmediate(native_immediate_callback cb,
                                void* data,
                                v8::Local<v8::Object> obj,
@@ -25,7 +25,8 @@ using v8::Value;
 IsolateData::IsolateData(Isolate* isolate,
                          uv_loop_t* event_loop,
                          MultiIsolatePlatform* platform,
-                         uint32_t* zero_fill_field) :
+                         uint32_t* zero_fill_field,
+                         SizeClassAllocator* size_classes) :
 
 // Create string and private symbol properties as internalized one byte strings.
 //
@@ -61,6 +62,7 @@ IsolateData::IsolateData(Isolate* isolate,
     isolate_(isolate),
     event_loop_(event_loop),
     zero_fill_field_(zero_fill_field),
+    size_classes_(size_classes),
     platform_(platform) {
   if (platform_ != nullptr)
     platform_->RegisterIsolate(this, event_loop);
@@ -48,6 +48,26 @@ struct nghttp2_rcbuf;
 
 namespace node {
 
+class SizeClassAllocator;
+class StatWatcherDirectory;
+class UDPRecvPool;
+
+namespace cares_wrap {
+class LookupCache;
+}
+
+namespace fs {
+class FSReqWrapPool;
+}
+
+namespace i18n {
+class ConverterCache;
+}
+
+namespace zlib {
+class StatePool;
+}
+
 namespace performance {
 class performance_state;
 }
@@ -200,6 +220,7 @@ struct PackageConfig {
   V(nsname_string, "nsname")                                                  \
   V(ocsp_request_string, "OCSPRequest")                                       \
   V(onaltsvc_string, "onaltsvc")                                              \
+  V(onbatch_string, "onbatch")                                                \
   V(onchange_string, "onchange")                                              \
   V(onclienthello_string, "onclienthello")                                    \
   V(oncomplete_string, "oncomplete")                                          \
@@ -216,6 +237,7 @@ struct PackageConfig {
   V(onnewsession_string, "onnewsession")                                      \
   V(onocspresponse_string, "onocspresponse")                                  \
   V(ongoawaydata_string, "ongoawaydata")                                      \
+  V(onoverflow_string, "onoverflow")                                          \
   V(onpriority_string, "onpriority")                                          \
   V(onread_string, "onread")                                                  \
   V(onreadstart_string, "onreadstart")                                        \
@@ -306,6 +328,7 @@ struct PackageConfig {
   V(domain_callback, v8::Function)                                            \
   V(fd_constructor_template, v8::ObjectTemplate)                              \
   V(fsreqpromise_constructor_template, v8::ObjectTemplate)                    \
+  V(fsreqwrap_constructor_template, v8::ObjectTemplate)                       \
   V(fdclose_constructor_template, v8::ObjectTemplate)                         \
   V(host_import_module_dynamically_callback, v8::Function)                    \
   V(host_initialize_import_meta_object_callback, v8::Function)                \
@@ -345,10 +368,12 @@ class IsolateData {
  public:
   IsolateData(v8::Isolate* isolate, uv_loop_t* event_loop,
               MultiIsolatePlatform* platform = nullptr,
-              uint32_t* zero_fill_field = nullptr);
+              uint32_t* zero_fill_field = nullptr,
+              SizeClassAllocator* size_classes = nullptr);
   ~IsolateData();
   inline uv_loop_t* event_loop() const;
   inline uint32_t* zero_fill_field() const;
+  inline SizeClassAllocator* size_classes() const;
   inline MultiIsolatePlatform* platform() const;
 
 #define VP(PropertyName, StringValue) V(v8::Private, PropertyName)
@@ -380,6 +405,7 @@ class IsolateData {
   v8::Isolate* const isolate_;
   uv_loop_t* const event_loop_;
   uint32_t* const zero_fill_field_;
+  SizeClassAllocator* const size_classes_;
   MultiIsolatePlatform* platform_;
   v8::CpuProfiler* cpu_profiler_ = nullptr;
 
@@ -635,6 +661,9 @@ class Environment {
 
   std::unordered_map<std::string, loader::PackageConfig> package_json_cache;
 
+  std::unordered_map<std::string, StatWatcherDirectory*>
+      stat_watcher_directories;
+
   inline double* heap_statistics_buffer() const;
   inline void set_heap_statistics_buffer(double* pointer);
 
@@ -649,6 +678,21 @@ class Environment {
 
   inline AliasedBuffer<double, v8::Float64Array>* fs_stats_field_array();
 
+  inline cares_wrap::LookupCache* cares_lookup_cache() const;
+  inline void set_cares_lookup_cache(cares_wrap::LookupCache* cache);
+
+  inline fs::FSReqWrapPool* fs_req_wrap_pool() const;
+  inline void set_fs_req_wrap_pool(fs::FSReqWrapPool* pool);
+
+  inline i18n::ConverterCache* i18n_converter_cache() const;
+  inline void set_i18n_converter_cache(i18n::ConverterCache* cache);
+
+  inline zlib::StatePool* zlib_state_pool() const;
+  inline void set_zlib_state_pool(zlib::StatePool* pool);
+
+  inline UDPRecvPool* udp_recv_pool() const;
+  inline void set_udp_recv_pool(UDPRecvPool* pool);
+
   inline performance::performance_state* performance_state();
   inline std::map<std::string, uint64_t>* performance_marks();
 
@@ -827,6 +871,21 @@ class Environment {
   static const int kFsStatsFieldsLength = 2 * 14;
   AliasedBuffer<double, v8::Float64Array> fs_stats_field_array_;
 
+  // Owned by the cares_wrap binding, which frees it from an AtExit() callback.
+  cares_wrap::LookupCache* cares_lookup_cache_ = nullptr;
+
+  // Owned by the fs binding, which frees it from an AtExit() callback.
+  fs::FSReqWrapPool* fs_req_wrap_pool_ = nullptr;
+
+  // Owned by the icu binding, which frees it from an AtExit() callback.
+  i18n::ConverterCache* i18n_converter_cache_ = nullptr;
+
+  // Owned by the zlib binding, which frees it from an AtExit() callback.
+  zlib::StatePool* zlib_state_pool_ = nullptr;
+
+  // Owned by the udp_wrap binding, which frees it from an AtExit() callback.
+  UDPRecvPool* udp_recv_pool_ = nullptr;
+
   struct BeforeExitCallback {
     void (*cb_)(void* arg);
     void* arg_;
@@ -28,8 +28,16 @@
 
 #include <stdlib.h>
 
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 namespace node {
 
+using v8::Array;
+using v8::Boolean;
 using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -57,18 +65,90 @@ class FSEventWrap: public HandleWrap {
  private:
   static const encoding kDefaultEncoding = UTF8;
 
+  // A watch on a subdirectory of the watched directory. Used to implement
+  // recursive watching where libuv doesn't support it (i.e. on Linux).
+  struct Subdirectory {
+    uv_fs_event_t handle;
+    FSEventWrap* wrap;
+    std::string path;  // Relative to the watched directory.
+  };
+
+  // A uv_fs_scandir() or uv_fs_lstat() call on the threadpool on behalf of
+  // WatchTree() or of a rename event. Disowned by setting |wrap| to nullptr
+  // when the watcher is closed while it is in flight.
+  struct TreeScan {
+    uv_fs_t req;
+    FSEventWrap* wrap;
+    std::string path;
+    int events = 0;  // The event that is held back, see AfterSelfLstat().
+  };
+
   FSEventWrap(Environment* env, Local<Object> object);
   ~FSEventWrap() override;
 
   static void OnEvent(uv_fs_event_t* handle, const char* filename, int events,
     int status);
+  static void OnSubdirectoryEvent(uv_fs_event_t* handle,
+                                  const char* filename,
+                                  int events,
+                                  int status);
+  static void OnSubdirectoryClose(uv_handle_t* handle);
+  static void OnBatchTimeout(uv_timer_t* handle);
+  static void AfterScandir(uv_fs_t* req);
+  static void AfterLstat(uv_fs_t* req);
+  static void AfterRenameLstat(uv_fs_t* req);
+  static void AfterSelfLstat(uv_fs_t* req);
+
+  void HandleEvent(const std::string& path, int events, int status);
+  void Emit(int status, int events, const char* filename);
+  void Enqueue(const std::string& path, int events);
+  void FlushBatch();
+  void Overflow();
+
+  bool IsDirectory(const std::string& path);
+  void Lstat(const std::string& path, int events, uv_fs_cb cb);
+  void WatchTree(const std::string& path);
+  void UnwatchTree(const std::string& path);
+  void ScanNext();
+  static TreeScan* FinishScan(uv_fs_t* req);
 
   uv_fs_event_t handle_;
   bool initialized_ = false;
   enum encoding encoding_ = kDefaultEncoding;
+
+  std::string root_;
+  bool persistent_ = true;
+  bool emulate_recursive_ = false;
+  std::unordered_map<std::string, Subdirectory*> subdirectories_;
+  // Directories whose children are still to be scanned, and the scans that
+  // are in flight. Only a few directories are scanned at a time, so that
+  // watching a large tree does not crowd out other users of the threadpool.
+  std::deque<std::string> scan_queue_;
+  std::unordered_set<TreeScan*> tree_scans_;
+
+  // Coalescing of events, disabled when batch_window_ is negative. Events
+  // are collected for batch_window_ milliseconds, keyed by path, and then
+  // delivered to JS in a single call. No more than batch_limit_ distinct
+  // paths are kept; further events set batch_overflow_ instead.
+  int64_t batch_window_ = -1;
+  size_t batch_limit_ = 0;
+  uv_timer_t* batch_timer_ = nullptr;
+  std::vector<std::pair<std::string, int>> batch_;
+  std::unordered_map<std::string, size_t> batch_index_;
+  bool batch_overflow_ = false;
 };
 
 
+static void DeleteTimer(uv_handle_t* handle) {
+  delete reinterpret_cast<uv_timer_t*>(handle);
+}
+
+
+void FSEventWrap::OnSubdirectoryClose(uv_handle_t* handle) {
+  delete static_cast<Subdirectory*>(handle->data);
+}
+
+
 FSEventWrap::FSEventWrap(Environment* env, Local<Object> object)
     : HandleWrap(env,
                  object,
@@ -78,6 +158,9 @@ FSEventWrap::FSEventWrap(Environment* env, Local<Object> object)
 
 FSEventWrap::~FSEventWrap() {
   CHECK_EQ(initialized_, false);
+  CHECK(subdirectories_.empty());
+  CHECK(tree_scans_.empty());
+  CHECK_EQ(batch_timer_, nullptr);
 }
 
 
@@ -106,6 +189,7 @@ void FSEventWrap::New(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// start(path, persistent, recursive, encoding[, batchWindow, batchLimit])
 void FSEventWrap::Start(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -127,6 +211,14 @@ void FSEventWrap::Start(const FunctionCallbackInfo<Value>& args) {
     flags |= UV_FS_EVENT_RECURSIVE;
 
   wrap->encoding_ = ParseEncoding(env->isolate(), args[3], kDefaultEncoding);
+  wrap->persistent_ = args[1]->IsTrue();
+
+  if (args[4]->IsUint32()) {
+    CHECK(args[5]->IsUint32());
+    wrap->batch_window_ = args[4].As<v8::Uint32>()->Value();
+    wrap->batch_limit_ = args[5].As<v8::Uint32>()->Value();
+    CHECK_GT(wrap->batch_limit_, 0);
+  }
 
   int err = uv_fs_event_init(wrap->env()->event_loop(), &wrap->handle_);
   if (err == 0) {
@@ -135,9 +227,24 @@ void FSEventWrap::Start(const FunctionCallbackInfo<Value>& args) {
     err = uv_fs_event_start(&wrap->handle_, OnEvent, *path, flags);
 
     if (err == 0) {
+      wrap->root_.assign(*path, path.length());
+#if defined(__linux__)
+      if ((flags & UV_FS_EVENT_RECURSIVE) && wrap->IsDirectory("")) {
+        wrap->emulate_recursive_ = true;
+        wrap->WatchTree("");
+      }
+#endif
+      if (wrap->batch_window_ >= 0) {
+        wrap->batch_timer_ = new uv_timer_t;
+        CHECK_EQ(0, uv_timer_init(env->event_loop(), wrap->batch_timer_));
+        wrap->batch_timer_->data = wrap;
+      }
+
       // Check for persistent argument
-      if (!args[1]->IsTrue()) {
+      if (!wrap->persistent_) {
         uv_unref(reinterpret_cast<uv_handle_t*>(&wrap->handle_));
+        if (wrap->batch_timer_ != nullptr)
+          uv_unref(reinterpret_cast<uv_handle_t*>(wrap->batch_timer_));
       }
     } else {
       FSEventWrap::Close(args);
@@ -151,12 +258,71 @@ void FSEventWrap::Start(const FunctionCallbackInfo<Value>& args) {
 void FSEventWrap::OnEvent(uv_fs_event_t* handle, const char* filename,
     int events, int status) {
   FSEventWrap* wrap = static_cast<FSEventWrap*>(handle->data);
-  Environment* env = wrap->env();
+
+  if (!wrap->emulate_recursive_ && wrap->batch_window_ < 0)
+    return wrap->Emit(status, events, filename);
+
+  wrap->HandleEvent(filename != nullptr ? filename : "", events, status);
+}
+
+
+void FSEventWrap::OnSubdirectoryEvent(uv_fs_event_t* handle,
+                                      const char* filename,
+                                      int events,
+                                      int status) {
+  Subdirectory* subdirectory = static_cast<Subdirectory*>(handle->data);
+  FSEventWrap* wrap = subdirectory->wrap;
+
+  if (status != 0) {
+    // Losing a subdirectory is not fatal for the watcher as a whole.
+    wrap->UnwatchTree(subdirectory->path);
+    return;
+  }
+
+  if (filename == nullptr)
+    return;
+
+  // libuv reports the removal of the watched directory itself under the
+  // directory's own name. The parent directory reports it as well, so drop it
+  // rather than attributing it to a nonexistent child. Which of the two it is
+  // is found out on the threadpool, see AfterSelfLstat().
+  const size_t slash = subdirectory->path.find_last_of('/');
+  const char* basename = slash == std::string::npos ?
+      subdirectory->path.c_str() : subdirectory->path.c_str() + slash + 1;
+  if (strcmp(filename, basename) == 0)
+    return wrap->Lstat(subdirectory->path, events, AfterSelfLstat);
+
+  wrap->HandleEvent(subdirectory->path + "/" + filename, events, 0);
+}
+
+
+void FSEventWrap::HandleEvent(const std::string& path, int events, int status) {
+  if (status != 0) {
+    FlushBatch();
+    if (!initialized_)
+      return;  // Closed from the batch callback.
+    return Emit(status, events, path.empty() ? nullptr : path.c_str());
+  }
+
+  // Whether a directory appeared or went away is found out on the threadpool;
+  // AfterRenameLstat() then adds or removes the watches below |path|.
+  if (emulate_recursive_ && (events & UV_RENAME) && !path.empty())
+    Lstat(path, 0, AfterRenameLstat);
+
+  if (batch_window_ < 0)
+    return Emit(0, events, path.empty() ? nullptr : path.c_str());
+
+  Enqueue(path, events);
+}
+
+
+void FSEventWrap::Emit(int status, int events, const char* filename) {
+  Environment* env = this->env();
 
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
-  CHECK_EQ(wrap->persistent().IsEmpty(), false);
+  CHECK_EQ(persistent().IsEmpty(), false);
 
   // We're in a bind here. libuv can set both UV_RENAME and UV_CHANGE but
   // the Node API only lets us pass a single event to JS land.
@@ -190,7 +356,7 @@ void FSEventWrap::OnEvent(uv_fs_event_t* handle, const char* filename,
     Local<Value> error;
     MaybeLocal<Value> fn = StringBytes::Encode(env->isolate(),
                                                filename,
-                                               wrap->encoding_,
+                                               encoding_,
                                                &error);
     if (fn.IsEmpty()) {
       argv[0] = Integer::New(env->isolate(), UV_EINVAL);
@@ -204,7 +370,314 @@ void FSEventWrap::OnEvent(uv_fs_event_t* handle, const char* filename,
     }
   }
 
-  wrap->MakeCallback(env->onchange_string(), arraysize(argv), argv);
+  MakeCallback(env->onchange_string(), arraysize(argv), argv);
+}
+
+
+void FSEventWrap::Enqueue(const std::string& path, int events) {
+  auto it = batch_index_.find(path);
+  if (it != batch_index_.end()) {
+    batch_[it->second].second |= events;
+  } else if (batch_.size() < batch_limit_) {
+    batch_index_.emplace(path, batch_.size());
+    batch_.emplace_back(path, events);
+  } else {
+    batch_overflow_ = true;
+  }
+
+  if (!uv_is_active(reinterpret_cast<uv_handle_t*>(batch_timer_)))
+    uv_timer_start(batch_timer_, OnBatchTimeout, batch_window_, 0);
+}
+
+
+void FSEventWrap::OnBatchTimeout(uv_timer_t* handle) {
+  FSEventWrap* wrap = static_cast<FSEventWrap*>(handle->data);
+  wrap->FlushBatch();
+}
+
+
+// Delivers the collected events to JS as a flat array of
+// [eventType, filename, eventType, filename, ...] plus an overflow flag.
+// The same UV_RENAME over UV_CHANGE precedence as in Emit() applies.
+void FSEventWrap::FlushBatch() {
+  if (batch_timer_ == nullptr)
+    return;
+  uv_timer_stop(batch_timer_);
+  if (batch_.empty() && !batch_overflow_)
+    return;
+
+  Environment* env = this->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  std::vector<std::pair<std::string, int>> batch;
+  batch.swap(batch_);
+  batch_index_.clear();
+  const bool overflow = batch_overflow_;
+  batch_overflow_ = false;
+
+  Local<Context> context = env->context();
+  Local<Array> events = Array::New(env->isolate(), 2 * batch.size());
+  uint32_t index = 0;
+  for (const auto& entry : batch) {
+    Local<Value> error;
+    MaybeLocal<Value> filename;
+    if (!entry.first.empty()) {
+      filename = StringBytes::Encode(env->isolate(),
+                                     entry.first.c_str(),
+                                     encoding_,
+                                     &error);
+    }
+    Local<Value> event_string = (entry.second & UV_RENAME) ?
+        env->rename_string() : env->change_string();
+    events->Set(context, index++, event_string).FromJust();
+    events->Set(context,
+                index++,
+                filename.IsEmpty() ? Null(env->isolate()).As<Value>() :
+                                     filename.ToLocalChecked()).FromJust();
+  }
+
+  Local<Value> argv[] = {
+    events,
+    Boolean::New(env->isolate(), overflow)
+  };
+  MakeCallback(env->onbatch_string(), arraysize(argv), argv);
+}
+
+
+bool FSEventWrap::IsDirectory(const std::string& path) {
+  const std::string full_path = path.empty() ? root_ : root_ + "/" + path;
+  uv_fs_t req;
+  int err = uv_fs_lstat(env()->event_loop(), &req, full_path.c_str(), nullptr);
+  const bool is_directory =
+      err == 0 && (req.statbuf.st_mode & S_IFMT) == S_IFDIR;
+  uv_fs_req_cleanup(&req);
+  return is_directory;
+}
+
+
+// Runs uv_fs_lstat() on |path|, relative to the watched directory, and calls
+// |cb| with a TreeScan that carries |path| and |events|.
+void FSEventWrap::Lstat(const std::string& path, int events, uv_fs_cb cb) {
+  TreeScan* scan = new TreeScan();
+  scan->wrap = this;
+  scan->path = path;
+  scan->events = events;
+  scan->req.data = scan;
+  const std::string full_path = root_ + "/" + path;
+  if (uv_fs_lstat(env()->event_loop(),
+                  &scan->req,
+                  full_path.c_str(),
+                  cb) == 0) {
+    tree_scans_.insert(scan);
+  } else {
+    uv_fs_req_cleanup(&scan->req);
+    delete scan;
+  }
+}
+
+
+// Watches every directory below |path|, and |path| itself unless it is the
+// root. Symbolic links are not followed. The watch on |path| is added right
+// away, while its children are found on the threadpool and watched once they
+// are, so the whole tree is covered a little after this returns.
+void FSEventWrap::WatchTree(const std::string& path) {
+  if (!initialized_)
+    return;  // Closed by a callback.
+
+  const std::string full_path = path.empty() ? root_ : root_ + "/" + path;
+
+  if (!path.empty()) {
+    if (subdirectories_.find(path) != subdirectories_.end())
+      return;
+    Subdirectory* subdirectory = new Subdirectory();
+    subdirectory->wrap = this;
+    subdirectory->path = path;
+    CHECK_EQ(0, uv_fs_event_init(env()->event_loop(), &subdirectory->handle));
+    subdirectory->handle.data = subdirectory;
+    int err = uv_fs_event_start(&subdirectory->handle,
+                                OnSubdirectoryEvent,
+                                full_path.c_str(),
+                                0);
+    if (err != 0) {
+      // Typically the inotify watch limit. Let consumers know that they are
+      // not seeing everything.
+      uv_close(reinterpret_cast<uv_handle_t*>(&subdirectory->handle),
+               OnSubdirectoryClose);
+      Overflow();
+      return;
+    }
+    if (!persistent_)
+      uv_unref(reinterpret_cast<uv_handle_t*>(&subdirectory->handle));
+    subdirectories_.emplace(path, subdirectory);
+  }
+
+  scan_queue_.push_back(path);
+  ScanNext();
+}
+
+
+void FSEventWrap::ScanNext() {
+  static const size_t kMaxTreeScans = 2;
+
+  while (initialized_ &&
+         tree_scans_.size() < kMaxTreeScans &&
+         !scan_queue_.empty()) {
+    TreeScan* scan = new TreeScan();
+    scan->wrap = this;
+    scan->path = std::move(scan_queue_.front());
+    scan_queue_.pop_front();
+    scan->req.data = scan;
+
+    const std::string full_path =
+        scan->path.empty() ? root_ : root_ + "/" + scan->path;
+    int err = uv_fs_scandir(env()->event_loop(),
+                            &scan->req,
+                            full_path.c_str(),
+                            0,
+                            AfterScandir);
+    if (err < 0) {
+      uv_fs_req_cleanup(&scan->req);
+      delete scan;
+      continue;
+    }
+    tree_scans_.insert(scan);
+  }
+}
+
+
+// Cleans up after a scan and returns it, or returns nullptr if the watcher
+// was closed in the meantime.
+FSEventWrap::TreeScan* FSEventWrap::FinishScan(uv_fs_t* req) {
+  TreeScan* scan = static_cast<TreeScan*>(req->data);
+  if (scan->wrap == nullptr) {
+    uv_fs_req_cleanup(req);
+    delete scan;
+    return nullptr;
+  }
+  scan->wrap->tree_scans_.erase(scan);
+  return scan;
+}
+
+
+void FSEventWrap::AfterScandir(uv_fs_t* req) {
+  TreeScan* scan = FinishScan(req);
+  if (scan == nullptr)
+    return;
+  FSEventWrap* wrap = scan->wrap;
+
+  // Directories that disappeared in the meantime are simply skipped. The
+  // watcher may be closed from an 'overflow' event along the way.
+  uv_dirent_t ent;
+  while (req->result >= 0 &&
+         wrap->initialized_ &&
+         uv_fs_scandir_next(req, &ent) == 0) {
+    const std::string child =
+        scan->path.empty() ? ent.name : scan->path + "/" + ent.name;
+    if (ent.type == UV_DIRENT_DIR)
+      wrap->WatchTree(child);
+    else if (ent.type == UV_DIRENT_UNKNOWN)
+      wrap->Lstat(child, 0, AfterLstat);
+  }
+  uv_fs_req_cleanup(req);
+  delete scan;
+
+  wrap->ScanNext();
+}
+
+
+void FSEventWrap::AfterLstat(uv_fs_t* req) {
+  TreeScan* scan = FinishScan(req);
+  if (scan == nullptr)
+    return;
+  FSEventWrap* wrap = scan->wrap;
+
+  if (req->result == 0 && (req->statbuf.st_mode & S_IFMT) == S_IFDIR)
+    wrap->WatchTree(scan->path);
+  uv_fs_req_cleanup(req);
+  delete scan;
+
+  wrap->ScanNext();
+}
+
+
+// |scan->path| was renamed into or out of the watched tree.
+void FSEventWrap::AfterRenameLstat(uv_fs_t* req) {
+  TreeScan* scan = FinishScan(req);
+  if (scan == nullptr)
+    return;
+  FSEventWrap* wrap = scan->wrap;
+
+  if (req->result == 0 && (req->statbuf.st_mode & S_IFMT) == S_IFDIR)
+    wrap->WatchTree(scan->path);
+  else
+    wrap->UnwatchTree(scan->path);
+  uv_fs_req_cleanup(req);
+  delete scan;
+
+  wrap->ScanNext();
+}
+
+
+// The subdirectory |scan->path| reported an event under its own name. If it
+// is still a directory, the event was for a child of the same name and is
+// delivered now; otherwise the subdirectory itself went away.
+void FSEventWrap::AfterSelfLstat(uv_fs_t* req) {
+  TreeScan* scan = FinishScan(req);
+  if (scan == nullptr)
+    return;
+  FSEventWrap* wrap = scan->wrap;
+
+  const bool is_directory =
+      req->result == 0 && (req->statbuf.st_mode & S_IFMT) == S_IFDIR;
+  uv_fs_req_cleanup(req);
+  const std::string path = std::move(scan->path);
+  const int events = scan->events;
+  delete scan;
+
+  if (!is_directory) {
+    wrap->UnwatchTree(path);
+  } else {
+    const size_t slash = path.find_last_of('/');
+    const std::string basename =
+        slash == std::string::npos ? path : path.substr(slash + 1);
+    wrap->HandleEvent(path + "/" + basename, events, 0);
+  }
+
+  wrap->ScanNext();
+}
+
+
+// Events were lost, because a subdirectory could not be watched. Batches are
+// flagged, and otherwise JS is told right away, so that either way the
+// consumer knows to rescan.
+void FSEventWrap::Overflow() {
+  if (batch_window_ >= 0) {
+    batch_overflow_ = true;
+    if (!uv_is_active(reinterpret_cast<uv_handle_t*>(batch_timer_)))
+      uv_timer_start(batch_timer_, OnBatchTimeout, batch_window_, 0);
+    return;
+  }
+
+  Environment* env = this->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  MakeCallback(env->onoverflow_string(), 0, nullptr);
+}
+
+
+void FSEventWrap::UnwatchTree(const std::string& path) {
+  const std::string prefix = path + "/";
+  for (auto it = subdirectories_.begin(); it != subdirectories_.end();) {
+    if (it->first == path ||
+        it->first.compare(0, prefix.size(), prefix) == 0) {
+      uv_close(reinterpret_cast<uv_handle_t*>(&it->second->handle),
+               OnSubdirectoryClose);
+      it = subdirectories_.erase(it);
+    } else {
+      ++it;
+    }
+  }
 }
 
 
@@ -216,6 +689,23 @@ void FSEventWrap::Close(const FunctionCallbackInfo<Value>& args) {
     return;
   wrap->initialized_ = false;
 
+  for (const auto& entry : wrap->subdirectories_) {
+    uv_close(reinterpret_cast<uv_handle_t*>(&entry.second->handle),
+             OnSubdirectoryClose);
+  }
+  wrap->subdirectories_.clear();
+
+  for (TreeScan* scan : wrap->tree_scans_)
+    scan->wrap = nullptr;
+  wrap->tree_scans_.clear();
+  wrap->scan_queue_.clear();
+
+  if (wrap->batch_timer_ != nullptr) {
+    uv_close(reinterpret_cast<uv_handle_t*>(wrap->batch_timer_),
+             DeleteTimer);
+    wrap->batch_timer_ = nullptr;
+  }
+
   HandleWrap::Close(args);
 }
 
@@ -706,6 +706,16 @@ fail:
 }
 
 
+size_t ThreadpoolSize() {
+  static const size_t size = [] {
+    const char* val = getenv("UV_THREADPOOL_SIZE");
+    const long size = val != nullptr ? atol(val) : 4;  // NOLINT(runtime/int)
+    return static_cast<size_t>(size < 1 ? 1 : (size > 128 ? 128 : size));
+  }();
+  return size;
+}
+
+
 #ifdef _WIN32
 // Does about the same as strerror(),
 // but supports all windows error messages
@@ -779,12 +789,29 @@ Local<Value> WinapiErrnoException(Isolate* isolate,
 
 
 void* ArrayBufferAllocator::Allocate(size_t size) {
-  if (zero_fill_field_ || zero_fill_all_buffers)
+  const bool zero_fill = zero_fill_field_ || zero_fill_all_buffers;
+  if (void* data = size_classes_.Allocate(size)) {
+    if (zero_fill)
+      memset(data, 0, size);
+    return data;
+  }
+  if (zero_fill)
     return node::UncheckedCalloc(size);
   else
     return node::UncheckedMalloc(size);
 }
 
+void* ArrayBufferAllocator::AllocateUninitialized(size_t size) {
+  if (void* data = size_classes_.Allocate(size))
+    return data;
+  return node::UncheckedMalloc(size);
+}
+
+void ArrayBufferAllocator::Free(void* data, size_t size) {
+  if (!size_classes_.Free(data, size))
+    free(data);
+}
+
 namespace {
 
 bool ShouldAbortOnUncaughtException(Isolate* isolate) {
@@ -4433,7 +4460,8 @@ inline int Start(uv_loop_t* event_loop,
         isolate,
         event_loop,
         v8_platform.Platform(),
-        allocator.zero_fill_field());
+        allocator.zero_fill_field(),
+        allocator.size_classes());
     if (track_heap_objects) {
       isolate->GetHeapProfiler()->StartTrackingHeapObjects(true);
     }
@@ -21,6 +21,8 @@
 
 #include "node.h"
 #include "node_buffer.h"
+#include "node_buffer_allocator.h"
+#include "node_buffer_simd.h"
 
 #include "env-inl.h"
 #include "string_bytes.h"
@@ -66,11 +68,13 @@ inline void* BufferMalloc(size_t length) {
 
 namespace Buffer {
 
+using v8::Array;
 using v8::ArrayBuffer;
 using v8::ArrayBufferCreationMode;
 using v8::ArrayBufferView;
 using v8::Context;
 using v8::EscapableHandleScope;
+using v8::Float64Array;
 using v8::FunctionCallbackInfo;
 using v8::Integer;
 using v8::Isolate;
@@ -559,6 +563,42 @@ void Copy(const FunctionCallbackInfo<Value> &args) {
 }
 
 
+// bytesCopied = concat(target, list)
+// Copies the chunks in `list` back to back into `target`, stopping once
+// `target` is full. Returns -1 if an entry of `list` is not a Uint8Array.
+void Concat(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  THROW_AND_RETURN_UNLESS_BUFFER(env, args[0]);
+  CHECK(args[1]->IsArray());
+  Local<Object> target_obj = args[0].As<Object>();
+  Local<Array> list = args[1].As<Array>();
+  SPREAD_BUFFER_ARG(target_obj, target);
+
+  const uint32_t count = list->Length();
+  size_t offset = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> chunk;
+    if (!list->Get(env->context(), i).ToLocal(&chunk))
+      return;
+    if (!chunk->IsUint8Array())
+      return args.GetReturnValue().Set(-1);
+
+    const size_t remaining = target_length - offset;
+    if (remaining == 0)
+      continue;
+    const size_t chunk_length = Buffer::Length(chunk);
+    if (chunk_length == 0)
+      continue;
+    const size_t to_copy = MIN(chunk_length, remaining);
+    memcpy(target_data + offset, Buffer::Data(chunk), to_copy);
+    offset += to_copy;
+  }
+
+  args.GetReturnValue().Set(static_cast<double>(offset));
+}
+
+
 void Fill(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -640,18 +680,7 @@ void Fill(const FunctionCallbackInfo<Value>& args) {
   if (str_length == 0)
     return args.GetReturnValue().Set(-1);
 
-  size_t in_there = str_length;
-  char* ptr = ts_obj_data + start + str_length;
-
-  while (in_there < fill_length - in_there) {
-    memcpy(ptr, ts_obj_data + start, in_there);
-    ptr += in_there;
-    in_there *= 2;
-  }
-
-  if (in_there < fill_length) {
-    memcpy(ptr, ts_obj_data + start, fill_length - in_there);
-  }
+  simd::RepeatFill(ts_obj_data + start, str_length, fill_length);
 }
 
 
@@ -859,6 +888,24 @@ void Compare(const FunctionCallbackInfo<Value> &args) {
 }
 
 
+// equal = timingSafeEquals(a, b)
+// Unlike compare(), inspects every byte even after a difference is found.
+void TimingSafeEquals(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  THROW_AND_RETURN_UNLESS_BUFFER(env, args[0]);
+  THROW_AND_RETURN_UNLESS_BUFFER(env, args[1]);
+  SPREAD_BUFFER_ARG(args[0], obj_a);
+  SPREAD_BUFFER_ARG(args[1], obj_b);
+
+  if (obj_a_length != obj_b_length)
+    return args.GetReturnValue().Set(false);
+
+  args.GetReturnValue().Set(
+      simd::ConstantTimeEquals(obj_a_data, obj_b_data, obj_a_length));
+}
+
+
 // Computes the offset for starting an indexOf or lastIndexOf search.
 // Returns either a valid offset in [0...<length - 1>], ie inside the Buffer,
 // or -1 to signal that there is no possible match.
@@ -1108,7 +1155,7 @@ void IndexOfNumber(const FunctionCallbackInfo<Value>& args) {
   if (is_forward) {
     ptr = memchr(ts_obj_data + offset, needle, ts_obj_length - offset);
   } else {
-    ptr = node::stringsearch::MemrchrFill(ts_obj_data, needle, offset + 1);
+    ptr = simd::FindLastByte(ts_obj_data, needle, offset + 1);
   }
   const char* ptr_char = static_cast<const char*>(ptr);
   args.GetReturnValue().Set(ptr ? static_cast<int>(ptr_char - ts_obj_data)
@@ -1199,6 +1246,87 @@ void SetupBufferJS(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// getAllocatorStatistics(fields) fills |fields| as laid out by
+// SizeClassAllocator::StatisticsFields and returns false when the isolate
+// does not use node's ArrayBuffer allocator.
+void GetAllocatorStatistics(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SizeClassAllocator* size_classes = env->isolate_data()->size_classes();
+  if (size_classes == nullptr)
+    return args.GetReturnValue().Set(false);
+
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  CHECK_EQ(array->Length(), SizeClassAllocator::kStatisticsLength);
+  ArrayBuffer::Contents contents = array->Buffer()->GetContents();
+  double* fields = reinterpret_cast<double*>(
+      static_cast<char*>(contents.Data()) + array->ByteOffset());
+  size_classes->GetStatistics(fields);
+  args.GetReturnValue().Set(true);
+}
+
+
+void SetAllocatorRetentionLimit(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsNumber());
+  SizeClassAllocator* size_classes = env->isolate_data()->size_classes();
+  if (size_classes != nullptr)
+    size_classes->SetRetentionLimit(args[0]->IntegerValue());
+}
+
+
+// poolAcquire(size) returns a Buffer backed by a recycled block, or undefined
+// when |size| is too large to be pooled or the isolate does not use node's
+// ArrayBuffer allocator.
+void PoolAcquire(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsUint32());
+  SizeClassAllocator* size_classes = env->isolate_data()->size_classes();
+  if (size_classes == nullptr)
+    return;
+
+  size_t size = args[0]->Uint32Value();
+  char* data = static_cast<char*>(size_classes->AcquirePooled(size));
+  if (data == nullptr)
+    return;
+  if (zero_fill_all_buffers)
+    memset(data, 0, size);
+
+  // V8 hands the block back through ArrayBufferAllocator::Free() if the
+  // Buffer is garbage collected without being released.
+  Local<Object> obj;
+  if (New(env, data, size).ToLocal(&obj))
+    args.GetReturnValue().Set(obj);
+  else
+    size_classes->ReleasePooled(data);
+}
+
+
+// poolRelease(buf) detaches the ArrayBuffer of |buf| and puts its memory on
+// the recycle list, or leaves that to the last request that still reads or
+// writes the memory, see PooledBufferPins. Returns false when the memory did
+// not come from poolAcquire().
+void PoolRelease(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsArrayBufferView());
+  SizeClassAllocator* size_classes = env->isolate_data()->size_classes();
+  Local<ArrayBuffer> ab = args[0].As<ArrayBufferView>()->Buffer();
+  void* data = ab->GetContents().Data();
+  if (size_classes == nullptr ||
+      data == nullptr ||
+      ab->IsExternal() ||
+      !ab->IsNeuterable() ||
+      !size_classes->IsPooled(data)) {
+    return args.GetReturnValue().Set(false);
+  }
+
+  ab->Externalize();
+  ab->Neuter();
+  CHECK(size_classes->ReleasePooled(data));
+  args.GetReturnValue().Set(true);
+}
+
+
 void Initialize(Local<Object> target,
                 Local<Value> unused,
                 Local<Context> context) {
@@ -1209,8 +1337,10 @@ void Initialize(Local<Object> target,
 
   env->SetMethod(target, "byteLengthUtf8", ByteLengthUtf8);
   env->SetMethod(target, "copy", Copy);
+  env->SetMethod(target, "concat", Concat);
   env->SetMethod(target, "compare", Compare);
   env->SetMethod(target, "compareOffset", CompareOffset);
+  env->SetMethod(target, "timingSafeEquals", TimingSafeEquals);
   env->SetMethod(target, "fill", Fill);
   env->SetMethod(target, "indexOfBuffer", IndexOfBuffer);
   env->SetMethod(target, "indexOfNumber", IndexOfNumber);
@@ -1227,6 +1357,12 @@ void Initialize(Local<Object> target,
 
   env->SetMethod(target, "encodeUtf8String", EncodeUtf8String);
 
+  env->SetMethod(target, "getAllocatorStatistics", GetAllocatorStatistics);
+  env->SetMethod(target, "setAllocatorRetentionLimit",
+                 SetAllocatorRetentionLimit);
+  env->SetMethod(target, "poolAcquire", PoolAcquire);
+  env->SetMethod(target, "poolRelease", PoolRelease);
+
   target->Set(env->context(),
               FIXED_ONE_BYTE_STRING(env->isolate(), "kMaxLength"),
               Integer::NewFromUnsigned(env->isolate(), kMaxLength)).FromJust();
@@ -1234,6 +1370,13 @@ void Initialize(Local<Object> target,
   target->Set(env->context(),
               FIXED_ONE_BYTE_STRING(env->isolate(), "kStringMaxLength"),
               Integer::New(env->isolate(), String::kMaxLength)).FromJust();
+
+  target->Set(env->context(),
+              FIXED_ONE_BYTE_STRING(env->isolate(),
+                                    "kAllocatorStatisticsLength"),
+              Integer::NewFromUnsigned(
+                  env->isolate(),
+                  SizeClassAllocator::kStatisticsLength)).FromJust();
 }
 
 }  // anonymous namespace
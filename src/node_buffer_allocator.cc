@@ -0,0 +1,345 @@
+#include "node_buffer_allocator.h"
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+# include <malloc.h>
+#endif
+
+namespace node {
+
+constexpr size_t SizeClassAllocator::kStatisticsLength;
+
+namespace {
+
+// Slabs only need to be aligned to a page, so that the blocks in them are as
+// well. Aligning them to their own size would make the allocator reserve up
+// to twice as much address space for each of them.
+constexpr size_t kSlabAlignment = 4096;
+
+void* AllocateSlabMemory() {
+  constexpr size_t size = SizeClassAllocator::kSlabSize;
+#ifdef _WIN32
+  return _aligned_malloc(size, kSlabAlignment);
+#else
+  void* data;
+  if (posix_memalign(&data, kSlabAlignment, size) != 0)
+    return nullptr;
+  return data;
+#endif
+}
+
+void FreeSlabMemory(void* data) {
+#ifdef _WIN32
+  _aligned_free(data);
+#else
+  free(data);
+#endif
+}
+
+}  // anonymous namespace
+
+SizeClassAllocator::~SizeClassAllocator() {
+  for (auto& it : slabs_) {
+    FreeSlabMemory(it.second->base);
+    delete it.second;
+  }
+  for (auto& blocks : recycled_) {
+    for (void* block : blocks)
+      free(block);
+  }
+}
+
+size_t SizeClassAllocator::ClassIndex(size_t size) {
+  size_t index = 0;
+  while ((size_t{1} << (kMinClassShift + index)) < size)
+    index++;
+  return index;
+}
+
+size_t SizeClassAllocator::ClassSize(size_t index) {
+  return size_t{1} << (kMinClassShift + index);
+}
+
+size_t SizeClassAllocator::RetainedBytes() const {
+  return retained_slabs_ * kSlabSize + pool_retained_bytes_;
+}
+
+void* SizeClassAllocator::Allocate(size_t size) {
+  // Smaller requests would waste more than half of the smallest class.
+  if (size <= ClassSize(0) / 2 || size > ClassSize(kClassCount - 1))
+    return nullptr;
+
+  const size_t index = ClassIndex(size);
+  SizeClass& size_class = classes_[index];
+  Mutex::ScopedLock lock(mutex_);
+
+  Slab* slab = size_class.available;
+  if (slab == nullptr && (slab = NewSlab(index)) == nullptr)
+    return nullptr;
+
+  void* block;
+  if (slab->free_list != nullptr) {
+    block = slab->free_list;
+    slab->free_list = *static_cast<void**>(block);
+  } else {
+    // Blocks are handed out in order the first time so that untouched parts
+    // of a slab don't need to be paged in.
+    block = slab->base + slab->next_unused * ClassSize(index);
+    slab->next_unused++;
+  }
+
+  if (slab->in_use++ == 0)
+    retained_slabs_--;
+  if (slab->in_use == slab->capacity)
+    UnlinkAvailable(slab);
+
+  size_class.blocks_in_use++;
+  size_class.blocks_free--;
+  size_class.allocations++;
+  return block;
+}
+
+bool SizeClassAllocator::Free(void* data, size_t size) {
+  if (pooled_count_ > 0 && ReleasePooled(data))
+    return true;
+  if (size <= ClassSize(0) / 2 || size > ClassSize(kClassCount - 1))
+    return false;
+
+  Mutex::ScopedLock lock(mutex_);
+  Slab* slab = FindSlab(data);
+  if (slab == nullptr)
+    return false;
+
+  SizeClass& size_class = classes_[slab->class_index];
+  *static_cast<void**>(data) = slab->free_list;
+  slab->free_list = data;
+  if (slab->in_use-- == slab->capacity)
+    LinkAvailable(slab);
+  size_class.blocks_in_use--;
+  size_class.blocks_free++;
+
+  if (slab->in_use == 0) {
+    retained_slabs_++;
+    // The retention limit held before this call, so releasing this slab is
+    // enough to get back under it.
+    if (RetainedBytes() > retention_limit_)
+      ReleaseSlab(slab);
+  }
+  return true;
+}
+
+void* SizeClassAllocator::AcquirePooled(size_t size) {
+  if (size > ClassSize(kPoolClassCount - 1))
+    return nullptr;
+
+  const size_t index = ClassIndex(size);
+  void* block = nullptr;
+  {
+    Mutex::ScopedLock lock(mutex_);
+    std::vector<void*>& recycled = recycled_[index];
+    if (!recycled.empty()) {
+      block = recycled.back();
+      recycled.pop_back();
+      pool_retained_bytes_ -= ClassSize(index);
+    }
+  }
+  if (block == nullptr && (block = malloc(ClassSize(index))) == nullptr)
+    return nullptr;
+
+  Mutex::ScopedLock lock(mutex_);
+  pooled_[reinterpret_cast<uintptr_t>(block)] = { index, 0, false };
+  pooled_count_++;
+  return block;
+}
+
+// Returns the pool block that |data| points into, or pooled_.end().
+std::map<uintptr_t, SizeClassAllocator::PooledBlock>::iterator
+SizeClassAllocator::FindPooled(const void* data) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(data);
+  auto it = pooled_.upper_bound(address);
+  if (it == pooled_.begin())
+    return pooled_.end();
+  --it;
+  if (address - it->first >= ClassSize(it->second.class_index))
+    return pooled_.end();
+  return it;
+}
+
+void SizeClassAllocator::RecyclePooled(
+    std::map<uintptr_t, PooledBlock>::iterator it) {
+  void* data = reinterpret_cast<void*>(it->first);
+  const size_t index = it->second.class_index;
+  pooled_.erase(it);
+  pooled_count_--;
+  if (RetainedBytes() + ClassSize(index) > retention_limit_) {
+    free(data);
+  } else {
+    recycled_[index].push_back(data);
+    pool_retained_bytes_ += ClassSize(index);
+  }
+}
+
+bool SizeClassAllocator::ReleasePooled(void* data) {
+  Mutex::ScopedLock lock(mutex_);
+  auto it = pooled_.find(reinterpret_cast<uintptr_t>(data));
+  if (it == pooled_.end() || it->second.released)
+    return false;
+
+  if (it->second.pins > 0)
+    it->second.released = true;
+  else
+    RecyclePooled(it);
+  return true;
+}
+
+bool SizeClassAllocator::IsPooled(void* data) {
+  Mutex::ScopedLock lock(mutex_);
+  auto it = pooled_.find(reinterpret_cast<uintptr_t>(data));
+  return it != pooled_.end() && !it->second.released;
+}
+
+bool SizeClassAllocator::Pin(const void* data) {
+  if (pooled_count_ == 0)
+    return false;
+  Mutex::ScopedLock lock(mutex_);
+  auto it = FindPooled(data);
+  if (it == pooled_.end())
+    return false;
+  it->second.pins++;
+  return true;
+}
+
+void SizeClassAllocator::Unpin(const void* data) {
+  Mutex::ScopedLock lock(mutex_);
+  auto it = FindPooled(data);
+  CHECK(it != pooled_.end());
+  CHECK_GT(it->second.pins, 0);
+  if (--it->second.pins == 0 && it->second.released)
+    RecyclePooled(it);
+}
+
+void PooledBufferPins::Pin(SizeClassAllocator* allocator, const void* data) {
+  if (allocator == nullptr || !allocator->Pin(data))
+    return;
+  CHECK(allocator_ == nullptr || allocator_ == allocator);
+  allocator_ = allocator;
+  pinned_.push_back(data);
+}
+
+void PooledBufferPins::Clear() {
+  for (const void* data : pinned_)
+    allocator_->Unpin(data);
+  pinned_.clear();
+}
+
+void SizeClassAllocator::SetRetentionLimit(size_t limit) {
+  Mutex::ScopedLock lock(mutex_);
+  retention_limit_ = limit;
+  TrimLocked();
+}
+
+void SizeClassAllocator::GetStatistics(double* fields) {
+  Mutex::ScopedLock lock(mutex_);
+  fields[kRetentionLimitField] = retention_limit_;
+  fields[kSlabSizeField] = kSlabSize;
+  fields[kSlabsField] = slabs_.size();
+  fields[kRetainedSlabsField] = retained_slabs_;
+  fields[kPoolBlocksInUseField] = pooled_.size();
+  fields[kPoolRetainedBytesField] = pool_retained_bytes_;
+  for (size_t i = 0; i < kClassCount; i++) {
+    double* class_fields = fields + kClassFieldsStart + i * kClassFieldCount;
+    class_fields[kClassSizeField] = ClassSize(i);
+    class_fields[kClassSlabsField] = classes_[i].slabs;
+    class_fields[kClassBlocksInUseField] = classes_[i].blocks_in_use;
+    class_fields[kClassBlocksFreeField] = classes_[i].blocks_free;
+    class_fields[kClassAllocationsField] = classes_[i].allocations;
+  }
+}
+
+// Returns the slab that |data| lies in, or nullptr. That is the slab with the
+// highest base address that is not above |data|, if it reaches that far.
+SizeClassAllocator::Slab* SizeClassAllocator::FindSlab(void* data) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(data);
+  auto it = slabs_.upper_bound(address);
+  if (it == slabs_.begin())
+    return nullptr;
+  Slab* slab = (--it)->second;
+  if (address - it->first >= kSlabSize)
+    return nullptr;
+  return slab;
+}
+
+SizeClassAllocator::Slab* SizeClassAllocator::NewSlab(size_t index) {
+  char* base = static_cast<char*>(AllocateSlabMemory());
+  if (base == nullptr)
+    return nullptr;
+
+  Slab* slab = new Slab();
+  slab->base = base;
+  slab->class_index = index;
+  slab->capacity = kSlabSize / ClassSize(index);
+  slabs_[reinterpret_cast<uintptr_t>(base)] = slab;
+  retained_slabs_++;
+  classes_[index].slabs++;
+  classes_[index].blocks_free += slab->capacity;
+  LinkAvailable(slab);
+  return slab;
+}
+
+void SizeClassAllocator::ReleaseSlab(Slab* slab) {
+  CHECK_EQ(slab->in_use, 0);
+  UnlinkAvailable(slab);
+  SizeClass& size_class = classes_[slab->class_index];
+  size_class.slabs--;
+  size_class.blocks_free -= slab->capacity;
+  retained_slabs_--;
+  slabs_.erase(reinterpret_cast<uintptr_t>(slab->base));
+  FreeSlabMemory(slab->base);
+  delete slab;
+}
+
+void SizeClassAllocator::LinkAvailable(Slab* slab) {
+  CHECK(!slab->available);
+  SizeClass& size_class = classes_[slab->class_index];
+  slab->prev = nullptr;
+  slab->next = size_class.available;
+  if (slab->next != nullptr)
+    slab->next->prev = slab;
+  size_class.available = slab;
+  slab->available = true;
+}
+
+void SizeClassAllocator::UnlinkAvailable(Slab* slab) {
+  CHECK(slab->available);
+  if (slab->prev != nullptr)
+    slab->prev->next = slab->next;
+  else
+    classes_[slab->class_index].available = slab->next;
+  if (slab->next != nullptr)
+    slab->next->prev = slab->prev;
+  slab->prev = slab->next = nullptr;
+  slab->available = false;
+}
+
+void SizeClassAllocator::TrimLocked() {
+  // Recycled pool blocks go first, largest first.
+  for (size_t i = kPoolClassCount; i-- > 0;) {
+    while (!recycled_[i].empty() && RetainedBytes() > retention_limit_) {
+      free(recycled_[i].back());
+      recycled_[i].pop_back();
+      pool_retained_bytes_ -= ClassSize(i);
+    }
+  }
+  if (RetainedBytes() <= retention_limit_)
+    return;
+  for (auto it = slabs_.begin(); it != slabs_.end();) {
+    Slab* slab = (it++)->second;
+    if (slab->in_use == 0)
+      ReleaseSlab(slab);
+    if (RetainedBytes() <= retention_limit_)
+      return;
+  }
+}
+
+}  // namespace node
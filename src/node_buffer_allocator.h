@@ -0,0 +1,181 @@
+#ifndef SRC_NODE_BUFFER_ALLOCATOR_H_
+#define SRC_NODE_BUFFER_ALLOCATOR_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include "node_mutex.h"
+#include "util.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <vector>
+
+namespace node {
+
+// Serves ArrayBuffer backing stores between 2 KiB and 64 KiB from slabs, one
+// set of slabs per power-of-two size class, so that medium sized Buffers
+// don't each go through malloc() and free(). Every isolate gets its own
+// instance through its ArrayBufferAllocator.
+//
+// It also keeps the recycle list behind Buffer.pool: blocks of up to 1 MiB
+// that are handed back explicitly, or by the garbage collector, are reused
+// by later Buffer.pool.acquire() calls. Asynchronous requests pin the blocks
+// they read or write, see PooledBufferPins, so that a block that is released
+// while a request still uses it is only recycled once the request is done.
+//
+// V8 frees backing stores from its concurrent sweeper tasks, which is why
+// the allocator is guarded by a mutex rather than being lock-free.
+//
+// As V8 documents for ArrayBuffer::Externalize(), externalized memory comes
+// from the allocator and has to go back to it, not to free(). Addons that
+// externalize an ArrayBuffer can hand the memory back by wrapping it in a new
+// ArrayBuffer in kInternalized mode, see doc/api/addons.md.
+class SizeClassAllocator {
+ public:
+  static constexpr size_t kMinClassShift = 12;  // 4 KiB
+  static constexpr size_t kMaxClassShift = 16;  // 64 KiB
+  static constexpr size_t kClassCount = kMaxClassShift - kMinClassShift + 1;
+  static constexpr size_t kSlabShift = 20;  // 1 MiB
+  static constexpr size_t kSlabSize = size_t{1} << kSlabShift;
+  static constexpr size_t kDefaultRetentionLimit = 8 * kSlabSize;
+  static constexpr size_t kMaxPoolShift = 20;  // 1 MiB
+  static constexpr size_t kPoolClassCount =
+      kMaxPoolShift - kMinClassShift + 1;
+
+  // Layout of the array filled in by GetStatistics().
+  enum StatisticsFields {
+    kRetentionLimitField,
+    kSlabSizeField,
+    kSlabsField,
+    kRetainedSlabsField,
+    kPoolBlocksInUseField,
+    kPoolRetainedBytesField,
+    kClassFieldsStart
+  };
+  enum ClassStatisticsFields {
+    kClassSizeField,
+    kClassSlabsField,
+    kClassBlocksInUseField,
+    kClassBlocksFreeField,
+    kClassAllocationsField,
+    kClassFieldCount
+  };
+  static constexpr size_t kStatisticsLength =
+      kClassFieldsStart + kClassCount * kClassFieldCount;
+
+  SizeClassAllocator() = default;
+  ~SizeClassAllocator();
+
+  // Returns nullptr when |size| is not served by a size class or when no
+  // slab could be allocated, the caller is expected to fall back to malloc().
+  void* Allocate(size_t size);
+  // Returns false when |data| was not allocated by this allocator.
+  bool Free(void* data, size_t size);
+
+  // Returns a block of at least |size| bytes for Buffer.pool.acquire(),
+  // recycled if possible. Returns nullptr for sizes above 1 MiB or when
+  // memory is exhausted.
+  void* AcquirePooled(size_t size);
+  // Takes back a block handed out by AcquirePooled(). Returns false when
+  // |data| is not such a block.
+  bool ReleasePooled(void* data);
+  bool IsPooled(void* data);
+  // Pin() returns false when |data| does not point into a pool block, which
+  // then needs no Unpin().
+  bool Pin(const void* data);
+  void Unpin(const void* data);
+
+  // Limits the memory that is kept in completely unused slabs and in
+  // recycled pool blocks. Memory in excess of the limit is released
+  // immediately.
+  void SetRetentionLimit(size_t limit);
+  void GetStatistics(double* fields);
+
+ private:
+  struct Slab {
+    char* base;
+    size_t class_index;
+    size_t capacity;
+    size_t in_use = 0;
+    size_t next_unused = 0;
+    void* free_list = nullptr;
+    Slab* prev = nullptr;
+    Slab* next = nullptr;
+    bool available = false;
+  };
+
+  struct PooledBlock {
+    size_t class_index;
+    size_t pins;
+    // Released while pinned; recycled by the last Unpin().
+    bool released;
+  };
+
+  struct SizeClass {
+    // Slabs with at least one free block.
+    Slab* available = nullptr;
+    size_t slabs = 0;
+    size_t blocks_in_use = 0;
+    size_t blocks_free = 0;
+    double allocations = 0;
+  };
+
+  static inline size_t ClassIndex(size_t size);
+  static inline size_t ClassSize(size_t index);
+
+  inline size_t RetainedBytes() const;
+
+  std::map<uintptr_t, PooledBlock>::iterator FindPooled(const void* data);
+  void RecyclePooled(std::map<uintptr_t, PooledBlock>::iterator it);
+  Slab* FindSlab(void* data);
+  Slab* NewSlab(size_t index);
+  void ReleaseSlab(Slab* slab);
+  void LinkAvailable(Slab* slab);
+  void UnlinkAvailable(Slab* slab);
+  void TrimLocked();
+
+  Mutex mutex_;
+  SizeClass classes_[kClassCount];
+  // Keyed by base address, in order, so that FindSlab() can look up the slab
+  // that a block lies in.
+  std::map<uintptr_t, Slab*> slabs_;
+  size_t retained_slabs_ = 0;
+  size_t retention_limit_ = kDefaultRetentionLimit;
+
+  // Pool blocks handed out and not yet recycled, keyed by address, in order,
+  // so that FindPooled() can look up the block that a view points into.
+  // The counter lets Free() and Pin() skip the lookup while the pool is
+  // unused.
+  std::map<uintptr_t, PooledBlock> pooled_;
+  std::atomic<size_t> pooled_count_ { 0 };
+  std::vector<void*> recycled_[kPoolClassCount];
+  size_t pool_retained_bytes_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(SizeClassAllocator);
+};
+
+// Pins the Buffer.pool blocks that an asynchronous request reads or writes
+// until Clear() is called or the instance is destroyed.
+class PooledBufferPins {
+ public:
+  PooledBufferPins() = default;
+  ~PooledBufferPins() { Clear(); }
+
+  // |allocator| may be nullptr if the isolate does not use node's allocator.
+  void Pin(SizeClassAllocator* allocator, const void* data);
+  void Clear();
+
+ private:
+  SizeClassAllocator* allocator_ = nullptr;
+  std::vector<const void*> pinned_;
+
+  DISALLOW_COPY_AND_ASSIGN(PooledBufferPins);
+};
+
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_BUFFER_ALLOCATOR_H_
@@ -0,0 +1,567 @@
+#include "node_internals.h"
+#include "node_buffer.h"
+#include "env-inl.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <string.h>
+
+// Schema driven encoding and decoding of binary records, used by
+// BufferCursor in lib/internal/buffer_cursor.js. A schema is a Uint8Array of
+// FieldType codes; each call reads or writes a whole record so that a message
+// costs one binding call instead of one per field.
+
+namespace node {
+
+using v8::Array;
+using v8::ArrayBuffer;
+using v8::Context;
+using v8::Float64Array;
+using v8::FunctionCallbackInfo;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::String;
+using v8::Uint8Array;
+using v8::Value;
+
+namespace {
+
+enum FieldType : uint8_t {
+  kUInt8,
+  kInt8,
+  kUInt16LE,
+  kUInt16BE,
+  kInt16LE,
+  kInt16BE,
+  kUInt32LE,
+  kUInt32BE,
+  kInt32LE,
+  kInt32BE,
+  kFloatLE,
+  kFloatBE,
+  kDoubleLE,
+  kDoubleBE,
+  kVarUInt,  // Unsigned LEB128.
+  kVarInt,   // Zigzag encoded LEB128.
+  kString,   // kVarUInt byte length followed by UTF-8 data.
+  kBytes,    // kVarUInt byte length followed by raw bytes.
+  kFieldTypeCount
+};
+
+enum CursorStatus {
+  kOk,
+  kOutOfBounds,   // The record does not fit the buffer.
+  kInvalidType,   // A value has the wrong JS type for its field.
+  kOutOfRange,    // A value, or a decoded varint, is out of range.
+  kInvalidSchema  // Unknown field type code.
+};
+
+// Layout of the Float64Array passed as the last argument to every call.
+enum CursorStateField {
+  kEndOffsetField,  // Offset after the record, or the record's byte length.
+  kFieldIndexField,  // Index of the field that caused a non-kOk status.
+  kStateLength
+};
+
+constexpr double kMaxSafeInteger = 9007199254740991.0;  // 2^53 - 1
+constexpr uint64_t kMaxVarUInt = (uint64_t{1} << 53) - 1;
+// Zigzag encoding maps [-(2^53 - 1), 2^53 - 1] onto [0, 2^54 - 2].
+constexpr uint64_t kMaxVarInt = (uint64_t{1} << 54) - 2;
+constexpr size_t kMaxVarIntBytes = 8;
+
+
+struct FieldInfo {
+  uint8_t size;  // 0 for variable length fields.
+  bool little_endian;
+  double min;
+  double max;
+};
+
+const FieldInfo kFieldInfo[kFieldTypeCount] = {
+  { 1, true, 0, 255 },                                     // kUInt8
+  { 1, true, -128, 127 },                                  // kInt8
+  { 2, true, 0, 65535 },                                   // kUInt16LE
+  { 2, false, 0, 65535 },                                  // kUInt16BE
+  { 2, true, -32768, 32767 },                              // kInt16LE
+  { 2, false, -32768, 32767 },                             // kInt16BE
+  { 4, true, 0, 4294967295.0 },                            // kUInt32LE
+  { 4, false, 0, 4294967295.0 },                           // kUInt32BE
+  { 4, true, -2147483648.0, 2147483647.0 },                // kInt32LE
+  { 4, false, -2147483648.0, 2147483647.0 },               // kInt32BE
+  { 4, true, 0, 0 },                                       // kFloatLE
+  { 4, false, 0, 0 },                                      // kFloatBE
+  { 8, true, 0, 0 },                                       // kDoubleLE
+  { 8, false, 0, 0 },                                      // kDoubleBE
+  { 0, true, 0, kMaxSafeInteger },                         // kVarUInt
+  { 0, true, -kMaxSafeInteger, kMaxSafeInteger },          // kVarInt
+  { 0, true, 0, 0 },                                       // kString
+  { 0, true, 0, 0 },                                       // kBytes
+};
+
+
+inline uint64_t LoadUnsigned(const uint8_t* p, size_t size, bool le) {
+  uint64_t value = 0;
+  if (le) {
+    for (size_t i = size; i-- > 0;)
+      value = (value << 8) | p[i];
+  } else {
+    for (size_t i = 0; i < size; i++)
+      value = (value << 8) | p[i];
+  }
+  return value;
+}
+
+
+inline void StoreUnsigned(uint8_t* p, uint64_t value, size_t size, bool le) {
+  for (size_t i = 0; i < size; i++) {
+    p[le ? i : size - 1 - i] = static_cast<uint8_t>(value);
+    value >>= 8;
+  }
+}
+
+
+inline size_t VarIntSize(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    size++;
+  }
+  return size;
+}
+
+
+inline size_t StoreVarInt(uint8_t* p, uint64_t value) {
+  size_t i = 0;
+  while (value >= 0x80) {
+    p[i++] = static_cast<uint8_t>(value) | 0x80;
+    value >>= 7;
+  }
+  p[i++] = static_cast<uint8_t>(value);
+  return i;
+}
+
+
+// Decodes a varint at `p`, never reading at or past `end`.
+inline CursorStatus LoadVarInt(const uint8_t* p,
+                               const uint8_t* end,
+                               uint64_t max,
+                               uint64_t* value,
+                               size_t* size) {
+  uint64_t result = 0;
+  for (size_t i = 0; i < kMaxVarIntBytes; i++) {
+    if (p + i >= end)
+      return kOutOfBounds;
+    const uint8_t byte = p[i];
+    result |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+    if ((byte & 0x80) == 0) {
+      if (result > max)
+        return kOutOfRange;
+      *value = result;
+      *size = i + 1;
+      return kOk;
+    }
+  }
+  return kOutOfRange;
+}
+
+
+inline uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+
+inline int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+
+inline bool IsIntegral(double value) {
+  return value == static_cast<double>(static_cast<int64_t>(value));
+}
+
+
+struct CursorArgs {
+  Local<Object> buffer;
+  uint8_t* data;
+  size_t length;
+  size_t offset;
+  const uint8_t* ops;
+  size_t op_count;
+  double* state_data;
+};
+
+
+// Unpacks (buffer, offset, ops, ..., state). Returns false if `offset` is
+// not a valid position in `buffer`.
+bool ParseCursorArgs(const FunctionCallbackInfo<Value>& args,
+                     int state_index,
+                     CursorArgs* out) {
+  CHECK(args[0]->IsUint8Array());
+  CHECK(args[2]->IsUint8Array());
+  CHECK(args[state_index]->IsFloat64Array());
+
+  out->buffer = args[0].As<Object>();
+  out->data = reinterpret_cast<uint8_t*>(Buffer::Data(args[0]));
+  out->length = Buffer::Length(args[0]);
+  out->ops = reinterpret_cast<const uint8_t*>(Buffer::Data(args[2]));
+  out->op_count = Buffer::Length(args[2]);
+  CHECK_EQ(args[state_index].As<Float64Array>()->Length(), kStateLength);
+  out->state_data = reinterpret_cast<double*>(Buffer::Data(args[state_index]));
+
+  // A field index of -1 blames the offset rather than a field.
+  out->state_data[kFieldIndexField] = -1;
+  if (!args[1]->IsUint32())
+    return false;
+  out->offset = args[1].As<Integer>()->Value();
+  return out->offset <= out->length;
+}
+
+
+// values = read(buffer, offset, ops, state)
+// Returns an Array with one value per field, or a CursorStatus on failure.
+void Read(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+
+  CursorArgs c;
+  if (!ParseCursorArgs(args, 3, &c))
+    return args.GetReturnValue().Set(kOutOfBounds);
+
+  Local<Context> context = env->context();
+  Local<Array> result = Array::New(isolate, c.op_count);
+  const uint8_t* p = c.data + c.offset;
+  const uint8_t* const end = c.data + c.length;
+  Local<ArrayBuffer> ab;
+  size_t ab_offset = 0;
+
+  for (size_t i = 0; i < c.op_count; i++) {
+    const uint8_t type = c.ops[i];
+    CursorStatus status = kOk;
+    Local<Value> value;
+
+    if (type >= kFieldTypeCount) {
+      status = kInvalidSchema;
+    } else if (kFieldInfo[type].size != 0) {
+      const FieldInfo& info = kFieldInfo[type];
+      if (static_cast<size_t>(end - p) < info.size) {
+        status = kOutOfBounds;
+      } else {
+        const uint64_t raw = LoadUnsigned(p, info.size, info.little_endian);
+        p += info.size;
+        switch (type) {
+          case kUInt8:
+          case kUInt16LE:
+          case kUInt16BE:
+          case kUInt32LE:
+          case kUInt32BE:
+            value =
+                Integer::NewFromUnsigned(isolate, static_cast<uint32_t>(raw));
+            break;
+          case kInt8:
+            value = Integer::New(isolate, static_cast<int8_t>(raw));
+            break;
+          case kInt16LE:
+          case kInt16BE:
+            value = Integer::New(isolate, static_cast<int16_t>(raw));
+            break;
+          case kInt32LE:
+          case kInt32BE:
+            value = Integer::New(isolate, static_cast<int32_t>(raw));
+            break;
+          case kFloatLE:
+          case kFloatBE: {
+            const uint32_t bits = static_cast<uint32_t>(raw);
+            float number;
+            memcpy(&number, &bits, sizeof(number));
+            value = Number::New(isolate, number);
+            break;
+          }
+          default: {
+            double number;
+            memcpy(&number, &raw, sizeof(number));
+            value = Number::New(isolate, number);
+            break;
+          }
+        }
+      }
+    } else {
+      uint64_t raw;
+      size_t size;
+      const uint64_t max = type == kVarInt ? kMaxVarInt : kMaxVarUInt;
+      status = LoadVarInt(p, end, max, &raw, &size);
+      if (status == kOk) {
+        p += size;
+        if (type == kVarUInt) {
+          value = Number::New(isolate, static_cast<double>(raw));
+        } else if (type == kVarInt) {
+          value = Number::New(isolate,
+                              static_cast<double>(ZigZagDecode(raw)));
+        } else if (raw > static_cast<size_t>(end - p)) {
+          status = kOutOfBounds;
+        } else if (type == kString) {
+          if (raw > static_cast<uint64_t>(String::kMaxLength)) {
+            status = kOutOfRange;
+          } else {
+            Local<String> string;
+            if (!String::NewFromUtf8(isolate,
+                                     reinterpret_cast<const char*>(p),
+                                     v8::NewStringType::kNormal,
+                                     static_cast<int>(raw))
+                     .ToLocal(&string)) {
+              return;
+            }
+            value = string;
+            p += raw;
+          }
+        } else {
+          // kBytes fields are returned as views into the source buffer.
+          if (ab.IsEmpty()) {
+            Local<Uint8Array> source = c.buffer.As<Uint8Array>();
+            ab = source->Buffer();
+            ab_offset = source->ByteOffset();
+          }
+          const size_t start = ab_offset + (p - c.data);
+          Local<Uint8Array> view;
+          if (!Buffer::New(env, ab, start, raw).ToLocal(&view))
+            return;
+          value = view;
+          p += raw;
+        }
+      }
+    }
+
+    if (status != kOk) {
+      c.state_data[kFieldIndexField] = static_cast<double>(i);
+      return args.GetReturnValue().Set(status);
+    }
+    // Unlike Set(), this cannot run setters installed on Array.prototype,
+    // which could otherwise detach the buffer while it is being read.
+    if (result->CreateDataProperty(context, i, value).IsNothing())
+      return;
+  }
+
+  c.state_data[kEndOffsetField] = static_cast<double>(p - c.data);
+  args.GetReturnValue().Set(result);
+}
+
+
+// Checks `value` against field `type`. On success stores the number to
+// write in `number`, or the byte length of a string or bytes field in `size`.
+CursorStatus CheckValue(Local<Value> value,
+                        uint8_t type,
+                        double* number,
+                        size_t* size) {
+  if (type >= kFieldTypeCount)
+    return kInvalidSchema;
+
+  if (type == kString) {
+    if (!value->IsString())
+      return kInvalidType;
+    *size = value.As<String>()->Utf8Length();
+    return kOk;
+  }
+
+  if (type == kBytes) {
+    if (!value->IsUint8Array())
+      return kInvalidType;
+    *size = Buffer::Length(value);
+    return kOk;
+  }
+
+  if (!value->IsNumber())
+    return kInvalidType;
+  *number = value.As<Number>()->Value();
+
+  const FieldInfo& info = kFieldInfo[type];
+  if (type >= kFloatLE && type <= kDoubleBE)
+    return kOk;
+  if (!(*number >= info.min && *number <= info.max))
+    return kOutOfRange;
+  if ((type == kVarUInt || type == kVarInt) && !IsIntegral(*number))
+    return kOutOfRange;
+  return kOk;
+}
+
+
+// status = write(buffer, offset, ops, values, state)
+void Write(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Local<Context> context = env->context();
+
+  CHECK(args[2]->IsUint8Array());
+  CHECK(args[3]->IsArray());
+  Local<Array> array = args[3].As<Array>();
+
+  // Fetch every value before looking at the buffer: getters run JS, which
+  // could detach or resize it.
+  const size_t count = Buffer::Length(args[2]);
+  MaybeStackBuffer<Local<Value>, 16> values(count);
+  for (size_t i = 0; i < count; i++) {
+    if (!array->Get(context, i).ToLocal(&values[i]))
+      return;
+  }
+
+  CursorArgs c;
+  if (!ParseCursorArgs(args, 4, &c))
+    return args.GetReturnValue().Set(kOutOfBounds);
+
+  uint8_t* p = c.data + c.offset;
+  uint8_t* const end = c.data + c.length;
+
+  for (size_t i = 0; i < c.op_count; i++) {
+    const uint8_t type = c.ops[i];
+    Local<Value> value = values[i];
+    double number = 0;
+    size_t size = 0;
+    CursorStatus status = CheckValue(value, type, &number, &size);
+
+    if (status == kOk) {
+      const size_t available = static_cast<size_t>(end - p);
+      const FieldInfo& info = kFieldInfo[type];
+      if (info.size != 0) {
+        if (available < info.size) {
+          status = kOutOfBounds;
+        } else {
+          uint64_t raw;
+          if (type == kFloatLE || type == kFloatBE) {
+            const float f = static_cast<float>(number);
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            raw = bits;
+          } else if (type == kDoubleLE || type == kDoubleBE) {
+            memcpy(&raw, &number, sizeof(raw));
+          } else {
+            raw = static_cast<uint64_t>(static_cast<int64_t>(number));
+          }
+          StoreUnsigned(p, raw, info.size, info.little_endian);
+          p += info.size;
+        }
+      } else if (type == kVarUInt || type == kVarInt) {
+        const int64_t integer = static_cast<int64_t>(number);
+        const uint64_t raw = type == kVarInt ? ZigZagEncode(integer) :
+                                               static_cast<uint64_t>(integer);
+        if (available < VarIntSize(raw))
+          status = kOutOfBounds;
+        else
+          p += StoreVarInt(p, raw);
+      } else if (available < VarIntSize(size) ||
+                 available - VarIntSize(size) < size) {
+        status = kOutOfBounds;
+      } else {
+        p += StoreVarInt(p, size);
+        if (type == kString) {
+          value.As<String>()->WriteUtf8(
+              reinterpret_cast<char*>(p),
+              static_cast<int>(size),
+              nullptr,
+              String::NO_NULL_TERMINATION | String::REPLACE_INVALID_UTF8);
+        } else if (size > 0) {
+          memmove(p, Buffer::Data(value), size);
+        }
+        p += size;
+      }
+    }
+
+    if (status != kOk) {
+      c.state_data[kFieldIndexField] = static_cast<double>(i);
+      return args.GetReturnValue().Set(status);
+    }
+  }
+
+  c.state_data[kEndOffsetField] = static_cast<double>(p - c.data);
+  args.GetReturnValue().Set(kOk);
+}
+
+
+// status = byteLength(ops, values, state)
+// Stores the encoded size of `values` in state[kEndOffsetField].
+void ByteLength(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Local<Context> context = env->context();
+
+  CHECK(args[0]->IsUint8Array());
+  CHECK(args[1]->IsArray());
+  CHECK(args[2]->IsFloat64Array());
+  const uint8_t* ops = reinterpret_cast<const uint8_t*>(Buffer::Data(args[0]));
+  const size_t op_count = Buffer::Length(args[0]);
+  Local<Array> values = args[1].As<Array>();
+  double* state = reinterpret_cast<double*>(Buffer::Data(args[2]));
+
+  double total = 0;
+  for (size_t i = 0; i < op_count; i++) {
+    const uint8_t type = ops[i];
+    Local<Value> value;
+    if (!values->Get(context, i).ToLocal(&value))
+      return;
+
+    double number = 0;
+    size_t size = 0;
+    CursorStatus status = CheckValue(value, type, &number, &size);
+    if (status != kOk) {
+      state[kFieldIndexField] = static_cast<double>(i);
+      return args.GetReturnValue().Set(status);
+    }
+
+    if (kFieldInfo[type].size != 0) {
+      total += kFieldInfo[type].size;
+    } else if (type == kVarUInt) {
+      total += VarIntSize(static_cast<uint64_t>(number));
+    } else if (type == kVarInt) {
+      total += VarIntSize(ZigZagEncode(static_cast<int64_t>(number)));
+    } else {
+      total += VarIntSize(size) + size;
+    }
+  }
+
+  state[kEndOffsetField] = total;
+  args.GetReturnValue().Set(kOk);
+}
+
+
+void InitializeBufferCursor(Local<Object> target,
+                            Local<Value> unused,
+                            Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  env->SetMethod(target, "read", Read);
+  env->SetMethod(target, "write", Write);
+  env->SetMethod(target, "byteLength", ByteLength);
+
+  NODE_DEFINE_CONSTANT(target, kUInt8);
+  NODE_DEFINE_CONSTANT(target, kInt8);
+  NODE_DEFINE_CONSTANT(target, kUInt16LE);
+  NODE_DEFINE_CONSTANT(target, kUInt16BE);
+  NODE_DEFINE_CONSTANT(target, kInt16LE);
+  NODE_DEFINE_CONSTANT(target, kInt16BE);
+  NODE_DEFINE_CONSTANT(target, kUInt32LE);
+  NODE_DEFINE_CONSTANT(target, kUInt32BE);
+  NODE_DEFINE_CONSTANT(target, kInt32LE);
+  NODE_DEFINE_CONSTANT(target, kInt32BE);
+  NODE_DEFINE_CONSTANT(target, kFloatLE);
+  NODE_DEFINE_CONSTANT(target, kFloatBE);
+  NODE_DEFINE_CONSTANT(target, kDoubleLE);
+  NODE_DEFINE_CONSTANT(target, kDoubleBE);
+  NODE_DEFINE_CONSTANT(target, kVarUInt);
+  NODE_DEFINE_CONSTANT(target, kVarInt);
+  NODE_DEFINE_CONSTANT(target, kString);
+  NODE_DEFINE_CONSTANT(target, kBytes);
+
+  NODE_DEFINE_CONSTANT(target, kOk);
+  NODE_DEFINE_CONSTANT(target, kOutOfBounds);
+  NODE_DEFINE_CONSTANT(target, kInvalidType);
+  NODE_DEFINE_CONSTANT(target, kOutOfRange);
+  NODE_DEFINE_CONSTANT(target, kInvalidSchema);
+
+  NODE_DEFINE_CONSTANT(target, kEndOffsetField);
+  NODE_DEFINE_CONSTANT(target, kFieldIndexField);
+  NODE_DEFINE_CONSTANT(target, kStateLength);
+}
+
+}  // anonymous namespace
+}  // namespace node
+
+NODE_BUILTIN_MODULE_CONTEXT_AWARE(buffer_cursor, node::InitializeBufferCursor)
@@ -0,0 +1,639 @@
+#include "node_buffer_simd.h"
+
+#include <string.h>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) ||                                 \
+    (defined(__i386__) && defined(__SSE2__)) ||                               \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NODE_BUFFER_SIMD_SSE2 1
+#include <emmintrin.h>
+// AVX2 kernels are compiled with function level target attributes so that
+// the rest of the binary keeps running on CPUs without AVX2.
+#if defined(__GNUC__) || defined(__clang__)
+#define NODE_BUFFER_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define NODE_BUFFER_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace node {
+namespace Buffer {
+namespace simd {
+
+namespace {
+
+struct Kernels {
+  void (*repeat_fill)(char* data, size_t pattern_length, size_t length);
+  bool (*constant_time_equals)(const char* a, const char* b, size_t length);
+  const char* (*find_last_byte)(const char* haystack,
+                                uint8_t needle,
+                                size_t length);
+  bool (*is_ascii)(const char* data, size_t length);
+  const char* (*find_first_of)(const char* haystack,
+                               size_t length,
+                               const uint8_t needles[4]);
+  bool (*all_in_ranges)(const char* data,
+                        size_t length,
+                        const uint8_t ranges[4][2]);
+};
+
+// Vector fills only pay off once a few full vectors get written.
+constexpr size_t kMinVectorFill = 64;
+
+
+void RepeatFillScalar(char* data, size_t pattern_length, size_t length) {
+  size_t in_there = pattern_length;
+  char* ptr = data + pattern_length;
+
+  while (in_there < length - in_there) {
+    memcpy(ptr, data, in_there);
+    ptr += in_there;
+    in_there *= 2;
+  }
+
+  if (in_there < length)
+    memcpy(ptr, data, length - in_there);
+}
+
+
+inline uint8_t DiffBytes(const char* a, const char* b, size_t length) {
+  uint8_t diff = 0;
+  for (size_t i = 0; i < length; i++)
+    diff |= static_cast<uint8_t>(a[i] ^ b[i]);
+  return diff;
+}
+
+
+bool ConstantTimeEqualsScalar(const char* a, const char* b, size_t length) {
+  return DiffBytes(a, b, length) == 0;
+}
+
+
+const char* FindLastByteScalar(const char* haystack,
+                               uint8_t needle,
+                               size_t length) {
+  for (size_t i = length; i-- > 0;) {
+    if (static_cast<uint8_t>(haystack[i]) == needle)
+      return haystack + i;
+  }
+  return nullptr;
+}
+
+
+bool IsAsciiScalar(const char* data, size_t length) {
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    if (word & 0x8080808080808080ull)
+      return false;
+  }
+  for (; i < length; i++) {
+    if (data[i] & 0x80)
+      return false;
+  }
+  return true;
+}
+
+
+const char* FindFirstOfScalar(const char* haystack,
+                              size_t length,
+                              const uint8_t needles[4]) {
+  for (size_t i = 0; i < length; i++) {
+    const uint8_t c = static_cast<uint8_t>(haystack[i]);
+    if (c == needles[0] || c == needles[1] ||
+        c == needles[2] || c == needles[3]) {
+      return haystack + i;
+    }
+  }
+  return nullptr;
+}
+
+
+inline bool InRange(uint8_t c, const uint8_t range[2]) {
+  return static_cast<uint8_t>(c - range[0]) <=
+         static_cast<uint8_t>(range[1] - range[0]);
+}
+
+
+bool AllInRangesScalar(const char* data,
+                       size_t length,
+                       const uint8_t ranges[4][2]) {
+  for (size_t i = 0; i < length; i++) {
+    const uint8_t c = static_cast<uint8_t>(data[i]);
+    if (!InRange(c, ranges[0]) && !InRange(c, ranges[1]) &&
+        !InRange(c, ranges[2]) && !InRange(c, ranges[3])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+#if !defined(NODE_BUFFER_SIMD_SSE2) && !defined(NODE_BUFFER_SIMD_NEON)
+const Kernels kScalarKernels = {
+  RepeatFillScalar,
+  ConstantTimeEqualsScalar,
+  FindLastByteScalar,
+  IsAsciiScalar,
+  FindFirstOfScalar,
+  AllInRangesScalar
+};
+#endif
+
+
+#if defined(NODE_BUFFER_SIMD_SSE2) || defined(NODE_BUFFER_SIMD_AVX2)
+inline unsigned HighestBit(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;  // NOLINT(runtime/int)
+  _BitScanReverse(&index, mask);
+  return static_cast<unsigned>(index);
+#else
+  return 31 - __builtin_clz(mask);
+#endif
+}
+
+
+inline unsigned LowestBit(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;  // NOLINT(runtime/int)
+  _BitScanForward(&index, mask);
+  return static_cast<unsigned>(index);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+
+#if defined(NODE_BUFFER_SIMD_SSE2)
+void RepeatFillSSE2(char* data, size_t pattern_length, size_t length) {
+  if (16 % pattern_length != 0 || length < kMinVectorFill)
+    return RepeatFillScalar(data, pattern_length, length);
+
+  RepeatFillScalar(data, pattern_length, 16);
+  const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  size_t offset = 16;
+  for (; offset + 64 <= length; offset += 64) {
+    __m128i* p = reinterpret_cast<__m128i*>(data + offset);
+    _mm_storeu_si128(p, v);
+    _mm_storeu_si128(p + 1, v);
+    _mm_storeu_si128(p + 2, v);
+    _mm_storeu_si128(p + 3, v);
+  }
+  for (; offset + 16 <= length; offset += 16)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data + offset), v);
+  // `offset` is a multiple of the pattern length, so the tail starts at the
+  // beginning of the pattern.
+  memcpy(data + offset, data, length - offset);
+}
+
+
+bool ConstantTimeEqualsSSE2(const char* a, const char* b, size_t length) {
+  __m128i acc = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    acc = _mm_or_si128(acc, _mm_xor_si128(va, vb));
+  }
+  const uint8_t tail = DiffBytes(a + i, b + i, length - i);
+  const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128()));
+  return ((mask ^ 0xFFFF) | tail) == 0;
+}
+
+
+const char* FindLastByteSSE2(const char* haystack,
+                             uint8_t needle,
+                             size_t length) {
+  const __m128i n = _mm_set1_epi8(static_cast<char>(needle));
+  size_t i = length;
+  while (i >= 16) {
+    i -= 16;
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+    const uint32_t mask =
+        static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, n)));
+    if (mask != 0)
+      return haystack + i + HighestBit(mask);
+  }
+  return FindLastByteScalar(haystack, needle, i);
+}
+
+
+bool IsAsciiSSE2(const char* data, size_t length) {
+  const __m128i* p = reinterpret_cast<const __m128i*>(data);
+  size_t i = 0;
+  // Check 64 bytes per branch; the sign bits of all four vectors end up in
+  // the OR.
+  for (; i + 64 <= length; i += 64, p += 4) {
+    const __m128i v = _mm_or_si128(
+        _mm_or_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+        _mm_or_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+    if (_mm_movemask_epi8(v) != 0)
+      return false;
+  }
+  for (; i + 16 <= length; i += 16, p++) {
+    if (_mm_movemask_epi8(_mm_loadu_si128(p)) != 0)
+      return false;
+  }
+  return IsAsciiScalar(data + i, length - i);
+}
+
+
+const char* FindFirstOfSSE2(const char* haystack,
+                            size_t length,
+                            const uint8_t needles[4]) {
+  const __m128i n0 = _mm_set1_epi8(static_cast<char>(needles[0]));
+  const __m128i n1 = _mm_set1_epi8(static_cast<char>(needles[1]));
+  const __m128i n2 = _mm_set1_epi8(static_cast<char>(needles[2]));
+  const __m128i n3 = _mm_set1_epi8(static_cast<char>(needles[3]));
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+    const __m128i eq = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, n0), _mm_cmpeq_epi8(v, n1)),
+        _mm_or_si128(_mm_cmpeq_epi8(v, n2), _mm_cmpeq_epi8(v, n3)));
+    const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(eq));
+    if (mask != 0)
+      return haystack + i + LowestBit(mask);
+  }
+  return FindFirstOfScalar(haystack + i, length - i, needles);
+}
+
+
+// A byte c lies in [lo, hi] iff (c - lo) wrapped to eight bits is at most
+// hi - lo, i.e. iff the saturating subtraction of hi - lo from it is zero.
+bool AllInRangesSSE2(const char* data,
+                     size_t length,
+                     const uint8_t ranges[4][2]) {
+  __m128i lo[4];
+  __m128i span[4];
+  for (int r = 0; r < 4; r++) {
+    lo[r] = _mm_set1_epi8(static_cast<char>(ranges[r][0]));
+    span[r] = _mm_set1_epi8(static_cast<char>(ranges[r][1] - ranges[r][0]));
+  }
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    __m128i in = zero;
+    for (int r = 0; r < 4; r++) {
+      in = _mm_or_si128(in, _mm_cmpeq_epi8(
+          _mm_subs_epu8(_mm_sub_epi8(v, lo[r]), span[r]), zero));
+    }
+    if (_mm_movemask_epi8(in) != 0xffff)
+      return false;
+  }
+  return AllInRangesScalar(data + i, length - i, ranges);
+}
+
+
+const Kernels kSSE2Kernels = {
+  RepeatFillSSE2,
+  ConstantTimeEqualsSSE2,
+  FindLastByteSSE2,
+  IsAsciiSSE2,
+  FindFirstOfSSE2,
+  AllInRangesSSE2
+};
+#endif  // defined(NODE_BUFFER_SIMD_SSE2)
+
+
+#if defined(NODE_BUFFER_SIMD_AVX2)
+__attribute__((target("avx2")))
+void RepeatFillAVX2(char* data, size_t pattern_length, size_t length) {
+  if (32 % pattern_length != 0 || length < kMinVectorFill)
+    return RepeatFillScalar(data, pattern_length, length);
+
+  RepeatFillScalar(data, pattern_length, 32);
+  const __m256i v =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+  size_t offset = 32;
+  for (; offset + 128 <= length; offset += 128) {
+    __m256i* p = reinterpret_cast<__m256i*>(data + offset);
+    _mm256_storeu_si256(p, v);
+    _mm256_storeu_si256(p + 1, v);
+    _mm256_storeu_si256(p + 2, v);
+    _mm256_storeu_si256(p + 3, v);
+  }
+  for (; offset + 32 <= length; offset += 32)
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + offset), v);
+  memcpy(data + offset, data, length - offset);
+}
+
+
+__attribute__((target("avx2")))
+bool ConstantTimeEqualsAVX2(const char* a, const char* b, size_t length) {
+  __m256i acc = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    const __m256i va =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    const __m256i vb =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    acc = _mm256_or_si256(acc, _mm256_xor_si256(va, vb));
+  }
+  const uint8_t tail = DiffBytes(a + i, b + i, length - i);
+  const int zero = _mm256_testz_si256(acc, acc);
+  return (zero & (tail == 0)) != 0;
+}
+
+
+__attribute__((target("avx2")))
+const char* FindLastByteAVX2(const char* haystack,
+                             uint8_t needle,
+                             size_t length) {
+  const __m256i n = _mm256_set1_epi8(static_cast<char>(needle));
+  size_t i = length;
+  while (i >= 32) {
+    i -= 32;
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i));
+    const uint32_t mask =
+        static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, n)));
+    if (mask != 0)
+      return haystack + i + HighestBit(mask);
+  }
+  return FindLastByteSSE2(haystack, needle, i);
+}
+
+
+__attribute__((target("avx2")))
+bool IsAsciiAVX2(const char* data, size_t length) {
+  const __m256i* p = reinterpret_cast<const __m256i*>(data);
+  size_t i = 0;
+  for (; i + 128 <= length; i += 128, p += 4) {
+    const __m256i v = _mm256_or_si256(
+        _mm256_or_si256(_mm256_loadu_si256(p), _mm256_loadu_si256(p + 1)),
+        _mm256_or_si256(_mm256_loadu_si256(p + 2), _mm256_loadu_si256(p + 3)));
+    if (_mm256_movemask_epi8(v) != 0)
+      return false;
+  }
+  for (; i + 32 <= length; i += 32, p++) {
+    if (_mm256_movemask_epi8(_mm256_loadu_si256(p)) != 0)
+      return false;
+  }
+  return IsAsciiSSE2(data + i, length - i);
+}
+
+
+__attribute__((target("avx2")))
+const char* FindFirstOfAVX2(const char* haystack,
+                            size_t length,
+                            const uint8_t needles[4]) {
+  const __m256i n0 = _mm256_set1_epi8(static_cast<char>(needles[0]));
+  const __m256i n1 = _mm256_set1_epi8(static_cast<char>(needles[1]));
+  const __m256i n2 = _mm256_set1_epi8(static_cast<char>(needles[2]));
+  const __m256i n3 = _mm256_set1_epi8(static_cast<char>(needles[3]));
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i));
+    const __m256i eq = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, n0), _mm256_cmpeq_epi8(v, n1)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, n2), _mm256_cmpeq_epi8(v, n3)));
+    const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq));
+    if (mask != 0)
+      return haystack + i + LowestBit(mask);
+  }
+  return FindFirstOfSSE2(haystack + i, length - i, needles);
+}
+
+
+__attribute__((target("avx2")))
+bool AllInRangesAVX2(const char* data,
+                     size_t length,
+                     const uint8_t ranges[4][2]) {
+  __m256i lo[4];
+  __m256i span[4];
+  for (int r = 0; r < 4; r++) {
+    lo[r] = _mm256_set1_epi8(static_cast<char>(ranges[r][0]));
+    span[r] =
+        _mm256_set1_epi8(static_cast<char>(ranges[r][1] - ranges[r][0]));
+  }
+  const __m256i zero = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    __m256i in = zero;
+    for (int r = 0; r < 4; r++) {
+      in = _mm256_or_si256(in, _mm256_cmpeq_epi8(
+          _mm256_subs_epu8(_mm256_sub_epi8(v, lo[r]), span[r]), zero));
+    }
+    if (static_cast<uint32_t>(_mm256_movemask_epi8(in)) != 0xffffffffu)
+      return false;
+  }
+  return AllInRangesSSE2(data + i, length - i, ranges);
+}
+
+
+const Kernels kAVX2Kernels = {
+  RepeatFillAVX2,
+  ConstantTimeEqualsAVX2,
+  FindLastByteAVX2,
+  IsAsciiAVX2,
+  FindFirstOfAVX2,
+  AllInRangesAVX2
+};
+#endif  // defined(NODE_BUFFER_SIMD_AVX2)
+
+
+#if defined(NODE_BUFFER_SIMD_NEON)
+void RepeatFillNEON(char* data, size_t pattern_length, size_t length) {
+  if (16 % pattern_length != 0 || length < kMinVectorFill)
+    return RepeatFillScalar(data, pattern_length, length);
+
+  RepeatFillScalar(data, pattern_length, 16);
+  const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(data));
+  uint8_t* out = reinterpret_cast<uint8_t*>(data);
+  size_t offset = 16;
+  for (; offset + 64 <= length; offset += 64) {
+    vst1q_u8(out + offset, v);
+    vst1q_u8(out + offset + 16, v);
+    vst1q_u8(out + offset + 32, v);
+    vst1q_u8(out + offset + 48, v);
+  }
+  for (; offset + 16 <= length; offset += 16)
+    vst1q_u8(out + offset, v);
+  memcpy(data + offset, data, length - offset);
+}
+
+
+bool ConstantTimeEqualsNEON(const char* a, const char* b, size_t length) {
+  const uint8_t* ua = reinterpret_cast<const uint8_t*>(a);
+  const uint8_t* ub = reinterpret_cast<const uint8_t*>(b);
+  uint8x16_t acc = vdupq_n_u8(0);
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16)
+    acc = vorrq_u8(acc, veorq_u8(vld1q_u8(ua + i), vld1q_u8(ub + i)));
+  const uint8_t tail = DiffBytes(a + i, b + i, length - i);
+  return (vmaxvq_u8(acc) | tail) == 0;
+}
+
+
+const char* FindLastByteNEON(const char* haystack,
+                             uint8_t needle,
+                             size_t length) {
+  const uint8_t* h = reinterpret_cast<const uint8_t*>(haystack);
+  const uint8x16_t n = vdupq_n_u8(needle);
+  size_t i = length;
+  while (i >= 16) {
+    i -= 16;
+    if (vmaxvq_u8(vceqq_u8(vld1q_u8(h + i), n)) != 0)
+      return FindLastByteScalar(haystack + i, needle, 16);
+  }
+  return FindLastByteScalar(haystack, needle, i);
+}
+
+
+bool IsAsciiNEON(const char* data, size_t length) {
+  const uint8_t* d = reinterpret_cast<const uint8_t*>(data);
+  size_t i = 0;
+  for (; i + 64 <= length; i += 64) {
+    const uint8x16_t v =
+        vorrq_u8(vorrq_u8(vld1q_u8(d + i), vld1q_u8(d + i + 16)),
+                 vorrq_u8(vld1q_u8(d + i + 32), vld1q_u8(d + i + 48)));
+    if (vmaxvq_u8(v) >= 0x80)
+      return false;
+  }
+  for (; i + 16 <= length; i += 16) {
+    if (vmaxvq_u8(vld1q_u8(d + i)) >= 0x80)
+      return false;
+  }
+  return IsAsciiScalar(data + i, length - i);
+}
+
+
+const char* FindFirstOfNEON(const char* haystack,
+                            size_t length,
+                            const uint8_t needles[4]) {
+  const uint8_t* h = reinterpret_cast<const uint8_t*>(haystack);
+  const uint8x16_t n0 = vdupq_n_u8(needles[0]);
+  const uint8x16_t n1 = vdupq_n_u8(needles[1]);
+  const uint8x16_t n2 = vdupq_n_u8(needles[2]);
+  const uint8x16_t n3 = vdupq_n_u8(needles[3]);
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const uint8x16_t v = vld1q_u8(h + i);
+    const uint8x16_t eq = vorrq_u8(vorrq_u8(vceqq_u8(v, n0), vceqq_u8(v, n1)),
+                                   vorrq_u8(vceqq_u8(v, n2), vceqq_u8(v, n3)));
+    if (vmaxvq_u8(eq) != 0)
+      return FindFirstOfScalar(haystack + i, 16, needles);
+  }
+  return FindFirstOfScalar(haystack + i, length - i, needles);
+}
+
+
+bool AllInRangesNEON(const char* data,
+                     size_t length,
+                     const uint8_t ranges[4][2]) {
+  const uint8_t* d = reinterpret_cast<const uint8_t*>(data);
+  uint8x16_t lo[4];
+  uint8x16_t span[4];
+  for (int r = 0; r < 4; r++) {
+    lo[r] = vdupq_n_u8(ranges[r][0]);
+    span[r] = vdupq_n_u8(static_cast<uint8_t>(ranges[r][1] - ranges[r][0]));
+  }
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const uint8x16_t v = vld1q_u8(d + i);
+    uint8x16_t in = vdupq_n_u8(0);
+    for (int r = 0; r < 4; r++)
+      in = vorrq_u8(in, vcleq_u8(vsubq_u8(v, lo[r]), span[r]));
+    if (vminvq_u8(in) != 0xff)
+      return false;
+  }
+  return AllInRangesScalar(data + i, length - i, ranges);
+}
+
+
+const Kernels kNEONKernels = {
+  RepeatFillNEON,
+  ConstantTimeEqualsNEON,
+  FindLastByteNEON,
+  IsAsciiNEON,
+  FindFirstOfNEON,
+  AllInRangesNEON
+};
+#endif  // defined(NODE_BUFFER_SIMD_NEON)
+
+
+const Kernels* DetectKernels() {
+#if defined(NODE_BUFFER_SIMD_AVX2)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return &kAVX2Kernels;
+#endif
+#if defined(NODE_BUFFER_SIMD_SSE2)
+  return &kSSE2Kernels;
+#elif defined(NODE_BUFFER_SIMD_NEON)
+  return &kNEONKernels;
+#else
+  return &kScalarKernels;
+#endif
+}
+
+
+std::atomic<const Kernels*> selected_kernels{nullptr};
+
+inline const Kernels& GetKernels() {
+  const Kernels* kernels = selected_kernels.load(std::memory_order_acquire);
+  if (kernels == nullptr) {
+    // Racing threads all detect the same kernel set, so whichever store
+    // lands last is as good as the first.
+    kernels = DetectKernels();
+    selected_kernels.store(kernels, std::memory_order_release);
+  }
+  return *kernels;
+}
+
+}  // anonymous namespace
+
+
+void RepeatFill(char* data, size_t pattern_length, size_t length) {
+  if (pattern_length == 0 || pattern_length >= length)
+    return;
+  GetKernels().repeat_fill(data, pattern_length, length);
+}
+
+
+bool ConstantTimeEquals(const char* a, const char* b, size_t length) {
+  return GetKernels().constant_time_equals(a, b, length);
+}
+
+
+const char* FindLastByte(const char* haystack, uint8_t needle, size_t length) {
+  return GetKernels().find_last_byte(haystack, needle, length);
+}
+
+
+bool IsAscii(const char* data, size_t length) {
+  return GetKernels().is_ascii(data, length);
+}
+
+
+const char* FindFirstOf(const char* haystack,
+                        size_t length,
+                        const uint8_t needles[4]) {
+  return GetKernels().find_first_of(haystack, length, needles);
+}
+
+
+bool AllInRanges(const char* data, size_t length, const uint8_t ranges[4][2]) {
+  return GetKernels().all_in_ranges(data, length, ranges);
+}
+
+}  // namespace simd
+}  // namespace Buffer
+}  // namespace node
@@ -0,0 +1,53 @@
+#ifndef SRC_NODE_BUFFER_SIMD_H_
+#define SRC_NODE_BUFFER_SIMD_H_
+
+#if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+namespace Buffer {
+namespace simd {
+
+// Byte kernels behind Buffer#fill(), Buffer#equals(), Buffer#lastIndexOf(),
+// the ASCII checks in string decoding, the querystring scanner and the URL
+// host fast path. The first call picks the widest implementation the CPU
+// supports (AVX2 or SSE2 on x86, NEON on arm64, portable C otherwise) and
+// every later call goes straight to it.
+
+// `data` holds `pattern_length` bytes of a fill pattern; repeats them until
+// `length` bytes are filled. Patterns whose length divides the vector width
+// are written with vector stores, others by doubling memcpy()s.
+void RepeatFill(char* data, size_t pattern_length, size_t length);
+
+// Returns true if `a` and `b` hold the same `length` bytes. The running time
+// depends only on `length`, not on where the inputs differ.
+bool ConstantTimeEquals(const char* a, const char* b, size_t length);
+
+// Returns a pointer to the last occurrence of `needle` in the first `length`
+// bytes of `haystack`, or nullptr.
+const char* FindLastByte(const char* haystack, uint8_t needle, size_t length);
+
+// Returns true if none of the first `length` bytes of `data` has its high
+// bit set, i.e. the data is 7-bit ASCII.
+bool IsAscii(const char* data, size_t length);
+
+// Returns a pointer to the first of the `length` bytes of `haystack` that is
+// equal to any of the four bytes in `needles`, or nullptr. Needles may repeat.
+const char* FindFirstOf(const char* haystack,
+                        size_t length,
+                        const uint8_t needles[4]);
+
+// Returns true if each of the first `length` bytes of `data` lies in one of
+// the four inclusive ranges `ranges[i][0]` to `ranges[i][1]`. Ranges may
+// repeat.
+bool AllInRanges(const char* data, size_t length, const uint8_t ranges[4][2]);
+
+}  // namespace simd
+}  // namespace Buffer
+}  // namespace node
+
+#endif  // defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
+
+#endif  // SRC_NODE_BUFFER_SIMD_H_
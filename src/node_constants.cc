@@ -24,6 +24,11 @@
 
 #include "zlib.h"
 
+#if NODE_HAVE_BROTLI
+#include <brotli/decode.h>
+#include <brotli/encode.h>
+#endif
+
 #include <errno.h>
 #if !defined(_MSC_VER)
 #include <unistd.h>
@@ -1227,7 +1232,9 @@ void DefineZlibConstants(Local<Object> target) {
     GUNZIP,
     DEFLATERAW,
     INFLATERAW,
-    UNZIP
+    UNZIP,
+    BROTLI_DECODE,
+    BROTLI_ENCODE
   };
 
   NODE_DEFINE_CONSTANT(target, DEFLATE);
@@ -1238,6 +1245,37 @@ void DefineZlibConstants(Local<Object> target) {
   NODE_DEFINE_CONSTANT(target, INFLATERAW);
   NODE_DEFINE_CONSTANT(target, UNZIP);
 
+#if NODE_HAVE_BROTLI
+  NODE_DEFINE_CONSTANT(target, BROTLI_DECODE);
+  NODE_DEFINE_CONSTANT(target, BROTLI_ENCODE);
+
+  NODE_DEFINE_CONSTANT(target, BROTLI_OPERATION_PROCESS);
+  NODE_DEFINE_CONSTANT(target, BROTLI_OPERATION_FLUSH);
+  NODE_DEFINE_CONSTANT(target, BROTLI_OPERATION_FINISH);
+  NODE_DEFINE_CONSTANT(target, BROTLI_OPERATION_EMIT_METADATA);
+
+  NODE_DEFINE_CONSTANT(target, BROTLI_PARAM_MODE);
+  NODE_DEFINE_CONSTANT(target, BROTLI_MODE_GENERIC);
+  NODE_DEFINE_CONSTANT(target, BROTLI_MODE_TEXT);
+  NODE_DEFINE_CONSTANT(target, BROTLI_MODE_FONT);
+  NODE_DEFINE_CONSTANT(target, BROTLI_DEFAULT_MODE);
+  NODE_DEFINE_CONSTANT(target, BROTLI_PARAM_QUALITY);
+  NODE_DEFINE_CONSTANT(target, BROTLI_MIN_QUALITY);
+  NODE_DEFINE_CONSTANT(target, BROTLI_MAX_QUALITY);
+  NODE_DEFINE_CONSTANT(target, BROTLI_DEFAULT_QUALITY);
+  NODE_DEFINE_CONSTANT(target, BROTLI_PARAM_LGWIN);
+  NODE_DEFINE_CONSTANT(target, BROTLI_MIN_WINDOW_BITS);
+  NODE_DEFINE_CONSTANT(target, BROTLI_MAX_WINDOW_BITS);
+  NODE_DEFINE_CONSTANT(target, BROTLI_DEFAULT_WINDOW);
+  NODE_DEFINE_CONSTANT(target, BROTLI_PARAM_LGBLOCK);
+  NODE_DEFINE_CONSTANT(target, BROTLI_MIN_INPUT_BLOCK_BITS);
+  NODE_DEFINE_CONSTANT(target, BROTLI_MAX_INPUT_BLOCK_BITS);
+  NODE_DEFINE_CONSTANT(target, BROTLI_PARAM_DISABLE_LITERAL_CONTEXT_MODELING);
+  NODE_DEFINE_CONSTANT(target, BROTLI_PARAM_SIZE_HINT);
+  NODE_DEFINE_CONSTANT(target,
+                       BROTLI_DECODER_PARAM_DISABLE_RING_BUFFER_REALLOCATION);
+#endif  // NODE_HAVE_BROTLI
+
   NODE_DEFINE_CONSTANT(target, Z_MIN_WINDOWBITS);
   NODE_DEFINE_CONSTANT(target, Z_MAX_WINDOWBITS);
   NODE_DEFINE_CONSTANT(target, Z_DEFAULT_WINDOWBITS);
@@ -1319,6 +1357,7 @@ void DefineConstants(v8::Isolate* isolate, Local<Object> target) {
   // Define libuv constants.
   NODE_DEFINE_CONSTANT(os_constants, UV_UDP_REUSEADDR);
   NODE_DEFINE_CONSTANT(fs_constants, UV_FS_COPYFILE_EXCL);
+  NODE_DEFINE_CONSTANT(fs_constants, UV_FS_COPYFILE_FICLONE_FORCE);
 
   os_constants->Set(OneByteString(isolate, "dlopen"), dlopen_constants);
   os_constants->Set(OneByteString(isolate, "errno"), err_constants);
@@ -27,6 +27,12 @@
 #include "node.h"
 #include "v8.h"
 
+// Understood by the native copy engine in node_file.cc. Matches the value
+// used by later libuv releases so the two stay interchangeable.
+#ifndef UV_FS_COPYFILE_FICLONE_FORCE
+#define UV_FS_COPYFILE_FICLONE_FORCE 0x0004
+#endif
+
 #if HAVE_OPENSSL
 
 #ifndef RSA_PSS_SALTLEN_DIGEST
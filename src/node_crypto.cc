@@ -21,6 +21,7 @@
 
 #include "node.h"
 #include "node_buffer.h"
+#include "node_buffer_allocator.h"
 #include "node_constants.h"
 #include "node_crypto.h"
 #include "node_crypto_bio.h"
@@ -5137,11 +5138,18 @@ class RandomBytesRequest : public AsyncWrap {
     error_ = err;
   }
 
+  // Keeps Buffer.pool memory that is being filled from being recycled by
+  // Buffer.pool.release() before the request is done.
+  inline void PinBuffer(const void* data) {
+    pins_.Pin(env()->isolate_data()->size_classes(), data);
+  }
+
   size_t self_size() const override { return sizeof(*this); }
 
   uv_work_t work_req_;
 
  private:
+  PooledBufferPins pins_;
   unsigned long error_;  // NOLINT(runtime/int)
   size_t size_;
   char* data_;
@@ -5284,6 +5292,7 @@ void RandomBytesBuffer(const FunctionCallbackInfo<Value>& args) {
   if (args[3]->IsFunction()) {
     obj->Set(env->context(), env->ondone_string(), args[3]).FromJust();
 
+    req->PinBuffer(data);
     uv_queue_work(env->event_loop(),
                   req.release()->work_req(),
                   RandomBytesWork,
@@ -21,7 +21,9 @@
 
 #include "aliased_buffer.h"
 #include "node_buffer.h"
+#include "node_constants.h"
 #include "node_internals.h"
+#include "node_mutex.h"
 #include "node_stat_watcher.h"
 #include "node_file.h"
 
@@ -40,7 +42,19 @@
 # include <io.h>
 #endif
 
+#ifdef __POSIX__
+# include <unistd.h>
+#endif
+
+#if defined(__linux__)
+# include <sys/ioctl.h>
+# include <sys/sendfile.h>
+# include <sys/syscall.h>
+#endif
+
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace node {
@@ -255,8 +269,27 @@ void FileHandle::Close(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void FSReqWrap::CallOnComplete(int argc, Local<Value>* argv) {
+  if (callback_.IsEmpty()) {
+    MakeCallback(env()->oncomplete_string(), argc, argv);
+    return;
+  }
+
+  // Pooled requests invoke the user's callback directly, with an undefined
+  // receiver just like the makeCallback() wrapper in lib/fs.js would.
+  Local<Function> callback = callback_.Get(env()->isolate());
+  callback_.Reset();
+  InternalCallbackScope callback_scope(this);
+  if (callback->Call(env()->context(),
+                     Undefined(env()->isolate()),
+                     argc,
+                     argv).IsEmpty()) {
+    callback_scope.MarkAsFailed();
+  }
+}
+
 void FSReqWrap::Reject(Local<Value> reject) {
-  MakeCallback(env()->oncomplete_string(), 1, &reject);
+  CallOnComplete(1, &reject);
 }
 
 void FSReqWrap::FillStatsArray(const uv_stat_t* stat) {
@@ -272,7 +305,7 @@ void FSReqWrap::Resolve(Local<Value> value) {
     Null(env()->isolate()),
     value
   };
-  MakeCallback(env()->oncomplete_string(), arraysize(argv), argv);
+  CallOnComplete(arraysize(argv), argv);
 }
 
 void FSReqWrap::SetReturnValue(const FunctionCallbackInfo<Value>& args) {
@@ -292,6 +325,48 @@ void NewFSReqWrap(const FunctionCallbackInfo<Value>& args) {
   new FSReqWrap(env, args.This());
 }
 
+FSReqWrapPool::~FSReqWrapPool() {
+  for (FSReqWrap* req_wrap : free_) {
+    // Put it back so that ~ReqWrap() has a list node to unlink. Its destroy
+    // hook already ran in Release(), so ~AsyncWrap() emits nothing.
+    req_wrap->Requeue();
+    delete req_wrap;
+  }
+}
+
+FSReqWrap* FSReqWrapPool::Acquire(Local<Function> oncomplete) {
+  FSReqWrap* req_wrap;
+  if (free_.empty()) {
+    Local<Object> obj = env_->fsreqwrap_constructor_template()
+                            ->NewInstance(env_->context()).ToLocalChecked();
+    req_wrap = new FSReqWrap(env_, obj, this);
+  } else {
+    req_wrap = free_.back();
+    free_.pop_back();
+    req_wrap->Requeue();
+    // Give the request a fresh async id and emit init() for it.
+    req_wrap->AsyncReset();
+  }
+  req_wrap->callback_.Reset(env_->isolate(), oncomplete);
+  return req_wrap;
+}
+
+void FSReqWrapPool::Release(FSReqWrap* req_wrap) {
+  CHECK_EQ(req_wrap->pool(), this);
+  req_wrap->callback_.Reset();
+  req_wrap->Reset();
+
+  if (free_.size() >= kMaximumLength) {
+    delete req_wrap;
+    return;
+  }
+
+  // Emit what ~AsyncWrap() would have emitted had the request been deleted.
+  req_wrap->EmitDestroy();
+  req_wrap->Unqueue();
+  free_.push_back(req_wrap);
+}
+
 FSReqPromise::FSReqPromise(Environment* env)
     : FSReqBase(env,
                 env->fsreqpromise_constructor_template()
@@ -344,11 +419,16 @@ FSReqAfterScope::FSReqAfterScope(FSReqBase* wrap, uv_fs_t* req)
       handle_scope_(wrap->env()->isolate()),
       context_scope_(wrap->env()->context()) {
   CHECK_EQ(wrap_->req(), req);
+  wrap_->UnpinBuffers();
 }
 
 FSReqAfterScope::~FSReqAfterScope() {
   uv_fs_req_cleanup(wrap_->req());
-  delete wrap_;
+  FSReqWrapPool* pool = wrap_->pool();
+  if (pool != nullptr)
+    pool->Release(static_cast<FSReqWrap*>(wrap_));
+  else
+    delete wrap_;
 }
 
 // TODO(joyeecheung): create a normal context object, and
@@ -593,7 +673,9 @@ inline int SyncCall(Environment* env, Local<Value> ctx, fs_req_wrap* req_wrap,
 #define SYNC_RESULT err
 
 inline FSReqBase* GetReqWrap(Environment* env, Local<Value> value) {
-  if (value->IsObject()) {
+  if (value->IsFunction()) {
+    return env->fs_req_wrap_pool()->Acquire(value.As<Function>());
+  } else if (value->IsObject()) {
     return Unwrap<FSReqBase>(value.As<Object>());
   } else if (value->StrictEquals(env->fs_use_promises_symbol())) {
     return new FSReqPromise(env);
@@ -647,26 +729,39 @@ void Close(const FunctionCallbackInfo<Value>& args) {
 }
 
 
-// Used to speed up module loading.  Returns the contents of the file as
-// a string or undefined when the file cannot be opened or "main" is not found
-// in the file.
-static void InternalModuleReadJSON(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
-  uv_loop_t* loop = env->event_loop();
+namespace {
 
-  CHECK(args[0]->IsString());
-  node::Utf8Value path(env->isolate(), args[0]);
-
-  if (strlen(*path) != path.length())
-    return;  // Contains a nul byte.
+// The "main" field of a package.json file, which is all that module
+// resolution looks at. Entries are kept in a process-wide cache keyed by path
+// and are revalidated against the file's mtime and size, so repeated lookups
+// of the same package cost a stat() instead of an open/read/parse cycle.
+struct PackageJSONEntry {
+  uv_timespec_t mtime;
+  uint64_t size;
+  bool has_main = false;
+  std::string main;
+};
 
+// Enough for the packages of a large application. Once it is full, an
+// arbitrary entry makes room for each new one.
+const size_t kPackageJSONCacheSize = 4096;
+Mutex package_json_cache_mutex;
+std::unordered_map<std::string, PackageJSONEntry> package_json_cache;
+
+// Reads the file at |path| into |chars| and stores the result of stat()ing
+// the opened file in |s|, so that the cache entry describes the contents that
+// were actually read. The file is read rather than mapped, as a mapping of a
+// file that is truncated at the same time would fault.
+bool ReadPackageJSON(uv_loop_t* loop,
+                     const char* path,
+                     std::vector<char>* chars,
+                     uv_stat_t* s) {
   uv_fs_t open_req;
-  const int fd = uv_fs_open(loop, &open_req, *path, O_RDONLY, 0, nullptr);
+  const int fd = uv_fs_open(loop, &open_req, path, O_RDONLY, 0, nullptr);
   uv_fs_req_cleanup(&open_req);
 
-  if (fd < 0) {
-    return;
-  }
+  if (fd < 0)
+    return false;
 
   std::shared_ptr<void> defer_close(nullptr, [fd, loop] (...) {
     uv_fs_t close_req;
@@ -674,16 +769,23 @@ static void InternalModuleReadJSON(const FunctionCallbackInfo<Value>& args) {
     uv_fs_req_cleanup(&close_req);
   });
 
+  uv_fs_t stat_req;
+  int rc = uv_fs_fstat(loop, &stat_req, fd, nullptr);
+  *s = stat_req.statbuf;
+  uv_fs_req_cleanup(&stat_req);
+
+  if (rc < 0 || (s->st_mode & S_IFMT) == S_IFDIR)
+    return false;
+
   const size_t kBlockSize = 32 << 10;
-  std::vector<char> chars;
   int64_t offset = 0;
   ssize_t numchars;
   do {
-    const size_t start = chars.size();
-    chars.resize(start + kBlockSize);
+    const size_t start = chars->size();
+    chars->resize(start + kBlockSize);
 
     uv_buf_t buf;
-    buf.base = &chars[start];
+    buf.base = &(*chars)[start];
     buf.len = kBlockSize;
 
     uv_fs_t read_req;
@@ -691,27 +793,130 @@ static void InternalModuleReadJSON(const FunctionCallbackInfo<Value>& args) {
     uv_fs_req_cleanup(&read_req);
 
     if (numchars < 0)
-      return;
+      return false;
 
     offset += numchars;
   } while (static_cast<size_t>(numchars) == kBlockSize);
 
-  size_t start = 0;
-  if (offset >= 3 && 0 == memcmp(&chars[0], "\xEF\xBB\xBF", 3)) {
-    start = 3;  // Skip UTF-8 BOM.
+  chars->resize(offset);
+  return true;
+}
+
+inline bool IsUpToDate(const PackageJSONEntry& entry, const uv_stat_t& s) {
+  return entry.size == s.st_size &&
+         entry.mtime.tv_sec == s.st_mtim.tv_sec &&
+         entry.mtime.tv_nsec == s.st_mtim.tv_nsec;
+}
+
+Local<Array> PackageJSONEntryToArray(Environment* env,
+                                     const PackageJSONEntry& entry) {
+  Isolate* isolate = env->isolate();
+  Local<Array> result = Array::New(isolate, 1);
+  if (entry.has_main) {
+    Local<String> main =
+        String::NewFromUtf8(isolate,
+                            entry.main.data(),
+                            v8::NewStringType::kNormal,
+                            entry.main.size()).ToLocalChecked();
+    result->Set(env->context(), 0, main).FromJust();
+  }
+  return result;
+}
+
+void CachePackageJSONEntry(const std::string& key, PackageJSONEntry&& entry) {
+  Mutex::ScopedLock lock(package_json_cache_mutex);
+  if (package_json_cache.size() >= kPackageJSONCacheSize &&
+      package_json_cache.find(key) == package_json_cache.end()) {
+    package_json_cache.erase(package_json_cache.begin());
+  }
+  package_json_cache[key] = std::move(entry);
+}
+
+}  // anonymous namespace
+
+// Used to speed up module loading. Returns `[main]` for the package.json file
+// at the given path, with `main` left undefined if the file has no such
+// field. Returns undefined when the file cannot be read. Returns the source
+// text when it is not valid JSON but mentions "main", so that the caller can
+// report the parse error, and undefined when it does not, as such files used
+// to be skipped without being parsed.
+static void InternalModuleReadJSON(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  uv_loop_t* loop = env->event_loop();
+
+  CHECK(args[0]->IsString());
+  node::Utf8Value path(isolate, args[0]);
+
+  if (strlen(*path) != path.length())
+    return;  // Contains a nul byte.
+
+  uv_fs_t stat_req;
+  int rc = uv_fs_stat(loop, &stat_req, *path, nullptr);
+  const uv_stat_t s = stat_req.statbuf;
+  uv_fs_req_cleanup(&stat_req);
+
+  if (rc < 0 || (s.st_mode & S_IFMT) == S_IFDIR)
+    return;
+
+  const std::string key(*path, path.length());
+  {
+    Mutex::ScopedLock lock(package_json_cache_mutex);
+    auto it = package_json_cache.find(key);
+    if (it != package_json_cache.end() && IsUpToDate(it->second, s)) {
+      args.GetReturnValue().Set(PackageJSONEntryToArray(env, it->second));
+      return;
+    }
   }
 
-  const size_t size = offset - start;
-  if (size == 0 || size == SearchString(&chars[start], size, "\"main\"")) {
+  std::vector<char> source;
+  uv_stat_t source_stat;
+  if (!ReadPackageJSON(loop, *path, &source, &source_stat))
     return;
-  } else {
-    Local<String> chars_string =
-        String::NewFromUtf8(env->isolate(),
-                            &chars[start],
-                            String::kNormalString,
-                            size);
-    args.GetReturnValue().Set(chars_string);
+
+  const char* chars = source.data();
+  size_t size = source.size();
+  if (size >= 3 && 0 == memcmp(chars, "\xEF\xBB\xBF", 3)) {
+    chars += 3;  // Skip UTF-8 BOM.
+    size -= 3;
   }
+
+  if (size == 0)
+    return;
+
+  Local<Context> context = env->context();
+  Local<String> chars_string =
+      String::NewFromUtf8(isolate,
+                          chars,
+                          v8::NewStringType::kNormal,
+                          size).ToLocalChecked();
+
+  Local<Value> json;
+  {
+    v8::TryCatch try_catch(isolate);
+    if (!v8::JSON::Parse(context, chars_string).ToLocal(&json)) {
+      if (size != SearchString(chars, size, "\"main\""))
+        args.GetReturnValue().Set(chars_string);
+      return;
+    }
+  }
+
+  PackageJSONEntry entry;
+  entry.mtime = source_stat.st_mtim;
+  entry.size = source_stat.st_size;
+
+  if (json->IsObject()) {
+    Local<Value> main;
+    if (json.As<Object>()->Get(context, env->main_string()).ToLocal(&main) &&
+        main->IsString()) {
+      node::Utf8Value main_utf8(isolate, main);
+      entry.has_main = true;
+      entry.main.assign(*main_utf8, main_utf8.length());
+    }
+  }
+
+  args.GetReturnValue().Set(PackageJSONEntryToArray(env, entry));
+  CachePackageJSONEntry(key, std::move(entry));
 }
 
 // Used to speed up module loading.  Returns 0 if the path refers to
@@ -1183,6 +1388,606 @@ static void OpenFileHandle(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// Native copy engine behind fs.copyFile() and fs.copy(). File data is moved
+// with the cheapest mechanism available: a reflink (FICLONE), then
+// copy_file_range(2), then sendfile(2), then plain read(2)/write(2). The
+// work runs on the threadpool; directory trees are first scanned by a single
+// job and the files are then copied by up to `concurrency` parallel jobs.
+// macOS and Windows defer to uv_fs_copyfile(), which already uses
+// copyfile(3) and CopyFileW() respectively.
+namespace {
+
+constexpr int kCopyFileFlags =
+    UV_FS_COPYFILE_EXCL | UV_FS_COPYFILE_FICLONE_FORCE;
+
+// Upper bound for a single copy_file_range(2)/sendfile(2) call, so that
+// progress is reported at a reasonable granularity for large files.
+constexpr size_t kCopyChunkSize = 8 * 1024 * 1024;
+constexpr size_t kCopyBufferSize = 64 * 1024;
+
+#ifdef _WIN32
+constexpr char kPathSeparator = '\\';
+#else
+constexpr char kPathSeparator = '/';
+#endif
+
+struct CopyError {
+  int err = 0;
+  const char* syscall = nullptr;
+  std::string path;
+  std::string dest;
+};
+
+inline int SetCopyError(CopyError* error,
+                        int err,
+                        const char* syscall,
+                        const std::string& path,
+                        const std::string& dest) {
+  error->err = err;
+  error->syscall = syscall;
+  error->path = path;
+  error->dest = dest;
+  return err;
+}
+
+// Shared between the threadpool jobs of one copy and the progress timer.
+struct CopyProgress {
+  void AddBytes(uint64_t bytes) {
+    Mutex::ScopedLock lock(mutex);
+    bytes_copied += bytes;
+  }
+
+  Mutex mutex;
+  uint64_t bytes_copied = 0;
+  size_t files_copied = 0;
+};
+
+#if defined(__POSIX__) && !defined(__APPLE__)
+
+#if defined(__linux__)
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+
+// Errors that mean "this mechanism does not apply to these two files",
+// as opposed to an actual I/O error.
+inline bool IsCopyFallbackError(int err) {
+  return err == ENOSYS || err == EXDEV || err == EINVAL ||
+         err == EOPNOTSUPP || err == ENOTSUP || err == EBADF ||
+         err == EPERM || err == ETXTBSY;
+}
+#endif  // defined(__linux__)
+
+// Copies the contents of srcfd into dstfd, both positioned at offset 0.
+// `size` is the size of the source file as reported by fstat(2).
+int CopyFileData(int srcfd,
+                 int dstfd,
+                 uint64_t size,
+                 int flags,
+                 CopyProgress* progress) {
+  uint64_t offset = 0;
+
+#if defined(__linux__)
+  if (ioctl(dstfd, FICLONE, srcfd) == 0) {
+    if (progress != nullptr)
+      progress->AddBytes(size);
+    return 0;
+  }
+  if (flags & UV_FS_COPYFILE_FICLONE_FORCE)
+    return -errno;
+
+  // Files like the ones in /proc report a size of 0, leave those to the
+  // read/write loop below which copies until EOF.
+  if (size != 0) {
+    // Both system calls return 0 at EOF, i.e. when the source shrunk, but
+    // also for procfs and sysfs files whose size is only nominal. Only the
+    // read/write loop can tell these apart, so 0 hands the rest of the copy
+    // over to it.
+    bool stalled = false;
+#ifdef __NR_copy_file_range
+    while (!stalled && offset < size) {
+      loff_t in_offset = offset;
+      loff_t out_offset = offset;
+      size_t len = MIN(size - offset, kCopyChunkSize);
+      ssize_t n = syscall(__NR_copy_file_range,
+                          srcfd, &in_offset, dstfd, &out_offset, len, 0);
+      if (n > 0) {
+        offset += n;
+        if (progress != nullptr)
+          progress->AddBytes(n);
+      } else if (n == 0) {
+        stalled = true;
+      } else if (errno != EINTR) {
+        if (!IsCopyFallbackError(errno))
+          return -errno;
+        break;
+      }
+    }
+#endif  // __NR_copy_file_range
+
+    // sendfile(2) writes at the current file position of dstfd.
+    if (!stalled && offset < size && lseek(dstfd, offset, SEEK_SET) == -1)
+      return -errno;
+    while (!stalled && offset < size) {
+      off_t in_offset = offset;
+      size_t len = MIN(size - offset, kCopyChunkSize);
+      ssize_t n = sendfile(dstfd, srcfd, &in_offset, len);
+      if (n > 0) {
+        offset += n;
+        if (progress != nullptr)
+          progress->AddBytes(n);
+      } else if (n == 0) {
+        stalled = true;
+      } else if (errno != EINTR) {
+        if (!IsCopyFallbackError(errno))
+          return -errno;
+        break;
+      }
+    }
+
+    if (!stalled && offset >= size)
+      return 0;
+  }
+#else
+  if (flags & UV_FS_COPYFILE_FICLONE_FORCE)
+    return UV_ENOSYS;
+#endif  // defined(__linux__)
+
+  std::unique_ptr<char[]> buffer(new char[kCopyBufferSize]);
+  for (;;) {
+    ssize_t nread = pread(srcfd, buffer.get(), kCopyBufferSize, offset);
+    if (nread == 0)
+      return 0;
+    if (nread < 0) {
+      if (errno == EINTR)
+        continue;
+      return -errno;
+    }
+    for (ssize_t written = 0; written < nread;) {
+      ssize_t n = pwrite(dstfd,
+                         buffer.get() + written,
+                         nread - written,
+                         offset + written);
+      if (n < 0) {
+        if (errno == EINTR)
+          continue;
+        return -errno;
+      }
+      written += n;
+    }
+    offset += nread;
+    if (progress != nullptr)
+      progress->AddBytes(nread);
+  }
+}
+
+#endif  // defined(__POSIX__) && !defined(__APPLE__)
+
+// Copies a single file. Safe to call from any thread. The destination is
+// created with the mode of the source and removed again if the copy fails.
+int CopyFileContents(const std::string& src,
+                     const std::string& dest,
+                     int flags,
+                     CopyProgress* progress,
+                     CopyError* error) {
+  if (flags & ~kCopyFileFlags)
+    return SetCopyError(error, UV_EINVAL, "copyfile", src, dest);
+
+  uv_fs_t req;
+#if defined(__POSIX__) && !defined(__APPLE__)
+  int srcfd = uv_fs_open(nullptr, &req, src.c_str(), O_RDONLY, 0, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (srcfd < 0)
+    return SetCopyError(error, srcfd, "copyfile", src, dest);
+
+  int err = uv_fs_fstat(nullptr, &req, srcfd, nullptr);
+  uv_stat_t src_stat = req.statbuf;
+  uv_fs_req_cleanup(&req);
+  int dstfd = -1;
+  bool regular = false;
+  if (err == 0 && S_ISDIR(src_stat.st_mode))
+    err = UV_EISDIR;
+
+  if (err == 0) {
+    int dst_flags = O_WRONLY | O_CREAT;
+    if (flags & UV_FS_COPYFILE_EXCL)
+      dst_flags |= O_EXCL;
+    dstfd = uv_fs_open(nullptr, &req, dest.c_str(), dst_flags,
+                       src_stat.st_mode, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (dstfd < 0)
+      err = dstfd;
+  }
+
+  if (err == 0) {
+    err = uv_fs_fstat(nullptr, &req, dstfd, nullptr);
+    uv_stat_t dst_stat = req.statbuf;
+    uv_fs_req_cleanup(&req);
+    regular = err == 0 && S_ISREG(dst_stat.st_mode);
+    // Copying a file onto itself must not truncate it.
+    if (err == 0 &&
+        dst_stat.st_dev == src_stat.st_dev &&
+        dst_stat.st_ino == src_stat.st_ino) {
+      regular = false;
+    } else if (regular) {
+      if (ftruncate(dstfd, 0) != 0 ||
+          fchmod(dstfd, src_stat.st_mode) != 0) {
+        err = -errno;
+      }
+      if (err == 0)
+        err = CopyFileData(srcfd, dstfd, src_stat.st_size, flags, progress);
+    } else if (err == 0) {
+      err = CopyFileData(srcfd, dstfd, src_stat.st_size, flags, progress);
+    }
+  }
+
+  uv_fs_close(nullptr, &req, srcfd, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (dstfd >= 0) {
+    int close_err = uv_fs_close(nullptr, &req, dstfd, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (err == 0)
+      err = close_err;
+    if (err != 0 && regular) {
+      uv_fs_unlink(nullptr, &req, dest.c_str(), nullptr);
+      uv_fs_req_cleanup(&req);
+    }
+  }
+
+  if (err != 0)
+    return SetCopyError(error, err, "copyfile", src, dest);
+#else
+  if (flags & UV_FS_COPYFILE_FICLONE_FORCE)
+    return SetCopyError(error, UV_ENOSYS, "copyfile", src, dest);
+  int err = uv_fs_copyfile(nullptr, &req, src.c_str(), dest.c_str(),
+                           flags, nullptr);
+  uv_fs_req_cleanup(&req);
+  if (err < 0)
+    return SetCopyError(error, err, "copyfile", src, dest);
+  if (progress != nullptr &&
+      uv_fs_stat(nullptr, &req, dest.c_str(), nullptr) == 0) {
+    progress->AddBytes(req.statbuf.st_size);
+  }
+  uv_fs_req_cleanup(&req);
+#endif  // defined(__POSIX__) && !defined(__APPLE__)
+  return 0;
+}
+
+class CopyJob {
+ public:
+  CopyJob(Environment* env,
+          FSReqBase* req_wrap,
+          const char* src,
+          const char* dest,
+          int flags,
+          bool recursive,
+          size_t concurrency)
+      : env_(env),
+        req_wrap_(req_wrap),
+        src_(src),
+        dest_(dest),
+        flags_(flags),
+        recursive_(recursive),
+        concurrency_(concurrency) {
+    // The request is completed by hand in Finish(), make sure that the
+    // uv_fs_req_cleanup() call of FSReqAfterScope finds nothing to free.
+    memset(req_wrap_->req(), 0, sizeof(*req_wrap_->req()));
+    req_wrap_->Dispatched();
+  }
+
+  // Copies a single file, like uv_fs_copyfile().
+  void StartFile() {
+    entries_.push_back({ src_, dest_ });
+    StartCopy();
+  }
+
+  // Copies a file or a directory tree.
+  void StartTree(Local<Function> onprogress, uint32_t interval) {
+    if (!onprogress.IsEmpty()) {
+      onprogress_.Reset(env_->isolate(), onprogress);
+      interval_ = interval;
+    }
+    scan_req_.data = this;
+    int err = uv_queue_work(env_->event_loop(), &scan_req_, ScanWork,
+                            AfterScan);
+    CHECK_EQ(err, 0);
+  }
+
+ private:
+  struct Entry {
+    std::string src;
+    std::string dest;
+  };
+
+  struct Worker {
+    uv_work_t req;
+    CopyJob* job;
+    // The entry that is being copied.
+    size_t index;
+  };
+
+  ~CopyJob() {
+    CHECK_EQ(req_wrap_, nullptr);
+  }
+
+  // Records the first error. Called from the threadpool.
+  void Fail(const CopyError& error) {
+    Mutex::ScopedLock lock(mutex_);
+    if (error_.err == 0)
+      error_ = error;
+  }
+
+  bool failed() {
+    Mutex::ScopedLock lock(mutex_);
+    return error_.err != 0;
+  }
+
+  static void ScanWork(uv_work_t* req) {
+    CopyJob* job = static_cast<CopyJob*>(req->data);
+    CopyError error;
+    if (job->Scan(&error) != 0)
+      job->Fail(error);
+  }
+
+  static void AfterScan(uv_work_t* req, int status) {
+    CopyJob* job = static_cast<CopyJob*>(req->data);
+    CHECK_EQ(status, 0);
+    if (job->error_.err != 0 || job->entries_.empty())
+      return job->Finish();
+    if (!job->onprogress_.IsEmpty()) {
+      uv_timer_init(job->env_->event_loop(), &job->timer_);
+      job->timer_.data = job;
+      uv_timer_start(&job->timer_, OnProgressTimer,
+                     job->interval_, job->interval_);
+      uv_unref(reinterpret_cast<uv_handle_t*>(&job->timer_));
+      job->has_timer_ = true;
+    }
+    job->StartCopy();
+  }
+
+  // Creates the destination directories and symbolic links and collects
+  // the files that need to be copied. Runs on the threadpool.
+  int Scan(CopyError* error) {
+    uv_fs_t req;
+    int err = uv_fs_stat(nullptr, &req, src_.c_str(), nullptr);
+    uv_stat_t stat = req.statbuf;
+    uv_fs_req_cleanup(&req);
+    if (err < 0)
+      return SetCopyError(error, err, "copyfile", src_, dest_);
+
+    if (!S_ISDIR(stat.st_mode)) {
+      entries_.push_back({ src_, dest_ });
+      total_bytes_ = stat.st_size;
+      return 0;
+    }
+    if (!recursive_)
+      return SetCopyError(error, UV_EISDIR, "copyfile", src_, dest_);
+
+    std::vector<std::pair<Entry, int>> directories;
+    directories.push_back({ { src_, dest_ }, static_cast<int>(stat.st_mode) });
+    while (!directories.empty()) {
+      Entry dir = directories.back().first;
+      int mode = directories.back().second;
+      directories.pop_back();
+
+      // Keep the directory writable so that its contents can be copied.
+      err = uv_fs_mkdir(nullptr, &req, dir.dest.c_str(),
+                        (mode & 0777) | 0700, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (err == UV_EEXIST && !(flags_ & UV_FS_COPYFILE_EXCL)) {
+        err = uv_fs_stat(nullptr, &req, dir.dest.c_str(), nullptr);
+        if (err == 0 && !S_ISDIR(req.statbuf.st_mode))
+          err = UV_EEXIST;
+        uv_fs_req_cleanup(&req);
+      }
+      if (err < 0)
+        return SetCopyError(error, err, "mkdir", dir.dest, "");
+
+      err = uv_fs_scandir(nullptr, &req, dir.src.c_str(), 0, nullptr);
+      if (err < 0) {
+        uv_fs_req_cleanup(&req);
+        return SetCopyError(error, err, "scandir", dir.src, "");
+      }
+      uv_dirent_t ent;
+      while (err >= 0 && uv_fs_scandir_next(&req, &ent) != UV_EOF)
+        err = ScanEntry(dir, ent.name, &directories, error);
+      uv_fs_req_cleanup(&req);
+      if (err < 0)
+        return err;
+    }
+    return 0;
+  }
+
+  int ScanEntry(const Entry& dir,
+                const char* name,
+                std::vector<std::pair<Entry, int>>* directories,
+                CopyError* error) {
+    Entry entry { dir.src + kPathSeparator + name,
+                  dir.dest + kPathSeparator + name };
+    uv_fs_t req;
+    int err = uv_fs_lstat(nullptr, &req, entry.src.c_str(), nullptr);
+    uv_stat_t stat = req.statbuf;
+    uv_fs_req_cleanup(&req);
+    if (err < 0)
+      return SetCopyError(error, err, "lstat", entry.src, "");
+
+    if (S_ISDIR(stat.st_mode)) {
+      directories->push_back({ entry, static_cast<int>(stat.st_mode) });
+    } else if (S_ISREG(stat.st_mode)) {
+      total_bytes_ += stat.st_size;
+      entries_.push_back(entry);
+    } else if (S_ISLNK(stat.st_mode)) {
+      err = uv_fs_readlink(nullptr, &req, entry.src.c_str(), nullptr);
+      if (err < 0) {
+        uv_fs_req_cleanup(&req);
+        return SetCopyError(error, err, "readlink", entry.src, "");
+      }
+      std::string target(static_cast<const char*>(req.ptr));
+      uv_fs_req_cleanup(&req);
+      err = uv_fs_symlink(nullptr, &req, target.c_str(), entry.dest.c_str(),
+                          0, nullptr);
+      uv_fs_req_cleanup(&req);
+      if (err == UV_EEXIST && !(flags_ & UV_FS_COPYFILE_EXCL)) {
+        uv_fs_unlink(nullptr, &req, entry.dest.c_str(), nullptr);
+        uv_fs_req_cleanup(&req);
+        err = uv_fs_symlink(nullptr, &req, target.c_str(),
+                            entry.dest.c_str(), 0, nullptr);
+        uv_fs_req_cleanup(&req);
+      }
+      if (err < 0)
+        return SetCopyError(error, err, "symlink", target, entry.dest);
+    } else {
+      // Sockets, FIFOs and device files are not copied.
+      return SetCopyError(error, UV_ENOTSUP, "copyfile", entry.src,
+                          entry.dest);
+    }
+    return 0;
+  }
+
+  // Up to concurrency_ files are copied at a time. Every file is a
+  // threadpool request of its own, so that other requests get their turn
+  // between files rather than waiting for the whole tree to be copied.
+  void StartCopy() {
+    size_t count = MIN(concurrency_, entries_.size());
+    workers_.reset(new Worker[count]);
+    for (size_t i = 0; i < count; i++) {
+      workers_[i].job = this;
+      workers_[i].req.data = &workers_[i];
+      QueueNextFile(&workers_[i]);
+    }
+  }
+
+  // Returns false if there is nothing left to copy.
+  bool QueueNextFile(Worker* worker) {
+    if (failed() || next_entry_ == entries_.size())
+      return false;
+    worker->index = next_entry_++;
+    pending_workers_++;
+    int err = uv_queue_work(env_->event_loop(), &worker->req, CopyWork,
+                            AfterCopy);
+    CHECK_EQ(err, 0);
+    return true;
+  }
+
+  static void CopyWork(uv_work_t* req) {
+    Worker* worker = static_cast<Worker*>(req->data);
+    CopyJob* job = worker->job;
+    const Entry& entry = job->entries_[worker->index];
+    CopyError error;
+    if (CopyFileContents(entry.src, entry.dest, job->flags_,
+                         &job->progress_, &error) != 0) {
+      return job->Fail(error);
+    }
+    Mutex::ScopedLock lock(job->progress_.mutex);
+    job->progress_.files_copied++;
+  }
+
+  static void AfterCopy(uv_work_t* req, int status) {
+    Worker* worker = static_cast<Worker*>(req->data);
+    CopyJob* job = worker->job;
+    CHECK_EQ(status, 0);
+    job->pending_workers_--;
+    if (!job->QueueNextFile(worker) && job->pending_workers_ == 0)
+      job->Finish();
+  }
+
+  static void OnProgressTimer(uv_timer_t* handle) {
+    CopyJob* job = static_cast<CopyJob*>(handle->data);
+    HandleScope handle_scope(job->env_->isolate());
+    Context::Scope context_scope(job->env_->context());
+    job->EmitProgress(false);
+  }
+
+  void EmitProgress(bool force) {
+    uint64_t bytes_copied;
+    size_t files_copied;
+    {
+      Mutex::ScopedLock lock(progress_.mutex);
+      bytes_copied = progress_.bytes_copied;
+      files_copied = progress_.files_copied;
+    }
+    if (!force &&
+        bytes_copied == last_bytes_copied_ &&
+        files_copied == last_files_copied_) {
+      return;
+    }
+    last_bytes_copied_ = bytes_copied;
+    last_files_copied_ = files_copied;
+
+    Isolate* isolate = env_->isolate();
+    Local<Value> argv[] = {
+      Number::New(isolate, static_cast<double>(bytes_copied)),
+      Number::New(isolate, static_cast<double>(total_bytes_)),
+      Number::New(isolate, static_cast<double>(files_copied)),
+      Number::New(isolate, static_cast<double>(entries_.size()))
+    };
+    req_wrap_->MakeCallback(PersistentToLocal(isolate, onprogress_),
+                            arraysize(argv), argv);
+  }
+
+  void Finish() {
+    HandleScope handle_scope(env_->isolate());
+    Context::Scope context_scope(env_->context());
+
+    if (has_timer_) {
+      uv_close(reinterpret_cast<uv_handle_t*>(&timer_), OnTimerClose);
+      if (error_.err == 0)
+        EmitProgress(true);
+    }
+
+    uv_fs_t* req = req_wrap_->req();
+    req->result = error_.err;
+    if (error_.err != 0) {
+      req_wrap_->Init(error_.syscall,
+                      error_.dest.empty() ? nullptr : error_.dest.c_str(),
+                      error_.dest.size());
+      req->path = error_.path.c_str();
+    }
+    {
+      FSReqAfterScope after(req_wrap_, req);
+      if (after.Proceed())
+        req_wrap_->Resolve(Undefined(env_->isolate()));
+    }
+    req_wrap_ = nullptr;
+
+    if (!has_timer_)
+      delete this;
+  }
+
+  static void OnTimerClose(uv_handle_t* handle) {
+    delete static_cast<CopyJob*>(handle->data);
+  }
+
+  Environment* const env_;
+  FSReqBase* req_wrap_;
+  const std::string src_;
+  const std::string dest_;
+  const int flags_;
+  const bool recursive_;
+  const size_t concurrency_;
+
+  uv_work_t scan_req_;
+  std::vector<Entry> entries_;
+  uint64_t total_bytes_ = 0;
+
+  std::unique_ptr<Worker[]> workers_;
+  size_t pending_workers_ = 0;
+  size_t next_entry_ = 0;
+
+  Mutex mutex_;
+  CopyError error_;
+  CopyProgress progress_;
+
+  Persistent<Function> onprogress_;
+  uint32_t interval_ = 0;
+  uv_timer_t timer_;
+  bool has_timer_ = false;
+  uint64_t last_bytes_copied_ = 0;
+  size_t last_files_copied_ = 0;
+};
+
+}  // anonymous namespace
+
 static void CopyFile(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -1197,13 +2002,53 @@ static void CopyFile(const FunctionCallbackInfo<Value>& args) {
 
   FSReqBase* req_wrap = GetReqWrap(env, args[3]);
   if (req_wrap != nullptr) {
-    AsyncCall(env, req_wrap, args, "copyfile", UTF8, AfterNoArgs,
-              uv_fs_copyfile, *src, *dest, flags);
+    CopyJob* job = new CopyJob(env, req_wrap, *src, *dest, flags, false, 1);
+    job->StartFile();
+    req_wrap->SetReturnValue(args);
   } else {
-    SYNC_DEST_CALL(copyfile, *src, *dest, *src, *dest, flags)
+    env->PrintSyncTrace();
+    CopyError error;
+    if (CopyFileContents(*src, *dest, flags, nullptr, &error) != 0) {
+      return env->ThrowUVException(
+          error.err, error.syscall, nullptr, error.path.c_str(),
+          error.dest.empty() ? nullptr : error.dest.c_str());
+    }
   }
 }
 
+// copyTree(src, dest, flags, recursive, concurrency, interval, onprogress,
+//          req)
+static void CopyTree(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK_GE(args.Length(), 8);
+  CHECK(args[2]->IsInt32());
+  CHECK(args[4]->IsUint32());
+  CHECK(args[5]->IsUint32());
+
+  BufferValue src(env->isolate(), args[0]);
+  CHECK_NE(*src, nullptr);
+  BufferValue dest(env->isolate(), args[1]);
+  CHECK_NE(*dest, nullptr);
+  int flags = args[2].As<Int32>()->Value();
+  bool recursive = args[3]->IsTrue();
+  // 0 selects the default, one file per thread of the threadpool.
+  size_t concurrency = args[4]->Uint32Value();
+  if (concurrency == 0)
+    concurrency = ThreadpoolSize();
+  uint32_t interval = args[5]->Uint32Value();
+  Local<Function> onprogress;
+  if (args[6]->IsFunction())
+    onprogress = args[6].As<Function>();
+
+  FSReqBase* req_wrap = GetReqWrap(env, args[7]);
+  CHECK_NE(req_wrap, nullptr);
+  CopyJob* job = new CopyJob(env, req_wrap, *src, *dest, flags, recursive,
+                             concurrency);
+  job->StartTree(onprogress, interval);
+  req_wrap->SetReturnValue(args);
+}
+
 
 // Wrapper for write(2).
 //
@@ -1239,6 +2084,7 @@ static void WriteBuffer(const FunctionCallbackInfo<Value>& args) {
 
   FSReqBase* req_wrap = GetReqWrap(env, args[5]);
   if (req_wrap != nullptr) {
+    req_wrap->PinBuffer(buf);
     AsyncCall(env, req_wrap, args, "write", UTF8, AfterInteger,
               uv_fs_write, fd, &uvbuf, 1, pos);
     return;
@@ -1276,6 +2122,8 @@ static void WriteBuffers(const FunctionCallbackInfo<Value>& args) {
 
   FSReqBase* req_wrap = GetReqWrap(env, args[3]);
   if (req_wrap != nullptr) {
+    for (uint32_t i = 0; i < iovs.length(); i++)
+      req_wrap->PinBuffer(iovs[i].base);
     AsyncCall(env, req_wrap, args, "write", UTF8, AfterInteger,
               uv_fs_write, fd, *iovs, iovs.length(), pos);
     return;
@@ -1398,6 +2246,7 @@ static void Read(const FunctionCallbackInfo<Value>& args) {
 
   FSReqBase* req_wrap = GetReqWrap(env, args[5]);
   if (req_wrap != nullptr) {
+    req_wrap->PinBuffer(buf);
     AsyncCall(env, req_wrap, args, "read", UTF8, AfterInteger,
               uv_fs_read, fd, &uvbuf, 1, pos);
   } else {
@@ -1607,6 +2456,7 @@ void InitFs(Local<Object> target,
   env->SetMethod(target, "writeString", WriteString);
   env->SetMethod(target, "realpath", RealPath);
   env->SetMethod(target, "copyFile", CopyFile);
+  env->SetMethod(target, "copyTree", CopyTree);
 
   env->SetMethod(target, "chmod", Chmod);
   env->SetMethod(target, "fchmod", FChmod);
@@ -1636,6 +2486,13 @@ void InitFs(Local<Object> target,
       FIXED_ONE_BYTE_STRING(env->isolate(), "FSReqWrap");
   fst->SetClassName(wrapString);
   target->Set(context, wrapString, fst->GetFunction()).FromJust();
+  env->set_fsreqwrap_constructor_template(fst->InstanceTemplate());
+
+  FSReqWrapPool* pool = new FSReqWrapPool(env);
+  env->set_fs_req_wrap_pool(pool);
+  env->AtExit([](void* arg) {
+    delete static_cast<FSReqWrapPool*>(arg);
+  }, pool);
 
   // Create Function Template for FSReqPromise
   Local<FunctionTemplate> fpt = FunctionTemplate::New(env->isolate());
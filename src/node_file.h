@@ -4,11 +4,15 @@
 #if defined(NODE_WANT_INTERNALS) && NODE_WANT_INTERNALS
 
 #include "node.h"
+#include "node_buffer_allocator.h"
 #include "req_wrap-inl.h"
 
+#include <vector>
+
 namespace node {
 
 using v8::Context;
+using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::HandleScope;
 using v8::Local;
@@ -20,6 +24,8 @@ using v8::Value;
 
 namespace fs {
 
+class FSReqWrapPool;
+
 class FSReqBase : public ReqWrap<uv_fs_t> {
  public:
   FSReqBase(Environment* env, Local<Object> req, AsyncWrap::ProviderType type)
@@ -47,12 +53,35 @@ class FSReqBase : public ReqWrap<uv_fs_t> {
     }
   }
 
+  // Drops the per-request state so that the instance can be handed out
+  // again by a pool.
+  void Reset() {
+    syscall_ = nullptr;
+    encoding_ = UTF8;
+    data_ = nullptr;
+    pins_.Clear();
+  }
+
+  // Keeps Buffer.pool memory that the request reads or writes from being
+  // recycled by Buffer.pool.release() before the request is done.
+  void PinBuffer(const void* data) {
+    pins_.Pin(env()->isolate_data()->size_classes(), data);
+  }
+
+  // Called once the threadpool is done with the request, before the JS
+  // callback runs, so that the callback already sees the memory recycled.
+  void UnpinBuffers() { pins_.Clear(); }
+
   virtual void FillStatsArray(const uv_stat_t* stat) = 0;
   virtual void Reject(Local<Value> reject) = 0;
   virtual void Resolve(Local<Value> value) = 0;
   virtual void ResolveStat() = 0;
   virtual void SetReturnValue(const FunctionCallbackInfo<Value>& args) = 0;
 
+  // Non-null when the request was created on behalf of a plain JS callback
+  // and should be handed back to the pool instead of being deleted.
+  virtual FSReqWrapPool* pool() const { return nullptr; }
+
   const char* syscall() const { return syscall_; }
   const char* data() const { return data_; }
   enum encoding encoding() const { return encoding_; }
@@ -65,14 +94,17 @@ class FSReqBase : public ReqWrap<uv_fs_t> {
 
   const char* data_ = nullptr;
   MaybeStackBuffer<char> buffer_;
+  PooledBufferPins pins_;
 
   DISALLOW_COPY_AND_ASSIGN(FSReqBase);
 };
 
 class FSReqWrap : public FSReqBase {
  public:
-  FSReqWrap(Environment* env, Local<Object> req)
-      : FSReqBase(env, req, AsyncWrap::PROVIDER_FSREQWRAP) { }
+  FSReqWrap(Environment* env,
+            Local<Object> req,
+            FSReqWrapPool* pool = nullptr)
+      : FSReqBase(env, req, AsyncWrap::PROVIDER_FSREQWRAP), pool_(pool) { }
 
   void FillStatsArray(const uv_stat_t* stat) override;
   void Reject(Local<Value> reject) override;
@@ -80,10 +112,44 @@ class FSReqWrap : public FSReqBase {
   void ResolveStat() override;
   void SetReturnValue(const FunctionCallbackInfo<Value>& args) override;
 
+  FSReqWrapPool* pool() const override { return pool_; }
+
+  size_t self_size() const override { return sizeof(*this); }
+
  private:
+  friend class FSReqWrapPool;
+
+  void CallOnComplete(int argc, Local<Value>* argv);
+
+  FSReqWrapPool* const pool_;
+  // Set for pooled requests only. Other requests look up `oncomplete` on
+  // the JS object instead.
+  Persistent<Function> callback_;
+
   DISALLOW_COPY_AND_ASSIGN(FSReqWrap);
 };
 
+// Keeps a bounded number of idle FSReqWrap instances around for async calls
+// that pass a plain callback function instead of a FSReqWrap object. This
+// saves the JS object, the native wrap and the uv_fs_t allocation on hot
+// paths like fs.stat() and fs.access().
+class FSReqWrapPool {
+ public:
+  explicit FSReqWrapPool(Environment* env) : env_(env) {}
+  ~FSReqWrapPool();
+
+  FSReqWrap* Acquire(Local<Function> oncomplete);
+  void Release(FSReqWrap* req_wrap);
+
+  static const size_t kMaximumLength = 128;
+
+ private:
+  Environment* const env_;
+  std::vector<FSReqWrap*> free_;
+
+  DISALLOW_COPY_AND_ASSIGN(FSReqWrapPool);
+};
+
 class FSReqPromise : public FSReqBase {
  public:
   explicit FSReqPromise(Environment* env);
@@ -66,6 +66,10 @@
 #include <unicode/uversion.h>
 #include <unicode/ustring.h>
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #ifdef NODE_HAVE_SMALL_ICU
 /* if this is defined, we have a 'secondary' entry point.
    compare following to utypes.h defs for U_ICUDATA_ENTRY_POINT */
@@ -83,6 +87,7 @@ extern "C" const char U_DATA_API SMALL_ICUDATA_ENTRY_POINT[];
 
 namespace node {
 
+using v8::Array;
 using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::HandleScope;
@@ -95,6 +100,86 @@ using v8::String;
 using v8::Value;
 
 namespace i18n {
+
+// Opening a UConverter means looking up the converter by name and, for
+// table based encodings, loading its conversion tables, which is the bulk of
+// the cost of transcoding short inputs. Converters that are no longer in use
+// are kept here, keyed by encoding name and configuration, and handed out
+// again after a ucnv_reset().
+class ConverterCache {
+ public:
+  ConverterCache() {}
+
+  ~ConverterCache() {
+    for (auto& entry : idle_) {
+      for (UConverter* conv : entry.second)
+        ucnv_close(conv);
+    }
+  }
+
+  static std::string Key(const char* name, const char* sub, bool fatal) {
+    std::string key(name);
+    key += fatal ? "\n1" : "\n0";
+    if (sub != nullptr)
+      key += sub;
+    return key;
+  }
+
+  // Returns nullptr and sets |status| if no converter exists for |name|.
+  UConverter* Acquire(const std::string& key,
+                      const char* name,
+                      const char* sub,
+                      bool fatal,
+                      UErrorCode* status) {
+    auto it = idle_.find(key);
+    if (it != idle_.end() && !it->second.empty()) {
+      UConverter* conv = it->second.back();
+      it->second.pop_back();
+      idle_count_--;
+      ucnv_reset(conv);
+      return conv;
+    }
+
+    UConverter* conv = ucnv_open(name, status);
+    if (U_FAILURE(*status))
+      return nullptr;
+    if (sub != nullptr)
+      ucnv_setSubstChars(conv, sub, strlen(sub), status);
+    if (fatal) {
+      ucnv_setToUCallBack(conv, UCNV_TO_U_CALLBACK_STOP,
+                          nullptr, nullptr, nullptr, status);
+    }
+    if (U_FAILURE(*status)) {
+      ucnv_close(conv);
+      return nullptr;
+    }
+    return conv;
+  }
+
+  void Release(const std::string& key, UConverter* conv) {
+    if (idle_count_ >= kMaxIdle) {
+      ucnv_close(conv);
+      return;
+    }
+    std::vector<UConverter*>& list = idle_[key];
+    if (list.size() >= kMaxIdlePerKey) {
+      ucnv_close(conv);
+      return;
+    }
+    list.push_back(conv);
+    idle_count_++;
+  }
+
+ private:
+  static const size_t kMaxIdle = 64;
+  static const size_t kMaxIdlePerKey = 4;
+
+  std::unordered_map<std::string, std::vector<UConverter*>> idle_;
+  size_t idle_count_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(ConverterCache);
+};
+
 namespace {
 
 template <typename T>
@@ -113,30 +198,36 @@ MaybeLocal<Object> ToBufferEndian(Environment* env, MaybeStackBuffer<T>* buf) {
   return ret;
 }
 
+// A converter borrowed from the Environment's ConverterCache for the lifetime
+// of this object.
 struct Converter {
-  explicit Converter(const char* name, const char* sub = nullptr)
-      : conv(nullptr) {
+  Converter(Environment* env,
+            const char* name,
+            const char* sub = nullptr,
+            bool fatal = false)
+      : env(env), key(ConverterCache::Key(name, sub, fatal)) {
     UErrorCode status = U_ZERO_ERROR;
-    conv = ucnv_open(name, &status);
+    conv = env->i18n_converter_cache()->Acquire(key, name, sub, fatal, &status);
     CHECK(U_SUCCESS(status));
-    if (sub != nullptr) {
-      ucnv_setSubstChars(conv, sub, strlen(sub), &status);
-    }
   }
 
-  explicit Converter(UConverter* converter,
-                     const char* sub = nullptr) : conv(converter) {
+  Converter(Environment* env, UConverter* converter, const std::string& key)
+      : env(env), key(key), conv(converter) {
     CHECK_NE(conv, nullptr);
-    UErrorCode status = U_ZERO_ERROR;
-    if (sub != nullptr) {
-      ucnv_setSubstChars(conv, sub, strlen(sub), &status);
-    }
   }
 
   ~Converter() {
-    ucnv_close(conv);
+    // Garbage collected ConverterObjects may be destroyed after the cache has
+    // been freed at exit.
+    ConverterCache* cache = env->i18n_converter_cache();
+    if (cache != nullptr)
+      cache->Release(key, conv);
+    else
+      ucnv_close(conv);
   }
 
+  Environment* env;
+  const std::string key;
   UConverter* conv;
 };
 
@@ -157,10 +248,15 @@ class ConverterObject : public BaseObject, Converter {
     CHECK_GE(args.Length(), 1);
     Utf8Value label(env->isolate(), args[0]);
 
+    // A successfully opened converter is kept in the cache, where the
+    // getConverter() call that usually follows picks it up again.
+    ConverterCache* cache = env->i18n_converter_cache();
+    const std::string key = ConverterCache::Key(*label, nullptr, false);
     UErrorCode status = U_ZERO_ERROR;
-    UConverter* conv = ucnv_open(*label, &status);
+    UConverter* conv = cache->Acquire(key, *label, nullptr, false, &status);
     args.GetReturnValue().Set(!!U_SUCCESS(status));
-    ucnv_close(conv);
+    if (conv != nullptr)
+      cache->Release(key, conv);
   }
 
   static void Create(const FunctionCallbackInfo<Value>& args) {
@@ -175,21 +271,17 @@ class ConverterObject : public BaseObject, Converter {
     bool ignoreBOM =
         (flags & CONVERTER_FLAGS_IGNORE_BOM) == CONVERTER_FLAGS_IGNORE_BOM;
 
+    const std::string key = ConverterCache::Key(*label, nullptr, fatal);
     UErrorCode status = U_ZERO_ERROR;
-    UConverter* conv = ucnv_open(*label, &status);
-    if (U_FAILURE(status))
+    UConverter* conv = env->i18n_converter_cache()->Acquire(
+        key, *label, nullptr, fatal, &status);
+    if (conv == nullptr)
       return;
 
-    if (fatal) {
-      status = U_ZERO_ERROR;
-      ucnv_setToUCallBack(conv, UCNV_TO_U_CALLBACK_STOP,
-                          nullptr, nullptr, nullptr, &status);
-    }
-
     Local<ObjectTemplate> t = ObjectTemplate::New(env->isolate());
     t->SetInternalFieldCount(1);
     Local<Object> obj = t->NewInstance(env->context()).ToLocalChecked();
-    new ConverterObject(env, obj, conv, ignoreBOM);
+    new ConverterObject(env, obj, conv, key, ignoreBOM);
     args.GetReturnValue().Set(obj);
   }
 
@@ -198,7 +290,6 @@ class ConverterObject : public BaseObject, Converter {
 
     CHECK_GE(args.Length(), 3);  // Converter, Buffer, Flags
 
-    Converter utf8("utf8");
     ConverterObject* converter;
     ASSIGN_OR_RETURN_UNWRAP(&converter, args[0].As<Object>());
     SPREAD_BUFFER_ARG(args[1], input_obj);
@@ -253,10 +344,10 @@ class ConverterObject : public BaseObject, Converter {
   ConverterObject(Environment* env,
                   v8::Local<v8::Object> wrap,
                   UConverter* converter,
-                  bool ignoreBOM,
-                  const char* sub = nullptr) :
+                  const std::string& key,
+                  bool ignoreBOM) :
                   BaseObject(env, wrap),
-                  Converter(converter, sub),
+                  Converter(env, converter, key),
                   ignoreBOM_(ignoreBOM) {
     MakeWeak<ConverterObject>(this);
 
@@ -307,8 +398,8 @@ MaybeLocal<Object> Transcode(Environment* env,
   *status = U_ZERO_ERROR;
   MaybeLocal<Object> ret;
   MaybeStackBuffer<char> result;
-  Converter to(toEncoding, "?");
-  Converter from(fromEncoding);
+  Converter to(env, toEncoding, "?");
+  Converter from(env, fromEncoding);
   const uint32_t limit = source_length * ucnv_getMaxCharSize(to.conv);
   result.AllocateSufficientStorage(limit);
   char* target = *result;
@@ -331,7 +422,7 @@ MaybeLocal<Object> TranscodeToUcs2(Environment* env,
   *status = U_ZERO_ERROR;
   MaybeLocal<Object> ret;
   MaybeStackBuffer<UChar> destbuf(source_length);
-  Converter from(fromEncoding);
+  Converter from(env, fromEncoding);
   const size_t length_in_chars = source_length * sizeof(UChar);
   ucnv_toUChars(from.conv, *destbuf, length_in_chars,
                 source, source_length, status);
@@ -349,7 +440,7 @@ MaybeLocal<Object> TranscodeFromUcs2(Environment* env,
   *status = U_ZERO_ERROR;
   MaybeStackBuffer<UChar> sourcebuf;
   MaybeLocal<Object> ret;
-  Converter to(toEncoding, "?");
+  Converter to(env, toEncoding, "?");
   const size_t length_in_chars = source_length / sizeof(UChar);
   CopySourceBuffer(&sourcebuf, source, source_length, length_in_chars);
   MaybeStackBuffer<char> destbuf(length_in_chars);
@@ -441,6 +532,34 @@ bool SupportedEncoding(const enum encoding encoding) {
   }
 }
 
+TranscodeFunc SelectTranscodeFunc(const enum encoding fromEncoding,
+                                  const enum encoding toEncoding) {
+  switch (fromEncoding) {
+    case ASCII:
+    case LATIN1:
+      if (toEncoding == UCS2)
+        return &TranscodeToUcs2;
+      break;
+    case UTF8:
+      if (toEncoding == UCS2)
+        return &TranscodeUcs2FromUtf8;
+      break;
+    case UCS2:
+      switch (toEncoding) {
+        case UCS2:
+          return &Transcode;
+        case UTF8:
+          return &TranscodeUtf8FromUcs2;
+        default:
+          return &TranscodeFromUcs2;
+      }
+    default:
+      // This should not happen because of the SupportedEncoding checks
+      ABORT();
+  }
+  return &Transcode;
+}
+
 void Transcode(const FunctionCallbackInfo<Value>&args) {
   Environment* env = Environment::GetCurrent(args);
   Isolate* isolate = env->isolate();
@@ -453,34 +572,7 @@ void Transcode(const FunctionCallbackInfo<Value>&args) {
   const enum encoding toEncoding = ParseEncoding(isolate, args[2], BUFFER);
 
   if (SupportedEncoding(fromEncoding) && SupportedEncoding(toEncoding)) {
-    TranscodeFunc tfn = &Transcode;
-    switch (fromEncoding) {
-      case ASCII:
-      case LATIN1:
-        if (toEncoding == UCS2)
-          tfn = &TranscodeToUcs2;
-        break;
-      case UTF8:
-        if (toEncoding == UCS2)
-          tfn = &TranscodeUcs2FromUtf8;
-        break;
-      case UCS2:
-        switch (toEncoding) {
-          case UCS2:
-            tfn = &Transcode;
-            break;
-          case UTF8:
-            tfn = &TranscodeUtf8FromUcs2;
-            break;
-          default:
-            tfn = &TranscodeFromUcs2;
-        }
-        break;
-      default:
-        // This should not happen because of the SupportedEncoding checks
-        ABORT();
-    }
-
+    TranscodeFunc tfn = SelectTranscodeFunc(fromEncoding, toEncoding);
     result = tfn(env, EncodingName(fromEncoding), EncodingName(toEncoding),
                  ts_obj_data, ts_obj_length, &status);
   } else {
@@ -493,6 +585,54 @@ void Transcode(const FunctionCallbackInfo<Value>&args) {
   return args.GetReturnValue().Set(result.ToLocalChecked());
 }
 
+// transcodeMany(sources, fromEncoding, toEncoding) transcodes every Buffer in
+// the sources array and returns an array of the results, or the ICU error
+// code of the first conversion that fails. The elements are checked again
+// here, as getters on the array may return something else than the values
+// that were validated in JS.
+void TranscodeMany(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+
+  CHECK(args[0]->IsArray());
+  Local<Array> sources = args[0].As<Array>();
+  const enum encoding fromEncoding = ParseEncoding(isolate, args[1], BUFFER);
+  const enum encoding toEncoding = ParseEncoding(isolate, args[2], BUFFER);
+  if (!SupportedEncoding(fromEncoding) || !SupportedEncoding(toEncoding))
+    return args.GetReturnValue().Set(U_ILLEGAL_ARGUMENT_ERROR);
+
+  TranscodeFunc tfn = SelectTranscodeFunc(fromEncoding, toEncoding);
+  const char* fromName = EncodingName(fromEncoding);
+  const char* toName = EncodingName(toEncoding);
+  const uint32_t length = sources->Length();
+  Local<Array> results = Array::New(isolate, length);
+  for (uint32_t i = 0; i < length; i++) {
+    Local<Value> source;
+    if (!sources->Get(context, i).ToLocal(&source))
+      return;
+    if (!Buffer::HasInstance(source))
+      return args.GetReturnValue().Set(U_ILLEGAL_ARGUMENT_ERROR);
+    SPREAD_BUFFER_ARG(source, ts_obj);
+
+    MaybeLocal<Object> result;
+    UErrorCode status = U_ZERO_ERROR;
+    if (ts_obj_length == 0) {
+      result = Buffer::New(env, static_cast<size_t>(0));
+    } else {
+      result = tfn(env, fromName, toName, ts_obj_data, ts_obj_length, &status);
+    }
+    if (result.IsEmpty()) {
+      if (U_SUCCESS(status))  // Buffer allocation failed.
+        status = U_MEMORY_ALLOCATION_ERROR;
+      return args.GetReturnValue().Set(status);
+    }
+    if (results->Set(context, i, result.ToLocalChecked()).IsNothing())
+      return;
+  }
+  args.GetReturnValue().Set(results);
+}
+
 void ICUErrorName(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   UErrorCode status = static_cast<UErrorCode>(args[0]->Int32Value());
@@ -857,6 +997,14 @@ void Init(Local<Object> target,
           Local<Context> context,
           void* priv) {
   Environment* env = Environment::GetCurrent(context);
+
+  env->set_i18n_converter_cache(new ConverterCache());
+  env->AtExit([](void* arg) {
+    Environment* env = static_cast<Environment*>(arg);
+    delete env->i18n_converter_cache();
+    env->set_i18n_converter_cache(nullptr);
+  }, env);
+
   env->SetMethod(target, "toUnicode", ToUnicode);
   env->SetMethod(target, "toASCII", ToASCII);
   env->SetMethod(target, "getStringWidth", GetStringWidth);
@@ -865,6 +1013,7 @@ void Init(Local<Object> target,
   // One-shot converters
   env->SetMethod(target, "icuErrName", ICUErrorName);
   env->SetMethod(target, "transcode", Transcode);
+  env->SetMethod(target, "transcodeMany", TranscodeMany);
 
   // ConverterObject
   env->SetMethod(target, "getConverter", ConverterObject::Create);
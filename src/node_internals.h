@@ -33,6 +33,7 @@
 #include "tracing/trace_event.h"
 #include "node_perf_common.h"
 #include "node_debug_options.h"
+#include "node_buffer_allocator.h"
 
 #include <stdint.h>
 #include <stdlib.h>
@@ -102,6 +103,7 @@ struct sockaddr;
 #define NODE_BUILTIN_STANDARD_MODULES(V)                                      \
     V(async_wrap)                                                             \
     V(buffer)                                                                 \
+    V(buffer_cursor)                                                          \
     V(cares_wrap)                                                             \
     V(config)                                                                 \
     V(contextify)                                                             \
@@ -118,6 +120,7 @@ struct sockaddr;
     V(pipe_wrap)                                                              \
     V(process_wrap)                                                           \
     V(promise_context)                                                        \
+    V(querystring)                                                            \
     V(serdes)                                                                 \
     V(signal_wrap)                                                            \
     V(spawn_sync)                                                             \
@@ -259,6 +262,11 @@ void RegisterSignalHandler(int signal,
 
 bool SafeGetenv(const char* key, std::string* text);
 
+// The number of threads in libuv's threadpool. Mirrors how libuv sizes the
+// pool from UV_THREADPOOL_SIZE; the variable is read on the first call only,
+// much like libuv reads it when the first request is queued.
+size_t ThreadpoolSize();
+
 std::string GetHumanReadableProcessName();
 void GetHumanReadableProcessName(char (*name)[1024]);
 
@@ -343,14 +351,16 @@ inline bool IsBigEndian() {
 class ArrayBufferAllocator : public v8::ArrayBuffer::Allocator {
  public:
   inline uint32_t* zero_fill_field() { return &zero_fill_field_; }
+  inline SizeClassAllocator* size_classes() { return &size_classes_; }
 
-  virtual void* Allocate(size_t size);  // Defined in src/node.cc
-  virtual void* AllocateUninitialized(size_t size)
-    { return node::UncheckedMalloc(size); }
-  virtual void Free(void* data, size_t) { free(data); }
+  // Defined in src/node.cc
+  virtual void* Allocate(size_t size);
+  virtual void* AllocateUninitialized(size_t size);
+  virtual void Free(void* data, size_t size);
 
  private:
   uint32_t zero_fill_field_ = 1;  // Boolean but exposed as uint32 to JS land.
+  SizeClassAllocator size_classes_;
 };
 
 namespace Buffer {
@@ -0,0 +1,184 @@
+#include "node_internals.h"
+#include "node_buffer_simd.h"
+#include "env-inl.h"
+#include "util-inl.h"
+#include "v8.h"
+
+// Fast path for querystring.parse() in lib/querystring.js. The input is
+// copied once, scanned for separators, '%' and '+' with a vectorized search,
+// and keys and values that need decoding are decoded in place in that copy.
+// All keys and values are handed back to JS as one flat array.
+
+namespace node {
+
+using v8::Array;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Isolate;
+using v8::Local;
+using v8::NewStringType;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+namespace {
+
+inline int Unhex(uint8_t c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+// Decodes a key or value in place and returns its new length. This produces
+// the same bytes as the JS implementation: '+' turns into a space, valid %XX
+// escapes into the byte they encode, and everything else is kept as is,
+// including the character that follows a '%' which does not start an escape
+// (see unescapeBuffer() in lib/querystring.js).
+size_t Unescape(char* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    if (data[i] == '+')
+      data[i] = ' ';
+  }
+
+  size_t in = 0;
+  size_t out = 0;
+  while (in < length) {
+    char c = data[in];
+    if (c == '%' && in + 2 < length) {
+      const int high = Unhex(data[++in]);
+      if (high < 0) {
+        data[out++] = '%';
+        c = data[in];
+      } else {
+        const int low = Unhex(data[++in]);
+        if (low < 0) {
+          data[out++] = '%';
+          data[out++] = data[in - 1];
+          c = data[in];
+        } else {
+          c = static_cast<char>(high * 16 + low);
+        }
+      }
+    }
+    data[out++] = c;
+    in++;
+  }
+  return out;
+}
+
+Local<String> MakeString(Isolate* isolate,
+                         char* data,
+                         size_t length,
+                         bool escaped) {
+  if (length == 0)
+    return String::Empty(isolate);
+  if (!escaped) {
+    return String::NewFromOneByte(isolate,
+                                  reinterpret_cast<const uint8_t*>(data),
+                                  NewStringType::kNormal,
+                                  length).ToLocalChecked();
+  }
+  // Escapes may have produced any bytes; invalid UTF-8 is replaced the same
+  // way Buffer#toString() does it.
+  return String::NewFromUtf8(isolate,
+                             data,
+                             NewStringType::kNormal,
+                             Unescape(data, length)).ToLocalChecked();
+}
+
+// parse(input, sep, eq, maxKeys) returns [key0, value0, key1, value1, ...]
+// for a string with single character separators, or undefined if the input
+// is not pure ASCII and has to be parsed in JS. A maxKeys of -1 means no
+// limit; like in JS, empty pairs count towards the limit.
+void Parse(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsUint32());
+  CHECK(args[2]->IsUint32());
+  CHECK(args[3]->IsInt32());
+  const uint32_t sep = args[1]->Uint32Value(context).FromJust();
+  const uint32_t eq = args[2]->Uint32Value(context).FromJust();
+  int32_t pairs = args[3]->Int32Value(context).FromJust();
+  CHECK_LT(sep, 0x80);
+  CHECK_LT(eq, 0x80);
+  CHECK_NE(sep, eq);
+  CHECK(sep != '%' && sep != '+' && eq != '%' && eq != '+');
+
+  Utf8Value input(isolate, args[0]);
+  char* data = *input;
+  const size_t length = input.length();
+  if (!Buffer::simd::IsAscii(data, length))
+    return;
+
+  const uint8_t needles[4] = {
+    static_cast<uint8_t>(sep), static_cast<uint8_t>(eq), '%', '+'
+  };
+  Local<Array> result = Array::New(isolate);
+  uint32_t count = 0;
+
+  size_t start = 0;
+  size_t pos = 0;
+  size_t key_end = 0;
+  bool has_eq = false;
+  bool key_escaped = false;
+  bool value_escaped = false;
+  for (;;) {
+    const char* found =
+        Buffer::simd::FindFirstOf(data + pos, length - pos, needles);
+    const size_t end = found == nullptr ? length : found - data;
+
+    if (found != nullptr && static_cast<uint8_t>(*found) != sep) {
+      if (!has_eq && static_cast<uint8_t>(*found) == eq) {
+        has_eq = true;
+        key_end = end;
+      } else if (*found == '%' || *found == '+') {
+        (has_eq ? value_escaped : key_escaped) = true;
+      }
+      pos = end + 1;
+      continue;
+    }
+
+    if (has_eq || start < end) {
+      if (!has_eq)
+        key_end = end;
+      Local<String> key =
+          MakeString(isolate, data + start, key_end - start, key_escaped);
+      Local<String> value = has_eq ?
+          MakeString(isolate, data + key_end + 1, end - key_end - 1,
+                     value_escaped) :
+          String::Empty(isolate);
+      result->Set(context, count++, key).FromJust();
+      result->Set(context, count++, value).FromJust();
+    } else if (found == nullptr) {
+      // Trailing empty pairs are not counted.
+      break;
+    }
+
+    if (found == nullptr || --pairs == 0)
+      break;
+
+    start = pos = end + 1;
+    has_eq = key_escaped = value_escaped = false;
+  }
+
+  args.GetReturnValue().Set(result);
+}
+
+void InitializeQueryString(Local<Object> target,
+                           Local<Value> unused,
+                           Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "parse", Parse);
+}
+
+}  // anonymous namespace
+}  // namespace node
+
+NODE_BUILTIN_MODULE_CONTEXT_AWARE(querystring, node::InitializeQueryString)
@@ -27,8 +27,24 @@
 #include <string.h>
 #include <stdlib.h>
 
+#include <memory>
+
+#if defined(__linux__)
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#endif
+
 namespace node {
 
+struct StatWatcher::Probe {
+  uv_work_t req;
+  StatWatcher* watcher = nullptr;
+  std::string path;
+  std::string dirname;
+  bool watchable = false;
+  uint64_t dir_ino = 0;
+};
+
 using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
@@ -62,6 +78,26 @@ static void Delete(uv_handle_t* handle) {
 }
 
 
+// Mirrors statbuf_eq() in deps/uv/src/fs-poll.c so that both backends agree
+// on what counts as a change.
+static bool StatEqual(const uv_stat_t* a, const uv_stat_t* b) {
+  return a->st_ctim.tv_nsec == b->st_ctim.tv_nsec
+      && a->st_mtim.tv_nsec == b->st_mtim.tv_nsec
+      && a->st_birthtim.tv_nsec == b->st_birthtim.tv_nsec
+      && a->st_ctim.tv_sec == b->st_ctim.tv_sec
+      && a->st_mtim.tv_sec == b->st_mtim.tv_sec
+      && a->st_birthtim.tv_sec == b->st_birthtim.tv_sec
+      && a->st_size == b->st_size
+      && a->st_mode == b->st_mode
+      && a->st_uid == b->st_uid
+      && a->st_gid == b->st_gid
+      && a->st_ino == b->st_ino
+      && a->st_dev == b->st_dev
+      && a->st_flags == b->st_flags
+      && a->st_gen == b->st_gen;
+}
+
+
 StatWatcher::StatWatcher(Environment* env, Local<Object> wrap)
     : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_STATWATCHER),
       watcher_(new uv_fs_poll_t) {
@@ -69,6 +105,7 @@ StatWatcher::StatWatcher(Environment* env, Local<Object> wrap)
   Wrap(wrap, this);
   uv_fs_poll_init(env->event_loop(), watcher_);
   watcher_->data = static_cast<void*>(this);
+  memset(&statbuf_, 0, sizeof(statbuf_));
 }
 
 
@@ -111,14 +148,14 @@ void StatWatcher::Start(const FunctionCallbackInfo<Value>& args) {
   const bool persistent = args[1]->BooleanValue();
   const uint32_t interval = args[2]->Uint32Value();
 
-  if (uv_is_active(reinterpret_cast<uv_handle_t*>(wrap->watcher_)))
+  if (wrap->IsActive())
     return;
-  // Safe, uv_ref/uv_unref are idempotent.
-  if (persistent)
-    uv_ref(reinterpret_cast<uv_handle_t*>(wrap->watcher_));
-  else
-    uv_unref(reinterpret_cast<uv_handle_t*>(wrap->watcher_));
-  uv_fs_poll_start(wrap->watcher_, Callback, *path, interval);
+
+  wrap->path_ = *path;
+  wrap->persistent_ = persistent;
+  wrap->interval_ = interval;
+  if (wrap->StartEvents() != 0)
+    wrap->StartPolling();
 
   wrap->ClearWeak();
 }
@@ -134,12 +171,413 @@ void StatWatcher::Stop(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+bool StatWatcher::IsActive() const {
+  return probe_ != nullptr ||
+         directory_ != nullptr ||
+         uv_is_active(reinterpret_cast<uv_handle_t*>(watcher_));
+}
+
+
 void StatWatcher::Stop() {
-  if (!uv_is_active(reinterpret_cast<uv_handle_t*>(watcher_)))
+  if (!IsActive())
     return;
-  uv_fs_poll_stop(watcher_);
+  if (probe_ != nullptr) {
+    // The probe may already be running, so just disown it.
+    probe_->watcher = nullptr;
+    probe_ = nullptr;
+  } else if (directory_ != nullptr) {
+    StopEvents();
+  } else {
+    uv_fs_poll_stop(watcher_);
+  }
   MakeWeak<StatWatcher>(this);
 }
 
 
+void StatWatcher::StartPolling() {
+  // Safe, uv_ref/uv_unref are idempotent.
+  if (persistent_)
+    uv_ref(reinterpret_cast<uv_handle_t*>(watcher_));
+  else
+    uv_unref(reinterpret_cast<uv_handle_t*>(watcher_));
+  uv_fs_poll_start(watcher_, Callback, path_.c_str(), interval_);
+}
+
+
+#if defined(__linux__)
+// inotify reports changes to a directory entry, not to what a symlink points
+// to, and only changes made through the local kernel. So events are only used
+// for regular files on filesystems that are known to be local. Anything else,
+// including files that do not exist yet, is polled as before.
+static bool IsWatchableByEvents(const char* path) {
+  struct stat st;
+  if (lstat(path, &st) != 0 || !S_ISREG(st.st_mode))
+    return false;
+
+  struct statfs fs;
+  if (statfs(path, &fs) != 0)
+    return false;
+
+  switch (static_cast<uint32_t>(fs.f_type)) {
+    case 0xEF53:      // ext2, ext3, ext4
+    case 0x58465342:  // xfs
+    case 0x9123683E:  // btrfs
+    case 0xF2F52010:  // f2fs
+    case 0x01021994:  // tmpfs
+    case 0x858458F6:  // ramfs
+    case 0x794C7630:  // overlayfs
+    case 0x2FC12FC1:  // zfs
+    case 0x52654973:  // reiserfs
+    case 0x3153464A:  // jfs
+    case 0x4D44:      // vfat
+    case 0x2011BAB0:  // exfat
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+// Runs on the threadpool, so it must only touch |probe|.
+void StatWatcher::ProbeWork(uv_work_t* req) {
+  Probe* probe = ContainerOf(&Probe::req, req);
+  struct stat st;
+  probe->watchable = IsWatchableByEvents(probe->path.c_str()) &&
+                     stat(probe->dirname.c_str(), &st) == 0;
+  if (probe->watchable)
+    probe->dir_ino = st.st_ino;
+}
+
+
+void StatWatcher::AfterProbe(uv_work_t* req, int status) {
+  std::unique_ptr<Probe> probe(ContainerOf(&Probe::req, req));
+  StatWatcher* wrap = probe->watcher;
+  if (wrap == nullptr)
+    return;  // Stopped while the probe was in flight.
+
+  CHECK_EQ(wrap->probe_, probe.get());
+  wrap->probe_ = nullptr;
+
+  int err;
+  StatWatcherDirectory* directory = nullptr;
+  if (status == 0 && probe->watchable) {
+    directory = StatWatcherDirectory::Acquire(wrap->env(),
+                                              probe->dirname,
+                                              probe->dir_ino,
+                                              &err);
+  }
+  if (directory == nullptr) {
+    wrap->StartPolling();
+    return;
+  }
+
+  wrap->last_status_ = 0;
+  memset(&wrap->statbuf_, 0, sizeof(wrap->statbuf_));
+  wrap->directory_ = directory;
+  directory->Add(wrap);
+
+  // Take the initial snapshot, just like uv_fs_poll_start() does.
+  wrap->ScheduleStat();
+}
+#endif
+
+
+// Watches |path_| through a uv_fs_event_t on its parent directory rather than
+// by polling it. Whether the file qualifies is checked on the threadpool, and
+// the probe's callback then either attaches the watcher to the directory or
+// starts polling. Returns an error code when no probe could be started, in
+// which case the caller falls back to uv_fs_poll right away.
+int StatWatcher::StartEvents() {
+#if defined(__linux__)
+  const char* path = path_.c_str();
+  const char* slash = strrchr(path, '/');
+  std::string dirname;
+  if (slash == nullptr)
+    dirname = ".";
+  else if (slash == path)
+    dirname = "/";
+  else
+    dirname.assign(path, slash - path);
+  const char* basename = slash == nullptr ? path : slash + 1;
+  if (*basename == '\0')
+    return UV_EINVAL;
+  basename_ = basename;
+
+  Probe* probe = new Probe();
+  probe->watcher = this;
+  probe->path = path_;
+  probe->dirname = dirname;
+  int err = uv_queue_work(env()->event_loop(),
+                          &probe->req,
+                          ProbeWork,
+                          AfterProbe);
+  if (err != 0) {
+    delete probe;
+    return err;
+  }
+  probe_ = probe;
+  return 0;
+#else
+  return UV_ENOSYS;
+#endif
+}
+
+
+void StatWatcher::StopEvents() {
+  StatWatcherDirectory* directory = directory_;
+  directory_ = nullptr;
+  directory->Remove(this);
+
+  // An in-flight stat() cannot be cancelled reliably, so just disown it.
+  if (stat_req_ != nullptr) {
+    stat_req_->data = nullptr;
+    stat_req_ = nullptr;
+  }
+  stat_again_ = false;
+}
+
+
+void StatWatcher::ScheduleStat() {
+  CHECK_NE(directory_, nullptr);
+  // Coalesce bursts of events into at most one pending stat() call.
+  if (stat_req_ != nullptr) {
+    stat_again_ = true;
+    return;
+  }
+
+  stat_req_ = new uv_fs_t;
+  stat_req_->data = this;
+  CHECK_EQ(0, uv_fs_stat(env()->event_loop(),
+                         stat_req_,
+                         path_.c_str(),
+                         AfterStat));
+}
+
+
+void StatWatcher::AfterStat(uv_fs_t* req) {
+  StatWatcher* wrap = static_cast<StatWatcher*>(req->data);
+  const int status = req->result;
+  const uv_stat_t statbuf = req->statbuf;
+  uv_fs_req_cleanup(req);
+  delete req;
+
+  if (wrap == nullptr)
+    return;  // Stopped while the request was in flight.
+
+  CHECK_EQ(wrap->stat_req_, req);
+  wrap->stat_req_ = nullptr;
+
+  Environment* env = wrap->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  wrap->OnStat(status, &statbuf);
+
+  if (wrap->directory_ != nullptr && wrap->stat_again_) {
+    wrap->stat_again_ = false;
+    wrap->ScheduleStat();
+  }
+}
+
+
+// Same state machine as poll_cb() in deps/uv/src/fs-poll.c.
+void StatWatcher::OnStat(int status, const uv_stat_t* statbuf) {
+  Environment* env = this->env();
+  uv_stat_t prev = statbuf_;
+
+  if (status != 0) {
+    if (last_status_ != status) {
+      static const uv_stat_t zero_statbuf = uv_stat_t();
+      last_status_ = status;
+      FillStatsArray(env->fs_stats_field_array(), &zero_statbuf);
+      FillStatsArray(env->fs_stats_field_array(), &prev, 14);
+      Local<Value> arg = Integer::New(env->isolate(), status);
+      MakeCallback(env->onchange_string(), 1, &arg);
+    }
+    return;
+  }
+
+  const bool changed = last_status_ != 0 &&
+                       (last_status_ < 0 || !StatEqual(&prev, statbuf));
+  statbuf_ = *statbuf;
+  last_status_ = 1;
+
+  if (changed) {
+    FillStatsArray(env->fs_stats_field_array(), statbuf);
+    FillStatsArray(env->fs_stats_field_array(), &prev, 14);
+    Local<Value> arg = Integer::New(env->isolate(), 0);
+    MakeCallback(env->onchange_string(), 1, &arg);
+  }
+}
+
+
+// Called when the directory watch goes stale, e.g. because the directory
+// itself was removed or renamed. Polling notices when the path reappears.
+void StatWatcher::FallBackToPolling() {
+  StopEvents();
+  StartPolling();
+}
+
+
+StatWatcherDirectory::StatWatcherDirectory(Environment* env,
+                                           const std::string& path)
+    : env_(env), path_(path) {
+  const size_t slash = path_.find_last_of('/');
+  basename_ = slash == std::string::npos ? path_ : path_.substr(slash + 1);
+  CHECK_EQ(0, uv_fs_event_init(env->event_loop(), &handle_));
+  handle_.data = this;
+}
+
+
+StatWatcherDirectory* StatWatcherDirectory::Acquire(Environment* env,
+                                                    const std::string& path,
+                                                    uint64_t ino,
+                                                    int* err) {
+  auto it = env->stat_watcher_directories.find(path);
+  if (it != env->stat_watcher_directories.end())
+    return it->second;
+
+  StatWatcherDirectory* directory = new StatWatcherDirectory(env, path);
+  *err = directory->Start(ino);
+  if (*err != 0) {
+    directory->Close();
+    return nullptr;
+  }
+  env->stat_watcher_directories.emplace(path, directory);
+  return directory;
+}
+
+
+int StatWatcherDirectory::Start(uint64_t ino) {
+  ino_ = ino;
+  return uv_fs_event_start(&handle_, OnEvent, path_.c_str(), 0);
+}
+
+
+void StatWatcherDirectory::Add(StatWatcher* watcher) {
+  watchers_.emplace(watcher->basename_, watcher);
+  if (watcher->persistent_)
+    persistent_count_++;
+  UpdateRef();
+}
+
+
+void StatWatcherDirectory::Remove(StatWatcher* watcher) {
+  auto range = watchers_.equal_range(watcher->basename_);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == watcher) {
+      watchers_.erase(it);
+      break;
+    }
+  }
+  if (watcher->persistent_)
+    persistent_count_--;
+
+  if (watchers_.empty()) {
+    env_->stat_watcher_directories.erase(path_);
+    Close();
+  } else {
+    UpdateRef();
+  }
+}
+
+
+void StatWatcherDirectory::UpdateRef() {
+  uv_handle_t* handle = reinterpret_cast<uv_handle_t*>(&handle_);
+  if (persistent_count_ > 0)
+    uv_ref(handle);
+  else
+    uv_unref(handle);
+}
+
+
+// Renaming or removing the watched directory invalidates the inotify watch
+// without any further notice, so check whether |path_| still refers to the
+// directory that was originally watched. The stat() runs on the threadpool;
+// AfterValidate() moves all watchers over to polling if it does not.
+void StatWatcherDirectory::CheckStillValid() {
+  if (validate_req_ != nullptr)
+    return;
+  validate_req_ = new uv_fs_t;
+  validate_req_->data = this;
+  CHECK_EQ(0, uv_fs_stat(env_->event_loop(),
+                         validate_req_,
+                         path_.c_str(),
+                         AfterValidate));
+}
+
+
+void StatWatcherDirectory::AfterValidate(uv_fs_t* req) {
+  StatWatcherDirectory* directory =
+      static_cast<StatWatcherDirectory*>(req->data);
+  const bool valid = directory == nullptr ||
+                     (req->result == 0 &&
+                      req->statbuf.st_ino == directory->ino_);
+  uv_fs_req_cleanup(req);
+  delete req;
+
+  if (directory == nullptr)
+    return;  // Closed while the request was in flight.
+
+  CHECK_EQ(directory->validate_req_, req);
+  directory->validate_req_ = nullptr;
+  if (valid)
+    return;
+
+  std::vector<StatWatcher*> all;
+  for (const auto& entry : directory->watchers_)
+    all.push_back(entry.second);
+  // This closes |directory| once the last watcher has been moved.
+  for (StatWatcher* watcher : all)
+    watcher->FallBackToPolling();
+}
+
+
+void StatWatcherDirectory::Close() {
+  // An in-flight stat() cannot be cancelled reliably, so just disown it.
+  if (validate_req_ != nullptr) {
+    validate_req_->data = nullptr;
+    validate_req_ = nullptr;
+  }
+  uv_close(reinterpret_cast<uv_handle_t*>(&handle_), OnClose);
+}
+
+
+void StatWatcherDirectory::OnClose(uv_handle_t* handle) {
+  delete static_cast<StatWatcherDirectory*>(handle->data);
+}
+
+
+void StatWatcherDirectory::OnEvent(uv_fs_event_t* handle,
+                                   const char* filename,
+                                   int events,
+                                   int status) {
+  StatWatcherDirectory* directory =
+      static_cast<StatWatcherDirectory*>(handle->data);
+
+  // Stat callbacks can stop watchers and thereby modify |watchers_|, so work
+  // on a snapshot of the affected watchers.
+  std::vector<StatWatcher*> affected;
+  if (status != 0 || filename == nullptr) {
+    for (const auto& entry : directory->watchers_)
+      affected.push_back(entry.second);
+  } else {
+    auto range = directory->watchers_.equal_range(filename);
+    for (auto it = range.first; it != range.second; ++it)
+      affected.push_back(it->second);
+  }
+
+  if ((events & UV_RENAME) &&
+      filename != nullptr &&
+      directory->basename_ == filename) {
+    directory->CheckStillValid();
+  }
+
+  for (StatWatcher* watcher : affected) {
+    if (watcher->directory_ == directory)
+      watcher->ScheduleStat();
+  }
+}
+
+
 }  // namespace node
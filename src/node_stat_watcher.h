@@ -30,8 +30,13 @@
 #include "uv.h"
 #include "v8.h"
 
+#include <string>
+#include <unordered_map>
+
 namespace node {
 
+class StatWatcherDirectory;
+
 class StatWatcher : public AsyncWrap {
  public:
   ~StatWatcher() override;
@@ -48,13 +53,88 @@ class StatWatcher : public AsyncWrap {
   size_t self_size() const override { return sizeof(*this); }
 
  private:
+  friend class StatWatcherDirectory;
+
   static void Callback(uv_fs_poll_t* handle,
                        int status,
                        const uv_stat_t* prev,
                        const uv_stat_t* curr);
+  static void AfterStat(uv_fs_t* req);
+
+  bool IsActive() const;
   void Stop();
+  void StartPolling();
+
+  // Event based watching, see StatWatcherDirectory.
+  struct Probe;
+  static void ProbeWork(uv_work_t* req);
+  static void AfterProbe(uv_work_t* req, int status);
+  int StartEvents();
+  void StopEvents();
+  void ScheduleStat();
+  void OnStat(int status, const uv_stat_t* statbuf);
+  void FallBackToPolling();
 
   uv_fs_poll_t* watcher_;
+
+  // Non-null while the threadpool checks whether |path_| can be watched
+  // through events; the watcher neither polls nor has a directory yet.
+  Probe* probe_ = nullptr;
+  StatWatcherDirectory* directory_ = nullptr;
+  std::string path_;
+  std::string basename_;
+  bool persistent_ = true;
+  uint32_t interval_ = 0;
+  uv_fs_t* stat_req_ = nullptr;
+  bool stat_again_ = false;
+  // Same meaning as uv_fs_poll's busy_polling: 0 before the first stat,
+  // 1 after a successful stat and the error code after a failed one.
+  int last_status_ = 0;
+  uv_stat_t statbuf_;
+};
+
+// Shares a single uv_fs_event_t (i.e. a single inotify watch) on a directory
+// between all StatWatchers that watch an entry in it. Events are dispatched
+// by file name, and each affected watcher re-stats its file and reports a
+// change the same way uv_fs_poll would have.
+class StatWatcherDirectory {
+ public:
+  // |ino| is the inode number of |path|, as found by the probe that
+  // decided to watch it.
+  static StatWatcherDirectory* Acquire(Environment* env,
+                                       const std::string& path,
+                                       uint64_t ino,
+                                       int* err);
+
+  void Add(StatWatcher* watcher);
+  void Remove(StatWatcher* watcher);
+
+ private:
+  StatWatcherDirectory(Environment* env, const std::string& path);
+  ~StatWatcherDirectory() {}
+
+  int Start(uint64_t ino);
+  void UpdateRef();
+  void CheckStillValid();
+  void Close();
+
+  static void OnEvent(uv_fs_event_t* handle,
+                      const char* filename,
+                      int events,
+                      int status);
+  static void AfterValidate(uv_fs_t* req);
+  static void OnClose(uv_handle_t* handle);
+
+  Environment* const env_;
+  const std::string path_;
+  std::string basename_;
+  uv_fs_event_t handle_;
+  uint64_t ino_ = 0;
+  uv_fs_t* validate_req_ = nullptr;
+  size_t persistent_count_ = 0;
+  std::unordered_multimap<std::string, StatWatcher*> watchers_;
+
+  DISALLOW_COPY_AND_ASSIGN(StatWatcherDirectory);
 };
 
 }  // namespace node
@@ -2,8 +2,13 @@
 #include "node_internals.h"
 #include "base_object-inl.h"
 #include "node_i18n.h"
+#include "node_mutex.h"
+#include "node_buffer_simd.h"
 
+#include <list>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <stdio.h>
 #include <cmath>
@@ -691,8 +696,78 @@ inline int NormalizePort(std::string scheme, int p) {
   return p;
 }
 
+// A small thread safe map from strings to values that evicts the least
+// recently used entry once it is full.
+template <typename T>
+class LruCache {
+ public:
+  explicit LruCache(size_t capacity) : capacity_(capacity) {}
+
+  bool Lookup(const std::string& key, T* value) {
+    Mutex::ScopedLock lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end())
+      return false;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    *value = it->second->second;
+    return true;
+  }
+
+  void Insert(const std::string& key, const T& value) {
+    Mutex::ScopedLock lock(mutex_);
+    if (index_.find(key) != index_.end())
+      return;
+    if (entries_.size() >= capacity_) {
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+    }
+    entries_.emplace_front(key, value);
+    index_.emplace(key, entries_.begin());
+  }
+
+ private:
+  typedef std::list<std::pair<std::string, T>> Entries;
+
+  const size_t capacity_;
+  Mutex mutex_;
+  Entries entries_;  // Most recently used first.
+  std::unordered_map<std::string, typename Entries::iterator> index_;
+
+  DISALLOW_COPY_AND_ASSIGN(LruCache);
+};
+
 #if defined(NODE_HAVE_I18N_SUPPORT)
+// UTS #46 ToASCII and ToUnicode map a domain made up only of lowercase ASCII
+// letters, digits, '-', '.' and '_' to itself, unless one of its labels
+// starts with "xn--" and has to be decoded as punycode and validated. That
+// covers nearly every host in practice, and ICU does not need to see them.
+inline bool IsCanonicalASCIIDomain(const std::string& input) {
+  static const uint8_t kRanges[4][2] = {
+    { 'a', 'z' }, { '0', '9' }, { '-', '.' }, { '_', '_' }
+  };
+  if (input.empty() ||
+      !Buffer::simd::AllInRanges(input.data(), input.size(), kRanges)) {
+    return false;
+  }
+  for (size_t label = 0; label != std::string::npos;) {
+    if (input.compare(label, 4, "xn--") == 0)
+      return false;
+    label = input.find('.', label);
+    if (label != std::string::npos)
+      label++;
+  }
+  return true;
+}
+
+// Results of ICU's ToASCII for the internationalized domains seen recently.
+LruCache<std::string> to_ascii_cache(256);
+const size_t kToASCIICacheMaxInputLength = 1024;
+
 inline bool ToUnicode(const std::string& input, std::string* output) {
+  if (IsCanonicalASCIIDomain(input)) {
+    *output = input;
+    return true;
+  }
   MaybeStackBuffer<char> buf;
   if (i18n::ToUnicode(&buf, input.c_str(), input.length()) < 0)
     return false;
@@ -701,10 +776,21 @@ inline bool ToUnicode(const std::string& input, std::string* output) {
 }
 
 inline bool ToASCII(const std::string& input, std::string* output) {
+  if (IsCanonicalASCIIDomain(input)) {
+    *output = input;
+    return true;
+  }
+  const bool cacheable = input.size() <= kToASCIICacheMaxInputLength;
+  if (cacheable && to_ascii_cache.Lookup(input, output))
+    return true;
   MaybeStackBuffer<char> buf;
   if (i18n::ToASCII(&buf, input.c_str(), input.length()) < 0)
     return false;
-  output->assign(*buf, buf.length());
+  // |output| may alias |input|, which is still needed as the cache key.
+  std::string result(*buf, buf.length());
+  if (cacheable)
+    to_ascii_cache.Insert(input, result);
+  *output = std::move(result);
   return true;
 }
 #else
@@ -1976,6 +2062,84 @@ void URL::Parse(const char* input,
   }
 }  // NOLINT(readability/fn_size)
 
+// https://url.spec.whatwg.org/#concept-url-serializer
+static std::string Serialize(const struct url_data& url) {
+  std::string ret = url.scheme;
+  if (url.flags & URL_FLAGS_HAS_HOST) {
+    ret += "//";
+    if (!url.username.empty() || !url.password.empty()) {
+      ret += url.username;
+      if (!url.password.empty())
+        ret += ":" + url.password;
+      ret += "@";
+    }
+    ret += url.host;
+    if (url.port > -1)
+      ret += ":" + std::to_string(url.port);
+  } else if (url.scheme == "file:") {
+    ret += "//";
+  }
+  if (url.flags & URL_FLAGS_CANNOT_BE_BASE) {
+    if (!url.path.empty())
+      ret += url.path[0];
+  } else {
+    for (const std::string& segment : url.path)
+      ret += "/" + segment;
+  }
+  if (url.flags & URL_FLAGS_HAS_QUERY)
+    ret += "?" + url.query;
+  if (url.flags & URL_FLAGS_HAS_FRAGMENT)
+    ret += "#" + url.fragment;
+  return ret;
+}
+
+// Remembers the outcome of recent full parses, failed ones included.
+// Servers and module loaders tend to parse the same few hundred URLs over and
+// over again; a hit copies the parsed record instead of running the state
+// machine.
+LruCache<struct url_data> parse_cache(512);
+
+// Longer inputs are rarely repeated and would only crowd out other entries.
+const size_t kParseCacheMaxInputLength = 2048;
+
+// Runs a full parse of |input| against |base| (which may be nullptr),
+// consulting the parse cache first.
+static void ParseCached(const char* input,
+                        size_t len,
+                        const struct url_data* base,
+                        struct url_data* url) {
+  const bool has_base = base != nullptr;
+  if (len > kParseCacheMaxInputLength) {
+    URL::Parse(input, len, kUnknownState, url, false, base, has_base);
+    return;
+  }
+
+  // The length prefix keeps the input and the base apart.
+  std::string key = std::to_string(len) + ":";
+  key.append(input, len);
+  if (has_base)
+    key += std::to_string(base->flags) + ":" + Serialize(*base);
+
+  if (parse_cache.Lookup(key, url))
+    return;
+  URL::Parse(input, len, kUnknownState, url, false, base, has_base);
+  parse_cache.Insert(key, *url);
+}
+
+static void CallErrorCallback(Environment* env,
+                              Local<Value> recv,
+                              Local<Value> error_cb,
+                              int32_t flags,
+                              Local<Value> input) {
+  if (!error_cb->IsFunction())
+    return;
+  Local<Value> argv[2];
+  argv[ERR_ARG_FLAGS] = Integer::NewFromUnsigned(env->isolate(), flags);
+  argv[ERR_ARG_INPUT] = input;
+  error_cb.As<Function>()->Call(env->context(), recv, arraysize(argv), argv)
+      .FromMaybe(Local<Value>());
+}
+
 static inline void SetArgs(Environment* env,
                            Local<Value> argv[],
                            const struct url_data* url) {
@@ -2013,16 +2177,28 @@ static void Parse(Environment* env,
   Context::Scope context_scope(context);
 
   const bool has_context = context_obj->IsObject();
-  const bool has_base = base_obj->IsObject();
+  const bool has_base = base_obj->IsObject() || base_obj->IsString();
 
   struct url_data base;
   struct url_data url;
   if (has_context)
     HarvestContext(env, &url, context_obj.As<Object>());
-  if (has_base)
+
+  if (base_obj->IsString()) {
+    // The base was passed as a string rather than as a parsed URL context,
+    // which spares JS land from constructing an intermediate URL object.
+    Utf8Value base_input(isolate, base_obj);
+    ParseCached(*base_input, base_input.length(), nullptr, &base);
+    if (base.flags & URL_FLAGS_FAILED)
+      return CallErrorCallback(env, recv, error_cb, base.flags, base_obj);
+  } else if (has_base) {
     HarvestBase(env, &base, base_obj.As<Object>());
+  }
 
-  URL::Parse(input, len, state_override, &url, has_context, &base, has_base);
+  if (state_override == kUnknownState && !has_context)
+    ParseCached(input, len, has_base ? &base : nullptr, &url);
+  else
+    URL::Parse(input, len, state_override, &url, has_context, &base, has_base);
   if ((url.flags & URL_FLAGS_INVALID_PARSE_STATE) ||
       ((state_override != kUnknownState) &&
        (url.flags & URL_FLAGS_TERMINATED)))
@@ -2045,15 +2221,12 @@ static void Parse(Environment* env,
     };
     SetArgs(env, argv, &url);
     cb->Call(context, recv, arraysize(argv), argv).FromMaybe(Local<Value>());
-  } else if (error_cb->IsFunction()) {
-    Local<Value> argv[2] = { undef, undef };
-    argv[ERR_ARG_FLAGS] = Integer::NewFromUnsigned(isolate, url.flags);
-    argv[ERR_ARG_INPUT] =
-      String::NewFromUtf8(env->isolate(),
-                          input,
-                          v8::NewStringType::kNormal).ToLocalChecked();
-    error_cb.As<Function>()->Call(context, recv, arraysize(argv), argv)
-        .FromMaybe(Local<Value>());
+  } else {
+    CallErrorCallback(env, recv, error_cb, url.flags,
+                      String::NewFromUtf8(env->isolate(),
+                                          input,
+                                          v8::NewStringType::kNormal)
+                          .ToLocalChecked());
   }
 }
 
@@ -2061,9 +2234,10 @@ static void Parse(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   CHECK_GE(args.Length(), 5);
   CHECK(args[0]->IsString());  // input
-  CHECK(args[2]->IsUndefined() ||  // base context
+  CHECK(args[2]->IsUndefined() ||  // base context or base input
         args[2]->IsNull() ||
-        args[2]->IsObject());
+        args[2]->IsObject() ||
+        args[2]->IsString());
   CHECK(args[3]->IsUndefined() ||  // context
         args[3]->IsNull() ||
         args[3]->IsObject());
@@ -2086,6 +2260,33 @@ static void Parse(const FunctionCallbackInfo<Value>& args) {
         args[5]);
 }
 
+// href(input, base, errorCallback) parses |input| against the optional
+// |base| string and returns only the serialized URL. Callers that need the
+// href and nothing else avoid creating strings for every component.
+static void Href(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsString());  // input
+  CHECK(args[1]->IsUndefined() || args[1]->IsString());  // base
+  CHECK(args[2]->IsFunction());  // error callback
+
+  struct url_data base;
+  const bool has_base = args[1]->IsString();
+  if (has_base) {
+    Utf8Value base_input(env->isolate(), args[1]);
+    ParseCached(*base_input, base_input.length(), nullptr, &base);
+    if (base.flags & URL_FLAGS_FAILED)
+      return CallErrorCallback(env, args.This(), args[2], base.flags, args[1]);
+  }
+
+  Utf8Value input(env->isolate(), args[0]);
+  struct url_data url;
+  ParseCached(*input, input.length(), has_base ? &base : nullptr, &url);
+  if (url.flags & URL_FLAGS_FAILED)
+    return CallErrorCallback(env, args.This(), args[2], url.flags, args[0]);
+
+  args.GetReturnValue().Set(UTF8STRING(env->isolate(), Serialize(url)));
+}
+
 static void EncodeAuthSet(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   CHECK_GE(args.Length(), 1);
@@ -2296,6 +2497,7 @@ static void Init(Local<Object> target,
                  void* priv) {
   Environment* env = Environment::GetCurrent(context);
   env->SetMethod(target, "parse", Parse);
+  env->SetMethod(target, "href", Href);
   env->SetMethod(target, "encodeAuth", EncodeAuthSet);
   env->SetMethod(target, "toUSVString", ToUSVString);
   env->SetMethod(target, "domainToASCII", DomainToASCII);
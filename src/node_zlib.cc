@@ -21,6 +21,8 @@
 
 #include "node.h"
 #include "node_buffer.h"
+#include "node_buffer_allocator.h"
+#include "node_internals.h"
 
 #include "async_wrap-inl.h"
 #include "env-inl.h"
@@ -29,11 +31,22 @@
 #include "v8.h"
 #include "zlib.h"
 
+#if NODE_HAVE_BROTLI
+#include <brotli/decode.h>
+#include <brotli/encode.h>
+#endif
+
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace node {
 
 using v8::Array;
@@ -43,13 +56,189 @@ using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::HandleScope;
+using v8::Isolate;
 using v8::Local;
 using v8::Number;
 using v8::Object;
 using v8::String;
 using v8::Uint32Array;
+using v8::Undefined;
 using v8::Value;
 
+namespace zlib {
+
+// Allocation functions for zlib and brotli that keep track of how much memory
+// a stream holds, so that it can be reported to V8 and to JS. The size of
+// every allocation is stored in front of it. A stream is only ever used by
+// one thread at a time, so the count needs no synchronization.
+struct AllocationCounter {
+  static void* Alloc(void* opaque, size_t size) {
+    char* memory = UncheckedMalloc(kHeaderSize + size);
+    if (memory == nullptr)
+      return nullptr;
+    *reinterpret_cast<size_t*>(memory) = size;
+    static_cast<AllocationCounter*>(opaque)->bytes += size;
+    return memory + kHeaderSize;
+  }
+
+  static void Free(void* opaque, void* pointer) {
+    if (pointer == nullptr)
+      return;
+    char* memory = static_cast<char*>(pointer) - kHeaderSize;
+    static_cast<AllocationCounter*>(opaque)->bytes -=
+        *reinterpret_cast<size_t*>(memory);
+    free(memory);
+  }
+
+  static voidpf ZAlloc(voidpf opaque, uInt items, uInt size) {
+    return Alloc(opaque, static_cast<size_t>(items) * size);
+  }
+
+  static void ZFree(voidpf opaque, voidpf pointer) {
+    Free(opaque, pointer);
+  }
+
+  // Keeps the memory handed out as aligned as what malloc() returns.
+  static const size_t kHeaderSize = alignof(std::max_align_t);
+  static_assert(kHeaderSize >= sizeof(size_t), "header too small");
+
+  size_t bytes = 0;
+};
+
+// A z_stream that lives on the heap. zlib ties its internal state to the
+// address of the z_stream, so a stream cannot be moved from the pool into
+// the context that picks it up.
+struct ZStream {
+  ZStream() : strm() {
+    strm.zalloc = AllocationCounter::ZAlloc;
+    strm.zfree = AllocationCounter::ZFree;
+    strm.opaque = &allocations;
+  }
+
+  z_stream strm;
+  AllocationCounter allocations;
+};
+
+// An immutable preset dictionary.
+class Dictionary {
+ public:
+  Dictionary(const char* data, size_t length)
+      : data_(new Bytef[length]), length_(length) {
+    memcpy(data_.get(), data, length);
+  }
+
+  const Bytef* data() const { return data_.get(); }
+  size_t length() const { return length_; }
+
+  bool Equals(const char* data, size_t length) const {
+    return length == length_ && memcmp(data, data_.get(), length) == 0;
+  }
+
+ private:
+  std::unique_ptr<Bytef[]> data_;
+  const size_t length_;
+};
+
+// Streams of closed contexts, reset and ready to be picked up by new ones
+// with the same parameters, so that short-lived compressions such as the
+// ones behind zlib.deflate() and friends do not have to allocate and
+// initialize a stream every time. Also keeps track of the preset
+// dictionaries in use, which contexts with equal dictionaries share instead
+// of each keeping a copy. Only used on the main thread.
+class StatePool {
+ public:
+  // The parameters a stream was initialized with. deflateReset() and
+  // inflateReset() keep all of them.
+  struct Key {
+    bool deflate;
+    int window_bits;
+    int level;
+    int mem_level;
+    int strategy;
+
+    bool operator==(const Key& other) const {
+      return deflate == other.deflate &&
+             window_bits == other.window_bits &&
+             level == other.level &&
+             mem_level == other.mem_level &&
+             strategy == other.strategy;
+    }
+  };
+
+  explicit StatePool(Isolate* isolate) : isolate_(isolate) {}
+
+  ~StatePool() {
+    for (const auto& entry : idle_)
+      Free(entry);
+  }
+
+  // Returns the most recently released stream for |key|, or nullptr.
+  ZStream* Acquire(const Key& key) {
+    for (size_t i = idle_.size(); i > 0; i--) {
+      if (idle_[i - 1].first == key) {
+        ZStream* stream = idle_[i - 1].second;
+        idle_.erase(idle_.begin() + (i - 1));
+        return stream;
+      }
+    }
+    return nullptr;
+  }
+
+  // Takes over a stream that has been reset, together with the memory the
+  // context reported to V8 for it. Frees the least recently released one if
+  // there are too many.
+  void Release(const Key& key, ZStream* stream) {
+    if (idle_.size() == kMaxIdleStreams) {
+      Free(idle_.front());
+      idle_.erase(idle_.begin());
+    }
+    idle_.push_back(std::make_pair(key, stream));
+  }
+
+  // Returns a dictionary with the given contents, shared with the other
+  // contexts that currently use one that is equal.
+  std::shared_ptr<const Dictionary> GetDictionary(const char* data,
+                                                  size_t length) {
+    std::shared_ptr<const Dictionary> found;
+    for (auto it = dictionaries_.begin(); it != dictionaries_.end();) {
+      std::shared_ptr<const Dictionary> dictionary = it->lock();
+      if (!dictionary) {
+        it = dictionaries_.erase(it);
+        continue;
+      }
+      if (!found && dictionary->Equals(data, length))
+        found = dictionary;
+      ++it;
+    }
+    if (!found) {
+      found = std::make_shared<const Dictionary>(data, length);
+      dictionaries_.push_back(found);
+    }
+    return found;
+  }
+
+ private:
+  void Free(const std::pair<Key, ZStream*>& entry) {
+    ZStream* stream = entry.second;
+    isolate_->AdjustAmountOfExternalAllocatedMemory(
+        -static_cast<int64_t>(stream->allocations.bytes));
+    if (entry.first.deflate)
+      deflateEnd(&stream->strm);
+    else
+      inflateEnd(&stream->strm);
+    delete stream;
+  }
+
+  // A deflate stream with the default settings holds about 256 KiB.
+  static const size_t kMaxIdleStreams = 8;
+
+  Isolate* const isolate_;
+  std::vector<std::pair<Key, ZStream*>> idle_;
+  std::vector<std::weak_ptr<const Dictionary>> dictionaries_;
+};
+
+}  // namespace zlib
+
 namespace {
 
 enum node_zlib_mode {
@@ -60,7 +249,9 @@ enum node_zlib_mode {
   GUNZIP,
   DEFLATERAW,
   INFLATERAW,
-  UNZIP
+  UNZIP,
+  BROTLI_DECODE,
+  BROTLI_ENCODE
 };
 
 #define GZIP_HEADER_ID1 0x1f
@@ -73,8 +264,6 @@ class ZCtx : public AsyncWrap {
  public:
   ZCtx(Environment* env, Local<Object> wrap, node_zlib_mode mode)
       : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_ZLIB),
-        dictionary_(nullptr),
-        dictionary_len_(0),
         err_(0),
         flush_(0),
         init_done_(false),
@@ -82,12 +271,18 @@ class ZCtx : public AsyncWrap {
         memLevel_(0),
         mode_(mode),
         strategy_(0),
+        stream_(nullptr),
+        reported_memory_(0),
         windowBits_(0),
         write_in_progress_(false),
         pending_close_(false),
         refs_(0),
         gzip_id_bytes_read_(0),
-        write_result_(nullptr) {
+        write_result_(nullptr),
+        one_shot_(false),
+        out_data_(nullptr),
+        out_length_(0),
+        out_too_large_(false) {
     MakeWeak<ZCtx>(this);
     Wrap(wrap, this);
   }
@@ -96,6 +291,7 @@ class ZCtx : public AsyncWrap {
   ~ZCtx() override {
     CHECK_EQ(false, write_in_progress_ && "write in progress");
     Close();
+    free(out_data_);
   }
 
   void Close() {
@@ -109,23 +305,29 @@ class ZCtx : public AsyncWrap {
     CHECK_LE(mode_, UNZIP);
 
     int status = Z_OK;
-    if (mode_ == DEFLATE || mode_ == GZIP || mode_ == DEFLATERAW) {
-      status = deflateEnd(&strm_);
-      int64_t change_in_bytes = -static_cast<int64_t>(kDeflateContextSize);
-      env()->isolate()->AdjustAmountOfExternalAllocatedMemory(change_in_bytes);
-    } else if (mode_ == INFLATE || mode_ == GUNZIP || mode_ == INFLATERAW ||
-               mode_ == UNZIP) {
-      status = inflateEnd(&strm_);
-      int64_t change_in_bytes = -static_cast<int64_t>(kInflateContextSize);
-      env()->isolate()->AdjustAmountOfExternalAllocatedMemory(change_in_bytes);
+    if (mode_ != NONE) {
+      // A stream goes back to the pool reset, so that the next context to
+      // pick it up finds it in the same state as a new one. The memory that
+      // was reported for it is now the pool's.
+      zlib::StatePool* pool = env()->zlib_state_pool();
+      const bool deflate = IsDeflate();
+      status = deflate ? deflateReset(&stream_->strm) :
+                         inflateReset(&stream_->strm);
+      if (pool != nullptr && status == Z_OK) {
+        ReportMemory();
+        pool->Release(PoolKey(), stream_);
+        reported_memory_ = 0;
+      } else {
+        status = deflate ? deflateEnd(&stream_->strm) :
+                           inflateEnd(&stream_->strm);
+        ReportMemory();
+        delete stream_;
+      }
+      stream_ = nullptr;
     }
     CHECK(status == Z_OK || status == Z_DATA_ERROR);
     mode_ = NONE;
-
-    if (dictionary_ != nullptr) {
-      delete[] dictionary_;
-      dictionary_ = nullptr;
-    }
+    dictionary_.reset();
   }
 
 
@@ -136,6 +338,14 @@ class ZCtx : public AsyncWrap {
   }
 
 
+  // Returns the number of bytes zlib currently holds for this context.
+  static void GetAllocatedBytes(const FunctionCallbackInfo<Value>& args) {
+    ZCtx* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    args.GetReturnValue().Set(static_cast<double>(ctx->AllocatedBytes()));
+  }
+
+
   // write(flush, in, in_off, in_len, out, out_off, out_len)
   template <bool async>
   static void Write(const FunctionCallbackInfo<Value>& args) {
@@ -154,15 +364,7 @@ class ZCtx : public AsyncWrap {
     CHECK_EQ(false, args[0]->IsUndefined() && "must provide flush value");
 
     unsigned int flush = args[0]->Uint32Value();
-
-    if (flush != Z_NO_FLUSH &&
-        flush != Z_PARTIAL_FLUSH &&
-        flush != Z_SYNC_FLUSH &&
-        flush != Z_FULL_FLUSH &&
-        flush != Z_FINISH &&
-        flush != Z_BLOCK) {
-      CHECK(0 && "Invalid flush value");
-    }
+    CheckFlush(flush);
 
     Bytef *in;
     Bytef *out;
@@ -195,19 +397,21 @@ class ZCtx : public AsyncWrap {
     // build up the work request
     uv_work_t* work_req = &(ctx->work_req_);
 
-    ctx->strm_.avail_in = in_len;
-    ctx->strm_.next_in = in;
-    ctx->strm_.avail_out = out_len;
-    ctx->strm_.next_out = out;
+    ctx->stream_->strm.avail_in = in_len;
+    ctx->stream_->strm.next_in = in;
+    ctx->stream_->strm.avail_out = out_len;
+    ctx->stream_->strm.next_out = out;
     ctx->flush_ = flush;
+    ctx->one_shot_ = false;
 
     if (!async) {
       // sync version
       env->PrintSyncTrace();
       Process(work_req);
+      ctx->ReportMemory();
       if (CheckError(ctx)) {
-        ctx->write_result_[0] = ctx->strm_.avail_out;
-        ctx->write_result_[1] = ctx->strm_.avail_in;
+        ctx->write_result_[0] = ctx->stream_->strm.avail_out;
+        ctx->write_result_[1] = ctx->stream_->strm.avail_in;
         ctx->write_in_progress_ = false;
         ctx->Unref();
       }
@@ -215,17 +419,194 @@ class ZCtx : public AsyncWrap {
     }
 
     // async version
+    SizeClassAllocator* size_classes = env->isolate_data()->size_classes();
+    if (in != nullptr)
+      ctx->pins_.Pin(size_classes, in);
+    ctx->pins_.Pin(size_classes, out);
+    uv_queue_work(env->event_loop(), work_req, ZCtx::Process, ZCtx::After);
+  }
+
+
+  // writeAll(flush, in, in_off, in_len)
+  // Runs all of the input through zlib as a single job, collecting the output
+  // in one growing buffer, so that compressing or decompressing a large
+  // buffer does not take a threadpool round trip and a call back into JS per
+  // output chunk. The output is returned by the sync version and passed to
+  // the `oncomplete` callback by the async one. It is undefined if it would
+  // have exceeded kMaxLength.
+  template <bool async>
+  static void WriteAll(const FunctionCallbackInfo<Value>& args) {
+    CHECK_EQ(args.Length(), 4);
+
+    ZCtx* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    CHECK(ctx->init_done_ && "write before init");
+    CHECK(ctx->mode_ != NONE && "already finalized");
+
+    CHECK_EQ(false, ctx->write_in_progress_ && "write already in progress");
+    CHECK_EQ(false, ctx->pending_close_ && "close is pending");
+
+    unsigned int flush = args[0]->Uint32Value();
+    CheckFlush(flush);
+
+    Environment* env = ctx->env();
+    CHECK(Buffer::HasInstance(args[1]));
+    Local<Object> in_buf = args[1].As<Object>();
+    size_t in_off = args[2]->Uint32Value();
+    size_t in_len = args[3]->Uint32Value();
+    CHECK(Buffer::IsWithinBounds(in_off, in_len, Buffer::Length(in_buf)));
+
+    ctx->write_in_progress_ = true;
+    ctx->Ref();
+
+    ctx->stream_->strm.avail_in = in_len;
+    ctx->stream_->strm.next_in =
+        reinterpret_cast<Bytef*>(Buffer::Data(in_buf) + in_off);
+    ctx->stream_->strm.avail_out = 0;
+    ctx->stream_->strm.next_out = nullptr;
+    ctx->flush_ = flush;
+    ctx->one_shot_ = true;
+    ctx->out_too_large_ = false;
+
+    uv_work_t* work_req = &(ctx->work_req_);
+    if (!async) {
+      env->PrintSyncTrace();
+      Process(work_req);
+      ctx->ReportMemory();
+      if (!CheckError(ctx)) {
+        ctx->DiscardOutput();
+        return;
+      }
+      ctx->write_result_[0] = ctx->stream_->strm.avail_out;
+      ctx->write_result_[1] = ctx->stream_->strm.avail_in;
+      ctx->write_in_progress_ = false;
+      args.GetReturnValue().Set(ctx->TakeOutput());
+      ctx->Unref();
+      return;
+    }
+
+    ctx->pins_.Pin(env->isolate_data()->size_classes(),
+                   ctx->stream_->strm.next_in);
     uv_queue_work(env->event_loop(), work_req, ZCtx::Process, ZCtx::After);
   }
 
 
+  static void CheckFlush(unsigned int flush) {
+    if (flush != Z_NO_FLUSH &&
+        flush != Z_PARTIAL_FLUSH &&
+        flush != Z_SYNC_FLUSH &&
+        flush != Z_FULL_FLUSH &&
+        flush != Z_FINISH &&
+        flush != Z_BLOCK) {
+      CHECK(0 && "Invalid flush value");
+    }
+  }
+
+
   // thread pool!
-  // This function may be called multiple times on the uv_work pool
-  // for a single write() call, until all of the input bytes have
-  // been consumed.
   static void Process(uv_work_t* work_req) {
     ZCtx *ctx = ContainerOf(&ZCtx::work_req_, work_req);
+    if (ctx->one_shot_)
+      ProcessAll(ctx);
+    else
+      ProcessChunk(ctx);
+  }
+
+
+  // Calls ProcessChunk() until it stops filling up the output buffer, which
+  // doubles in size every time it does. Deflate output is allocated up front
+  // with the bound zlib gives for the input length, so that it fits in the
+  // first round.
+  static void ProcessAll(ZCtx* ctx) {
+    size_t capacity;
+    switch (ctx->mode_) {
+      case DEFLATE:
+      case GZIP:
+      case DEFLATERAW:
+        capacity = deflateBound(&ctx->stream_->strm,
+                                ctx->stream_->strm.avail_in);
+        break;
+      default:
+        capacity = static_cast<size_t>(ctx->stream_->strm.avail_in) * 4;
+        if (capacity > kMaxOneShotInflateGuess)
+          capacity = kMaxOneShotInflateGuess;
+    }
+    if (capacity < kMinOneShotOutput)
+      capacity = kMinOneShotOutput;
+    if (capacity > Buffer::kMaxLength)
+      capacity = Buffer::kMaxLength;
+
+    char* data = nullptr;
+    size_t length = 0;
+    for (;;) {
+      char* grown = UncheckedRealloc(data, capacity);
+      if (grown == nullptr) {
+        ctx->err_ = Z_MEM_ERROR;
+        break;
+      }
+      data = grown;
+      ctx->stream_->strm.next_out = reinterpret_cast<Bytef*>(data + length);
+      ctx->stream_->strm.avail_out = capacity - length;
+
+      ProcessChunk(ctx);
+      length = capacity - ctx->stream_->strm.avail_out;
+      if (ctx->err_ != Z_OK &&
+          ctx->err_ != Z_BUF_ERROR &&
+          ctx->err_ != Z_STREAM_END) {
+        break;
+      }
+      if (ctx->stream_->strm.avail_out != 0)
+        break;
+
+      if (capacity == Buffer::kMaxLength) {
+        ctx->out_too_large_ = true;
+        break;
+      }
+      capacity = capacity > Buffer::kMaxLength / 2 ?
+          Buffer::kMaxLength : capacity * 2;
+    }
+
+    // Give back what deflateBound() or the last doubling overestimated.
+    if (length > 0 && length < capacity && !ctx->out_too_large_) {
+      if (char* shrunk = UncheckedRealloc(data, length))
+        data = shrunk;
+    }
+    ctx->out_data_ = data;
+    ctx->out_length_ = length;
+  }
+
+
+  // Wraps the output of a writeAll() call in a Buffer, or returns undefined
+  // if it did not fit into one.
+  Local<Value> TakeOutput() {
+    if (out_too_large_) {
+      DiscardOutput();
+      return Undefined(env()->isolate());
+    }
+    Local<Object> buffer;
+    if (out_length_ == 0) {
+      DiscardOutput();
+      buffer = Buffer::New(env(), static_cast<size_t>(0)).ToLocalChecked();
+    } else {
+      buffer = Buffer::New(env(), out_data_, out_length_).ToLocalChecked();
+      out_data_ = nullptr;
+      out_length_ = 0;
+    }
+    return buffer;
+  }
+
 
+  void DiscardOutput() {
+    free(out_data_);
+    out_data_ = nullptr;
+    out_length_ = 0;
+  }
+
+
+  // This function may be called multiple times on the uv_work pool
+  // for a single write() call, until all of the input bytes have
+  // been consumed.
+  static void ProcessChunk(ZCtx* ctx) {
     const Bytef* next_expected_header_byte = nullptr;
 
     // If the avail_out is left at 0, then it means that it ran out
@@ -235,11 +616,11 @@ class ZCtx : public AsyncWrap {
       case DEFLATE:
       case GZIP:
       case DEFLATERAW:
-        ctx->err_ = deflate(&ctx->strm_, ctx->flush_);
+        ctx->err_ = deflate(&ctx->stream_->strm, ctx->flush_);
         break;
       case UNZIP:
-        if (ctx->strm_.avail_in > 0) {
-          next_expected_header_byte = ctx->strm_.next_in;
+        if (ctx->stream_->strm.avail_in > 0) {
+          next_expected_header_byte = ctx->stream_->strm.next_in;
         }
 
         switch (ctx->gzip_id_bytes_read_) {
@@ -252,7 +633,7 @@ class ZCtx : public AsyncWrap {
               ctx->gzip_id_bytes_read_ = 1;
               next_expected_header_byte++;
 
-              if (ctx->strm_.avail_in == 1) {
+              if (ctx->stream_->strm.avail_in == 1) {
                 // The only available byte was already read.
                 break;
               }
@@ -285,7 +666,7 @@ class ZCtx : public AsyncWrap {
       case INFLATE:
       case GUNZIP:
       case INFLATERAW:
-        ctx->err_ = inflate(&ctx->strm_, ctx->flush_);
+        ctx->err_ = inflate(&ctx->stream_->strm, ctx->flush_);
 
         // If data was encoded with dictionary (INFLATERAW will have it set in
         // SetDictionary, don't repeat that here)
@@ -293,12 +674,12 @@ class ZCtx : public AsyncWrap {
             ctx->err_ == Z_NEED_DICT &&
             ctx->dictionary_ != nullptr) {
           // Load it
-          ctx->err_ = inflateSetDictionary(&ctx->strm_,
-                                           ctx->dictionary_,
-                                           ctx->dictionary_len_);
+          ctx->err_ = inflateSetDictionary(&ctx->stream_->strm,
+                                           ctx->dictionary_->data(),
+                                           ctx->dictionary_->length());
           if (ctx->err_ == Z_OK) {
             // And try to decode again
-            ctx->err_ = inflate(&ctx->strm_, ctx->flush_);
+            ctx->err_ = inflate(&ctx->stream_->strm, ctx->flush_);
           } else if (ctx->err_ == Z_DATA_ERROR) {
             // Both inflateSetDictionary() and inflate() return Z_DATA_ERROR.
             // Make it possible for After() to tell a bad dictionary from bad
@@ -307,17 +688,17 @@ class ZCtx : public AsyncWrap {
           }
         }
 
-        while (ctx->strm_.avail_in > 0 &&
+        while (ctx->stream_->strm.avail_in > 0 &&
                ctx->mode_ == GUNZIP &&
                ctx->err_ == Z_STREAM_END &&
-               ctx->strm_.next_in[0] != 0x00) {
+               ctx->stream_->strm.next_in[0] != 0x00) {
           // Bytes remain in input buffer. Perhaps this is another compressed
           // member in the same archive, or just trailing garbage.
           // Trailing zero bytes are okay, though, since they are frequently
           // used for padding.
 
           Reset(ctx);
-          ctx->err_ = inflate(&ctx->strm_, ctx->flush_);
+          ctx->err_ = inflate(&ctx->stream_->strm, ctx->flush_);
         }
         break;
       default:
@@ -337,7 +718,7 @@ class ZCtx : public AsyncWrap {
     switch (ctx->err_) {
     case Z_OK:
     case Z_BUF_ERROR:
-      if (ctx->strm_.avail_out != 0 && ctx->flush_ == Z_FINISH) {
+      if (ctx->stream_->strm.avail_out != 0 && ctx->flush_ == Z_FINISH) {
         ZCtx::Error(ctx, "unexpected end of file");
         return false;
       }
@@ -366,21 +747,30 @@ class ZCtx : public AsyncWrap {
 
     ZCtx* ctx = ContainerOf(&ZCtx::work_req_, work_req);
     Environment* env = ctx->env();
+    ctx->pins_.Clear();
 
     HandleScope handle_scope(env->isolate());
     Context::Scope context_scope(env->context());
 
-    if (!CheckError(ctx))
+    ctx->ReportMemory();
+    if (!CheckError(ctx)) {
+      ctx->DiscardOutput();
       return;
+    }
 
-    ctx->write_result_[0] = ctx->strm_.avail_out;
-    ctx->write_result_[1] = ctx->strm_.avail_in;
+    ctx->write_result_[0] = ctx->stream_->strm.avail_out;
+    ctx->write_result_[1] = ctx->stream_->strm.avail_in;
     ctx->write_in_progress_ = false;
 
-    // call the write() cb
-    Local<Function> cb = PersistentToLocal(env->isolate(),
-                                           ctx->write_js_callback_);
-    ctx->MakeCallback(cb, 0, nullptr);
+    if (ctx->one_shot_) {
+      Local<Value> output = ctx->TakeOutput();
+      ctx->MakeCallback(env->oncomplete_string(), 1, &output);
+    } else {
+      // call the write() cb
+      Local<Function> cb = PersistentToLocal(env->isolate(),
+                                             ctx->write_js_callback_);
+      ctx->MakeCallback(cb, 0, nullptr);
+    }
 
     ctx->Unref();
     if (ctx->pending_close_)
@@ -393,8 +783,8 @@ class ZCtx : public AsyncWrap {
     // If you hit this assertion, you forgot to enter the v8::Context first.
     CHECK_EQ(env->context(), env->isolate()->GetCurrentContext());
 
-    if (ctx->strm_.msg != nullptr) {
-      message = ctx->strm_.msg;
+    if (ctx->stream_->strm.msg != nullptr) {
+      message = ctx->stream_->strm.msg;
     }
 
     HandleScope scope(env->isolate());
@@ -464,18 +854,19 @@ class ZCtx : public AsyncWrap {
 
     Local<Function> write_js_callback = args[5].As<Function>();
 
-    char* dictionary = nullptr;
-    size_t dictionary_len = 0;
+    std::shared_ptr<const zlib::Dictionary> dictionary;
     if (Buffer::HasInstance(args[6])) {
-      const char* dictionary_ = Buffer::Data(args[6]);
-      dictionary_len = Buffer::Length(args[6]);
-
-      dictionary = new char[dictionary_len];
-      memcpy(dictionary, dictionary_, dictionary_len);
+      const char* data = Buffer::Data(args[6]);
+      const size_t length = Buffer::Length(args[6]);
+      zlib::StatePool* pool = ctx->env()->zlib_state_pool();
+      if (pool != nullptr)
+        dictionary = pool->GetDictionary(data, length);
+      else
+        dictionary = std::make_shared<const zlib::Dictionary>(data, length);
     }
 
     bool ret = Init(ctx, level, windowBits, memLevel, strategy, write_result,
-                    write_js_callback, dictionary, dictionary_len);
+                    write_js_callback, std::move(dictionary));
     if (!ret) goto end;
 
     SetDictionary(ctx);
@@ -500,17 +891,13 @@ class ZCtx : public AsyncWrap {
 
   static bool Init(ZCtx *ctx, int level, int windowBits, int memLevel,
                    int strategy, uint32_t* write_result,
-                   Local<Function> write_js_callback, char* dictionary,
-                   size_t dictionary_len) {
+                   Local<Function> write_js_callback,
+                   std::shared_ptr<const zlib::Dictionary> dictionary) {
     ctx->level_ = level;
     ctx->windowBits_ = windowBits;
     ctx->memLevel_ = memLevel;
     ctx->strategy_ = strategy;
 
-    ctx->strm_.zalloc = Z_NULL;
-    ctx->strm_.zfree = Z_NULL;
-    ctx->strm_.opaque = Z_NULL;
-
     ctx->flush_ = Z_NO_FLUSH;
 
     ctx->err_ = Z_OK;
@@ -527,42 +914,40 @@ class ZCtx : public AsyncWrap {
       ctx->windowBits_ *= -1;
     }
 
-    switch (ctx->mode_) {
-      case DEFLATE:
-      case GZIP:
-      case DEFLATERAW:
-        ctx->err_ = deflateInit2(&ctx->strm_,
+    CHECK_NE(ctx->mode_, NONE);
+    CHECK_LE(ctx->mode_, UNZIP);
+    zlib::StatePool* pool = ctx->env()->zlib_state_pool();
+    if (pool != nullptr)
+      ctx->stream_ = pool->Acquire(ctx->PoolKey());
+    if (ctx->stream_ != nullptr) {
+      // The pool hands over the memory it reported for the stream.
+      ctx->reported_memory_ = ctx->stream_->allocations.bytes;
+    } else {
+      ctx->stream_ = new zlib::ZStream();
+      if (ctx->IsDeflate()) {
+        ctx->err_ = deflateInit2(&ctx->stream_->strm,
                                  ctx->level_,
                                  Z_DEFLATED,
                                  ctx->windowBits_,
                                  ctx->memLevel_,
                                  ctx->strategy_);
-        ctx->env()->isolate()
-            ->AdjustAmountOfExternalAllocatedMemory(kDeflateContextSize);
-        break;
-      case INFLATE:
-      case GUNZIP:
-      case INFLATERAW:
-      case UNZIP:
-        ctx->err_ = inflateInit2(&ctx->strm_, ctx->windowBits_);
-        ctx->env()->isolate()
-            ->AdjustAmountOfExternalAllocatedMemory(kInflateContextSize);
-        break;
-      default:
-        UNREACHABLE();
+      } else {
+        ctx->err_ = inflateInit2(&ctx->stream_->strm, ctx->windowBits_);
+      }
+      if (ctx->err_ != Z_OK) {
+        delete ctx->stream_;
+        ctx->stream_ = nullptr;
+      }
+      ctx->ReportMemory();
     }
 
-    ctx->dictionary_ = reinterpret_cast<Bytef *>(dictionary);
-    ctx->dictionary_len_ = dictionary_len;
+    ctx->dictionary_ = std::move(dictionary);
 
     ctx->write_in_progress_ = false;
     ctx->init_done_ = true;
 
     if (ctx->err_ != Z_OK) {
-      if (dictionary != nullptr) {
-        delete[] dictionary;
-        ctx->dictionary_ = nullptr;
-      }
+      ctx->dictionary_.reset();
       ctx->mode_ = NONE;
       return false;
     }
@@ -581,16 +966,16 @@ class ZCtx : public AsyncWrap {
     switch (ctx->mode_) {
       case DEFLATE:
       case DEFLATERAW:
-        ctx->err_ = deflateSetDictionary(&ctx->strm_,
-                                         ctx->dictionary_,
-                                         ctx->dictionary_len_);
+        ctx->err_ = deflateSetDictionary(&ctx->stream_->strm,
+                                         ctx->dictionary_->data(),
+                                         ctx->dictionary_->length());
         break;
       case INFLATERAW:
         // The other inflate cases will have the dictionary set when inflate()
         // returns Z_NEED_DICT in Process()
-        ctx->err_ = inflateSetDictionary(&ctx->strm_,
-                                         ctx->dictionary_,
-                                         ctx->dictionary_len_);
+        ctx->err_ = inflateSetDictionary(&ctx->stream_->strm,
+                                         ctx->dictionary_->data(),
+                                         ctx->dictionary_->length());
         break;
       default:
         break;
@@ -607,7 +992,13 @@ class ZCtx : public AsyncWrap {
     switch (ctx->mode_) {
       case DEFLATE:
       case DEFLATERAW:
-        ctx->err_ = deflateParams(&ctx->strm_, level, strategy);
+        ctx->err_ = deflateParams(&ctx->stream_->strm, level, strategy);
+        // The parameters are part of the pool key. They are left alone if
+        // the pending output did not fit.
+        if (ctx->err_ == Z_OK) {
+          ctx->level_ = level;
+          ctx->strategy_ = strategy;
+        }
         break;
       default:
         break;
@@ -625,12 +1016,12 @@ class ZCtx : public AsyncWrap {
       case DEFLATE:
       case DEFLATERAW:
       case GZIP:
-        ctx->err_ = deflateReset(&ctx->strm_);
+        ctx->err_ = deflateReset(&ctx->stream_->strm);
         break;
       case INFLATE:
       case INFLATERAW:
       case GUNZIP:
-        ctx->err_ = inflateReset(&ctx->strm_);
+        ctx->err_ = inflateReset(&ctx->stream_->strm);
         break;
       default:
         break;
@@ -641,7 +1032,9 @@ class ZCtx : public AsyncWrap {
     }
   }
 
-  size_t self_size() const override { return sizeof(*this); }
+  size_t self_size() const override {
+    return sizeof(*this) + AllocatedBytes();
+  }
 
  private:
   void Ref() {
@@ -657,11 +1050,37 @@ class ZCtx : public AsyncWrap {
     }
   }
 
-  static const int kDeflateContextSize = 16384;  // approximate
-  static const int kInflateContextSize = 10240;  // approximate
+  bool IsDeflate() const {
+    return mode_ == DEFLATE || mode_ == GZIP || mode_ == DEFLATERAW;
+  }
+
+  zlib::StatePool::Key PoolKey() const {
+    if (!IsDeflate())
+      return { false, windowBits_, 0, 0, 0 };
+    // deflateInit2() and deflateParams() treat both the same way.
+    const int level = level_ == Z_DEFAULT_COMPRESSION ? 6 : level_;
+    return { true, windowBits_, level, memLevel_, strategy_ };
+  }
+
+  size_t AllocatedBytes() const {
+    return stream_ != nullptr ? stream_->allocations.bytes : 0;
+  }
+
+  // Tells V8 about memory zlib allocated or freed since the last call. Inflate
+  // streams allocate their window on the first write.
+  void ReportMemory() {
+    const int64_t change = static_cast<int64_t>(AllocatedBytes()) -
+                           static_cast<int64_t>(reported_memory_);
+    if (change != 0) {
+      env()->isolate()->AdjustAmountOfExternalAllocatedMemory(change);
+      reported_memory_ = AllocatedBytes();
+    }
+  }
+
+  static const size_t kMinOneShotOutput = 16384;
+  static const size_t kMaxOneShotInflateGuess = 64 * 1024 * 1024;
 
-  Bytef* dictionary_;
-  size_t dictionary_len_;
+  std::shared_ptr<const zlib::Dictionary> dictionary_;
   int err_;
   int flush_;
   bool init_done_;
@@ -669,38 +1088,1141 @@ class ZCtx : public AsyncWrap {
   int memLevel_;
   node_zlib_mode mode_;
   int strategy_;
-  z_stream strm_;
+  zlib::ZStream* stream_;
+  size_t reported_memory_;
   int windowBits_;
   uv_work_t work_req_;
+  // The input and output of the write on the threadpool.
+  PooledBufferPins pins_;
   bool write_in_progress_;
   bool pending_close_;
   unsigned int refs_;
   unsigned int gzip_id_bytes_read_;
   uint32_t* write_result_;
   Persistent<Function> write_js_callback_;
+  // State of a writeAll() call.
+  bool one_shot_;
+  char* out_data_;
+  size_t out_length_;
+  bool out_too_large_;
 };
 
 
-void InitZlib(Local<Object> target,
-              Local<Value> unused,
-              Local<Context> context,
-              void* priv) {
-  Environment* env = Environment::GetCurrent(context);
-  Local<FunctionTemplate> z = env->NewFunctionTemplate(ZCtx::New);
+/**
+ * Parallel gzip
+ *
+ * Compresses large inputs the way pigz does: the input is split into blocks
+ * that are deflated concurrently on the threadpool, each one primed with the
+ * 32 KiB of input that precede it as a preset dictionary, so that matches
+ * across block boundaries are not lost. Every block but the last one of the
+ * stream ends with a sync flush, which leaves its output byte aligned and
+ * without the final bit set, so that the raw deflate output of all blocks
+ * can simply be concatenated. The gzip header and trailer are written around
+ * it, with the CRC32 of the whole input combined from the per-block ones.
+ */
+class ParallelGzip : public AsyncWrap {
+ public:
+  ParallelGzip(Environment* env,
+               Local<Object> wrap,
+               int level,
+               int mem_level,
+               int strategy,
+               size_t block_size)
+      : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_ZLIB),
+        level_(level),
+        mem_level_(mem_level),
+        strategy_(strategy),
+        block_size_(block_size),
+        crc_(crc32(0L, Z_NULL, 0)),
+        total_in_(0),
+        header_written_(false),
+        next_block_(0),
+        pending_blocks_(0),
+        final_(false),
+        write_in_progress_(false),
+        pending_close_(false),
+        closed_(false),
+        refs_(0) {
+    MakeWeak<ParallelGzip>(this);
+    Wrap(wrap, this);
+  }
 
-  z->InstanceTemplate()->SetInternalFieldCount(1);
 
-  AsyncWrap::AddWrapMethods(env, z);
-  env->SetProtoMethod(z, "write", ZCtx::Write<true>);
-  env->SetProtoMethod(z, "writeSync", ZCtx::Write<false>);
-  env->SetProtoMethod(z, "init", ZCtx::Init);
-  env->SetProtoMethod(z, "close", ZCtx::Close);
-  env->SetProtoMethod(z, "params", ZCtx::Params);
-  env->SetProtoMethod(z, "reset", ZCtx::Reset);
+  ~ParallelGzip() override {
+    CHECK_EQ(false, write_in_progress_ && "write in progress");
+    DiscardBlocks();
+  }
 
-  Local<String> zlibString = FIXED_ONE_BYTE_STRING(env->isolate(), "Zlib");
-  z->SetClassName(zlibString);
-  target->Set(zlibString, z->GetFunction());
+
+  void Close() {
+    if (write_in_progress_) {
+      pending_close_ = true;
+      return;
+    }
+    pending_close_ = false;
+    closed_ = true;
+    window_.clear();
+  }
+
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    CHECK(args[0]->IsInt32());
+    CHECK(args[1]->IsInt32());
+    CHECK(args[2]->IsInt32());
+    CHECK(args[3]->IsUint32());
+    const size_t block_size = args[3]->Uint32Value();
+    CHECK_GE(block_size, kWindowSize);
+    new ParallelGzip(env,
+                     args.This(),
+                     args[0]->Int32Value(),
+                     args[1]->Int32Value(),
+                     args[2]->Int32Value(),
+                     block_size);
+  }
+
+
+  static void Close(const FunctionCallbackInfo<Value>& args) {
+    ParallelGzip* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    ctx->Close();
+  }
+
+
+  // The blocks only exist while a write is in progress, so this is just the
+  // input kept around for the next one.
+  static void GetAllocatedBytes(const FunctionCallbackInfo<Value>& args) {
+    ParallelGzip* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    args.GetReturnValue().Set(static_cast<double>(ctx->window_.capacity()));
+  }
+
+
+  // writeAll(flush, in, in_off, in_len)
+  // Same interface as ZCtx::WriteAll(). A Z_FINISH flush ends the gzip
+  // member; any other flush value ends the output with a sync flush, so that
+  // everything written so far can be decompressed. The sync version
+  // compresses the blocks one after another on the calling thread.
+  template <bool async>
+  static void WriteAll(const FunctionCallbackInfo<Value>& args) {
+    CHECK_EQ(args.Length(), 4);
+
+    ParallelGzip* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    CHECK_EQ(false, ctx->closed_ && "already finalized");
+    CHECK_EQ(false, ctx->write_in_progress_ && "write already in progress");
+    CHECK_EQ(false, ctx->pending_close_ && "close is pending");
+
+    const unsigned int flush = args[0]->Uint32Value();
+    ZCtx::CheckFlush(flush);
+
+    Environment* env = ctx->env();
+    CHECK(Buffer::HasInstance(args[1]));
+    Local<Object> in_buf = args[1].As<Object>();
+    const size_t in_off = args[2]->Uint32Value();
+    const size_t in_len = args[3]->Uint32Value();
+    CHECK(Buffer::IsWithinBounds(in_off, in_len, Buffer::Length(in_buf)));
+    const Bytef* in =
+        reinterpret_cast<const Bytef*>(Buffer::Data(in_buf) + in_off);
+
+    ctx->write_in_progress_ = true;
+    ctx->Ref();
+    ctx->final_ = flush == Z_FINISH;
+    ctx->SplitIntoBlocks(in, in_len);
+
+    if (!async) {
+      env->PrintSyncTrace();
+      for (Block& block : ctx->blocks_)
+        Compress(&block);
+      Local<Value> output;
+      if (ctx->Finish(&output))
+        args.GetReturnValue().Set(output);
+      return;
+    }
+
+    // Only as many blocks as there are threads are queued at a time, so that
+    // a large input does not hold up all other threadpool work until it has
+    // been compressed. After() queues the remaining blocks one by one.
+    ctx->next_block_ = 0;
+    ctx->pending_blocks_ = 0;
+    ctx->pins_.Pin(env->isolate_data()->size_classes(), in);
+    const size_t max_in_flight = ThreadpoolSize();
+    while (ctx->pending_blocks_ < max_in_flight && ctx->QueueNextBlock()) {}
+  }
+
+
+  // params(level, strategy) applies to the blocks of the next write.
+  static void Params(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.Length() == 2 && "params(level, strategy)");
+    ParallelGzip* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    ctx->level_ = args[0]->Int32Value();
+    ctx->strategy_ = args[1]->Int32Value();
+  }
+
+
+  // reset() drops a partially written member; the next write starts over
+  // with a new gzip header.
+  static void Reset(const FunctionCallbackInfo<Value>& args) {
+    ParallelGzip* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    CHECK_EQ(false, ctx->write_in_progress_ && "write in progress");
+    ctx->StartMember();
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  struct Block {
+    ParallelGzip* ctx;
+    uv_work_t work_req;
+    int level;
+    int mem_level;
+    int strategy;
+    bool last;
+    const Bytef* in;
+    size_t in_len;
+    const Bytef* dictionary;
+    size_t dictionary_len;
+    uLong crc;
+    char* out;
+    size_t out_len;
+    int err;
+  };
+
+  void StartMember() {
+    crc_ = crc32(0L, Z_NULL, 0);
+    total_in_ = 0;
+    header_written_ = false;
+    window_.clear();
+  }
+
+  // The first block is primed with the tail of the previous write, which is
+  // kept in window_ because the JS side does not hold on to old input. All
+  // other blocks are at least kWindowSize bytes into the input and can use
+  // the input itself.
+  void SplitIntoBlocks(const Bytef* in, size_t in_len) {
+    size_t count = (in_len + block_size_ - 1) / block_size_;
+    if (count == 0)
+      count = 1;  // Still ends with a final block or sync flush marker.
+    blocks_.resize(count);
+    for (size_t i = 0; i < count; i++) {
+      Block& block = blocks_[i];
+      const size_t offset = i * block_size_;
+      block.ctx = this;
+      block.level = level_;
+      block.mem_level = mem_level_;
+      block.strategy = strategy_;
+      block.last = final_ && i == count - 1;
+      block.in = in + offset;
+      block.in_len = in_len - offset < block_size_ ?
+          in_len - offset : block_size_;
+      if (i == 0) {
+        block.dictionary = window_.data();
+        block.dictionary_len = window_.size();
+      } else {
+        block.dictionary = block.in - kWindowSize;
+        block.dictionary_len = kWindowSize;
+      }
+      block.crc = 0;
+      block.out = nullptr;
+      block.out_len = 0;
+      block.err = Z_OK;
+    }
+    in_ = in;
+    in_len_ = in_len;
+  }
+
+  bool QueueNextBlock() {
+    if (next_block_ == blocks_.size())
+      return false;
+    Block& block = blocks_[next_block_++];
+    pending_blocks_++;
+    uv_queue_work(env()->event_loop(),
+                  &block.work_req,
+                  ParallelGzip::Process,
+                  ParallelGzip::After);
+    return true;
+  }
+
+  // thread pool!
+  static void Process(uv_work_t* work_req) {
+    Compress(ContainerOf(&Block::work_req, work_req));
+  }
+
+  static void Compress(Block* block) {
+    block->crc = crc32(0L, block->in, block->in_len);
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    block->err = deflateInit2(&strm,
+                              block->level,
+                              Z_DEFLATED,
+                              -kWindowBits,
+                              block->mem_level,
+                              block->strategy);
+    if (block->err != Z_OK)
+      return;
+    if (block->dictionary_len > 0) {
+      block->err = deflateSetDictionary(&strm,
+                                        block->dictionary,
+                                        block->dictionary_len);
+    }
+
+    // deflateBound() does not account for the empty stored block that a sync
+    // flush appends, hence the extra bytes; the loop copes with anything
+    // else.
+    size_t capacity = deflateBound(&strm, block->in_len) + kFlushMarkerSize;
+    strm.next_in = const_cast<Bytef*>(block->in);
+    strm.avail_in = block->in_len;
+    const int flush = block->last ? Z_FINISH : Z_SYNC_FLUSH;
+    while (block->err == Z_OK) {
+      char* grown = UncheckedRealloc(block->out, capacity);
+      if (grown == nullptr) {
+        block->err = Z_MEM_ERROR;
+        break;
+      }
+      block->out = grown;
+      strm.next_out = reinterpret_cast<Bytef*>(block->out + block->out_len);
+      strm.avail_out = capacity - block->out_len;
+
+      const int err = deflate(&strm, flush);
+      block->out_len = capacity - strm.avail_out;
+      if (err == Z_STREAM_END)
+        break;
+      if (err != Z_OK && err != Z_BUF_ERROR) {
+        block->err = err;
+        break;
+      }
+      if (strm.avail_out != 0 && !block->last)
+        break;
+      capacity *= 2;
+    }
+    deflateEnd(&strm);
+  }
+
+  // v8 land!
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+
+    Block* block = ContainerOf(&Block::work_req, work_req);
+    ParallelGzip* ctx = block->ctx;
+    ctx->pending_blocks_--;
+    // Once a block has failed, the output is lost anyway. Blocks that were
+    // never queued come after the failed one, so Finish() still reports it.
+    if (block->err == Z_OK)
+      ctx->QueueNextBlock();
+    if (ctx->pending_blocks_ > 0)
+      return;
+
+    Environment* env = ctx->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    Local<Value> output;
+    if (ctx->Finish(&output))
+      ctx->MakeCallback(env->oncomplete_string(), 1, &output);
+  }
+
+  // Stitches the compressed blocks together, or reports the first error.
+  // The output is undefined if it does not fit into a Buffer.
+  bool Finish(Local<Value>* output) {
+    for (const Block& block : blocks_) {
+      if (block.err != Z_OK) {
+        Error(block.err);
+        return false;
+      }
+    }
+
+    size_t length = header_written_ ? 0 : kHeaderSize;
+    for (const Block& block : blocks_)
+      length += block.out_len;
+    if (final_)
+      length += kTrailerSize;
+
+    for (const Block& block : blocks_) {
+      crc_ = crc32_combine(crc_, block.crc, static_cast<z_off_t>(block.in_len));
+      total_in_ += block.in_len;
+    }
+    UpdateWindow();
+
+    if (length > Buffer::kMaxLength) {
+      *output = Undefined(env()->isolate());
+    } else if (length == 0) {
+      *output = Buffer::New(env(), static_cast<size_t>(0)).ToLocalChecked();
+    } else {
+      char* data = node::Malloc(length);
+      char* p = data;
+      if (!header_written_) {
+        WriteHeader(p);
+        p += kHeaderSize;
+        header_written_ = true;
+      }
+      for (const Block& block : blocks_) {
+        memcpy(p, block.out, block.out_len);
+        p += block.out_len;
+      }
+      if (final_) {
+        WriteLE32(p, crc_);
+        WriteLE32(p + 4, static_cast<uint32_t>(total_in_));
+      }
+      *output = Buffer::New(env(), data, length).ToLocalChecked();
+    }
+
+    if (final_)
+      StartMember();
+    DiscardBlocks();
+    write_in_progress_ = false;
+    Unref();
+    if (pending_close_)
+      Close();
+    return true;
+  }
+
+  // Keeps the last kWindowSize bytes of input as the dictionary for the next
+  // write, which may have to combine the old window with a short input.
+  void UpdateWindow() {
+    if (in_len_ >= kWindowSize) {
+      window_.assign(in_ + in_len_ - kWindowSize, in_ + in_len_);
+      return;
+    }
+    const size_t keep = window_.size() + in_len_ > kWindowSize ?
+        kWindowSize - in_len_ : window_.size();
+    window_.erase(window_.begin(), window_.end() - keep);
+    window_.insert(window_.end(), in_, in_ + in_len_);
+  }
+
+  void WriteHeader(char* p) const {
+    p[0] = static_cast<char>(GZIP_HEADER_ID1);
+    p[1] = static_cast<char>(GZIP_HEADER_ID2);
+    p[2] = Z_DEFLATED;
+    memset(p + 3, 0, 5);  // No flags, no modification time.
+    // Same extra flags as deflate() writes for the level and strategy.
+    p[8] = level_ == 9 ? 2 :
+        (strategy_ >= Z_HUFFMAN_ONLY || (level_ >= 0 && level_ < 2) ? 4 : 0);
+    p[9] = kOSCode;
+  }
+
+  static void WriteLE32(char* p, uint32_t value) {
+    for (int i = 0; i < 4; i++)
+      p[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+
+  void DiscardBlocks() {
+    for (Block& block : blocks_)
+      free(block.out);
+    blocks_.clear();
+    in_ = nullptr;
+    in_len_ = 0;
+    pins_.Clear();
+  }
+
+  void Error(int err) {
+    Environment* env = this->env();
+    CHECK_EQ(env->context(), env->isolate()->GetCurrentContext());
+
+    // Whatever was compressed is lost, the next write would start a new
+    // member.
+    StartMember();
+    DiscardBlocks();
+
+    HandleScope scope(env->isolate());
+    Local<Value> args[2] = {
+      OneByteString(env->isolate(), zError(err)),
+      Number::New(env->isolate(), err)
+    };
+    MakeCallback(env->onerror_string(), arraysize(args), args);
+
+    // no hope of rescue.
+    if (write_in_progress_)
+      Unref();
+    write_in_progress_ = false;
+    if (pending_close_)
+      Close();
+  }
+
+  void Ref() {
+    if (++refs_ == 1) {
+      ClearWeak();
+    }
+  }
+
+  void Unref() {
+    CHECK_GT(refs_, 0);
+    if (--refs_ == 0) {
+      MakeWeak<ParallelGzip>(this);
+    }
+  }
+
+  static const int kWindowBits = 15;
+  static const size_t kWindowSize = 1 << kWindowBits;
+  static const size_t kFlushMarkerSize = 16;
+  static const size_t kHeaderSize = 10;
+  static const size_t kTrailerSize = 8;
+#ifdef _WIN32
+  static const char kOSCode = 10;  // NTFS
+#else
+  static const char kOSCode = 3;  // Unix
+#endif
+
+  int level_;
+  int mem_level_;
+  int strategy_;
+  size_t block_size_;
+  uLong crc_;
+  uint64_t total_in_;
+  bool header_written_;
+  std::vector<Bytef> window_;
+  // State of the current write.
+  std::vector<Block> blocks_;
+  const Bytef* in_;
+  size_t in_len_;
+  PooledBufferPins pins_;
+  size_t next_block_;
+  size_t pending_blocks_;
+  bool final_;
+  bool write_in_progress_;
+  bool pending_close_;
+  bool closed_;
+  unsigned int refs_;
+};
+
+
+#if NODE_HAVE_BROTLI
+/**
+ * Brotli
+ *
+ * Same interface and threadpool usage as ZCtx, so that lib/zlib.js can drive
+ * it with the same stream code. The flush values are the brotli operations
+ * (BROTLI_OPERATION_PROCESS etc.), which the decoder ignores.
+ */
+class BrotliCtx : public AsyncWrap {
+ public:
+  BrotliCtx(Environment* env, Local<Object> wrap, node_zlib_mode mode)
+      : AsyncWrap(env, wrap, AsyncWrap::PROVIDER_ZLIB),
+        mode_(mode),
+        encoder_(nullptr),
+        decoder_(nullptr),
+        decoder_result_(BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT),
+        failed_(false),
+        flush_(BROTLI_OPERATION_PROCESS),
+        next_in_(nullptr),
+        avail_in_(0),
+        next_out_(nullptr),
+        avail_out_(0),
+        reported_memory_(0),
+        init_done_(false),
+        write_in_progress_(false),
+        pending_close_(false),
+        refs_(0),
+        write_result_(nullptr),
+        one_shot_(false),
+        out_data_(nullptr),
+        out_length_(0),
+        out_too_large_(false) {
+    MakeWeak<BrotliCtx>(this);
+    Wrap(wrap, this);
+  }
+
+
+  ~BrotliCtx() override {
+    CHECK_EQ(false, write_in_progress_ && "write in progress");
+    Close();
+    free(out_data_);
+  }
+
+
+  void Close() {
+    if (write_in_progress_) {
+      pending_close_ = true;
+      return;
+    }
+
+    pending_close_ = false;
+    DestroyInstance();
+    ReportMemory();
+    mode_ = NONE;
+  }
+
+
+  static void Close(const FunctionCallbackInfo<Value>& args) {
+    BrotliCtx* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    ctx->Close();
+  }
+
+
+  static void GetAllocatedBytes(const FunctionCallbackInfo<Value>& args) {
+    BrotliCtx* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    args.GetReturnValue().Set(static_cast<double>(ctx->allocations_.bytes));
+  }
+
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    CHECK(args[0]->IsInt32());
+    node_zlib_mode mode = static_cast<node_zlib_mode>(args[0]->Int32Value());
+    CHECK(mode == BROTLI_ENCODE || mode == BROTLI_DECODE);
+    new BrotliCtx(env, args.This(), mode);
+  }
+
+
+  // init(writeResult, writeCallback)
+  static void Init(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.Length() == 2 && "init(writeResult, writeCallback)");
+    BrotliCtx* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    CHECK_EQ(false, ctx->init_done_ && "init called twice");
+
+    Local<Uint32Array> write_result = args[0].As<Uint32Array>();
+    Local<ArrayBuffer> ab = write_result->Buffer();
+    ctx->write_result_ = static_cast<uint32_t*>(ab->GetContents().Data());
+
+    CHECK(args[1]->IsFunction());
+    ctx->write_js_callback_.Reset(ctx->env()->isolate(),
+                                  args[1].As<Function>());
+
+    ctx->init_done_ = ctx->CreateInstance();
+    ctx->ReportMemory();
+    args.GetReturnValue().Set(ctx->init_done_);
+  }
+
+
+  // params(key, value) sets one of the BROTLI_PARAM_* or
+  // BROTLI_DECODER_PARAM_* parameters and returns whether it was accepted.
+  // The encoder only accepts them before any input has been written. They
+  // are remembered for reset().
+  static void Params(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.Length() == 2 && "params(key, value)");
+    BrotliCtx* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    CHECK(ctx->init_done_ && "params before init");
+    CHECK(args[0]->IsUint32());
+    CHECK(args[1]->IsUint32());
+    const uint32_t key = args[0]->Uint32Value();
+    const uint32_t value = args[1]->Uint32Value();
+
+    const bool ok = ctx->SetParameter(key, value);
+    if (ok)
+      ctx->params_.push_back(std::make_pair(key, value));
+    args.GetReturnValue().Set(ok);
+  }
+
+
+  static void Reset(const FunctionCallbackInfo<Value>& args) {
+    BrotliCtx* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    CHECK(ctx->init_done_ && "reset before init");
+    CHECK_EQ(false, ctx->write_in_progress_ && "write in progress");
+
+    ctx->DestroyInstance();
+    bool ok = ctx->CreateInstance();
+    for (size_t i = 0; ok && i < ctx->params_.size(); i++)
+      ok = ctx->SetParameter(ctx->params_[i].first, ctx->params_[i].second);
+    ctx->ReportMemory();
+    if (!ok)
+      ctx->Error("Failed to reset stream", Z_MEM_ERROR);
+  }
+
+
+  // write(flush, in, in_off, in_len, out, out_off, out_len)
+  template <bool async>
+  static void Write(const FunctionCallbackInfo<Value>& args) {
+    CHECK_EQ(args.Length(), 7);
+
+    BrotliCtx* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    Environment* env = ctx->env();
+    ctx->StartWrite(args);
+
+    CHECK(Buffer::HasInstance(args[4]));
+    Local<Object> out_buf = args[4].As<Object>();
+    const size_t out_off = args[5]->Uint32Value();
+    const size_t out_len = args[6]->Uint32Value();
+    CHECK(Buffer::IsWithinBounds(out_off, out_len, Buffer::Length(out_buf)));
+    ctx->next_out_ =
+        reinterpret_cast<uint8_t*>(Buffer::Data(out_buf) + out_off);
+    ctx->avail_out_ = out_len;
+    ctx->one_shot_ = false;
+
+    if (!async) {
+      env->PrintSyncTrace();
+      Process(&ctx->work_req_);
+      ctx->ReportMemory();
+      if (ctx->CheckError()) {
+        ctx->write_result_[0] = ctx->avail_out_;
+        ctx->write_result_[1] = ctx->avail_in_;
+        ctx->write_in_progress_ = false;
+        ctx->Unref();
+      }
+      return;
+    }
+
+    SizeClassAllocator* size_classes = env->isolate_data()->size_classes();
+    if (ctx->next_in_ != nullptr)
+      ctx->pins_.Pin(size_classes, ctx->next_in_);
+    ctx->pins_.Pin(size_classes, ctx->next_out_);
+    uv_queue_work(env->event_loop(),
+                  &ctx->work_req_,
+                  BrotliCtx::Process,
+                  BrotliCtx::After);
+  }
+
+
+  // writeAll(flush, in, in_off, in_len), see ZCtx::WriteAll().
+  template <bool async>
+  static void WriteAll(const FunctionCallbackInfo<Value>& args) {
+    CHECK_EQ(args.Length(), 4);
+
+    BrotliCtx* ctx;
+    ASSIGN_OR_RETURN_UNWRAP(&ctx, args.Holder());
+    Environment* env = ctx->env();
+    ctx->StartWrite(args);
+
+    ctx->next_out_ = nullptr;
+    ctx->avail_out_ = 0;
+    ctx->one_shot_ = true;
+    ctx->out_too_large_ = false;
+
+    if (!async) {
+      env->PrintSyncTrace();
+      Process(&ctx->work_req_);
+      ctx->ReportMemory();
+      if (!ctx->CheckError()) {
+        ctx->DiscardOutput();
+        return;
+      }
+      ctx->write_result_[0] = ctx->avail_out_;
+      ctx->write_result_[1] = ctx->avail_in_;
+      ctx->write_in_progress_ = false;
+      args.GetReturnValue().Set(ctx->TakeOutput());
+      ctx->Unref();
+      return;
+    }
+
+    if (ctx->next_in_ != nullptr)
+      ctx->pins_.Pin(env->isolate_data()->size_classes(), ctx->next_in_);
+    uv_queue_work(env->event_loop(),
+                  &ctx->work_req_,
+                  BrotliCtx::Process,
+                  BrotliCtx::After);
+  }
+
+  size_t self_size() const override {
+    return sizeof(*this) + allocations_.bytes;
+  }
+
+ private:
+  bool CreateInstance() {
+    if (mode_ == BROTLI_ENCODE) {
+      encoder_ = BrotliEncoderCreateInstance(zlib::AllocationCounter::Alloc,
+                                             zlib::AllocationCounter::Free,
+                                             &allocations_);
+    } else {
+      decoder_ = BrotliDecoderCreateInstance(zlib::AllocationCounter::Alloc,
+                                             zlib::AllocationCounter::Free,
+                                             &allocations_);
+    }
+    decoder_result_ = BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT;
+    failed_ = false;
+    return encoder_ != nullptr || decoder_ != nullptr;
+  }
+
+  void DestroyInstance() {
+    if (encoder_ != nullptr)
+      BrotliEncoderDestroyInstance(encoder_);
+    if (decoder_ != nullptr)
+      BrotliDecoderDestroyInstance(decoder_);
+    encoder_ = nullptr;
+    decoder_ = nullptr;
+  }
+
+  // See ZCtx::ReportMemory().
+  void ReportMemory() {
+    const int64_t change = static_cast<int64_t>(allocations_.bytes) -
+                           static_cast<int64_t>(reported_memory_);
+    if (change != 0) {
+      env()->isolate()->AdjustAmountOfExternalAllocatedMemory(change);
+      reported_memory_ = allocations_.bytes;
+    }
+  }
+
+  bool SetParameter(uint32_t key, uint32_t value) {
+    if (encoder_ != nullptr) {
+      return BrotliEncoderSetParameter(
+          encoder_, static_cast<BrotliEncoderParameter>(key), value);
+    }
+    if (decoder_ != nullptr) {
+      return BrotliDecoderSetParameter(
+          decoder_, static_cast<BrotliDecoderParameter>(key), value);
+    }
+    return false;
+  }
+
+  // Checks the state and picks up the flush value and input of a write() or
+  // writeAll() call.
+  void StartWrite(const FunctionCallbackInfo<Value>& args) {
+    CHECK(init_done_ && "write before init");
+    CHECK(mode_ != NONE && "already finalized");
+    CHECK_EQ(false, write_in_progress_ && "write already in progress");
+    CHECK_EQ(false, pending_close_ && "close is pending");
+
+    const unsigned int flush = args[0]->Uint32Value();
+    CHECK_LE(flush, BROTLI_OPERATION_EMIT_METADATA);
+    flush_ = static_cast<BrotliEncoderOperation>(flush);
+
+    if (args[1]->IsNull()) {
+      next_in_ = nullptr;
+      avail_in_ = 0;
+    } else {
+      CHECK(Buffer::HasInstance(args[1]));
+      Local<Object> in_buf = args[1].As<Object>();
+      const size_t in_off = args[2]->Uint32Value();
+      const size_t in_len = args[3]->Uint32Value();
+      CHECK(Buffer::IsWithinBounds(in_off, in_len, Buffer::Length(in_buf)));
+      next_in_ = reinterpret_cast<uint8_t*>(Buffer::Data(in_buf) + in_off);
+      avail_in_ = in_len;
+    }
+
+    write_in_progress_ = true;
+    Ref();
+  }
+
+  // thread pool!
+  static void Process(uv_work_t* work_req) {
+    BrotliCtx* ctx = ContainerOf(&BrotliCtx::work_req_, work_req);
+    if (ctx->one_shot_)
+      ctx->ProcessAll();
+    else
+      ctx->ProcessChunk();
+  }
+
+  void ProcessChunk() {
+    const uint8_t* next_in = next_in_;
+    if (mode_ == BROTLI_ENCODE) {
+      failed_ = !BrotliEncoderCompressStream(encoder_,
+                                             flush_,
+                                             &avail_in_,
+                                             &next_in,
+                                             &avail_out_,
+                                             &next_out_,
+                                             nullptr);
+    } else {
+      decoder_result_ = BrotliDecoderDecompressStream(decoder_,
+                                                      &avail_in_,
+                                                      &next_in,
+                                                      &avail_out_,
+                                                      &next_out_,
+                                                      nullptr);
+      failed_ = decoder_result_ == BROTLI_DECODER_RESULT_ERROR;
+    }
+    next_in_ = const_cast<uint8_t*>(next_in);
+  }
+
+  // Like ZCtx::ProcessAll().
+  void ProcessAll() {
+    size_t capacity;
+    if (mode_ == BROTLI_ENCODE) {
+      capacity = BrotliEncoderMaxCompressedSize(avail_in_);
+    } else {
+      capacity = avail_in_ * 4;
+      if (capacity > kMaxOneShotDecodeGuess)
+        capacity = kMaxOneShotDecodeGuess;
+    }
+    if (capacity < kMinOneShotOutput)
+      capacity = kMinOneShotOutput;
+    if (capacity > Buffer::kMaxLength)
+      capacity = Buffer::kMaxLength;
+
+    char* data = nullptr;
+    size_t length = 0;
+    for (;;) {
+      char* grown = UncheckedRealloc(data, capacity);
+      if (grown == nullptr) {
+        failed_ = true;
+        break;
+      }
+      data = grown;
+      next_out_ = reinterpret_cast<uint8_t*>(data + length);
+      avail_out_ = capacity - length;
+
+      ProcessChunk();
+      length = capacity - avail_out_;
+      if (failed_ || avail_out_ != 0)
+        break;
+
+      if (capacity == Buffer::kMaxLength) {
+        out_too_large_ = true;
+        break;
+      }
+      capacity = capacity > Buffer::kMaxLength / 2 ?
+          Buffer::kMaxLength : capacity * 2;
+    }
+
+    if (length > 0 && length < capacity && !out_too_large_) {
+      if (char* shrunk = UncheckedRealloc(data, length))
+        data = shrunk;
+    }
+    out_data_ = data;
+    out_length_ = length;
+  }
+
+  Local<Value> TakeOutput() {
+    if (out_too_large_) {
+      DiscardOutput();
+      return Undefined(env()->isolate());
+    }
+    Local<Object> buffer;
+    if (out_length_ == 0) {
+      DiscardOutput();
+      buffer = Buffer::New(env(), static_cast<size_t>(0)).ToLocalChecked();
+    } else {
+      buffer = Buffer::New(env(), out_data_, out_length_).ToLocalChecked();
+      out_data_ = nullptr;
+      out_length_ = 0;
+    }
+    return buffer;
+  }
+
+  void DiscardOutput() {
+    free(out_data_);
+    out_data_ = nullptr;
+    out_length_ = 0;
+  }
+
+  bool CheckError() {
+    if (mode_ == BROTLI_ENCODE) {
+      if (failed_) {
+        Error("Compression failed", Z_STREAM_ERROR);
+        return false;
+      }
+      return true;
+    }
+
+    if (failed_ && decoder_result_ != BROTLI_DECODER_RESULT_ERROR) {
+      Error("Out of memory", Z_MEM_ERROR);
+      return false;
+    }
+    if (failed_) {
+      // The error numbers overlap with zlib's, hence the separate code.
+      const BrotliDecoderErrorCode code = BrotliDecoderGetErrorCode(decoder_);
+      std::string message = "Decompression failed: ";
+      message += BrotliDecoderErrorString(code);
+      Error(message.c_str(), code, "BROTLI_DECODER_ERROR");
+      return false;
+    }
+    if (flush_ == BROTLI_OPERATION_FINISH &&
+        decoder_result_ == BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT) {
+      Error("unexpected end of file", Z_BUF_ERROR);
+      return false;
+    }
+    return true;
+  }
+
+  // v8 land!
+  static void After(uv_work_t* work_req, int status) {
+    CHECK_EQ(status, 0);
+
+    BrotliCtx* ctx = ContainerOf(&BrotliCtx::work_req_, work_req);
+    Environment* env = ctx->env();
+    ctx->pins_.Clear();
+
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+
+    ctx->ReportMemory();
+    if (!ctx->CheckError()) {
+      ctx->DiscardOutput();
+      return;
+    }
+
+    ctx->write_result_[0] = ctx->avail_out_;
+    ctx->write_result_[1] = ctx->avail_in_;
+    ctx->write_in_progress_ = false;
+
+    if (ctx->one_shot_) {
+      Local<Value> output = ctx->TakeOutput();
+      ctx->MakeCallback(env->oncomplete_string(), 1, &output);
+    } else {
+      Local<Function> cb = PersistentToLocal(env->isolate(),
+                                             ctx->write_js_callback_);
+      ctx->MakeCallback(cb, 0, nullptr);
+    }
+
+    ctx->Unref();
+    if (ctx->pending_close_)
+      ctx->Close();
+  }
+
+  // Calls onerror(message, errno, code). Without a code, the JS side looks
+  // up the name of the zlib error number.
+  void Error(const char* message, int err, const char* code = nullptr) {
+    Environment* env = this->env();
+
+    // If you hit this assertion, you forgot to enter the v8::Context first.
+    CHECK_EQ(env->context(), env->isolate()->GetCurrentContext());
+
+    HandleScope scope(env->isolate());
+    Local<Value> args[3] = {
+      OneByteString(env->isolate(), message),
+      Number::New(env->isolate(), err),
+      code == nullptr ?
+          Undefined(env->isolate()).As<Value>() :
+          OneByteString(env->isolate(), code).As<Value>()
+    };
+    MakeCallback(env->onerror_string(), arraysize(args), args);
+
+    // no hope of rescue.
+    if (write_in_progress_)
+      Unref();
+    write_in_progress_ = false;
+    if (pending_close_)
+      Close();
+  }
+
+  void Ref() {
+    if (++refs_ == 1) {
+      ClearWeak();
+    }
+  }
+
+  void Unref() {
+    CHECK_GT(refs_, 0);
+    if (--refs_ == 0) {
+      MakeWeak<BrotliCtx>(this);
+    }
+  }
+
+  static const size_t kMinOneShotOutput = 16384;
+  static const size_t kMaxOneShotDecodeGuess = 64 * 1024 * 1024;
+
+  node_zlib_mode mode_;
+  BrotliEncoderState* encoder_;
+  BrotliDecoderState* decoder_;
+  BrotliDecoderResult decoder_result_;
+  bool failed_;
+  BrotliEncoderOperation flush_;
+  uint8_t* next_in_;
+  size_t avail_in_;
+  uint8_t* next_out_;
+  size_t avail_out_;
+  // The input and output of the write on the threadpool.
+  PooledBufferPins pins_;
+  std::vector<std::pair<uint32_t, uint32_t>> params_;
+  zlib::AllocationCounter allocations_;
+  size_t reported_memory_;
+  bool init_done_;
+  uv_work_t work_req_;
+  bool write_in_progress_;
+  bool pending_close_;
+  unsigned int refs_;
+  uint32_t* write_result_;
+  Persistent<Function> write_js_callback_;
+  // State of a writeAll() call.
+  bool one_shot_;
+  char* out_data_;
+  size_t out_length_;
+  bool out_too_large_;
+};
+#endif  // NODE_HAVE_BROTLI
+
+
+// crc32(data, value) continues the CRC32 checksum |value| with |data|, which is
+// either an ArrayBufferView or a string that is checksummed as UTF-8.
+void CRC32(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsArrayBufferView() || args[0]->IsString());
+  CHECK(args[1]->IsUint32());
+  uLong value = args[1]->Uint32Value();
+
+  if (args[0]->IsArrayBufferView()) {
+    const size_t length = Buffer::Length(args[0]);
+    // An empty view may not have any memory behind it, and crc32() treats a
+    // null pointer as a request for the initial value.
+    if (length > 0) {
+      value = crc32(value,
+                    reinterpret_cast<const Bytef*>(Buffer::Data(args[0])),
+                    length);
+    }
+  } else {
+    Utf8Value data(args.GetIsolate(), args[0]);
+    value = crc32(value, reinterpret_cast<const Bytef*>(*data), data.length());
+  }
+
+  args.GetReturnValue().Set(static_cast<uint32_t>(value));
+}
+
+
+void InitZlib(Local<Object> target,
+              Local<Value> unused,
+              Local<Context> context,
+              void* priv) {
+  Environment* env = Environment::GetCurrent(context);
+
+  env->set_zlib_state_pool(new zlib::StatePool(env->isolate()));
+  env->AtExit([](void* arg) {
+    Environment* env = static_cast<Environment*>(arg);
+    delete env->zlib_state_pool();
+    env->set_zlib_state_pool(nullptr);
+  }, env);
+
+  Local<FunctionTemplate> z = env->NewFunctionTemplate(ZCtx::New);
+
+  z->InstanceTemplate()->SetInternalFieldCount(1);
+
+  AsyncWrap::AddWrapMethods(env, z);
+  env->SetProtoMethod(z, "write", ZCtx::Write<true>);
+  env->SetProtoMethod(z, "writeSync", ZCtx::Write<false>);
+  env->SetProtoMethod(z, "writeAll", ZCtx::WriteAll<true>);
+  env->SetProtoMethod(z, "writeAllSync", ZCtx::WriteAll<false>);
+  env->SetProtoMethod(z, "init", ZCtx::Init);
+  env->SetProtoMethod(z, "close", ZCtx::Close);
+  env->SetProtoMethod(z, "params", ZCtx::Params);
+  env->SetProtoMethod(z, "reset", ZCtx::Reset);
+  env->SetProtoMethod(z, "getAllocatedBytes", ZCtx::GetAllocatedBytes);
+
+  Local<String> zlibString = FIXED_ONE_BYTE_STRING(env->isolate(), "Zlib");
+  z->SetClassName(zlibString);
+  target->Set(zlibString, z->GetFunction());
+
+  Local<FunctionTemplate> pgz = env->NewFunctionTemplate(ParallelGzip::New);
+  pgz->InstanceTemplate()->SetInternalFieldCount(1);
+  AsyncWrap::AddWrapMethods(env, pgz);
+  env->SetProtoMethod(pgz, "writeAll", ParallelGzip::WriteAll<true>);
+  env->SetProtoMethod(pgz, "writeAllSync", ParallelGzip::WriteAll<false>);
+  env->SetProtoMethod(pgz, "close", ParallelGzip::Close);
+  env->SetProtoMethod(pgz, "params", ParallelGzip::Params);
+  env->SetProtoMethod(pgz, "reset", ParallelGzip::Reset);
+  env->SetProtoMethod(pgz, "getAllocatedBytes",
+                      ParallelGzip::GetAllocatedBytes);
+  Local<String> pgzString =
+      FIXED_ONE_BYTE_STRING(env->isolate(), "ParallelGzip");
+  pgz->SetClassName(pgzString);
+  target->Set(pgzString, pgz->GetFunction());
+
+#if NODE_HAVE_BROTLI
+  Local<FunctionTemplate> b = env->NewFunctionTemplate(BrotliCtx::New);
+  b->InstanceTemplate()->SetInternalFieldCount(1);
+  AsyncWrap::AddWrapMethods(env, b);
+  env->SetProtoMethod(b, "write", BrotliCtx::Write<true>);
+  env->SetProtoMethod(b, "writeSync", BrotliCtx::Write<false>);
+  env->SetProtoMethod(b, "writeAll", BrotliCtx::WriteAll<true>);
+  env->SetProtoMethod(b, "writeAllSync", BrotliCtx::WriteAll<false>);
+  env->SetProtoMethod(b, "init", BrotliCtx::Init);
+  env->SetProtoMethod(b, "close", BrotliCtx::Close);
+  env->SetProtoMethod(b, "params", BrotliCtx::Params);
+  env->SetProtoMethod(b, "reset", BrotliCtx::Reset);
+  env->SetProtoMethod(b, "getAllocatedBytes", BrotliCtx::GetAllocatedBytes);
+  Local<String> brotliString =
+      FIXED_ONE_BYTE_STRING(env->isolate(), "BrotliCtx");
+  b->SetClassName(brotliString);
+  target->Set(brotliString, b->GetFunction());
+#endif  // NODE_HAVE_BROTLI
+
+  // Getting the initial value also lets the bundled zlib select the SIMD
+  // implementations the CPU supports, before the first stream is created.
+  crc32(0L, Z_NULL, 0);
+  env->SetMethod(target, "crc32", CRC32);
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "ZLIB_VERSION"),
               FIXED_ONE_BYTE_STRING(env->isolate(), ZLIB_VERSION));
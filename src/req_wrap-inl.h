@@ -32,6 +32,17 @@ void ReqWrap<T>::Dispatched() {
   req_.data = this;
 }
 
+template <typename T>
+void ReqWrap<T>::Unqueue() {
+  req_wrap_queue_.Remove();
+}
+
+template <typename T>
+void ReqWrap<T>::Requeue() {
+  CHECK(req_wrap_queue_.IsEmpty());
+  env()->req_wrap_queue()->PushBack(reinterpret_cast<ReqWrap<uv_req_t>*>(this));
+}
+
 template <typename T>
 ReqWrap<T>* ReqWrap<T>::from_req(T* req) {
   return ContainerOf(&ReqWrap<T>::req_, req);
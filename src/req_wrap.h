@@ -18,6 +18,10 @@ class ReqWrap : public AsyncWrap {
                  AsyncWrap::ProviderType provider);
   inline ~ReqWrap() override;
   inline void Dispatched();  // Call this after the req has been dispatched.
+  // Pooled requests leave the environment's request queue while they sit
+  // idle so that they don't show up in process._getActiveRequests().
+  inline void Unqueue();
+  inline void Requeue();
   T* req() { return &req_; }
 
   static ReqWrap* from_req(T* req);
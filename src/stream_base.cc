@@ -151,6 +151,10 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
 
   StreamWriteResult res = Write(*bufs, count, nullptr, req_wrap_obj);
   req_wrap_obj->Set(env->bytes_string(), Number::New(env->isolate(), bytes));
+  if (res.wrap != nullptr) {
+    for (size_t i = 0; i < count; i++)
+      res.wrap->PinBuffer(env->isolate_data()->size_classes(), bufs[i].base);
+  }
   if (res.wrap != nullptr && storage) {
     res.wrap->SetAllocatedStorage(storage.release(), storage_size);
   }
@@ -174,10 +178,13 @@ int StreamBase::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   buf.base = Buffer::Data(args[1]);
   buf.len = Buffer::Length(args[1]);
 
+  const char* data = buf.base;
   StreamWriteResult res = Write(&buf, 1, nullptr, req_wrap_obj);
 
-  if (res.async)
+  if (res.async) {
+    res.wrap->PinBuffer(env->isolate_data()->size_classes(), data);
     req_wrap_obj->Set(env->context(), env->buffer_string(), args[1]).FromJust();
+  }
   req_wrap_obj->Set(env->context(), env->bytes_string(),
                     Integer::NewFromUnsigned(env->isolate(), buf.len))
       .FromJust();
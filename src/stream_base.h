@@ -7,6 +7,7 @@
 #include "async_wrap.h"
 #include "req_wrap-inl.h"
 #include "node.h"
+#include "node_buffer_allocator.h"
 #include "util.h"
 
 #include "v8.h"
@@ -69,6 +70,11 @@ class WriteWrap : public StreamReq {
   char* Storage();
   size_t StorageSize() const;
   void SetAllocatedStorage(char* data, size_t size);
+  // Keeps Buffer.pool memory that is being written from being recycled by
+  // Buffer.pool.release() before the write is done.
+  void PinBuffer(SizeClassAllocator* allocator, const void* data) {
+    pins_.Pin(allocator, data);
+  }
 
   WriteWrap(StreamBase* stream,
             v8::Local<v8::Object> req_wrap_obj)
@@ -83,6 +89,7 @@ class WriteWrap : public StreamReq {
  private:
   char* storage_ = nullptr;
   size_t storage_size_ = 0;
+  PooledBufferPins pins_;
 };
 
 
@@ -24,13 +24,7 @@ MaybeLocal<String> MakeString(Isolate* isolate,
                               enum encoding encoding) {
   Local<Value> error;
   MaybeLocal<Value> ret;
-  if (encoding == UTF8) {
-    return String::NewFromUtf8(
-        isolate,
-        data,
-        v8::NewStringType::kNormal,
-        length);
-  } else if (encoding == UCS2) {
+  if (encoding == UCS2) {
 #ifdef DEBUG
     CHECK_EQ(reinterpret_cast<uintptr_t>(data) % 2, 0);
     CHECK_EQ(length % 2, 0);
@@ -41,6 +35,8 @@ MaybeLocal<String> MakeString(Isolate* isolate,
         length / 2,
         &error);
   } else {
+    // For UTF-8 this skips the V8 decoder for pure ASCII data, which is
+    // copied straight into a one-byte string (an external one if large).
     ret = StringBytes::Encode(
         isolate,
         data,
@@ -67,6 +63,20 @@ MaybeLocal<String> StringDecoder::DecodeData(Isolate* isolate,
                                              const char* data,
                                              size_t* nread_ptr) {
   Local<String> prepend, body;
+  if (!DecodePieces(isolate, data, nread_ptr, &prepend, &body))
+    return MaybeLocal<String>();
+  if (prepend.IsEmpty())
+    return body;
+  return String::Concat(prepend, body);
+}
+
+bool StringDecoder::DecodePieces(Isolate* isolate,
+                                 const char* data,
+                                 size_t* nread_ptr,
+                                 Local<String>* prepend_ptr,
+                                 Local<String>* body_ptr) {
+  Local<String>& prepend = *prepend_ptr;
+  Local<String>& body = *body_ptr;
 
   size_t nread = *nread_ptr;
 
@@ -117,7 +127,7 @@ MaybeLocal<String> StringDecoder::DecodeData(Isolate* isolate,
                         IncompleteCharacterBuffer(),
                         BufferedBytes(),
                         Encoding()).ToLocal(&prepend)) {
-          return MaybeLocal<String>();
+          return false;
         }
 
         *nread_ptr += BufferedBytes();
@@ -217,20 +227,16 @@ MaybeLocal<String> StringDecoder::DecodeData(Isolate* isolate,
 
       if (nread > 0) {
         if (!MakeString(isolate, data, nread, Encoding()).ToLocal(&body))
-          return MaybeLocal<String>();
+          return false;
       } else {
         body = String::Empty(isolate);
       }
     }
 
-    if (prepend.IsEmpty()) {
-      return body;
-    } else {
-      return String::Concat(prepend, body);
-    }
+    return true;
   } else {
     CHECK(Encoding() == ASCII || Encoding() == HEX || Encoding() == LATIN1);
-    return MakeString(isolate, data, nread, Encoding());
+    return MakeString(isolate, data, nread, Encoding()).ToLocal(&body);
   }
 }
 
@@ -274,6 +280,33 @@ void DecodeData(const FunctionCallbackInfo<Value>& args) {
     args.GetReturnValue().Set(ret.ToLocalChecked());
 }
 
+// decodeInto(decoder, buf, rope) appends the decoded pieces of `buf` to the
+// `rope` array instead of concatenating them, and returns the new length of
+// `rope`.
+void DecodeInto(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  StringDecoder* decoder =
+      reinterpret_cast<StringDecoder*>(Buffer::Data(args[0]));
+  CHECK_NE(decoder, nullptr);
+  CHECK(args[2]->IsArray());
+  Local<Array> rope = args[2].As<Array>();
+  size_t nread = Buffer::Length(args[1]);
+  Local<String> pieces[2];
+  if (!decoder->DecodePieces(env->isolate(), Buffer::Data(args[1]), &nread,
+                             &pieces[0], &pieces[1])) {
+    return;
+  }
+  uint32_t length = rope->Length();
+  for (const Local<String>& piece : pieces) {
+    if (piece.IsEmpty() || piece->Length() == 0)
+      continue;
+    if (rope->Set(env->context(), length, piece).IsNothing())
+      return;
+    length++;
+  }
+  args.GetReturnValue().Set(length);
+}
+
 void FlushData(const FunctionCallbackInfo<Value>& args) {
   StringDecoder* decoder =
       reinterpret_cast<StringDecoder*>(Buffer::Data(args[0]));
@@ -323,6 +356,7 @@ void InitializeStringDecoder(Local<Object> target,
               Integer::New(isolate, sizeof(StringDecoder))).FromJust();
 
   env->SetMethod(target, "decode", DecodeData);
+  env->SetMethod(target, "decodeInto", DecodeInto);
   env->SetMethod(target, "flush", FlushData);
 }
 
@@ -25,6 +25,15 @@ class StringDecoder {
   v8::MaybeLocal<v8::String> DecodeData(v8::Isolate* isolate,
                                         const char* data,
                                         size_t* nread);
+  // Like DecodeData(), but leaves the string that finishes a character from
+  // the previous chunk (if any) in `prepend` and the rest in `body` instead
+  // of concatenating the two. Returns false if an exception is pending.
+  bool DecodePieces(v8::Isolate* isolate,
+                    const char* data,
+                    size_t* nread,
+                    v8::Local<v8::String>* prepend,
+                    v8::Local<v8::String>* body);
+
   // Flush an incomplete character. For character encodings like UTF8 this
   // means printing replacement characters, buf for e.g. Base64 the returned
   // string contains more data.
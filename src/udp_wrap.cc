@@ -22,16 +22,35 @@
 #include "udp_wrap.h"
 #include "env-inl.h"
 #include "node_buffer.h"
+#include "node_buffer_allocator.h"
 #include "handle_wrap.h"
 #include "req_wrap-inl.h"
 #include "util-inl.h"
 
+#include <errno.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <netinet/udp.h>
+#include <sys/uio.h>  // UIO_MAXIOV
+
+// Not defined by older C libraries.
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif  // __linux__
 
 
 namespace node {
 
 using v8::Array;
+using v8::ArrayBuffer;
 using v8::Context;
 using v8::EscapableHandleScope;
 using v8::FunctionCallbackInfo;
@@ -44,11 +63,24 @@ using v8::PropertyAttribute;
 using v8::Signature;
 using v8::String;
 using v8::Uint32;
+using v8::Uint32Array;
 using v8::Undefined;
 using v8::Value;
 
 using AsyncHooks = Environment::AsyncHooks;
 
+// The default and largest maximum datagram size.
+static const size_t kMaxDatagramSize = 64 * 1024;
+// Received datagrams are sliced out of chunks of this size, which hold a few
+// datagrams of the largest size or a few thousand small ones. One chunk at a
+// time is filled per Environment, see UDPRecvPool.
+static const size_t kRecvPoolSize = 256 * 1024;
+// The most datagrams a single recvmmsg() call takes.
+static const unsigned int kMaxRecvBatchSize = 1024;
+// The most memory a socket sets aside for batched reads. Sockets that receive
+// large datagrams read fewer of them at a time instead.
+static const size_t kMaxRecvSlotMemory = 2 * 1024 * 1024;
+
 
 class SendWrap : public ReqWrap<uv_udp_send_t> {
  public:
@@ -56,6 +88,10 @@ class SendWrap : public ReqWrap<uv_udp_send_t> {
   ~SendWrap();
   inline bool have_callback() const;
   size_t msg_size;
+  // The outcome of a datagram that was sent without uv_udp_send().
+  int status;
+  // The Buffer.pool memory of datagrams that libuv has queued.
+  PooledBufferPins pins;
   size_t self_size() const override { return sizeof(*this); }
  private:
   const bool have_callback_;
@@ -66,6 +102,7 @@ SendWrap::SendWrap(Environment* env,
                    Local<Object> req_wrap_obj,
                    bool have_callback)
     : ReqWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_UDPSENDWRAP),
+      status(0),
       have_callback_(have_callback) {
   Wrap(req_wrap_obj, this);
 }
@@ -87,11 +124,167 @@ static void NewSendWrap(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// The request behind a sendBatch() call. Datagrams that cannot be sent right
+// away are queued with a uv_udp_send() request each, the first one being
+// req(). The callback runs once all of them have completed, and reports the
+// first error if any datagram could not be sent.
+class SendBatchWrap : public ReqWrap<uv_udp_send_t> {
+ public:
+  SendBatchWrap(Environment* env,
+                Local<Object> req_wrap_obj,
+                bool have_callback,
+                size_t count);
+  ~SendBatchWrap();
+  uv_udp_send_t* NextReq();
+  void SetStatus(int status);
+  void Finish();
+  static void OnSend(uv_udp_send_t* req, int status);
+  size_t msg_size;
+  size_t pending;
+  // The Buffer.pool memory of datagrams that libuv has queued.
+  PooledBufferPins pins;
+  size_t self_size() const override { return sizeof(*this); }
+ private:
+  const bool have_callback_;
+  const size_t count_;
+  int status_ = 0;
+  size_t next_req_ = 0;
+  std::unique_ptr<uv_udp_send_t[]> extra_reqs_;
+};
+
+
+SendBatchWrap::SendBatchWrap(Environment* env,
+                             Local<Object> req_wrap_obj,
+                             bool have_callback,
+                             size_t count)
+    : ReqWrap(env, req_wrap_obj, AsyncWrap::PROVIDER_UDPSENDWRAP),
+      msg_size(0),
+      pending(0),
+      have_callback_(have_callback),
+      count_(count) {
+  Wrap(req_wrap_obj, this);
+}
+
+
+SendBatchWrap::~SendBatchWrap() {
+  ClearWrap(object());
+}
+
+
+uv_udp_send_t* SendBatchWrap::NextReq() {
+  if (next_req_++ == 0)
+    return req();
+  if (!extra_reqs_)
+    extra_reqs_.reset(new uv_udp_send_t[count_ - 1]);
+  uv_udp_send_t* req = &extra_reqs_[next_req_ - 2];
+  req->data = this;
+  return req;
+}
+
+
+// Records the outcome of a datagram that was sent or failed to be.
+void SendBatchWrap::SetStatus(int status) {
+  if (status != 0 && status_ == 0)
+    status_ = status;
+}
+
+
+void SendBatchWrap::Finish() {
+  if (have_callback_) {
+    Environment* env = this->env();
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Value> arg[] = {
+      Integer::New(env->isolate(), status_),
+      Integer::New(env->isolate(), msg_size),
+    };
+    MakeCallback(env->oncomplete_string(), arraysize(arg), arg);
+  }
+  delete this;
+}
+
+
+void SendBatchWrap::OnSend(uv_udp_send_t* req, int status) {
+  SendBatchWrap* req_wrap = static_cast<SendBatchWrap*>(req->data);
+  req_wrap->SetStatus(status);
+  if (--req_wrap->pending == 0)
+    req_wrap->Finish();
+}
+
+
+// Converts an IP address and port of the given family to a sockaddr.
+static int ToSockAddr(int family,
+                      const char* address,
+                      unsigned short port,
+                      sockaddr_storage* addr) {
+  switch (family) {
+  case AF_INET:
+    return uv_ip4_addr(address, port, reinterpret_cast<sockaddr_in*>(addr));
+  case AF_INET6:
+    return uv_ip6_addr(address, port, reinterpret_cast<sockaddr_in6*>(addr));
+  default:
+    CHECK(0 && "unexpected address family");
+    ABORT();
+  }
+}
+
+
+static socklen_t SockAddrLength(const sockaddr_storage* addr) {
+  return addr->ss_family == AF_INET6 ? sizeof(sockaddr_in6) :
+                                       sizeof(sockaddr_in);
+}
+
+
+#ifdef __linux__
+// Sends as many of the datagrams as the socket accepts without blocking, with
+// one sendmmsg() call per UIO_MAXIOV of them. Datagrams that fail with
+// anything but EAGAIN are skipped. Returns the number of datagrams that were
+// dealt with, the first error is passed to |req_wrap|. Connected sockets pass
+// no |addrs|.
+static size_t SendMany(int fd,
+                       uv_buf_t* bufs,
+                       sockaddr_storage* addrs,
+                       size_t count,
+                       SendBatchWrap* req_wrap) {
+  MaybeStackBuffer<mmsghdr, 16> msgs(count);
+  for (size_t i = 0; i < count; i++) {
+    memset(&msgs[i], 0, sizeof(msgs[i]));
+    if (addrs != nullptr) {
+      msgs[i].msg_hdr.msg_name = &addrs[i];
+      msgs[i].msg_hdr.msg_namelen = SockAddrLength(&addrs[i]);
+    }
+    msgs[i].msg_hdr.msg_iov = reinterpret_cast<iovec*>(&bufs[i]);
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  size_t done = 0;
+  while (done < count) {
+    unsigned int vlen = std::min<size_t>(count - done, UIO_MAXIOV);
+    int r;
+    do {
+      r = sendmmsg(fd, &msgs[done], vlen, 0);
+    } while (r == -1 && errno == EINTR);
+
+    if (r == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+        break;
+      // Only the first datagram fails like this, the others are sent otherwise.
+      req_wrap->SetStatus(-errno);
+      r = 1;
+    }
+    done += r;
+  }
+  return done;
+}
+#endif  // __linux__
+
+
 UDPWrap::UDPWrap(Environment* env, Local<Object> object)
     : HandleWrap(env,
                  object,
                  reinterpret_cast<uv_handle_t*>(&handle_),
-                 AsyncWrap::PROVIDER_UDPWRAP) {
+                 AsyncWrap::PROVIDER_UDPWRAP),
+      max_datagram_size_(kMaxDatagramSize) {
   int r = uv_udp_init(env->event_loop(), &handle_);
   CHECK_EQ(r, 0);  // can't fail anyway
 }
@@ -102,6 +295,12 @@ void UDPWrap::Initialize(Local<Object> target,
                          Local<Context> context) {
   Environment* env = Environment::GetCurrent(context);
 
+  UDPRecvPool* recv_pool = new UDPRecvPool(env);
+  env->set_udp_recv_pool(recv_pool);
+  env->AtExit([](void* arg) {
+    delete static_cast<UDPRecvPool*>(arg);
+  }, recv_pool);
+
   Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
   t->InstanceTemplate()->SetInternalFieldCount(1);
   Local<String> udpString =
@@ -127,12 +326,20 @@ void UDPWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "bind", Bind);
   env->SetProtoMethod(t, "send", Send);
   env->SetProtoMethod(t, "bind6", Bind6);
+  env->SetProtoMethod(t, "connect", Connect);
+  env->SetProtoMethod(t, "connect6", Connect6);
+  env->SetProtoMethod(t, "disconnect", Disconnect);
   env->SetProtoMethod(t, "send6", Send6);
+  env->SetProtoMethod(t, "sendBatch", SendBatch);
+  env->SetProtoMethod(t, "sendBatch6", SendBatch6);
   env->SetProtoMethod(t, "close", Close);
   env->SetProtoMethod(t, "recvStart", RecvStart);
   env->SetProtoMethod(t, "recvStop", RecvStop);
+  env->SetProtoMethod(t, "setRecvBatchSize", SetRecvBatchSize);
+  env->SetProtoMethod(t, "setMaxDatagramSize", SetMaxDatagramSize);
   env->SetProtoMethod(t, "getsockname",
                       GetSockOrPeerName<UDPWrap, uv_udp_getsockname>);
+  env->SetProtoMethod(t, "getpeername", GetPeerName);
   env->SetProtoMethod(t, "addMembership", AddMembership);
   env->SetProtoMethod(t, "dropMembership", DropMembership);
   env->SetProtoMethod(t, "setMulticastInterface", SetMulticastInterface);
@@ -140,6 +347,8 @@ void UDPWrap::Initialize(Local<Object> target,
   env->SetProtoMethod(t, "setMulticastLoopback", SetMulticastLoopback);
   env->SetProtoMethod(t, "setBroadcast", SetBroadcast);
   env->SetProtoMethod(t, "setTTL", SetTTL);
+  env->SetProtoMethod(t, "setGSO", SetGSO);
+  env->SetProtoMethod(t, "setGRO", SetGRO);
   env->SetProtoMethod(t, "bufferSize", BufferSize);
 
   env->SetProtoMethod(t, "ref", HandleWrap::Ref);
@@ -340,22 +549,38 @@ void UDPWrap::DoSend(const FunctionCallbackInfo<Value>& args, int family) {
                           args.Holder(),
                           args.GetReturnValue().Set(UV_EBADF));
 
-  // send(req, list, list.length, port, address, hasCallback)
+  // send(req, list, list.length, port, address, hasCallback), or
+  // send(req, list, list.length, hasCallback) on a connected socket
+  const bool sendto = args.Length() == 6;
   CHECK(args[0]->IsObject());
   CHECK(args[1]->IsArray());
   CHECK(args[2]->IsUint32());
-  CHECK(args[3]->IsUint32());
-  CHECK(args[4]->IsString());
-  CHECK(args[5]->IsBoolean());
+  CHECK(args[sendto ? 5 : 3]->IsBoolean());
 
   Local<Object> req_wrap_obj = args[0].As<Object>();
   Local<Array> chunks = args[1].As<Array>();
   // it is faster to fetch the length of the
   // array in js-land
   size_t count = args[2]->Uint32Value();
-  const unsigned short port = args[3]->Uint32Value();
-  node::Utf8Value address(env->isolate(), args[4]);
-  const bool have_callback = args[5]->IsTrue();
+  const bool have_callback = args[sendto ? 5 : 3]->IsTrue();
+
+  sockaddr_storage addr;
+  int err = 0;
+
+  if (sendto) {
+    CHECK(args[3]->IsUint32());
+    CHECK(args[4]->IsString());
+    const unsigned short port = args[3]->Uint32Value();
+    node::Utf8Value address(env->isolate(), args[4]);
+    err = ToSockAddr(family, *address, port, &addr);
+  } else if (wrap->connected_) {
+    addr = wrap->peer_;
+  } else {
+    err = UV_EDESTADDRREQ;
+  }
+
+  if (err)
+    return args.GetReturnValue().Set(err);
 
   SendWrap* req_wrap;
   {
@@ -379,29 +604,45 @@ void UDPWrap::DoSend(const FunctionCallbackInfo<Value>& args, int family) {
 
   req_wrap->msg_size = msg_size;
 
-  char addr[sizeof(sockaddr_in6)];
-  int err;
-
-  switch (family) {
-  case AF_INET:
-    err = uv_ip4_addr(*address, port, reinterpret_cast<sockaddr_in*>(&addr));
-    break;
-  case AF_INET6:
-    err = uv_ip6_addr(*address, port, reinterpret_cast<sockaddr_in6*>(&addr));
-    break;
-  default:
-    CHECK(0 && "unexpected address family");
-    ABORT();
+#ifdef __linux__
+  // uv_udp_send() always passes the address, which makes the kernel look up
+  // the route again. Connected sockets send without one when nothing is queued
+  // before the datagram, and have the callback called like libuv would.
+  uv_os_fd_t fd;
+  if (!sendto &&
+      uv_udp_get_send_queue_count(&wrap->handle_) == 0 &&
+      uv_fileno(reinterpret_cast<uv_handle_t*>(&wrap->handle_), &fd) == 0) {
+    msghdr h;
+    memset(&h, 0, sizeof(h));
+    h.msg_iov = reinterpret_cast<iovec*>(*bufs);
+    h.msg_iovlen = count;
+
+    ssize_t r;
+    do {
+      r = sendmsg(fd, &h, 0);
+    } while (r == -1 && errno == EINTR);
+
+    if (r != -1 || (errno != EAGAIN && errno != EWOULDBLOCK &&
+                    errno != ENOBUFS)) {
+      req_wrap->status = r == -1 ? -errno : 0;
+      req_wrap->Dispatched();
+      env->SetImmediate([](Environment* env, void* data) {
+        SendWrap* req_wrap = static_cast<SendWrap*>(data);
+        OnSend(req_wrap->req(), req_wrap->status);
+      }, req_wrap, req_wrap->object());
+      return args.GetReturnValue().Set(0);
+    }
   }
+#endif
 
-  if (err == 0) {
-    err = uv_udp_send(req_wrap->req(),
-                      &wrap->handle_,
-                      *bufs,
-                      count,
-                      reinterpret_cast<const sockaddr*>(&addr),
-                      OnSend);
-  }
+  for (size_t i = 0; i < count; i++)
+    req_wrap->pins.Pin(env->isolate_data()->size_classes(), bufs[i].base);
+  err = uv_udp_send(req_wrap->req(),
+                    &wrap->handle_,
+                    *bufs,
+                    count,
+                    reinterpret_cast<const sockaddr*>(&addr),
+                    OnSend);
 
   req_wrap->Dispatched();
   if (err)
@@ -421,6 +662,279 @@ void UDPWrap::Send6(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void UDPWrap::DoSendBatch(const FunctionCallbackInfo<Value>& args,
+                          int family) {
+  Environment* env = Environment::GetCurrent(args);
+
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+
+  // sendBatch(req, buffers, ports, addresses, count, hasCallback), or
+  // sendBatch(req, buffers, count, hasCallback) on a connected socket
+  const bool sendto = args.Length() == 6;
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsArray());
+  CHECK(args[sendto ? 4 : 2]->IsUint32());
+  CHECK(args[sendto ? 5 : 3]->IsBoolean());
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  Local<Array> buffers = args[1].As<Array>();
+  size_t count = args[sendto ? 4 : 2]->Uint32Value();
+  const bool have_callback = args[sendto ? 5 : 3]->IsTrue();
+
+  if (!sendto && !wrap->connected_)
+    return args.GetReturnValue().Set(UV_EDESTADDRREQ);
+
+  MaybeStackBuffer<uv_buf_t, 16> bufs(count);
+  MaybeStackBuffer<sockaddr_storage, 16> addrs(sendto ? count : 0);
+  size_t msg_size = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> chunk = buffers->Get(i);
+    size_t length = Buffer::Length(chunk);
+    bufs[i] = uv_buf_init(Buffer::Data(chunk), length);
+    msg_size += length;
+  }
+
+  if (sendto) {
+    CHECK(args[2]->IsArray());
+    CHECK(args[3]->IsArray());
+    Local<Array> ports = args[2].As<Array>();
+    Local<Array> addresses = args[3].As<Array>();
+    for (size_t i = 0; i < count; i++) {
+      node::Utf8Value address(env->isolate(), addresses->Get(i));
+      const unsigned short port = ports->Get(i)->Uint32Value();
+      int err = ToSockAddr(family, *address, port, &addrs[i]);
+      if (err != 0)
+        return args.GetReturnValue().Set(err);
+    }
+  }
+
+  SendBatchWrap* req_wrap;
+  {
+    AsyncHooks::DefaultTriggerAsyncIdScope trigger_scope(
+      env, wrap->get_async_id());
+    req_wrap = new SendBatchWrap(env, req_wrap_obj, have_callback, count);
+  }
+  req_wrap->msg_size = msg_size;
+
+  size_t sent = 0;
+#ifdef __linux__
+  // Datagrams that libuv has queued go out first, so the batch can only skip
+  // the queue if it is empty.
+  uv_os_fd_t fd;
+  if (uv_udp_get_send_queue_count(&wrap->handle_) == 0 &&
+      uv_fileno(reinterpret_cast<uv_handle_t*>(&wrap->handle_), &fd) == 0) {
+    sent = SendMany(fd, *bufs, sendto ? *addrs : nullptr, count, req_wrap);
+  }
+#endif
+
+  for (size_t i = sent; i < count; i++)
+    req_wrap->pins.Pin(env->isolate_data()->size_classes(), bufs[i].base);
+  for (size_t i = sent; i < count; i++) {
+    const sockaddr_storage* addr = sendto ? &addrs[i] : &wrap->peer_;
+    int err = uv_udp_send(req_wrap->NextReq(),
+                          &wrap->handle_,
+                          &bufs[i],
+                          1,
+                          reinterpret_cast<const sockaddr*>(addr),
+                          SendBatchWrap::OnSend);
+    if (err == 0)
+      req_wrap->pending++;
+    else
+      req_wrap->SetStatus(err);
+  }
+
+  req_wrap->Dispatched();
+  if (req_wrap->pending == 0) {
+    // Nothing was queued, but the callback must not run synchronously.
+    env->SetImmediate([](Environment* env, void* data) {
+      static_cast<SendBatchWrap*>(data)->Finish();
+    }, req_wrap, req_wrap->object());
+  }
+
+  args.GetReturnValue().Set(0);
+}
+
+
+void UDPWrap::SendBatch(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET);
+}
+
+
+void UDPWrap::SendBatch6(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET6);
+}
+
+
+// The socket is connected in the kernel on Linux only, because elsewhere
+// libuv's sends, which always pass an address, would then fail with EISCONN.
+// The address is kept in either case and used for sends, and datagrams from
+// other peers are dropped by FromPeer() where the kernel does not.
+void UDPWrap::DoConnect(const FunctionCallbackInfo<Value>& args, int family) {
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+
+  // connect(ip, port)
+  CHECK_EQ(args.Length(), 2);
+
+  node::Utf8Value address(args.GetIsolate(), args[0]);
+  const unsigned short port = args[1]->Uint32Value();
+  sockaddr_storage addr;
+  int err = ToSockAddr(family, *address, port, &addr);
+
+#ifdef __linux__
+  uv_os_fd_t fd;
+  if (err == 0)
+    err = uv_fileno(reinterpret_cast<uv_handle_t*>(&wrap->handle_), &fd);
+  if (err == 0 &&
+      connect(fd, reinterpret_cast<sockaddr*>(&addr), SockAddrLength(&addr))) {
+    err = -errno;
+  }
+#endif
+
+  if (err == 0) {
+    wrap->peer_ = addr;
+    wrap->connected_ = true;
+  }
+
+  args.GetReturnValue().Set(err);
+}
+
+
+void UDPWrap::Connect(const FunctionCallbackInfo<Value>& args) {
+  DoConnect(args, AF_INET);
+}
+
+
+void UDPWrap::Connect6(const FunctionCallbackInfo<Value>& args) {
+  DoConnect(args, AF_INET6);
+}
+
+
+void UDPWrap::Disconnect(const FunctionCallbackInfo<Value>& args) {
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+
+  int err = wrap->connected_ ? 0 : UV_ENOTCONN;
+
+#ifdef __linux__
+  uv_os_fd_t fd;
+  if (err == 0)
+    err = uv_fileno(reinterpret_cast<uv_handle_t*>(&wrap->handle_), &fd);
+  if (err == 0) {
+    sockaddr addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sa_family = AF_UNSPEC;
+    if (connect(fd, &addr, sizeof(addr)))
+      err = -errno;
+  }
+#endif
+
+  if (err == 0)
+    wrap->connected_ = false;
+
+  args.GetReturnValue().Set(err);
+}
+
+
+void UDPWrap::GetPeerName(const FunctionCallbackInfo<Value>& args) {
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+
+  CHECK(args[0]->IsObject());
+  if (!wrap->connected_)
+    return args.GetReturnValue().Set(UV_ENOTCONN);
+
+  AddressToJS(wrap->env(),
+              reinterpret_cast<const sockaddr*>(&wrap->peer_),
+              args[0].As<Object>());
+  args.GetReturnValue().Set(0);
+}
+
+
+bool UDPWrap::FromPeer(const sockaddr* addr) const {
+#ifdef __linux__
+  return true;
+#else
+  if (!connected_ || addr == nullptr)
+    return true;
+  if (addr->sa_family != peer_.ss_family)
+    return false;
+
+  if (addr->sa_family == AF_INET) {
+    const sockaddr_in* a = reinterpret_cast<const sockaddr_in*>(addr);
+    const sockaddr_in* b = reinterpret_cast<const sockaddr_in*>(&peer_);
+    return a->sin_port == b->sin_port &&
+           a->sin_addr.s_addr == b->sin_addr.s_addr;
+  }
+
+  const sockaddr_in6* a = reinterpret_cast<const sockaddr_in6*>(addr);
+  const sockaddr_in6* b = reinterpret_cast<const sockaddr_in6*>(&peer_);
+  return a->sin6_port == b->sin6_port &&
+         memcmp(&a->sin6_addr, &b->sin6_addr, sizeof(a->sin6_addr)) == 0;
+#endif
+}
+
+
+void UDPWrap::SetGSO(const FunctionCallbackInfo<Value>& args) {
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+
+  CHECK(args[0]->IsUint32());
+  int err = UV_ENOTSUP;
+
+#ifdef __linux__
+  const int size = args[0].As<Uint32>()->Value();
+  uv_os_fd_t fd;
+  err = uv_fileno(reinterpret_cast<uv_handle_t*>(&wrap->handle_), &fd);
+  if (err == 0 &&
+      setsockopt(fd, SOL_UDP, UDP_SEGMENT, &size, sizeof(size))) {
+    err = -errno;
+  }
+#endif
+
+  args.GetReturnValue().Set(err);
+}
+
+
+void UDPWrap::SetGRO(const FunctionCallbackInfo<Value>& args) {
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+
+  CHECK(args[0]->IsBoolean());
+  int err = UV_ENOTSUP;
+
+#ifdef __linux__
+  const int on = args[0]->IsTrue();
+  uv_os_fd_t fd;
+  err = uv_fileno(reinterpret_cast<uv_handle_t*>(&wrap->handle_), &fd);
+  if (err == 0 && setsockopt(fd, SOL_UDP, UDP_GRO, &on, sizeof(on)))
+    err = -errno;
+  if (err == 0) {
+    // Coalesced datagrams can only be split up with the segment size that
+    // comes with them, which ReadBatch() gets and libuv does not.
+    wrap->recv_gro_ = on;
+    wrap->AllocateRecvSlots();
+  }
+#endif
+
+  args.GetReturnValue().Set(err);
+}
+
+
 void UDPWrap::RecvStart(const FunctionCallbackInfo<Value>& args) {
   UDPWrap* wrap;
   ASSIGN_OR_RETURN_UNWRAP(&wrap,
@@ -444,6 +958,65 @@ void UDPWrap::RecvStop(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void UDPWrap::SetRecvBatchSize(const FunctionCallbackInfo<Value>& args) {
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+
+  CHECK(args[0]->IsUint32());
+  const unsigned int size = args[0].As<Uint32>()->Value();
+  CHECK_GE(size, 1);
+  CHECK_LE(size, kMaxRecvBatchSize);
+
+  wrap->recv_batch_size_ = size;
+  wrap->AllocateRecvSlots();
+  args.GetReturnValue().Set(0);
+}
+
+
+void UDPWrap::SetMaxDatagramSize(const FunctionCallbackInfo<Value>& args) {
+  UDPWrap* wrap;
+  ASSIGN_OR_RETURN_UNWRAP(&wrap,
+                          args.Holder(),
+                          args.GetReturnValue().Set(UV_EBADF));
+
+  CHECK(args[0]->IsUint32());
+  const size_t size = args[0].As<Uint32>()->Value();
+  CHECK_GE(size, 1);
+  CHECK_LE(size, kMaxDatagramSize);
+
+  wrap->max_datagram_size_ = size;
+  wrap->AllocateRecvSlots();
+  args.GetReturnValue().Set(0);
+}
+
+
+// Datagrams are read by ReadBatch() when they are received in batches or may
+// be coalesced, except on Windows, where the socket is not a file descriptor
+// and libuv reads one datagram at a time.
+void UDPWrap::AllocateRecvSlots() {
+#ifndef _WIN32
+  size_t count = 0;
+  if (recv_batch_size_ > 0)
+    count = recv_batch_size_;
+  else if (recv_gro_)
+    count = 1;
+  // A read may hold up to 64 KiB of coalesced datagrams.
+  const size_t size = recv_gro_ ? kMaxDatagramSize : max_datagram_size_;
+  if (count * size > kMaxRecvSlotMemory)
+    count = kMaxRecvSlotMemory / size;
+
+  if (count == recv_slot_count_ && size == recv_slot_size_)
+    return;
+  recv_slot_count_ = count;
+  recv_slot_size_ = size;
+  recv_buffers_.reset(count > 0 ? new char[count * size] : nullptr);
+  recv_slots_.reset(count > 0 ? new RecvSlot[count] : nullptr);
+#endif
+}
+
+
 void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
   SendWrap* req_wrap = static_cast<SendWrap*>(req->data);
   if (req_wrap->have_callback()) {
@@ -463,8 +1036,19 @@ void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
 void UDPWrap::OnAlloc(uv_handle_t* handle,
                       size_t suggested_size,
                       uv_buf_t* buf) {
-  buf->base = node::Malloc(suggested_size);
-  buf->len = suggested_size;
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+  if (wrap->recv_slot_count_ > 0) {
+    // Read the datagrams here and give libuv no buffer, which makes it stop
+    // reading and call OnRecv() with UV_ENOBUFS. They are delivered from there.
+    wrap->recv_error_ = wrap->ReadBatch();
+    *buf = uv_buf_init(nullptr, 0);
+    return;
+  }
+
+  // A datagram that fits takes only as much of the pool as it needs once it
+  // has been received, so the next one starts right after it.
+  buf->base = wrap->env()->udp_recv_pool()->Reserve(wrap->max_datagram_size_);
+  buf->len = wrap->max_datagram_size_;
 }
 
 
@@ -473,18 +1057,25 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
                      const uv_buf_t* buf,
                      const struct sockaddr* addr,
                      unsigned int flags) {
-  if (nread == 0 && addr == nullptr) {
-    if (buf->base != nullptr)
-      free(buf->base);
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+  const bool read_batch = nread == UV_ENOBUFS && wrap->recv_slot_count_ > 0;
+
+  // Nothing needs to be freed here, the pool space that OnAlloc() set aside
+  // is only taken by UDPRecvPool::Slice().
+  if (nread == 0 && addr == nullptr)
+    return;
+
+  if (nread >= 0 && !wrap->FromPeer(addr))
     return;
-  }
 
-  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
   Environment* env = wrap->env();
 
   HandleScope handle_scope(env->isolate());
   Context::Scope context_scope(env->context());
 
+  if (read_batch)
+    return wrap->DeliverBatch();
+
   Local<Object> wrap_obj = wrap->object();
   Local<Value> argv[] = {
     Integer::New(env->isolate(), nread),
@@ -494,19 +1085,273 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
   };
 
   if (nread < 0) {
-    if (buf->base != nullptr)
-      free(buf->base);
     wrap->MakeCallback(env->onmessage_string(), arraysize(argv), argv);
     return;
   }
 
-  char* base = node::UncheckedRealloc(buf->base, nread);
-  argv[2] = Buffer::New(env, base, nread).ToLocalChecked();
+  argv[2] = env->udp_recv_pool()->Slice(nread);
   argv[3] = AddressToJS(env, addr);
+
+  if (wrap->recv_batch_size_ > 0) {
+    // A batch of the one datagram that libuv read.
+    Local<ArrayBuffer> ab = ArrayBuffer::New(env->isolate(),
+                                             2 * sizeof(uint32_t));
+    uint32_t* offsets = static_cast<uint32_t*>(ab->GetContents().Data());
+    offsets[0] = 0;
+    offsets[1] = nread;
+    Local<Array> rinfos = Array::New(env->isolate(), 1);
+    rinfos->Set(0, argv[3]);
+    argv[3] = Uint32Array::New(ab, 0, 2);
+    Local<Value> batch_argv[] = {
+      Integer::New(env->isolate(), 1), wrap_obj, argv[2], argv[3], rinfos
+    };
+    wrap->MakeCallback(env->onbatch_string(), arraysize(batch_argv),
+                       batch_argv);
+    return;
+  }
+
   wrap->MakeCallback(env->onmessage_string(), arraysize(argv), argv);
 }
 
 
+#ifdef __linux__
+// Returns the size of the datagrams that were coalesced into one by GRO, or 0.
+static size_t GetSegmentSize(msghdr* h) {
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(h);
+       cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(h, cmsg)) {
+    if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+      int size;
+      memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+      return size;
+    }
+  }
+  return 0;
+}
+#endif  // __linux__
+
+
+// Reads as many of the datagrams that are waiting on the socket as there are
+// receive slots, with a single recvmmsg() call on Linux. Returns 0, or the
+// error that stopped the reading, to be reported after the datagrams.
+int UDPWrap::ReadBatch() {
+  recv_count_ = 0;
+
+#ifdef _WIN32
+  return UV_ENOTSUP;
+#else
+  uv_os_fd_t fd;
+  int err = uv_fileno(GetHandle(), &fd);
+  if (err != 0)
+    return err;
+
+  char* buffers = recv_buffers_.get();
+  const size_t max = recv_slot_count_;
+
+#ifdef __linux__
+  MaybeStackBuffer<mmsghdr, 16> msgs(max);
+  MaybeStackBuffer<iovec, 16> iov(max);
+  for (size_t i = 0; i < max; i++) {
+    iov[i].iov_base = buffers + i * recv_slot_size_;
+    iov[i].iov_len = recv_slot_size_;
+    memset(&msgs[i], 0, sizeof(msgs[i]));
+    msgs[i].msg_hdr.msg_name = &recv_slots_[i].peer;
+    msgs[i].msg_hdr.msg_namelen = sizeof(recv_slots_[i].peer);
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_control = recv_slots_[i].control;
+    msgs[i].msg_hdr.msg_controllen = sizeof(recv_slots_[i].control);
+  }
+
+  int r;
+  do {
+    r = recvmmsg(fd, *msgs, max, MSG_DONTWAIT, nullptr);
+  } while (r == -1 && errno == EINTR);
+
+  if (r == -1)
+    return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -errno;
+
+  for (recv_count_ = 0; recv_count_ < static_cast<size_t>(r); recv_count_++) {
+    RecvSlot* slot = &recv_slots_[recv_count_];
+    slot->length = msgs[recv_count_].msg_len;
+    slot->segment_size = GetSegmentSize(&msgs[recv_count_].msg_hdr);
+  }
+  return 0;
+#else
+  while (recv_count_ < max) {
+    RecvSlot* slot = &recv_slots_[recv_count_];
+    sockaddr* peer = reinterpret_cast<sockaddr*>(&slot->peer);
+    socklen_t namelen = sizeof(slot->peer);
+    ssize_t r;
+    do {
+      r = recvfrom(fd,
+                   buffers + recv_count_ * recv_slot_size_,
+                   recv_slot_size_,
+                   MSG_DONTWAIT,
+                   peer,
+                   &namelen);
+    } while (r == -1 && errno == EINTR);
+
+    if (r == -1)
+      return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -errno;
+    if (!FromPeer(peer))
+      continue;
+
+    slot->length = r;
+    slot->segment_size = 0;
+    recv_count_++;
+  }
+  return 0;
+#endif  // __linux__
+#endif  // _WIN32
+}
+
+
+// Passes what ReadBatch() read to JS. In batch mode, that is a single onbatch
+// call with the contents of all datagrams back to back in one Buffer, a table
+// of count + 1 offsets into it and an array of sender addresses. Otherwise,
+// onmessage is called for every datagram. Datagrams coalesced by GRO are split
+// up again either way.
+void UDPWrap::DeliverBatch() {
+  Environment* env = this->env();
+  const size_t count = recv_count_;
+  const int err = recv_error_;
+  const char* buffers = recv_buffers_.get();
+  recv_count_ = 0;
+  recv_error_ = 0;
+
+  auto segments_of = [](const RecvSlot& slot) -> size_t {
+    if (slot.segment_size == 0 || slot.length == 0)
+      return 1;
+    return (slot.length + slot.segment_size - 1) / slot.segment_size;
+  };
+
+  size_t segments = 0;
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++) {
+    segments += segments_of(recv_slots_[i]);
+    total += recv_slots_[i].length;
+  }
+
+  if (recv_batch_size_ > 0 && count > 0) {
+    // Only batches too large for a pool chunk get memory of their own.
+    char* base = env->udp_recv_pool()->Reserve(total);
+    const bool pooled = base != nullptr;
+    if (!pooled)
+      base = node::Malloc(total);
+    Local<ArrayBuffer> ab =
+        ArrayBuffer::New(env->isolate(), (segments + 1) * sizeof(uint32_t));
+    uint32_t* offsets = static_cast<uint32_t*>(ab->GetContents().Data());
+    Local<Array> rinfos = Array::New(env->isolate(), segments);
+
+    size_t offset = 0;
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+      const RecvSlot& slot = recv_slots_[i];
+      memcpy(base + offset, buffers + i * recv_slot_size_, slot.length);
+      const sockaddr* peer = reinterpret_cast<const sockaddr*>(&slot.peer);
+      for (size_t j = 0; j < segments_of(slot); j++) {
+        offsets[n] = offset + j * slot.segment_size;
+        rinfos->Set(n++, AddressToJS(env, peer));
+      }
+      offset += slot.length;
+    }
+    offsets[n] = total;
+
+    Local<Value> argv[] = {
+      Integer::New(env->isolate(), segments),
+      object(),
+      pooled ? env->udp_recv_pool()->Slice(total) :
+               Buffer::New(env, base, total).ToLocalChecked(),
+      Uint32Array::New(ab, 0, segments + 1),
+      rinfos
+    };
+    MakeCallback(env->onbatch_string(), arraysize(argv), argv);
+  } else if (count > 0) {
+    // Everything is copied out first, as the callbacks may change the slots.
+    MaybeStackBuffer<Local<Value>, 32> datagrams(2 * segments);
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+      const RecvSlot& slot = recv_slots_[i];
+      const sockaddr* peer = reinterpret_cast<const sockaddr*>(&slot.peer);
+      for (size_t j = 0; j < segments_of(slot); j++) {
+        const size_t start = j * slot.segment_size;
+        const size_t length = slot.segment_size == 0 ? slot.length :
+            std::min(slot.segment_size, slot.length - start);
+        char* data = env->udp_recv_pool()->Reserve(length);
+        memcpy(data, buffers + i * recv_slot_size_ + start, length);
+        datagrams[n++] = env->udp_recv_pool()->Slice(length);
+        datagrams[n++] = AddressToJS(env, peer);
+      }
+    }
+
+    for (size_t i = 0; i < datagrams.length(); i += 2) {
+      // A callback may have closed the socket.
+      if (!IsAlive(this) || uv_is_closing(GetHandle()))
+        return;
+      Local<Value> argv[] = {
+        Integer::New(env->isolate(), Buffer::Length(datagrams[i])),
+        object(),
+        datagrams[i],
+        datagrams[i + 1]
+      };
+      MakeCallback(env->onmessage_string(), arraysize(argv), argv);
+    }
+  }
+
+  // An error that came up while reading is reported the way libuv would have,
+  // unless a callback closed the socket.
+  if (err != 0 && IsAlive(this) && !uv_is_closing(GetHandle())) {
+    Local<Value> argv[] = {
+      Integer::New(env->isolate(), err),
+      object(),
+      Undefined(env->isolate()),
+      Undefined(env->isolate())
+    };
+    MakeCallback(env->onmessage_string(), arraysize(argv), argv);
+  }
+}
+
+
+// Returns where the next |size| bytes of the pool start, after replacing the
+// current chunk with a new one if it has less than that left. Returns nullptr
+// if |size| is more than a chunk holds. Sockets share the pool, so nothing
+// may reserve space in between a Reserve() call and its matching Slice().
+char* UDPRecvPool::Reserve(size_t size) {
+  if (size > kRecvPoolSize)
+    return nullptr;
+
+  if (chunk_.IsEmpty() || kRecvPoolSize - used_ < size) {
+    HandleScope handle_scope(env_->isolate());
+    char* data = node::Malloc(kRecvPoolSize);
+    Local<ArrayBuffer> ab =
+        ArrayBuffer::New(env_->isolate(),
+                         data,
+                         kRecvPoolSize,
+                         v8::ArrayBufferCreationMode::kInternalized);
+    chunk_.Reset(env_->isolate(), ab);
+    data_ = data;
+    used_ = 0;
+  }
+
+  return data_ + used_;
+}
+
+
+// Returns a Buffer for the next |length| bytes of the pool, which Reserve()
+// must have set aside, and takes them.
+Local<Object> UDPRecvPool::Slice(size_t length) {
+  CHECK(!chunk_.IsEmpty());
+  CHECK_LE(length, kRecvPoolSize - used_);
+
+  Local<ArrayBuffer> ab = PersistentToLocal(env_->isolate(), chunk_);
+  Local<Object> buffer = Buffer::New(env_, ab, used_, length).ToLocalChecked();
+  // Slices start at multiples of 8 bytes, like memory from malloc() does.
+  used_ = std::min((used_ + length + 7) & ~size_t{7}, kRecvPoolSize);
+  return buffer;
+}
+
+
 Local<Object> UDPWrap::Instantiate(Environment* env,
                                    AsyncWrap* parent,
                                    UDPWrap::SocketType type) {
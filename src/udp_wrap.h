@@ -31,8 +31,29 @@
 #include "uv.h"
 #include "v8.h"
 
+#include <memory>
+
 namespace node {
 
+// Received datagrams are sliced out of a chunk of memory that all UDP sockets
+// of an Environment share, so that an idle socket does not hold on to a chunk
+// of its own. The slices keep a chunk alive once the next one replaces it.
+class UDPRecvPool {
+ public:
+  explicit UDPRecvPool(Environment* env) : env_(env) {}
+
+  char* Reserve(size_t size);
+  v8::Local<v8::Object> Slice(size_t length);
+
+ private:
+  Environment* const env_;
+  Persistent<v8::ArrayBuffer> chunk_;
+  char* data_ = nullptr;
+  size_t used_ = 0;  // Bytes of chunk_ that have been sliced off.
+
+  DISALLOW_COPY_AND_ASSIGN(UDPRecvPool);
+};
+
 class UDPWrap: public HandleWrap {
  public:
   enum SocketType {
@@ -46,9 +67,19 @@ class UDPWrap: public HandleWrap {
   static void Bind(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Send(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Connect(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Connect6(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Disconnect(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetPeerName(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Send6(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStart(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStop(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetRecvBatchSize(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetMaxDatagramSize(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   static void AddMembership(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void DropMembership(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetMulticastInterface(
@@ -58,6 +89,8 @@ class UDPWrap: public HandleWrap {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetBroadcast(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetTTL(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetGSO(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetGRO(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void BufferSize(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static v8::Local<v8::Object> Instantiate(Environment* env,
@@ -74,12 +107,25 @@ class UDPWrap: public HandleWrap {
             int (*F)(const typename T::HandleType*, sockaddr*, int*)>
   friend void GetSockOrPeerName(const v8::FunctionCallbackInfo<v8::Value>&);
 
+  // A datagram read by ReadBatch().
+  struct RecvSlot {
+    sockaddr_storage peer;
+    size_t length;
+    // The size of the datagrams that the kernel coalesced into this one, or 0.
+    size_t segment_size;
+    char control[64];
+  };
+
   UDPWrap(Environment* env, v8::Local<v8::Object> object);
 
   static void DoBind(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
   static void DoSend(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
+  static void DoSendBatch(const v8::FunctionCallbackInfo<v8::Value>& args,
+                          int family);
+  static void DoConnect(const v8::FunctionCallbackInfo<v8::Value>& args,
+                        int family);
   static void SetMembership(const v8::FunctionCallbackInfo<v8::Value>& args,
                             uv_membership membership);
 
@@ -92,8 +138,30 @@ class UDPWrap: public HandleWrap {
                      const uv_buf_t* buf,
                      const struct sockaddr* addr,
                      unsigned int flags);
+  bool FromPeer(const sockaddr* addr) const;
+  void AllocateRecvSlots();
+  int ReadBatch();
+  void DeliverBatch();
 
   uv_udp_t handle_;
+  // Maximum number of datagrams per onbatch callback, 0 if datagrams are
+  // delivered one by one to onmessage.
+  unsigned int recv_batch_size_ = 0;
+  bool recv_gro_ = false;
+  // Longer datagrams are truncated to this many bytes.
+  size_t max_datagram_size_;
+  bool connected_ = false;
+  sockaddr_storage peer_;
+  // Datagrams are read by ReadBatch() rather than by libuv if there are
+  // slots for them, which are recv_slot_count_ times recv_slot_size_ bytes of
+  // recv_buffers_ and a RecvSlot each.
+  size_t recv_slot_count_ = 0;
+  size_t recv_slot_size_ = 0;
+  std::unique_ptr<char[]> recv_buffers_;
+  std::unique_ptr<RecvSlot[]> recv_slots_;
+  // What the last ReadBatch() call read, to be delivered by DeliverBatch().
+  size_t recv_count_ = 0;
+  int recv_error_ = 0;
 };
 
 }  // namespace node
@@ -2,6 +2,7 @@
 'use strict';
 
 const assert = require('assert');
+const dgram = require('dgram');
 const os = require('os');
 
 const types = {
@@ -301,11 +302,47 @@ function errorLookupMock(code = mockedErrorCode, syscall = mockedSysCall) {
   };
 }
 
+// A DNS server on 127.0.0.1 that answers queries from `records`, an object
+// that maps domain names to the resource records for them, without `domain`.
+// Names that are not in `records` do not exist.
+function createStubResolver(records, callback) {
+  const server = dgram.createSocket('udp4');
+  server.queries = [];
+  server.on('message', (msg, { address, port }) => {
+    const parsed = parseDNSPacket(msg);
+    const answers = [];
+    let flags;
+    for (const question of parsed.questions) {
+      const { domain, type } = question;
+      server.queries.push(`${type} ${domain}`);
+      const found = records[domain.toLowerCase()];
+      if (found === undefined) {
+        // NXDOMAIN
+        flags = 0x8183;
+        continue;
+      }
+      for (const rr of found) {
+        if (rr.type === type)
+          answers.push(Object.assign({ domain }, rr));
+      }
+    }
+    server.send(writeDNSPacket({
+      id: parsed.id,
+      flags,
+      questions: parsed.questions,
+      answers
+    }), port, address);
+  });
+  server.bind(0, '127.0.0.1', () => callback(server));
+  return server;
+}
+
 module.exports = {
   types,
   classes,
   writeDNSPacket,
   parseDNSPacket,
+  createStubResolver,
   errorLookupMock,
   mockedErrorCode,
   mockedSysCall
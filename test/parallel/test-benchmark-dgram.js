@@ -5,6 +5,7 @@ require('../common');
 const runBenchmark = require('../common/benchmark');
 
 runBenchmark('dgram', ['address=true',
+                       'batch=true',
                        'chunks=2',
                        'dur=0.1',
                        'len=1',
@@ -0,0 +1,54 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const buffer = require('buffer');
+
+const before = buffer.getAllocatorStatistics();
+assert.strictEqual(before.retentionLimit, 8 * 1024 * 1024);
+assert.strictEqual(before.slabSize, 1024 * 1024);
+assert.deepStrictEqual(before.sizeClasses.map((c) => c.size),
+                       [4096, 8192, 16384, 32768, 65536]);
+
+// Medium sized allocations are served from the matching size class.
+const buffers = [];
+for (let i = 0; i < 16; i++)
+  buffers.push(Buffer.allocUnsafe(12 * 1024), Buffer.alloc(16 * 1024));
+
+const after = buffer.getAllocatorStatistics();
+const [beforeClass, afterClass] = [before, after].map((s) => s.sizeClasses[2]);
+assert.ok(afterClass.allocations - beforeClass.allocations >= 32);
+assert.ok(afterClass.blocksInUse >= 32);
+assert.ok(afterClass.slabs >= 1);
+assert.ok(after.slabs >= after.retainedSlabs);
+
+// Allocated memory is usable and zero-filled where required.
+for (const buf of buffers) {
+  if (buf.length === 16 * 1024)
+    assert.ok(buf.every((byte) => byte === 0));
+  buf.fill(0xab);
+}
+
+// Allocations outside of the size classes still work.
+assert.strictEqual(Buffer.allocUnsafe(100).length, 100);
+assert.strictEqual(Buffer.allocUnsafe(1024 * 1024).length, 1024 * 1024);
+
+buffer.setAllocatorRetentionLimit(0);
+assert.strictEqual(buffer.getAllocatorStatistics().retentionLimit, 0);
+assert.strictEqual(buffer.getAllocatorStatistics().retainedSlabs, 0);
+buffer.setAllocatorRetentionLimit(4 * 1024 * 1024);
+assert.strictEqual(buffer.getAllocatorStatistics().retentionLimit,
+                   4 * 1024 * 1024);
+
+['1', null, undefined].forEach((limit) => {
+  common.expectsError(() => buffer.setAllocatorRetentionLimit(limit), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+});
+
+[-1, 1.5, NaN, Infinity].forEach((limit) => {
+  common.expectsError(() => buffer.setAllocatorRetentionLimit(limit), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError
+  });
+});
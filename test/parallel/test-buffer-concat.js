@@ -88,3 +88,23 @@ assert.deepStrictEqual(
 assert.deepStrictEqual(Buffer.concat([new Uint8Array([0x41, 0x42]),
                                       new Uint8Array([0x43, 0x44])]),
                        Buffer.from('ABCD'));
+
+// Uint8Array chunks are copied as well, and a short `length` truncates the
+// result at the last chunk that fits.
+{
+  const u8 = new Uint8Array([1, 2, 3]);
+  assert.deepStrictEqual(Buffer.concat([u8, Buffer.from([4, 5])]),
+                         Buffer.from([1, 2, 3, 4, 5]));
+  assert.deepStrictEqual(Buffer.concat([u8, u8, u8], 7),
+                         Buffer.from([1, 2, 3, 1, 2, 3, 1]));
+  assert.deepStrictEqual(Buffer.concat([u8], 5),
+                         Buffer.from([1, 2, 3, 0, 0]));
+}
+
+// An invalid entry is rejected even when it comes after the target is full.
+common.expectsError(() => {
+  Buffer.concat([Buffer.from('abc'), 'def'], 3);
+}, {
+  code: 'ERR_INVALID_ARG_TYPE',
+  type: TypeError
+});
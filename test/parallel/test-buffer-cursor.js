@@ -0,0 +1,188 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const { BufferCursor, BufferSchema } = require('buffer');
+
+// Every field type survives a round trip and uses the expected encoding.
+{
+  const schema = new BufferSchema([
+    'uint8', 'int8',
+    'uint16le', 'uint16be', 'int16le', 'int16be',
+    'uint32le', 'uint32be', 'int32le', 'int32be',
+    'floatle', 'floatbe', 'doublele', 'doublebe',
+    'varuint', 'varint', 'string', 'bytes'
+  ]);
+  const values = [
+    255, -128,
+    0x1234, 0x1234, -2, -2,
+    0xdeadbeef, 0xdeadbeef, -123456789, -123456789,
+    1.5, -1.5, Math.PI, -Math.PI,
+    300, -300, 'héllo', Buffer.from([1, 2, 3])
+  ];
+  const length = BufferCursor.byteLength(schema, values);
+  const buf = Buffer.alloc(length);
+  const writer = new BufferCursor(buf);
+  assert.strictEqual(writer.write(schema, values), writer);
+  assert.strictEqual(writer.offset, length);
+  assert.strictEqual(writer.remaining, 0);
+
+  const expected = Buffer.alloc(length);
+  let offset = 0;
+  offset = expected.writeUInt8(255, offset);
+  offset = expected.writeInt8(-128, offset);
+  offset = expected.writeUInt16LE(0x1234, offset);
+  offset = expected.writeUInt16BE(0x1234, offset);
+  offset = expected.writeInt16LE(-2, offset);
+  offset = expected.writeInt16BE(-2, offset);
+  offset = expected.writeUInt32LE(0xdeadbeef, offset);
+  offset = expected.writeUInt32BE(0xdeadbeef, offset);
+  offset = expected.writeInt32LE(-123456789, offset);
+  offset = expected.writeInt32BE(-123456789, offset);
+  offset = expected.writeFloatLE(1.5, offset);
+  offset = expected.writeFloatBE(-1.5, offset);
+  offset = expected.writeDoubleLE(Math.PI, offset);
+  offset = expected.writeDoubleBE(-Math.PI, offset);
+  expected[offset++] = 0xac;  // 300 as a varint.
+  expected[offset++] = 0x02;
+  expected[offset++] = 0xd7;  // Zigzag encoded -300 is 599.
+  expected[offset++] = 0x04;
+  expected[offset++] = 6;
+  offset += expected.write('héllo', offset);
+  expected[offset++] = 3;
+  Buffer.from([1, 2, 3]).copy(expected, offset);
+  assert.deepStrictEqual(buf, expected);
+
+  const reader = new BufferCursor(buf);
+  const result = reader.read(schema);
+  assert.strictEqual(reader.offset, length);
+  assert.deepStrictEqual(result.slice(0, -1), values.slice(0, -1));
+  assert.deepStrictEqual(result[result.length - 1], Buffer.from([1, 2, 3]));
+
+  // 'bytes' fields are views into the source buffer.
+  result[result.length - 1][0] = 42;
+  assert.strictEqual(buf[length - 3], 42);
+}
+
+// Plain arrays work as schemas, and consecutive records advance the offset.
+{
+  const buf = Buffer.alloc(12);
+  const cursor = new BufferCursor(buf, 2);
+  cursor.write(['uint16be', 'uint8'], [0xabcd, 7]);
+  cursor.write(['uint16be', 'uint8'], [0x0102, 8]);
+  assert.strictEqual(cursor.offset, 8);
+  assert.deepStrictEqual(new BufferCursor(buf, 2).read(['uint16be', 'uint8']),
+                         [0xabcd, 7]);
+  cursor.offset = 5;
+  assert.deepStrictEqual(cursor.read(['uint16be', 'uint8']), [0x0102, 8]);
+}
+
+// Varints cover the whole safe integer range.
+{
+  const schema = new BufferSchema(['varuint', 'varint', 'varint']);
+  const values = [Number.MAX_SAFE_INTEGER, Number.MIN_SAFE_INTEGER, 0];
+  const buf = Buffer.alloc(BufferCursor.byteLength(schema, values));
+  new BufferCursor(buf).write(schema, values);
+  assert.deepStrictEqual(new BufferCursor(buf).read(schema), values);
+
+  // A varint that does not terminate within 8 bytes is rejected.
+  common.expectsError(
+    () => new BufferCursor(Buffer.alloc(9, 0xff)).read(['varuint']),
+    {
+      code: 'ERR_OUT_OF_RANGE',
+      type: RangeError,
+      message: 'The value of "fields[0]" is out of range. It must be an ' +
+               'integer >= 0 and <= 2^53 - 1.'
+    });
+}
+
+// Reading past the end throws and leaves the offset alone.
+{
+  const cursor = new BufferCursor(Buffer.from([1, 2, 3]));
+  common.expectsError(() => cursor.read(['uint8', 'uint32le']), {
+    code: 'ERR_BUFFER_OUT_OF_BOUNDS',
+    type: RangeError,
+    message: '"fields[1]" is outside of buffer bounds'
+  });
+  assert.strictEqual(cursor.offset, 0);
+
+  // A string whose length prefix runs past the end of the buffer.
+  const truncated = new BufferCursor(Buffer.from([5, 0x61]));
+  common.expectsError(() => truncated.read(['string']), {
+    code: 'ERR_BUFFER_OUT_OF_BOUNDS',
+    type: RangeError
+  });
+
+  cursor.offset = 4;
+  common.expectsError(() => cursor.read(['uint8']), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError
+  });
+}
+
+// Writing validates values without coercing them.
+{
+  const cursor = new BufferCursor(Buffer.alloc(4));
+  common.expectsError(() => cursor.write(['uint8'], [256]), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError,
+    message: 'The value of "values[0]" is out of range. It must be ' +
+             '>= 0 and <= 255. Received 256'
+  });
+  common.expectsError(() => cursor.write(['uint8', 'uint8'], [1, '2']), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError,
+    message: 'The "values[1]" argument must be of type number. ' +
+             'Received type string'
+  });
+  common.expectsError(() => cursor.write(['varint'], [1.5]), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError
+  });
+  common.expectsError(() => cursor.write(['bytes'], ['abc']), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+  common.expectsError(() => cursor.write(['string'], ['abcd']), {
+    code: 'ERR_BUFFER_OUT_OF_BOUNDS',
+    type: RangeError,
+    message: 'Attempt to write outside buffer bounds'
+  });
+  assert.strictEqual(cursor.offset, 0);
+}
+
+// Invalid schemas and arguments.
+{
+  common.expectsError(() => new BufferSchema('uint8'), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+  common.expectsError(() => new BufferSchema(['uint8', 'uint64le']), {
+    code: 'ERR_INVALID_ARG_VALUE',
+    type: TypeError
+  });
+  common.expectsError(() => new BufferSchema(['toString']), {
+    code: 'ERR_INVALID_ARG_VALUE',
+    type: TypeError
+  });
+  common.expectsError(() => new BufferCursor('abc'), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+  common.expectsError(() => new BufferCursor(Buffer.alloc(1), 2), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError
+  });
+  const cursor = new BufferCursor(Buffer.alloc(1));
+  common.expectsError(() => cursor.read('uint8'), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+  common.expectsError(() => cursor.write(['uint8'], 1), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+
+  const schema = new BufferSchema(['uint8']);
+  assert.ok(Object.isFrozen(schema.fields));
+  assert.deepStrictEqual(schema.fields, ['uint8']);
+}
@@ -23,3 +23,38 @@ common.expectsError(
     'Buffer or Uint8Array. Received type string'
   }
 );
+
+// Constant-time comparison gives the same answers as the default one.
+{
+  const opts = { constantTime: true };
+  assert.ok(b.equals(c, opts));
+  assert.ok(!c.equals(d, opts));
+  assert.ok(!d.equals(e, opts));
+  assert.ok(d.equals(d, opts));
+  assert.ok(b.equals(c, { constantTime: false }));
+  assert.ok(b.equals(c, {}));
+
+  // Differences in every position of inputs longer than a vector register.
+  for (const length of [15, 16, 17, 31, 32, 33, 100, 4096]) {
+    const x = Buffer.alloc(length, 0x5a);
+    const y = Buffer.alloc(length, 0x5a);
+    assert.ok(x.equals(y, opts));
+    for (let i = 0; i < length; i += (length > 100 ? 97 : 1)) {
+      y[i] ^= 0x80;
+      assert.ok(!x.equals(y, opts));
+      y[i] ^= 0x80;
+    }
+  }
+
+  for (const value of [null, 1, 'constantTime']) {
+    common.expectsError(
+      () => b.equals(c, value),
+      {
+        code: 'ERR_INVALID_ARG_TYPE',
+        type: TypeError,
+        message: 'The "options" argument must be of type Object. ' +
+                 `Received type ${value === null ? 'null' : typeof value}`
+      }
+    );
+  }
+}
@@ -481,3 +481,19 @@ common.expectsError(() => {
   code: 'ERR_INVALID_ARG_VALUE',
   type: TypeError
 });
+
+// Multi-byte patterns of every length up to and around the vector widths,
+// into buffers large enough to take the vectorized path.
+for (let patternLength = 1; patternLength <= 40; patternLength++) {
+  const pattern = Buffer.alloc(patternLength);
+  for (let i = 0; i < patternLength; i++)
+    pattern[i] = (i * 7 + patternLength) & 0xff;
+  for (const length of [63, 64, 65, 127, 200, 1027]) {
+    const buf = Buffer.alloc(length + 2, 0xee);
+    buf.fill(pattern, 1, length + 1);
+    assert.strictEqual(buf[0], 0xee);
+    assert.strictEqual(buf[length + 1], 0xee);
+    for (let i = 0; i < length; i++)
+      assert.strictEqual(buf[i + 1], pattern[i % patternLength]);
+  }
+}
@@ -604,3 +604,18 @@ assert.strictEqual(0, reallyLong.lastIndexOf(pattern));
   assert.strictEqual(haystack.indexOf(needle), 2);
   assert.strictEqual(haystack.lastIndexOf(needle), haystack.length - 3);
 }
+
+// lastIndexOf(number) across vector-sized blocks.
+{
+  const haystack = Buffer.alloc(257, 0x20);
+  assert.strictEqual(haystack.lastIndexOf(0x41), -1);
+  for (const pos of [0, 1, 15, 16, 31, 32, 33, 128, 255, 256]) {
+    haystack[pos] = 0x41;
+    assert.strictEqual(haystack.lastIndexOf(0x41), pos);
+    assert.strictEqual(haystack.lastIndexOf(0x41, pos), pos);
+    if (pos > 0)
+      assert.strictEqual(haystack.lastIndexOf(0x41, pos - 1), -1);
+    haystack[pos] = 0x20;
+    assert.strictEqual(haystack.lastIndexOf(0x41), -1);
+  }
+}
@@ -0,0 +1,99 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const buffer = require('buffer');
+const fs = require('fs');
+const path = require('path');
+
+const { acquire, release } = Buffer.pool;
+
+{
+  const buf = acquire(100 * 1024);
+  assert.ok(buf instanceof Buffer);
+  assert.strictEqual(buf.length, 100 * 1024);
+  assert.strictEqual(buf.byteOffset, 0);
+  buf.fill(0xab);
+
+  const slice = buf.slice(10, 20);
+  const stats = buffer.getAllocatorStatistics();
+  assert.ok(stats.poolBlocksInUse >= 1);
+
+  // Releasing detaches the memory from all views.
+  assert.strictEqual(release(buf), true);
+  assert.strictEqual(buf.length, 0);
+  assert.strictEqual(slice.length, 0);
+  assert.strictEqual(release(buf), false);
+
+  const after = buffer.getAllocatorStatistics();
+  assert.strictEqual(after.poolBlocksInUse, stats.poolBlocksInUse - 1);
+  assert.ok(after.poolRetainedBytes >= 128 * 1024);
+
+  // The released memory is handed out again for the same size class.
+  const reused = acquire(70 * 1024);
+  assert.strictEqual(reused.length, 70 * 1024);
+  assert.strictEqual(buffer.getAllocatorStatistics().poolRetainedBytes,
+                     after.poolRetainedBytes - 128 * 1024);
+  assert.strictEqual(release(reused), true);
+}
+
+// Buffers that don't belong to the pool are left alone.
+{
+  const buf = Buffer.allocUnsafe(64 * 1024);
+  assert.strictEqual(release(buf), false);
+  assert.strictEqual(buf.length, 64 * 1024);
+  assert.strictEqual(release(new Uint8Array(10)), false);
+}
+
+// Sizes that aren't pooled still return a usable Buffer.
+assert.strictEqual(acquire(0).length, 0);
+assert.strictEqual(acquire(2 * 1024 * 1024).length, 2 * 1024 * 1024);
+
+// Pooled memory is subject to the retention limit.
+{
+  buffer.setAllocatorRetentionLimit(0);
+  const buf = acquire(32 * 1024);
+  assert.strictEqual(release(buf), true);
+  assert.strictEqual(buffer.getAllocatorStatistics().poolRetainedBytes, 0);
+  buffer.setAllocatorRetentionLimit(8 * 1024 * 1024);
+}
+
+['1', null, undefined].forEach((size) => {
+  common.expectsError(() => acquire(size), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+});
+
+['1', null, undefined, {}, new ArrayBuffer(8)].forEach((buf) => {
+  common.expectsError(() => release(buf), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+});
+
+// Releasing a buffer that an asynchronous request still uses detaches it
+// right away but leaves the memory alone until the request is done with it.
+{
+  const tmpdir = require('../common/tmpdir');
+  tmpdir.refresh();
+  const file = path.join(tmpdir.path, 'buffer-pool-write.bin');
+  const fd = fs.openSync(file, 'w');
+  const buf = acquire(48 * 1024);
+  buf.fill(0x5a);
+  const inUse = buffer.getAllocatorStatistics().poolBlocksInUse;
+
+  fs.write(fd, buf, 0, buf.length, 0, common.mustCall((err, written) => {
+    assert.ifError(err);
+    assert.strictEqual(written, 48 * 1024);
+    assert.strictEqual(buffer.getAllocatorStatistics().poolBlocksInUse,
+                       inUse - 1);
+    fs.closeSync(fd);
+    const contents = fs.readFileSync(file);
+    assert.strictEqual(contents.length, 48 * 1024);
+    assert.ok(contents.every((byte) => byte === 0x5a));
+  }));
+
+  assert.strictEqual(release(buf), true);
+  assert.strictEqual(buf.length, 0);
+  assert.strictEqual(buffer.getAllocatorStatistics().poolBlocksInUse, inUse);
+}
@@ -0,0 +1,129 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+
+// Datagrams sent with sendBatch() arrive in order at a socket that receives
+// them in batches.
+
+const messages = [];
+for (let i = 0; i < 10; i++)
+  messages.push(Buffer.alloc(i * 100, String.fromCharCode(97 + i)));
+messages.push(Buffer.alloc(0));
+
+const server = dgram.createSocket({ type: 'udp4', recvBatchSize: 16 });
+const client = dgram.createSocket('udp4');
+const received = [];
+let batches = 0;
+
+server.on('message', common.mustNotCall());
+server.on('messages', common.mustCallAtLeast((data, offsets, rinfos) => {
+  batches++;
+  assert.ok(Buffer.isBuffer(data));
+  assert.ok(offsets instanceof Uint32Array);
+  assert.strictEqual(offsets.length, rinfos.length + 1);
+  assert.strictEqual(offsets[0], 0);
+  assert.strictEqual(offsets[rinfos.length], data.length);
+  for (let i = 0; i < rinfos.length; i++) {
+    assert.strictEqual(rinfos[i].address, common.localhostIPv4);
+    assert.strictEqual(rinfos[i].port, client.address().port);
+    received.push(data.slice(offsets[i], offsets[i + 1]));
+  }
+
+  if (received.length < messages.length)
+    return;
+  assert.deepStrictEqual(received, messages);
+  // All datagrams are queued by the time the server reads the first one.
+  if (common.isLinux)
+    assert.strictEqual(batches, 1);
+  server.close();
+  client.close();
+}));
+
+server.bind(0, common.localhostIPv4, common.mustCall(() => {
+  const { port } = server.address();
+  client.bind(0, common.localhostIPv4, common.mustCall(() => {
+    const batch = messages.map((msg) => ({ msg, port }));
+    batch[1].address = common.localhostIPv4;
+    const size = messages.reduce((size, msg) => size + msg.length, 0);
+    client.sendBatch(batch, common.mustCall((err, sent) => {
+      assert.ifError(err);
+      assert.strictEqual(sent, size);
+    }));
+  }));
+}));
+
+// An empty batch completes asynchronously.
+{
+  const socket = dgram.createSocket('udp4');
+  let sync = true;
+  socket.sendBatch([], common.mustCall((err, sent) => {
+    assert.ifError(err);
+    assert.strictEqual(sent, 0);
+    assert.strictEqual(sync, false);
+    socket.close();
+  }));
+  sync = false;
+}
+
+// Strings are sent as UTF-8.
+{
+  const socket = dgram.createSocket({ type: 'udp4', recvBatchSize: 1 });
+  socket.on('messages', common.mustCall((data, offsets, rinfos) => {
+    assert.strictEqual(rinfos.length, 1);
+    assert.strictEqual(data.toString(), 'héllo');
+    socket.close();
+  }));
+  socket.bind(0, common.localhostIPv4, common.mustCall(() => {
+    socket.sendBatch([{ msg: 'héllo', port: socket.address().port }]);
+  }));
+}
+
+{
+  const socket = dgram.createSocket('udp4');
+
+  common.expectsError(() => socket.sendBatch('hello'), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError,
+    message: 'The "messages" argument must be of type Array. ' +
+             'Received type string'
+  });
+  common.expectsError(() => socket.sendBatch([{ msg: 'a', port: 1 }, null]), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError,
+    message: 'The "messages[1]" argument must be of type Object. ' +
+             'Received type null'
+  });
+  common.expectsError(() => socket.sendBatch([{ msg: 1, port: 1 }]), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+  common.expectsError(() => socket.sendBatch([{ msg: 'a', port: 0 }]), {
+    code: 'ERR_SOCKET_BAD_PORT',
+    type: RangeError
+  });
+  common.expectsError(() => socket.sendBatch([{ msg: 'a', port: 1,
+                                                address: 1 }]), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+
+  socket.close();
+}
+
+common.expectsError(() => dgram.createSocket({ type: 'udp4',
+                                               recvBatchSize: '16' }), {
+  code: 'ERR_INVALID_ARG_TYPE',
+  type: TypeError,
+  message: 'The "options.recvBatchSize" property must be of type number. ' +
+           'Received type string'
+});
+for (const recvBatchSize of [0, 1.5, 1025, NaN]) {
+  common.expectsError(() => dgram.createSocket({ type: 'udp4',
+                                                 recvBatchSize }), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError,
+    message: 'The value of "options.recvBatchSize" is out of range. ' +
+             `It must be an integer >= 1 and <= 1024. Received ${recvBatchSize}`
+  });
+}
@@ -0,0 +1,162 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+
+// A connected socket sends to its peer without an address, and only receives
+// datagrams from that peer.
+
+const server = dgram.createSocket('udp4');
+const other = dgram.createSocket('udp4');
+const client = dgram.createSocket('udp4');
+const received = [];
+
+server.on('message', common.mustCall((msg, rinfo) => {
+  assert.strictEqual(rinfo.port, client.address().port);
+  received.push(msg.toString());
+  if (received.length < 4)
+    return;
+  assert.deepStrictEqual(received, ['hello', 'ell', 'a', 'b']);
+  server.send('reply', rinfo.port, rinfo.address);
+}, 4));
+
+client.on('message', common.mustCall((msg, rinfo) => {
+  // The datagram from the other socket is dropped.
+  assert.strictEqual(msg.toString(), 'reply');
+  assert.strictEqual(rinfo.port, server.address().port);
+
+  client.disconnect();
+  common.expectsError(() => client.disconnect(), {
+    code: 'ERR_SOCKET_DGRAM_NOT_CONNECTED',
+    type: Error,
+    message: 'Not connected'
+  });
+  common.expectsError(() => client.remoteAddress(), {
+    code: 'ERR_SOCKET_DGRAM_NOT_CONNECTED',
+    type: Error
+  });
+  common.expectsError(() => client.send('hello'), {
+    code: 'ERR_SOCKET_BAD_PORT',
+    type: RangeError
+  });
+
+  client.close();
+  server.close();
+  other.close();
+}));
+
+server.bind(0, common.localhostIPv4, common.mustCall(() => {
+  const { port } = server.address();
+  client.connect(port, common.localhostIPv4, common.mustCall((err) => {
+    assert.ifError(err);
+    assert.deepStrictEqual(client.remoteAddress(),
+                           { address: common.localhostIPv4, family: 'IPv4',
+                             port });
+
+    common.expectsError(() => client.connect(port), {
+      code: 'ERR_SOCKET_DGRAM_IS_CONNECTED',
+      type: Error,
+      message: 'Already connected'
+    });
+    common.expectsError(() => client.send('hello', port), {
+      code: 'ERR_SOCKET_DGRAM_IS_CONNECTED',
+      type: Error
+    });
+    common.expectsError(() => client.sendBatch([{ msg: 'a', port }]), {
+      code: 'ERR_SOCKET_DGRAM_IS_CONNECTED',
+      type: Error
+    });
+
+    client.send('hello', common.mustCall((err, sent) => {
+      assert.ifError(err);
+      assert.strictEqual(sent, 5);
+      client.send(Buffer.from('hello'), 1, 3, common.mustCall((err) => {
+        assert.ifError(err);
+        client.sendBatch([{ msg: 'a' }, { msg: 'b' }], common.mustCall());
+      }));
+    }));
+
+    other.send('intruder', client.address().port, common.localhostIPv4);
+  }));
+}));
+
+// Connecting to a name that does not resolve fails in the callback, and the
+// socket can be connected again afterwards.
+{
+  const socket = dgram.createSocket('udp4');
+  socket.connect(12345, 'does-not-exist.invalid', common.mustCall((err) => {
+    assert.ok(err instanceof Error);
+    socket.connect(12345, common.localhostIPv4, common.mustCall(() => {
+      assert.strictEqual(socket.remoteAddress().port, 12345);
+      socket.close();
+    }));
+  }));
+}
+
+{
+  const socket = dgram.createSocket('udp4');
+  common.expectsError(() => socket.connect(0), {
+    code: 'ERR_SOCKET_BAD_PORT',
+    type: RangeError
+  });
+  common.expectsError(() => socket.connect(12345, 1), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+  common.expectsError(() => socket.setGSO('1200'), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError,
+    message: 'The "segmentSize" argument must be of type number. ' +
+             'Received type string'
+  });
+  common.expectsError(() => socket.setGSO(65536), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError,
+    message: 'The value of "segmentSize" is out of range. ' +
+             'It must be an integer >= 0 and <= 65535. Received 65536'
+  });
+  socket.close();
+}
+
+// With GSO, one large message leaves as several datagrams, which GRO may
+// coalesce again on the way in. Either way, they are delivered one by one.
+if (common.isLinux) {
+  const receiver = dgram.createSocket({ type: 'udp4', recvBatchSize: 8 });
+  const sender = dgram.createSocket('udp4');
+  const segments = [];
+
+  receiver.on('messages', (data, offsets, rinfos) => {
+    for (let i = 0; i < rinfos.length; i++)
+      segments.push(data.slice(offsets[i], offsets[i + 1]));
+    if (segments.length < 10)
+      return;
+    assert.strictEqual(segments.length, 10);
+    for (let i = 0; i < 10; i++)
+      assert.deepStrictEqual(segments[i], Buffer.alloc(i < 9 ? 1000 : 500, i));
+    receiver.close();
+    sender.close();
+  });
+
+  receiver.bind(0, common.localhostIPv4, common.mustCall(() => {
+    const payload = Buffer.alloc(9500);
+    for (let i = 0; i < 10; i++)
+      payload.fill(i, i * 1000, i * 1000 + 1000);
+
+    sender.connect(receiver.address().port, common.localhostIPv4, () => {
+      try {
+        receiver.setGRO(true);
+        sender.setGSO(1000);
+      } catch (err) {
+        if (err.code !== 'ENOPROTOOPT' && err.code !== 'ENOTSUP')
+          throw err;
+        common.printSkipMessage(`UDP segmentation offload: ${err.code}`);
+        receiver.close();
+        sender.close();
+        return;
+      }
+      sender.send(payload, common.mustCall((err) => {
+        assert.ifError(err);
+      }));
+    });
+  }));
+}
@@ -0,0 +1,93 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const dgram = require('dgram');
+
+// Received datagrams are slices of shared chunks of memory, and datagrams that
+// are longer than maxDatagramSize are truncated.
+
+const messages = ['a', 'bb', Buffer.alloc(100, 'c'), Buffer.alloc(2000, 'd'),
+                  ''];
+
+{
+  const socket = dgram.createSocket({ type: 'udp4', maxDatagramSize: 1000 });
+  const received = [];
+
+  socket.on('message', common.mustCall((msg, rinfo) => {
+    assert.strictEqual(rinfo.size, msg.length);
+    received.push(msg);
+    if (received.length < messages.length)
+      return;
+
+    assert.deepStrictEqual(received.map(String), [
+      'a', 'bb', 'c'.repeat(100), 'd'.repeat(1000), ''
+    ]);
+    // The datagrams come from the same chunk, one after the other, at offsets
+    // that are multiples of 8.
+    for (let i = 1; i < received.length; i++) {
+      assert.strictEqual(received[i].buffer, received[0].buffer);
+      assert.ok(received[i].byteOffset >=
+                received[i - 1].byteOffset + received[i - 1].length);
+      assert.strictEqual(received[i].byteOffset % 8, 0);
+    }
+    socket.close();
+  }, messages.length));
+
+  socket.bind(0, common.localhostIPv4, common.mustCall(() => {
+    const { port } = socket.address();
+    // Send one at a time, so that the datagrams arrive in order everywhere.
+    let i = 0;
+    (function next() {
+      if (i < messages.length)
+        socket.send(messages[i++], port, common.localhostIPv4, next);
+    })();
+  }));
+}
+
+// Batches are sliced from the pool too.
+{
+  const socket = dgram.createSocket({ type: 'udp4', recvBatchSize: 8,
+                                      maxDatagramSize: 1000 });
+  const buffers = [];
+  let received = 0;
+
+  socket.on('messages', common.mustCallAtLeast((data, offsets, rinfos) => {
+    buffers.push(data);
+    for (let i = 0; i < rinfos.length; i++) {
+      const length = offsets[i + 1] - offsets[i];
+      assert.ok(length <= 1000, `${length}`);
+    }
+    received += rinfos.length;
+    if (received < messages.length)
+      return;
+
+    assert.strictEqual(received, messages.length);
+    for (const buffer of buffers)
+      assert.strictEqual(buffer.buffer, buffers[0].buffer);
+    socket.close();
+  }));
+
+  socket.bind(0, common.localhostIPv4, common.mustCall(() => {
+    const { port } = socket.address();
+    socket.sendBatch(messages.map((msg) => ({ msg, port })),
+                     common.mustCall());
+  }));
+}
+
+common.expectsError(() => dgram.createSocket({ type: 'udp4',
+                                               maxDatagramSize: '1500' }), {
+  code: 'ERR_INVALID_ARG_TYPE',
+  type: TypeError,
+  message: 'The "options.maxDatagramSize" property must be of type number. ' +
+           'Received type string'
+});
+for (const maxDatagramSize of [0, 1.5, 65537, NaN]) {
+  common.expectsError(() => dgram.createSocket({ type: 'udp4',
+                                                 maxDatagramSize }), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError,
+    message: 'The value of "options.maxDatagramSize" is out of range. ' +
+             'It must be an integer >= 1 and <= 65536. ' +
+             `Received ${maxDatagramSize}`
+  });
+}
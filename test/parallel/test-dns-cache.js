@@ -0,0 +1,155 @@
+'use strict';
+const common = require('../common');
+const dnstools = require('../common/dns');
+const dns = require('dns');
+const assert = require('assert');
+const dgram = require('dgram');
+const { promisify } = require('util');
+
+// The cache is off by default.
+assert.deepStrictEqual(dns.getCacheStats(),
+                       { hits: 0, misses: 0, coalesced: 0, evictions: 0,
+                         entries: 0 });
+
+const queries = new Map();
+const server = dgram.createSocket('udp4');
+
+server.on('message', (msg, { address, port }) => {
+  const parsed = dnstools.parseDNSPacket(msg);
+  const { domain } = parsed.questions[0];
+  queries.set(domain, (queries.get(domain) || 0) + 1);
+
+  const reply = { id: parsed.id, questions: parsed.questions, answers: [] };
+  if (domain === 'missing.example.org') {
+    // NXDOMAIN
+    reply.flags = 0x8183;
+  } else {
+    reply.answers.push({
+      type: 'A',
+      address: '1.2.3.4',
+      ttl: domain === 'uncacheable.example.org' ? 0 : 123,
+      domain
+    });
+  }
+  server.send(dnstools.writeDNSPacket(reply), port, address);
+});
+
+function resolver() {
+  const resolver = new dns.Resolver();
+  resolver.setServers([`127.0.0.1:${server.address().port}`]);
+  return {
+    resolve4: promisify(resolver.resolve4.bind(resolver))
+  };
+}
+
+function statsSince(before) {
+  const now = dns.getCacheStats();
+  const delta = {};
+  for (const key of Object.keys(now))
+    delta[key] = now[key] - before[key];
+  return delta;
+}
+
+const lookup = promisify(dns.lookup);
+
+async function test() {
+  dns.setCacheOptions({ maxTtl: 60, negativeTtl: 60 });
+  const { resolve4 } = resolver();
+
+  // Identical queries in flight are sent once, and their answer is cached.
+  let before = dns.getCacheStats();
+  const results = await Promise.all([
+    resolve4('example.org'),
+    resolve4('example.org'),
+    resolve4('example.org', { ttl: true })
+  ]);
+  assert.deepStrictEqual(results, [
+    ['1.2.3.4'],
+    ['1.2.3.4'],
+    [{ address: '1.2.3.4', ttl: 123 }]
+  ]);
+  assert.deepStrictEqual(await resolve4('example.org'), ['1.2.3.4']);
+  assert.strictEqual(queries.get('example.org'), 1);
+  assert.deepStrictEqual(statsSince(before),
+                         { hits: 1, misses: 3, coalesced: 2, evictions: 0,
+                           entries: 1 });
+
+  // Names that do not exist are cached for the negative TTL.
+  for (let i = 0; i < 2; i++) {
+    const err = await resolve4('missing.example.org').then(
+      common.mustNotCall(), (err) => err);
+    assert.strictEqual(err.code, 'ENOTFOUND');
+  }
+  assert.strictEqual(queries.get('missing.example.org'), 1);
+
+  // Records with a TTL of 0 are not cached.
+  for (let i = 0; i < 2; i++)
+    await resolve4('uncacheable.example.org');
+  assert.strictEqual(queries.get('uncacheable.example.org'), 2);
+
+  // Resolvers do not share answers, as they may use different servers.
+  await resolver().resolve4('example.org');
+  assert.strictEqual(queries.get('example.org'), 2);
+
+  // dns.lookup() coalesces and caches too, for every kind of result.
+  before = dns.getCacheStats();
+  const [first, second] = await Promise.all([
+    lookup('localhost', { family: 4 }),
+    lookup('localhost', { family: 4, all: true })
+  ]);
+  assert.strictEqual(first.family, 4);
+  assert.deepStrictEqual(second[0], first);
+  assert.deepStrictEqual(await lookup('localhost', 4), first);
+  assert.deepStrictEqual(await lookup('localhost', { family: 4, all: true }),
+                         second);
+  const stats = statsSince(before);
+  assert.strictEqual(stats.coalesced, 1);
+  assert.strictEqual(stats.hits, 2);
+
+  // Only as many entries as configured are kept.
+  dns.setCacheOptions({ maxTtl: 60, maxEntries: 1 });
+  assert.strictEqual(dns.getCacheStats().entries, 0);
+  await resolve4('example.org');
+  await lookup('localhost', 4);
+  assert.strictEqual(dns.getCacheStats().entries, 1);
+  await resolve4('example.org');
+  assert.strictEqual(queries.get('example.org'), 4);
+
+  dns.clearCache();
+  assert.strictEqual(dns.getCacheStats().entries, 0);
+
+  // Without a maximum TTL, the cache is disabled again.
+  dns.setCacheOptions({});
+  await resolve4('example.org');
+  await resolve4('example.org');
+  assert.strictEqual(queries.get('example.org'), 6);
+
+  server.close();
+}
+
+server.bind(0, '127.0.0.1', common.mustCall(() => {
+  test().then(common.mustCall());
+}));
+
+common.expectsError(() => dns.setCacheOptions(), {
+  code: 'ERR_INVALID_ARG_TYPE',
+  type: TypeError
+});
+common.expectsError(() => dns.setCacheOptions({ maxTtl: '60' }), {
+  code: 'ERR_INVALID_ARG_TYPE',
+  type: TypeError,
+  message: 'The "options.maxTtl" property must be of type number. ' +
+           'Received type string'
+});
+for (const maxTtl of [-1, NaN, 2 ** 31]) {
+  common.expectsError(() => dns.setCacheOptions({ maxTtl }), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError
+  });
+}
+common.expectsError(() => dns.setCacheOptions({ maxEntries: 1.5 }), {
+  code: 'ERR_OUT_OF_RANGE',
+  type: RangeError,
+  message: 'The value of "options.maxEntries" is out of range. ' +
+           'It must be an integer >= 0 and <= 2^32 - 1. Received 1.5'
+});
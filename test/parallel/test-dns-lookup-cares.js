@@ -0,0 +1,100 @@
+'use strict';
+const common = require('../common');
+const { createStubResolver } = require('../common/dns');
+const assert = require('assert');
+const dns = require('dns');
+
+// dns.lookup() in c-ares mode answers from the hosts file first, and asks the
+// configured DNS servers otherwise.
+
+function lookup(hostname, options) {
+  return new Promise((resolve, reject) => {
+    dns.lookup(hostname, options, (err, ...results) => {
+      if (err)
+        reject(err);
+      else
+        resolve(results);
+    });
+  });
+}
+
+function lookupError(hostname, options) {
+  return lookup(hostname, options).then(common.mustNotCall(), (err) => err);
+}
+
+const records = {
+  'example.org': [
+    { type: 'A', address: '1.2.3.4', ttl: 60 },
+    { type: 'A', address: '1.2.3.5', ttl: 60 },
+    { type: 'AAAA', address: '2001:db8::1', ttl: 60 }
+  ],
+  'v4only.example.org': [
+    { type: 'A', address: '5.6.7.8', ttl: 60 }
+  ]
+};
+
+async function test(server) {
+  dns.setServers([`127.0.0.1:${server.address().port}`]);
+  dns.setLookupMode('cares');
+
+  assert.deepStrictEqual(await lookup('example.org', 4), ['1.2.3.4', 4]);
+  assert.deepStrictEqual(await lookup('example.org', 6), ['2001:db8::1', 6]);
+  assert.deepStrictEqual(await lookup('example.org', { all: true }), [[
+    { address: '1.2.3.4', family: 4 },
+    { address: '1.2.3.5', family: 4 },
+    { address: '2001:db8::1', family: 6 }
+  ]]);
+  assert.deepStrictEqual(
+    await lookup('EXAMPLE.org', { all: true, verbatim: true }), [[
+      { address: '2001:db8::1', family: 6 },
+      { address: '1.2.3.4', family: 4 },
+      { address: '1.2.3.5', family: 4 }
+    ]]);
+
+  // Names with addresses of one family only.
+  assert.deepStrictEqual(await lookup('v4only.example.org', {}),
+                         ['5.6.7.8', 4]);
+  assert.deepStrictEqual(
+    await lookup('v4only.example.org', { family: 6, hints: dns.V4MAPPED }),
+    ['::ffff:5.6.7.8', 6]);
+
+  // Failures look the same as with getaddrinfo().
+  for (const [hostname, family] of [['v4only.example.org', 6],
+                                    ['missing.example.org', 0]]) {
+    const err = await lookupError(hostname, family);
+    assert.strictEqual(err.code, 'ENOTFOUND');
+    assert.strictEqual(err.syscall, 'getaddrinfo');
+    assert.strictEqual(err.hostname, hostname);
+  }
+
+  // Names in the hosts file never reach the DNS server.
+  assert.deepStrictEqual(await lookup('localhost', 4), ['127.0.0.1', 4]);
+  assert.ok(!server.queries.some((query) => query.includes('localhost')),
+            server.queries);
+
+  // The mode can also be chosen for a single lookup.
+  dns.setLookupMode('getaddrinfo');
+  server.queries.length = 0;
+  assert.deepStrictEqual(
+    await lookup('v4only.example.org', { family: 4, mode: 'cares' }),
+    ['5.6.7.8', 4]);
+  assert.strictEqual(server.queries.pop(), 'A v4only.example.org');
+
+  server.close();
+}
+
+createStubResolver(records, common.mustCall((server) => {
+  test(server).then(common.mustCall());
+}));
+
+common.expectsError(() => dns.setLookupMode('libc'), {
+  code: 'ERR_INVALID_ARG_VALUE',
+  type: TypeError,
+  message: "The argument 'mode' must be 'getaddrinfo' or 'cares'. " +
+           "Received 'libc'"
+});
+common.expectsError(() => dns.lookup('example.org', { mode: 1 },
+                                     common.mustNotCall()), {
+  code: 'ERR_INVALID_ARG_VALUE',
+  type: TypeError
+});
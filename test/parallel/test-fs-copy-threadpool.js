@@ -0,0 +1,41 @@
+'use strict';
+const common = require('../common');
+const tmpdir = require('../common/tmpdir');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+// fs.copy() queues every file as a threadpool request of its own, so other
+// requests are not held up until the whole tree has been copied.
+
+tmpdir.refresh();
+
+const src = path.join(tmpdir.path, 'src');
+fs.mkdirSync(src);
+const data = Buffer.alloc(64 * 1024, 'x');
+for (let i = 0; i < 500; i++)
+  fs.writeFileSync(path.join(src, `file-${i}`), data);
+
+let copied = false;
+let statted = false;
+let statStarted = false;
+fs.copy(src, path.join(tmpdir.path, 'dest'),
+        { recursive: true, progressInterval: 1 },
+        common.mustCall((err) => {
+          assert.ifError(err);
+          copied = true;
+          // A stat request made while the copy was under way is done first.
+          if (statStarted)
+            assert.ok(statted);
+        })).on('progress', (progress) => {
+  // Start the stat request once the copy is under way, while enough files
+  // are left that some of them are queued after it.
+  if (statStarted || progress.totalFiles - progress.filesCopied < 16)
+    return;
+  statStarted = true;
+  fs.stat(src, common.mustCall((err) => {
+    assert.ifError(err);
+    assert.strictEqual(copied, false);
+    statted = true;
+  }));
+});
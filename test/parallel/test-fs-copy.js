@@ -0,0 +1,115 @@
+'use strict';
+const common = require('../common');
+const tmpdir = require('../common/tmpdir');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+tmpdir.refresh();
+
+const src = path.join(tmpdir.path, 'src');
+fs.mkdirSync(src);
+fs.mkdirSync(path.join(src, 'nested'));
+fs.mkdirSync(path.join(src, 'nested', 'deeper'));
+fs.mkdirSync(path.join(src, 'empty-dir'));
+
+const files = {
+  'a.txt': 'a',
+  'empty': '',
+  'nested/b.txt': 'b'.repeat(1024),
+  'nested/deeper/c.bin': Buffer.alloc(1024 * 1024, 'c'),
+};
+let totalBytes = 0;
+for (const name of Object.keys(files)) {
+  fs.writeFileSync(path.join(src, name), files[name]);
+  totalBytes += Buffer.byteLength(files[name]);
+}
+if (common.canCreateSymLink())
+  fs.symlinkSync('a.txt', path.join(src, 'link'));
+
+function verify(dest) {
+  for (const name of Object.keys(files)) {
+    assert.deepStrictEqual(fs.readFileSync(path.join(dest, name)),
+                           Buffer.from(files[name]));
+  }
+  assert.ok(fs.statSync(path.join(dest, 'empty-dir')).isDirectory());
+  if (common.canCreateSymLink())
+    assert.strictEqual(fs.readlinkSync(path.join(dest, 'link')), 'a.txt');
+}
+
+// Copies a directory tree and reports progress.
+{
+  const dest = path.join(tmpdir.path, 'dest');
+  let last;
+  fs.copy(src, dest, { recursive: true, concurrency: 2 }, common.mustCall(
+    (err) => {
+      assert.ifError(err);
+      verify(dest);
+      assert.deepStrictEqual(last, {
+        bytesCopied: totalBytes,
+        totalBytes,
+        filesCopied: Object.keys(files).length,
+        totalFiles: Object.keys(files).length
+      });
+
+      // Copying again overwrites the existing files.
+      fs.writeFileSync(path.join(dest, 'a.txt'), 'changed');
+      fs.copy(src, dest, { recursive: true }, common.mustCall((err) => {
+        assert.ifError(err);
+        verify(dest);
+
+        // Unless COPYFILE_EXCL is passed.
+        const flags = fs.constants.COPYFILE_EXCL;
+        fs.copy(src, dest, { recursive: true, flags }, common.mustCall(
+          (err) => {
+            assert.strictEqual(err.code, 'EEXIST');
+          }));
+      }));
+    })).on('progress', common.mustCallAtLeast((progress) => {
+    assert.ok(progress.bytesCopied <= progress.totalBytes);
+    assert.ok(progress.filesCopied <= progress.totalFiles);
+    last = progress;
+  }));
+}
+
+// A single file is copied like fs.copyFile() does.
+fs.copy(path.join(src, 'a.txt'), path.join(tmpdir.path, 'single.txt'),
+        common.mustCall((err) => {
+          assert.ifError(err);
+          assert.strictEqual(
+            fs.readFileSync(path.join(tmpdir.path, 'single.txt'), 'utf8'), 'a');
+        }));
+
+// Directories are only copied with the recursive option.
+fs.copy(src, path.join(tmpdir.path, 'not-recursive'), common.mustCall((err) => {
+  assert.strictEqual(err.code, 'EISDIR');
+  assert.strictEqual(err.syscall, 'copyfile');
+}));
+
+fs.copy(path.join(src, 'does-not-exist'), path.join(tmpdir.path, 'missing'),
+        common.mustCall((err) => {
+          assert.strictEqual(err.code, 'ENOENT');
+        }));
+
+common.expectsError(
+  () => fs.copy(src, path.join(src, 'nested', 'copy'), { recursive: true },
+                common.mustNotCall()),
+  { code: 'ERR_INVALID_ARG_VALUE', type: TypeError }
+);
+
+common.expectsError(
+  () => fs.copy(src, tmpdir.path, { concurrency: 0 }, common.mustNotCall()),
+  { code: 'ERR_OUT_OF_RANGE', type: RangeError }
+);
+
+[-1, 1.5, 'foo'].forEach((concurrency) => {
+  common.expectsError(
+    () => fs.copy(src, tmpdir.path, { concurrency }, common.mustNotCall()),
+    { code: 'ERR_INVALID_ARG_TYPE', type: TypeError }
+  );
+});
+
+common.expectsError(
+  () => fs.copy(src, tmpdir.path, {}),
+  { code: 'ERR_INVALID_ARG_TYPE', type: TypeError }
+);
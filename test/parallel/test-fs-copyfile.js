@@ -106,3 +106,28 @@ common.expectsError(() => {
 assert.throws(() => {
   fs.copyFileSync(src, dest, -1);
 }, /^Error: EINVAL: invalid argument, copyfile/);
+
+// Copying a file onto itself leaves it intact.
+fs.copyFileSync(dest, dest);
+verify(src, dest);
+
+// Verify that the reflink flag is defined.
+assert.strictEqual(typeof fs.constants.COPYFILE_FICLONE_FORCE, 'number');
+assert.strictEqual(fs.constants.COPYFILE_FICLONE_FORCE,
+                   fs.constants.UV_FS_COPYFILE_FICLONE_FORCE);
+
+// Files that report a size of 0 are copied until EOF.
+if (common.isLinux) {
+  const procDest = path.join(tmpdir.path, 'copyfile-proc.out');
+  fs.copyFileSync('/proc/self/cmdline', procDest);
+  assert.ok(fs.statSync(procDest).size > 0);
+}
+
+// sysfs files report a nominal size that copy_file_range() does not deliver.
+if (common.isLinux && fs.existsSync('/sys/devices/system/cpu/online')) {
+  const sysSrc = '/sys/devices/system/cpu/online';
+  const sysDest = path.join(tmpdir.path, 'copyfile-sys.out');
+  fs.copyFileSync(sysSrc, sysDest);
+  assert.strictEqual(fs.readFileSync(sysDest, 'utf8'),
+                     fs.readFileSync(sysSrc, 'utf8'));
+}
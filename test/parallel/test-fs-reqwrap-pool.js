@@ -0,0 +1,62 @@
+'use strict';
+
+// Async fs calls made with a plain callback reuse pooled native requests.
+// Make sure a reused request behaves like a fresh one: callbacks run with an
+// undefined receiver, every use gets its own async id and idle requests do
+// not show up as active.
+
+const common = require('../common');
+const assert = require('assert');
+const async_hooks = require('async_hooks');
+const fs = require('fs');
+
+const ids = new Set();
+const hooks = async_hooks.createHook({
+  init(id, type) {
+    if (type === 'FSREQWRAP') {
+      assert(!ids.has(id));
+      ids.add(id);
+    }
+  }
+}).enable();
+
+const rounds = 4;
+const concurrency = 16;
+
+function round(n) {
+  if (n === 0) {
+    assert.strictEqual(process._getActiveRequests().length, 0);
+
+    // Errors are delivered through the pooled request as well.
+    fs.lstat(`${__filename}-does-not-exist`, common.mustCall(function(err) {
+      assert.strictEqual(this, undefined);
+      assert.strictEqual(err.code, 'ENOENT');
+      assert.strictEqual(err.syscall, 'lstat');
+    }));
+    return;
+  }
+
+  let pending = concurrency * 2;
+  const done = common.mustCall(function() {
+    assert.strictEqual(this, undefined);
+    if (--pending === 0)
+      setImmediate(round, n - 1);
+  }, concurrency * 2);
+
+  for (let i = 0; i < concurrency; i++) {
+    fs.stat(__filename, common.mustCall(function(err, stats) {
+      assert.ifError(err);
+      assert.ok(stats.isFile());
+      done.call(this);
+    }));
+    fs.access(__filename, done);
+  }
+  assert.strictEqual(process._getActiveRequests().length, concurrency * 2);
+}
+
+round(rounds);
+
+process.on('exit', () => {
+  hooks.disable();
+  assert.strictEqual(ids.size, rounds * concurrency * 2 + 1);
+});
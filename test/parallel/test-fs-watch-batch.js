@@ -0,0 +1,88 @@
+'use strict';
+const common = require('../common');
+
+if (!(common.isOSX || common.isWindows || common.isLinux))
+  common.skip('recursive option is darwin/windows/linux specific');
+
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+const tmpdir = require('../common/tmpdir');
+tmpdir.refresh();
+
+[-1, 1.5, 'foo', {}].forEach((batchWindow) => {
+  common.expectsError(
+    () => fs.watch(tmpdir.path, { batchWindow }),
+    { code: 'ERR_INVALID_ARG_TYPE', type: TypeError }
+  );
+});
+
+common.expectsError(
+  () => fs.watch(tmpdir.path, { batchWindow: 10, maxBatchSize: 0 }),
+  { code: 'ERR_OUT_OF_RANGE', type: RangeError }
+);
+
+const subdir = path.join(tmpdir.path, 'sub');
+fs.mkdirSync(subdir);
+const files = [];
+for (let i = 0; i < 4; i++)
+  files.push(path.join(subdir, `file-${i}`));
+
+// Subdirectories are watched once they have been found in the background, so
+// the tests below keep writing until they see what they expect.
+
+// Several writes to the same files within the batch window are coalesced
+// into a single entry per path.
+{
+  const watcher = fs.watch(tmpdir.path, { recursive: true, batchWindow: 100 });
+  watcher.on('change', common.mustNotCall());
+  watcher.on('overflow', common.mustNotCall());
+
+  const pending =
+    new Set(files.map((file) => path.relative(tmpdir.path, file)));
+  watcher.on('changes', common.mustCallAtLeast((changes, overflow) => {
+    assert.strictEqual(Array.isArray(changes), true);
+    assert.strictEqual(overflow, false);
+    const seen = new Set();
+    for (const { eventType, filename } of changes) {
+      assert.ok(eventType === 'change' || eventType === 'rename');
+      assert.strictEqual(seen.has(filename), false);
+      seen.add(filename);
+      pending.delete(filename);
+    }
+    if (pending.size === 0) {
+      clearInterval(interval);
+      watcher.close();
+      testOverflow();
+    }
+  }));
+
+  const interval = setInterval(() => {
+    for (let round = 0; round < 3; round++)
+      for (const file of files)
+        fs.writeFileSync(file, `round ${round}`);
+  }, 50);
+}
+
+// Once maxBatchSize distinct paths are queued further paths are dropped and
+// the batch is flagged as overflowed.
+function testOverflow() {
+  const watcher = fs.watch(tmpdir.path, {
+    recursive: true,
+    batchWindow: 100,
+    maxBatchSize: 2
+  }, common.mustCallAtLeast((changes, overflow) => {
+    assert.ok(changes.length <= 2);
+    if (overflow) {
+      clearInterval(interval);
+      watcher.close();
+    }
+  }));
+  watcher.on('overflow', common.mustCall());
+
+  const interval = setInterval(() => {
+    for (let i = 0; i < 8; i++)
+      fs.writeFileSync(path.join(subdir, `overflow-${i}`), 'x');
+  }, 50);
+}
@@ -2,8 +2,8 @@
 
 const common = require('../common');
 
-if (!(common.isOSX || common.isWindows))
-  common.skip('recursive option is darwin/windows specific');
+if (!(common.isOSX || common.isWindows || common.isLinux))
+  common.skip('recursive option is darwin/windows/linux specific');
 
 const assert = require('assert');
 const path = require('path');
@@ -30,15 +30,17 @@ watcher.on('change', function(event, filename) {
   if (filename !== relativePathOne)
     return;
 
-  if (common.isOSX) {
+  if (common.isOSX || common.isLinux) {
     clearInterval(interval);
   }
   watcher.close();
   watcherClosed = true;
 });
 
+// On Linux, subdirectories are watched once they have been found in the
+// background, so keep writing until the change is seen.
 let interval;
-if (common.isOSX) {
+if (common.isOSX || common.isLinux) {
   interval = setInterval(function() {
     fs.writeFileSync(filepathOne, 'world');
   }, 10);
@@ -0,0 +1,82 @@
+'use strict';
+const common = require('../common');
+
+// On Linux fs.watchFile() is driven by inotify events on the parent directory
+// instead of polling. Use an interval that is far too long for polling to
+// notice anything so that only the event based backend can pass this test.
+
+if (!common.isLinux)
+  common.skip('inotify based fs.watchFile() is only used on Linux');
+
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+
+const tmpdir = require('../common/tmpdir');
+tmpdir.refresh();
+
+const options = { interval: 1e8 };
+const files = [];
+for (let i = 0; i < 8; i++) {
+  const file = path.join(tmpdir.path, `file-${i}`);
+  fs.writeFileSync(file, 'a');
+  files.push(file);
+}
+
+// Watchers on the other files in the directory must not fire.
+for (const file of files.slice(1))
+  fs.watchFile(file, options, common.mustNotCall());
+
+const target = files[0];
+const steps = [
+  (curr, prev) => {
+    assert.strictEqual(prev.size, 1);
+    assert.strictEqual(curr.size, 3);
+    fs.unlinkSync(target);
+  },
+  (curr, prev) => {
+    assert.strictEqual(prev.size, 3);
+    assert.strictEqual(curr.size, 0);
+    assert.strictEqual(curr.ino, 0);
+    fs.writeFileSync(target, 'abcde');
+  },
+  (curr, prev) => {
+    assert.strictEqual(prev.size, 3);
+    assert.strictEqual(curr.size, 5);
+    for (const file of files)
+      fs.unwatchFile(file);
+  }
+];
+
+fs.watchFile(target, options, common.mustCall((curr, prev) => {
+  steps.shift()(curr, prev);
+}, steps.length));
+
+// Whether a file can be watched through events is checked on the threadpool.
+// Stopping the watcher before that check is done must leave it stopped.
+{
+  const file = path.join(tmpdir.path, 'stopped-early');
+  fs.writeFileSync(file, 'a');
+  fs.watchFile(file, options, common.mustNotCall());
+  fs.unwatchFile(file);
+  setTimeout(() => fs.writeFileSync(file, 'ab'), common.platformTimeout(100));
+}
+
+// Give the initial stat() calls a chance to complete first.
+setTimeout(() => fs.writeFileSync(target, 'abc'), common.platformTimeout(100));
+
+// Symbolic links are polled, as inotify would only report changes to the link
+// itself and not to its target.
+if (common.canCreateSymLink()) {
+  const linkTarget = path.join(tmpdir.path, 'link-target');
+  const link = path.join(tmpdir.path, 'link');
+  fs.writeFileSync(linkTarget, 'a');
+  fs.symlinkSync(linkTarget, link);
+  fs.watchFile(link, { interval: 10 }, common.mustCall((curr, prev) => {
+    assert.strictEqual(prev.size, 1);
+    assert.strictEqual(curr.size, 2);
+    fs.unwatchFile(link);
+  }));
+  setTimeout(() => fs.writeFileSync(linkTarget, 'ab'),
+             common.platformTimeout(100));
+}
@@ -0,0 +1,110 @@
+'use strict';
+
+const common = require('../common');
+
+if (!common.hasIntl)
+  common.skip('missing Intl');
+
+const buffer = require('buffer');
+const assert = require('assert');
+const { TextDecoder } = require('util');
+
+// Every combination of supported encodings gives the same results as
+// converting the buffers one at a time.
+{
+  const strings = ['tést €', '', 'hi', '€'.repeat(4000), 'hä'];
+  const encodings = ['utf8', 'ucs2', 'latin1', 'ascii'];
+  for (const from of encodings) {
+    const sources = strings.map((s) => Buffer.from(s, from));
+    for (const to of encodings) {
+      const results = buffer.transcodeMany(sources, from, to);
+      assert.strictEqual(results.length, sources.length);
+      for (let i = 0; i < sources.length; i++) {
+        assert.ok(Buffer.isBuffer(results[i]));
+        assert.deepStrictEqual(results[i],
+                               buffer.transcode(sources[i], from, to));
+      }
+    }
+  }
+}
+
+// Converters are reused between calls without carrying state over, including
+// an incomplete sequence at the end of an input.
+{
+  const incomplete = Buffer.from([0x61, 0xe2, 0x82]);
+  const complete = Buffer.from('€b');
+  for (let i = 0; i < 3; i++) {
+    assert.deepStrictEqual(
+      buffer.transcodeMany([incomplete, complete], 'utf8', 'latin1'),
+      [Buffer.from('a?', 'latin1'), Buffer.from('?b', 'latin1')]);
+  }
+}
+
+assert.deepStrictEqual(buffer.transcodeMany([], 'utf8', 'ucs2'), []);
+assert.deepStrictEqual(
+  buffer.transcodeMany([new Uint8Array([0x68, 0xe4])], 'latin1', 'utf16le'),
+  [Buffer.from('hä', 'utf16le')]);
+
+common.expectsError(
+  () => buffer.transcodeMany(Buffer.from('a'), 'utf8', 'ascii'),
+  {
+    type: TypeError,
+    code: 'ERR_INVALID_ARG_TYPE',
+    message: 'The "sources" argument must be of type Array. ' +
+             'Received type object'
+  }
+);
+
+common.expectsError(
+  () => buffer.transcodeMany([Buffer.from('a'), 'b'], 'utf8', 'ascii'),
+  {
+    type: TypeError,
+    code: 'ERR_INVALID_ARG_TYPE',
+    message: 'The "sources[1]" argument must be one of type Buffer ' +
+             'or Uint8Array. Received type string'
+  }
+);
+
+assert.throws(
+  () => buffer.transcodeMany([Buffer.from('a')], 'b', 'utf8'),
+  /^Error: Unable to transcode Buffer \[U_ILLEGAL_ARGUMENT_ERROR\]$/
+);
+
+// Elements that change after being validated are rejected without aborting.
+{
+  const sources = [Buffer.from('a')];
+  let reads = 0;
+  Object.defineProperty(sources, 0, {
+    get() {
+      return ++reads === 1 ? Buffer.from('a') : 'a';
+    }
+  });
+  assert.throws(
+    () => buffer.transcodeMany(sources, 'utf8', 'ascii'),
+    /^Error: Unable to transcode Buffer \[U_ILLEGAL_ARGUMENT_ERROR\]$/
+  );
+
+  const throwing = [Buffer.from('a')];
+  reads = 0;
+  Object.defineProperty(throwing, 0, {
+    get: () => {
+      if (++reads > 1)
+        throw new Error('boom');
+      return Buffer.from('a');
+    }
+  });
+  assert.throws(() => buffer.transcodeMany(throwing, 'utf8', 'ascii'),
+                /^Error: boom$/);
+}
+
+// Cached converters keep their configuration apart: fatal and non-fatal
+// TextDecoders for the same encoding can be created in any order.
+{
+  const invalid = new Uint8Array([0x61, 0xff, 0x62]);
+  for (let i = 0; i < 3; i++) {
+    assert.throws(() => new TextDecoder('utf-8', { fatal: true })
+                          .decode(invalid),
+                  TypeError);
+    assert.strictEqual(new TextDecoder('utf-8').decode(invalid), 'a\ufffdb');
+  }
+}
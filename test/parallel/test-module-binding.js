@@ -1,15 +1,56 @@
 'use strict';
 require('../common');
 const fixtures = require('../common/fixtures');
+const tmpdir = require('../common/tmpdir');
 const { internalModuleReadJSON } = process.binding('fs');
-const { readFileSync } = require('fs');
-const { strictEqual } = require('assert');
+const fs = require('fs');
+const path = require('path');
+const { deepStrictEqual, strictEqual, throws } = require('assert');
 
 strictEqual(internalModuleReadJSON('nosuchfile'), undefined);
 strictEqual(internalModuleReadJSON(fixtures.path('empty.txt')), undefined);
 strictEqual(internalModuleReadJSON(fixtures.path('empty-with-bom.txt')),
             undefined);
+strictEqual(internalModuleReadJSON(fixtures.path('require-bin')), undefined);
 {
   const filename = fixtures.path('require-bin/package.json');
-  strictEqual(internalModuleReadJSON(filename), readFileSync(filename, 'utf8'));
+  deepStrictEqual(internalModuleReadJSON(filename),
+                  ['./lib/req.js']);
+  // Served from the cache the second time around.
+  deepStrictEqual(internalModuleReadJSON(filename),
+                  ['./lib/req.js']);
+}
+
+tmpdir.refresh();
+
+{
+  const filename = path.join(tmpdir.path, 'package.json');
+  fs.writeFileSync(filename, JSON.stringify({ main: 'a.js' }));
+  deepStrictEqual(internalModuleReadJSON(filename), ['a.js']);
+
+  // A changed file is picked up even if its size stays the same.
+  fs.writeFileSync(filename, JSON.stringify({ main: 'b.js' }));
+  const future = Date.now() / 1000 + 60;
+  fs.utimesSync(filename, future, future);
+  deepStrictEqual(internalModuleReadJSON(filename), ['b.js']);
+
+  // Invalid JSON is handed back as source text for error reporting.
+  const source = '{ "main": ';
+  fs.writeFileSync(filename, source);
+  fs.utimesSync(filename, future + 60, future + 60);
+  strictEqual(internalModuleReadJSON(filename), source);
+
+  throws(() => require(tmpdir.path), (err) => {
+    return err instanceof SyntaxError &&
+           err.path === filename &&
+           err.message.startsWith(`Error parsing ${filename}: `);
+  });
+
+  // Invalid JSON without "main" is skipped, and index.js is loaded instead.
+  fs.writeFileSync(filename, '{ "name": ');
+  fs.utimesSync(filename, future + 120, future + 120);
+  strictEqual(internalModuleReadJSON(filename), undefined);
+  fs.writeFileSync(path.join(tmpdir.path, 'index.js'),
+                   'module.exports = 42;');
+  strictEqual(require(tmpdir.path), 42);
 }
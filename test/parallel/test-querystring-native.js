@@ -0,0 +1,69 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const qs = require('querystring');
+
+// Strings of at least 32 characters with single character ASCII separators
+// are parsed by the binding, shorter ones in JS. Padding a short input with an
+// extra pair therefore compares both parsers on the same data.
+const padding = `pad=${'x'.repeat(32)}`;
+
+function parseBoth(input, sep = '&', eq = '=') {
+  const short = qs.parse(input, sep, eq);
+  const long = qs.parse(`${padding}${sep}${input}`, sep, eq);
+  assert.strictEqual(long.pad, 'x'.repeat(32));
+  delete long.pad;
+  assert.deepStrictEqual(long, short);
+  return short;
+}
+
+const cases = [
+  '', '&', '&&', '=', '==', '&=&', 'a', 'a=', '=a', 'a=b=c', 'a&b', 'a&&b',
+  'a=1&a=2&a=3', 'a+b=c+d', '+=+', '%41=%42', '%4=1', '%4', '%%41=1',
+  '%4%41=x', '%zz=%', 'a=%4+1', '%2B=%2b', 'a=%e2%82%ac', 'a=%e2%82',
+  'a=%ff%fe', '%C3%A9=%c3', 'a=1&', 'a=1&=', '&a=1', 'a=%2', 'x=%%%',
+  'toString=1&__proto__=2'
+];
+
+for (const input of cases)
+  parseBoth(input);
+
+assert.deepStrictEqual(parseBoth('a+b=c+d&%41=%e2%82%ac'),
+                       Object.assign(Object.create(null),
+                                     { 'a b': 'c d', 'A': '€' }));
+assert.deepStrictEqual(parseBoth('%4%41=%zz'),
+                       Object.assign(Object.create(null), { '%4%41': '%zz' }));
+
+// Custom single character separators.
+parseBoth('a:1;b:2;b:3', ';', ':');
+parseBoth('a=1;b', ';');
+
+// Non-ASCII input falls back to the JS parser.
+assert.deepStrictEqual(
+  qs.parse(`${padding}&é=€%41`),
+  Object.assign(Object.create(null),
+                { pad: 'x'.repeat(32), 'é': '€A' }));
+
+// maxKeys limits the number of pairs, empty ones included.
+{
+  const input = `${padding}&&a=1&b=2&c=3`;
+  assert.deepStrictEqual(Object.keys(qs.parse(input, null, null,
+                                              { maxKeys: 1 })),
+                         ['pad']);
+  assert.deepStrictEqual(Object.keys(qs.parse(input, null, null,
+                                              { maxKeys: 3 })),
+                         ['pad', 'a']);
+  for (const maxKeys of [0, -1, 1.5, Infinity, NaN, 2 ** 40]) {
+    assert.deepStrictEqual(Object.keys(qs.parse(input, null, null,
+                                                { maxKeys })),
+                           ['pad', 'a', 'b', 'c']);
+  }
+}
+
+// A custom decoder always goes through the JS parser.
+{
+  const decodeURIComponent = (s) => s.toUpperCase();
+  assert.deepStrictEqual(
+    qs.parse(`${padding}&a=b`, null, null, { decodeURIComponent }),
+    Object.assign(Object.create(null), { PAD: 'X'.repeat(32), A: 'B' }));
+}
@@ -1,6 +1,6 @@
 // Flags: --expose_internals
 'use strict';
-require('../common');
+const common = require('../common');
 const assert = require('assert');
 const BufferList = require('internal/streams/BufferList');
 const util = require('util');
@@ -38,3 +38,31 @@ assert.strictEqual(
   util.inspect(list),
   'BufferList { length: \u001b[33m0\u001b[39m }');
 util.inspect.defaultOptions = { colors: tmp };
+
+// Test buffer list with several elements.
+const multi = new BufferList();
+multi.push(Buffer.from('foo'));
+multi.push(Buffer.from('bar'));
+multi.push(Buffer.from('baz'));
+
+assert.deepStrictEqual(multi.concat(9), Buffer.from('foobarbaz'));
+assert.deepStrictEqual(multi.concat(4), Buffer.from('foob'));
+
+// Consuming across chunk boundaries copies the pieces in one pass and keeps
+// the remainder of a partially consumed chunk at the head of the list.
+assert.deepStrictEqual(multi.consume(4, false), Buffer.from('foob'));
+assert.strictEqual(multi.length, 2);
+assert.deepStrictEqual(multi.first(), Buffer.from('ar'));
+assert.deepStrictEqual(multi.consume(5, false), Buffer.from('arbaz'));
+assert.strictEqual(multi.length, 0);
+assert.strictEqual(multi.head, null);
+assert.strictEqual(multi.tail, null);
+
+// Chunks that are not Buffers are rejected instead of being skipped.
+const mixed = new BufferList();
+mixed.push(Buffer.from('foo'));
+mixed.push('bar');
+common.expectsError(() => mixed.concat(6), {
+  code: 'ERR_INVALID_ARG_TYPE',
+  type: TypeError
+});
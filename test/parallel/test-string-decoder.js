@@ -160,6 +160,59 @@ common.expectsError(
   }
 );
 
+// A single non-ASCII byte anywhere in a chunk, including the tails that the
+// vectorized ASCII check leaves to scalar code, takes the slow path.
+for (const length of [15, 16, 17, 63, 64, 65, 130, 300]) {
+  const ascii = Buffer.alloc(length, 'a');
+  decoder = new StringDecoder('utf8');
+  assert.strictEqual(decoder.write(ascii), 'a'.repeat(length));
+  for (const position of [0, length >> 1, length - 2]) {
+    const input = Buffer.from(ascii);
+    input[position] = 0xC3;
+    input[position + 1] = 0xA9;
+    const expected = `${'a'.repeat(position)}\u00e9` +
+                     'a'.repeat(length - position - 2);
+    assert.strictEqual(decoder.write(input), expected);
+    assert.strictEqual(input.toString(), expected);
+    assert.strictEqual(input.toString('ascii'),
+                       expected.replace('\u00e9', 'C)'));
+  }
+}
+
+// Large ASCII chunks are turned into external strings.
+{
+  const input = Buffer.alloc(2 * 1024 * 1024, 'x');
+  decoder = new StringDecoder('utf8');
+  const str = decoder.write(input);
+  assert.strictEqual(str.length, input.length);
+  assert.strictEqual(str, 'x'.repeat(input.length));
+}
+
+// writeInto() appends to the given array and validates its arguments.
+{
+  decoder = new StringDecoder('utf8');
+  const rope = ['x'];
+  assert.strictEqual(decoder.writeInto(Buffer.from('a\u20ac', 'utf8')
+                                         .slice(0, 3), rope), rope);
+  assert.deepStrictEqual(rope, ['x', 'a']);
+  decoder.writeInto(Buffer.from([0xAC, 0x62]), rope);
+  assert.deepStrictEqual(rope, ['x', 'a', '\u20ac', 'b']);
+  decoder.writeInto(Buffer.alloc(0), rope);
+  decoder.writeInto('', rope);
+  decoder.writeInto('c', rope);
+  assert.deepStrictEqual(rope, ['x', 'a', '\u20ac', 'b', 'c']);
+
+  common.expectsError(() => decoder.writeInto(Buffer.alloc(1), 'abc'), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError,
+    message: 'The "rope" argument must be of type Array. Received type string'
+  });
+  common.expectsError(() => decoder.writeInto(null, []), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+}
+
 // test verifies that StringDecoder will correctly decode the given input
 // buffer with the given encoding to the expected output. It will attempt all
 // possible ways to write() the input buffer, see writeSequences(). The
@@ -189,6 +242,15 @@ function test(encoding, input, expected, singleSequence) {
         `Full Decoder State: ${inspect(decoder)}`;
       assert.fail(output, expected, message);
     }
+
+    // Decoding into a rope yields the same text.
+    const ropeDecoder = new StringDecoder(encoding);
+    const rope = [];
+    sequence.forEach((write) => {
+      ropeDecoder.writeInto(input.slice(write[0], write[1]), rope);
+    });
+    assert.ok(rope.every((piece) => piece.length > 0));
+    assert.strictEqual(rope.join('') + ropeDecoder.end(), expected);
   });
 }
 
@@ -5,7 +5,7 @@ if (!common.hasIntl)
   common.skip('missing Intl');
 
 const assert = require('assert');
-const { domainToASCII, domainToUnicode } = require('url');
+const { domainToASCII, domainToUnicode, URL } = require('url');
 
 // Tests below are not from WPT.
 const tests = require('../fixtures/url-idna.js');
@@ -51,3 +51,35 @@ const wptToASCIITests = require('../fixtures/url-toascii.js');
     }
   }
 }
+
+// Hosts that are already lowercase ASCII skip ICU, and the results for other
+// hosts are cached. Both have to agree with a fresh conversion.
+{
+  const cases = [
+    ['example.com', 'example.com'],
+    ['a_b.example', 'a_b.example'],
+    ['-a-.b', '-a-.b'],
+    ['ab--cd.com', 'ab--cd.com'],
+    ['a..b', 'a..b'],
+    ['trailing.dot.', 'trailing.dot.'],
+    [`${'x'.repeat(70)}.com`, `${'x'.repeat(70)}.com`],
+    ['EXAMPLE.com', 'example.com'],
+    ['xn--nxasmq6b.com', 'xn--nxasmq6b.com'],
+    ['xn--a.com', ''],
+    ['a.xn--a', ''],
+    ['ñ.com', 'xn--ida.com']
+  ];
+  for (let round = 0; round < 2; round++) {
+    for (const [input, ascii] of cases) {
+      assert.strictEqual(domainToASCII(input), ascii, input);
+      if (ascii === '') {
+        assert.throws(() => new URL(`http://${input}/`), TypeError);
+      } else {
+        assert.strictEqual(new URL(`http://${input}/`).hostname, ascii);
+      }
+    }
+  }
+  assert.strictEqual(domainToUnicode('a_b.example'), 'a_b.example');
+  assert.strictEqual(domainToUnicode('xn--ida.com'), 'ñ.com');
+  assert.strictEqual(domainToUnicode('xn--a.com'), '');
+}
@@ -0,0 +1,72 @@
+// Flags: --expose-internals
+'use strict';
+
+const common = require('../common');
+if (!common.hasIntl) {
+  // A handful of the tests fail when ICU is not included.
+  common.skip('missing Intl');
+}
+
+const assert = require('assert');
+const { URL } = require('url');
+const { toHref } = require('internal/url');
+const fixtures = require('../common/fixtures');
+
+const tests = require(fixtures.path('url-tests'))
+  .filter((test) => typeof test === 'object');
+
+// Parse every fixture twice, so that the second round is answered from the
+// binding's parse cache, and make sure both rounds agree with the href-only
+// fast path.
+for (let round = 0; round < 2; round++) {
+  for (const test of tests) {
+    if (test.failure) {
+      common.expectsError(() => new URL(test.input, test.base), {
+        code: 'ERR_INVALID_URL',
+        type: TypeError
+      });
+      common.expectsError(() => toHref(test.input, test.base), {
+        code: 'ERR_INVALID_URL',
+        type: TypeError
+      });
+      continue;
+    }
+    const url = new URL(test.input, test.base);
+    assert.strictEqual(url.href, test.href);
+    assert.strictEqual(toHref(test.input, test.base), test.href);
+  }
+}
+
+// A base given as a URL object and as a string lead to the same result.
+{
+  const base = new URL('https://example.org/a/b?c#d');
+  assert.strictEqual(new URL('../x', base).href, 'https://example.org/x');
+  assert.strictEqual(new URL('../x', base.href).href, 'https://example.org/x');
+  assert.strictEqual(toHref('../x', base), 'https://example.org/x');
+
+  // The same input resolves differently against different bases.
+  assert.strictEqual(new URL('y', 'http://a/b/').href, 'http://a/b/y');
+  assert.strictEqual(new URL('y', 'http://a/c/').href, 'http://a/c/y');
+}
+
+// Modifying a URL does not affect later parses of the same input.
+{
+  const first = new URL('http://example.com/path?query');
+  first.pathname = '/other';
+  first.searchParams.set('a', 'b');
+  const second = new URL('http://example.com/path?query');
+  assert.strictEqual(second.href, 'http://example.com/path?query');
+  assert.strictEqual(first.href, 'http://example.com/other?a=b');
+}
+
+// An invalid base is reported as the invalid input.
+{
+  for (const fn of [() => new URL('/x', 'not a url'),
+                    () => toHref('/x', 'not a url')]) {
+    common.expectsError(fn, {
+      code: 'ERR_INVALID_URL',
+      type: TypeError,
+      message: 'Invalid URL: not a url'
+    });
+  }
+}
@@ -0,0 +1,127 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+const { constants } = zlib;
+
+const input = Buffer.alloc(512 * 1024);
+for (let i = 0, x = 1; i < input.length; i++) {
+  x = (Math.imul(x, 1103515245) + 12345) >>> 0;
+  input[i] = i > 100 && (x >>> 30) !== 0 ?
+    input[i - 1 - ((x >>> 16) % 100)] : 0x61 + (x >>> 29);
+}
+
+// Round trips through the convenience methods and streams.
+{
+  const compressed = zlib.brotliCompressSync(input);
+  assert.ok(compressed.length < input.length / 2);
+  assert.deepStrictEqual(zlib.brotliDecompressSync(compressed), input);
+  assert.deepStrictEqual(
+    zlib.brotliDecompressSync(zlib.brotliCompressSync(Buffer.alloc(0))),
+    Buffer.alloc(0));
+
+  zlib.brotliCompress(input, common.mustCall((err, result) => {
+    assert.ifError(err);
+    assert.deepStrictEqual(result, compressed);
+    zlib.brotliDecompress(result, { info: true },
+                          common.mustCall((err, { buffer, engine }) => {
+                            assert.ifError(err);
+                            assert.deepStrictEqual(buffer, input);
+                            assert.strictEqual(engine.bytesRead,
+                                               compressed.length);
+                          }));
+  }));
+
+  const chunks = [];
+  const decompress = zlib.createBrotliDecompress();
+  decompress.on('data', (chunk) => chunks.push(chunk));
+  decompress.on('end', common.mustCall(() => {
+    assert.deepStrictEqual(Buffer.concat(chunks), input);
+  }));
+  const compress = zlib.createBrotliCompress();
+  compress.pipe(decompress);
+  for (let offset = 0; offset < input.length; offset += 100000)
+    compress.write(input.slice(offset, offset + 100000));
+  compress.end();
+}
+
+// A flush makes everything written so far decodable.
+{
+  const compress = zlib.createBrotliCompress();
+  const chunks = [];
+  compress.on('data', (chunk) => chunks.push(chunk));
+  compress.write(input.slice(0, 1000));
+  compress.flush(common.mustCall(() => {
+    const partial = zlib.brotliDecompressSync(Buffer.concat(chunks), {
+      finishFlush: constants.BROTLI_OPERATION_FLUSH
+    });
+    assert.deepStrictEqual(partial, input.slice(0, 1000));
+    compress.end(input.slice(1000));
+  }));
+  compress.on('end', common.mustCall(() => {
+    assert.deepStrictEqual(
+      zlib.brotliDecompressSync(Buffer.concat(chunks)), input);
+  }));
+}
+
+// Parameters are passed to the encoder.
+{
+  const fast = zlib.brotliCompressSync(input, {
+    params: { [constants.BROTLI_PARAM_QUALITY]: constants.BROTLI_MIN_QUALITY }
+  });
+  assert.notDeepStrictEqual(fast, zlib.brotliCompressSync(input));
+  assert.deepStrictEqual(zlib.brotliDecompressSync(fast), input);
+
+  for (const params of [{ 1234: 1 },
+                        { [constants.BROTLI_PARAM_QUALITY]: 'x' },
+                        { [constants.BROTLI_PARAM_QUALITY]: -1 },
+                        { foo: 1 }]) {
+    common.expectsError(() => zlib.createBrotliCompress({ params }), {
+      code: 'ERR_BROTLI_INVALID_PARAM',
+      type: RangeError
+    });
+  }
+  common.expectsError(() => zlib.createBrotliCompress({ params: 1 }), {
+    code: 'ERR_INVALID_OPT_VALUE',
+    type: TypeError
+  });
+  common.expectsError(() => zlib.createBrotliCompress().params(1, 2), {
+    code: 'ERR_METHOD_NOT_IMPLEMENTED',
+    type: Error
+  });
+}
+
+// reset() keeps the parameters and starts a new stream.
+{
+  const params = { [constants.BROTLI_PARAM_QUALITY]: 1 };
+  const expected = zlib.brotliCompressSync(input, { params });
+  const compress = zlib.createBrotliCompress({ params });
+  const chunks = [];
+  let collecting = false;
+  compress.on('data', (chunk) => {
+    if (collecting)
+      chunks.push(chunk);
+  });
+  compress.on('end', common.mustCall(() => {
+    assert.deepStrictEqual(Buffer.concat(chunks), expected);
+  }));
+  compress.write(Buffer.from('discarded'), common.mustCall(() => {
+    collecting = true;
+    compress.reset();
+    compress.end(input);
+  }));
+}
+
+// Invalid and truncated input.
+{
+  const invalid = Buffer.from('\xff\xff\xff\xff garbage', 'latin1');
+  assert.throws(() => zlib.brotliDecompressSync(invalid),
+                (err) => err.code === 'BROTLI_DECODER_ERROR' &&
+                         /^Decompression failed: /.test(err.message));
+
+  const truncated = zlib.brotliCompressSync(input).slice(0, 100);
+  zlib.brotliDecompress(truncated, common.mustCall((err) => {
+    assert.strictEqual(err.code, 'Z_BUF_ERROR');
+    assert.strictEqual(err.message, 'unexpected end of file');
+  }));
+}
@@ -0,0 +1,108 @@
+'use strict';
+// The convenience methods compress and decompress the whole input in a single
+// binding call. Check them against the streaming API for inputs whose output
+// has to grow several times.
+
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+// Compresses very well, so that inflating it takes many times the space of
+// the compressed data.
+const repetitive = Buffer.alloc(4 * 1024 * 1024, 'abcdefgh');
+// Compresses badly, so that deflating it needs about as much space as the
+// input.
+const random = Buffer.alloc(256 * 1024);
+for (let i = 0, x = 1; i < random.length; i++) {
+  x = (Math.imul(x, 1103515245) + 12345) >>> 0;
+  random[i] = x >>> 24;
+}
+
+function streamed(ctor, input, callback) {
+  const chunks = [];
+  const engine = new ctor();
+  engine.on('data', (chunk) => chunks.push(chunk));
+  engine.on('end', common.mustCall(() => callback(Buffer.concat(chunks))));
+  engine.end(input);
+}
+
+for (const [compress, decompress, Compress] of [
+  ['gzip', 'gunzip', zlib.Gzip],
+  ['gzip', 'unzip', zlib.Gzip],
+  ['deflate', 'inflate', zlib.Deflate],
+  ['deflate', 'unzip', zlib.Deflate],
+  ['deflateRaw', 'inflateRaw', zlib.DeflateRaw]
+]) {
+  for (const input of [repetitive, random, Buffer.alloc(0)]) {
+    const compressed = zlib[`${compress}Sync`](input);
+    assert.deepStrictEqual(zlib[`${decompress}Sync`](compressed), input);
+
+    streamed(Compress, input, (expected) => {
+      assert.deepStrictEqual(compressed, expected);
+    });
+
+    zlib[compress](input, common.mustCall((err, result) => {
+      assert.ifError(err);
+      assert.deepStrictEqual(result, compressed);
+      zlib[decompress](result, common.mustCall((err, result) => {
+        assert.ifError(err);
+        assert.deepStrictEqual(result, input);
+      }));
+    }));
+  }
+}
+
+// bytesRead is set on the engine.
+{
+  const compressed = zlib.gzipSync(repetitive);
+  // Trailing zero padding is not consumed.
+  const padded = Buffer.concat([compressed, Buffer.alloc(3)]);
+  const { buffer, engine } = zlib.gunzipSync(padded, { info: true });
+  assert.deepStrictEqual(buffer, repetitive);
+  assert.strictEqual(engine.bytesRead, compressed.length);
+  zlib.gzip(repetitive, { info: true }, common.mustCall((err, result) => {
+    assert.ifError(err);
+    assert.strictEqual(result.engine.bytesRead, repetitive.length);
+  }));
+}
+
+// Errors are reported the same way as before, and only once.
+{
+  const truncated = zlib.gzipSync(repetitive).slice(0, 1000);
+  common.expectsError(() => zlib.gunzipSync(truncated), {
+    code: 'Z_BUF_ERROR',
+    type: Error,
+    message: 'unexpected end of file'
+  });
+  zlib.gunzip(truncated, common.mustCall((err, result) => {
+    common.expectsError({
+      code: 'Z_BUF_ERROR',
+      type: Error,
+      message: 'unexpected end of file'
+    })(err);
+    assert.strictEqual(result, undefined);
+  }));
+
+  const corrupt = Buffer.from(zlib.deflateSync(repetitive));
+  corrupt[corrupt.length - 1] ^= 0xff;
+  common.expectsError(() => zlib.inflateSync(corrupt), {
+    code: 'Z_DATA_ERROR',
+    type: Error
+  });
+  zlib.inflate(corrupt, common.mustCall((err) => {
+    assert.strictEqual(err.code, 'Z_DATA_ERROR');
+  }));
+}
+
+// A finishFlush other than Z_FINISH allows decompressing partial input.
+{
+  const truncated = zlib.gzipSync(repetitive).slice(0, 1000);
+  const opts = { finishFlush: zlib.constants.Z_SYNC_FLUSH };
+  const partial = zlib.gunzipSync(truncated, opts);
+  assert.ok(partial.length > 0);
+  assert.deepStrictEqual(partial, repetitive.slice(0, partial.length));
+  zlib.gunzip(truncated, opts, common.mustCall((err, result) => {
+    assert.ifError(err);
+    assert.deepStrictEqual(result, partial);
+  }));
+}
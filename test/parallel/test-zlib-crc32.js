@@ -0,0 +1,74 @@
+'use strict';
+
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+// Known values.
+assert.strictEqual(zlib.crc32(''), 0);
+assert.strictEqual(zlib.crc32('123456789'), 0xcbf43926);
+assert.strictEqual(zlib.crc32(Buffer.from('123456789')), 0xcbf43926);
+assert.strictEqual(zlib.crc32('€'), zlib.crc32(Buffer.from('€')));
+assert.strictEqual(zlib.crc32(Buffer.alloc(0), 12345), 12345);
+assert.strictEqual(zlib.crc32(new Uint8Array(0), 0xffffffff), 0xffffffff);
+assert.strictEqual(zlib.crc32('', 42), 42);
+
+let seed = 1;
+function random(length) {
+  const buf = Buffer.alloc(length);
+  for (let i = 0; i < length; i++) {
+    seed = (Math.imul(seed, 1103515245) + 12345) >>> 0;
+    buf[i] = seed >>> 24;
+  }
+  return buf;
+}
+
+// Lengths on both sides of the ones where the SIMD code takes over, and
+// buffers at every alignment. The gzip trailer holds the CRC32 of the input.
+for (const length of [1, 15, 16, 17, 63, 64, 65, 79, 127, 128, 1000, 65536]) {
+  const data = random(length + 16);
+  for (let offset = 0; offset < 16; offset += 5) {
+    const view = data.subarray(offset, offset + length);
+    const gzip = zlib.gzipSync(view);
+    const expected = gzip.readUInt32LE(gzip.length - 8);
+    assert.strictEqual(zlib.crc32(view), expected);
+
+    // In two steps.
+    const split = length >> 1;
+    assert.strictEqual(
+      zlib.crc32(view.subarray(split), zlib.crc32(view.subarray(0, split))),
+      expected);
+
+    // Other views of the same memory.
+    assert.strictEqual(
+      zlib.crc32(new DataView(view.buffer, view.byteOffset, length)),
+      expected);
+    if (view.byteOffset % 2 === 0 && length % 2 === 0) {
+      assert.strictEqual(
+        zlib.crc32(new Uint16Array(view.buffer, view.byteOffset, length / 2)),
+        expected);
+    }
+  }
+}
+
+for (const data of [undefined, null, 1, {}, [1, 2], new ArrayBuffer(4)]) {
+  common.expectsError(() => zlib.crc32(data), {
+    code: 'ERR_INVALID_ARG_TYPE',
+    type: TypeError
+  });
+}
+
+common.expectsError(() => zlib.crc32('a', '1'), {
+  code: 'ERR_INVALID_ARG_TYPE',
+  type: TypeError,
+  message: 'The "value" argument must be of type number. Received type string'
+});
+
+for (const value of [-1, 1.5, 2 ** 32, NaN, Infinity]) {
+  common.expectsError(() => zlib.crc32('a', value), {
+    code: 'ERR_OUT_OF_RANGE',
+    type: RangeError,
+    message: 'The value of "value" is out of range. It must be an integer ' +
+             `>= 0 and <= 2^32 - 1. Received ${value}`
+  });
+}
@@ -0,0 +1,109 @@
+'use strict';
+// Gzip with the `parallel` option compresses blocks of the input concurrently
+// and stitches them into a single gzip member, which has to decompress to the
+// input with any gunzip implementation.
+
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+// Repetitive enough that back references reach across block boundaries.
+const input = Buffer.alloc(1536 * 1024 + 123);
+for (let i = 0, x = 1; i < input.length; i++) {
+  x = (Math.imul(x, 1103515245) + 12345) >>> 0;
+  if (i > 1000 && (x >>> 28) !== 0)
+    input[i] = input[i - 1 - ((x >>> 16) % 1000)];
+  else
+    input[i] = 0x61 + (x >>> 29);
+}
+
+const opts = { parallel: true, blockSize: 64 * 1024 };
+
+// One-shot, sync and async, with the trailer checked by gunzip.
+{
+  const compressed = zlib.gzipSync(input, opts);
+  assert.strictEqual(compressed[0], 0x1f);
+  assert.strictEqual(compressed[1], 0x8b);
+  assert.deepStrictEqual(zlib.gunzipSync(compressed), input);
+
+  // Priming every block with the preceding input keeps the output close to
+  // that of a single deflate stream.
+  assert.ok(compressed.length < zlib.gzipSync(input).length * 1.02);
+
+  zlib.gzip(input, opts, common.mustCall((err, result) => {
+    assert.ifError(err);
+    assert.deepStrictEqual(result, compressed);
+  }));
+
+  zlib.gzip(input, Object.assign({ info: true }, opts),
+            common.mustCall((err, { buffer, engine }) => {
+              assert.ifError(err);
+              assert.deepStrictEqual(buffer, compressed);
+              assert.strictEqual(engine.bytesRead, input.length);
+            }));
+}
+
+// Inputs shorter than a block, and empty ones, are valid gzip members too.
+for (const short of [Buffer.alloc(0),
+                     Buffer.from('hello'),
+                     input.slice(0, 40000)]) {
+  assert.deepStrictEqual(zlib.gunzipSync(zlib.gzipSync(short, opts)), short);
+  zlib.gzip(short, opts, common.mustCall((err, result) => {
+    assert.ifError(err);
+    assert.deepStrictEqual(zlib.gunzipSync(result), short);
+  }));
+}
+
+// Streams collect their input into larger writes, and a flush makes the
+// output so far decompressible.
+{
+  const gzip = zlib.createGzip({ parallel: true, blockSize: 32 * 1024 });
+  const chunks = [];
+  gzip.on('data', (chunk) => chunks.push(chunk));
+
+  const half = input.length >> 1;
+  for (let offset = 0; offset < half; offset += 10000) {
+    // The stream must not hold on to chunks that the writer reuses.
+    const chunk = Buffer.from(input.slice(offset, Math.min(offset + 10000,
+                                                           half)));
+    gzip.write(chunk, () => chunk.fill(0));
+  }
+  gzip.flush(common.mustCall(() => {
+    const partial = zlib.gunzipSync(Buffer.concat(chunks), {
+      finishFlush: zlib.constants.Z_SYNC_FLUSH
+    });
+    assert.deepStrictEqual(partial, input.slice(0, half));
+
+    gzip.end(input.slice(half));
+  }));
+
+  gzip.on('end', common.mustCall(() => {
+    assert.strictEqual(gzip.bytesRead, input.length);
+    assert.deepStrictEqual(zlib.gunzipSync(Buffer.concat(chunks)), input);
+  }));
+}
+
+// params() and reset() work on parallel streams.
+{
+  const gzip = zlib.createGzip(opts);
+  const chunks = [];
+  gzip.on('data', (chunk) => chunks.push(chunk));
+  gzip.write(input.slice(0, 100000));
+  gzip.params(1, zlib.constants.Z_DEFAULT_STRATEGY, common.mustCall(() => {
+    gzip.end(input.slice(100000));
+  }));
+  gzip.on('end', common.mustCall(() => {
+    assert.deepStrictEqual(zlib.gunzipSync(Buffer.concat(chunks)), input);
+  }));
+}
+
+// The option only applies to gzip.
+assert.deepStrictEqual(zlib.inflateSync(zlib.deflateSync(input, opts)), input);
+
+for (const blockSize of [1024, 32 * 1024 - 1, Infinity]) {
+  common.expectsError(() => zlib.createGzip({ parallel: true, blockSize }), {
+    code: 'ERR_INVALID_OPT_VALUE',
+    type: RangeError,
+    message: `The value "${blockSize}" is invalid for option "blockSize"`
+  });
+}
@@ -0,0 +1,134 @@
+'use strict';
+// Closed deflate and inflate streams are reset and reused by later ones with
+// the same parameters. Reused streams must behave exactly like new ones.
+
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+let seed = 1;
+function random(length) {
+  const buf = Buffer.alloc(length);
+  for (let i = 0; i < length; i++) {
+    seed = (Math.imul(seed, 1103515245) + 12345) >>> 0;
+    // Keep the data compressible.
+    buf[i] = 97 + (seed >>> 24) % 8;
+  }
+  return buf;
+}
+
+const input = random(64 * 1024);
+
+// The same options give the same output no matter which streams were used
+// before.
+{
+  const variants = [
+    {},
+    { level: 1 },
+    { level: 9, memLevel: 9 },
+    { windowBits: 9, strategy: zlib.constants.Z_HUFFMAN_ONLY },
+    { level: 0 }
+  ];
+  const methods = [
+    ['deflateSync', 'inflateSync'],
+    ['deflateRawSync', 'inflateRawSync'],
+    ['gzipSync', 'gunzipSync']
+  ];
+  const expected = new Map();
+  for (let round = 0; round < 3; round++) {
+    for (const [compress, decompress] of methods) {
+      for (const options of variants) {
+        const key = `${compress} ${JSON.stringify(options)}`;
+        const output = zlib[compress](input, options);
+        if (round === 0)
+          expected.set(key, output);
+        else
+          assert.deepStrictEqual(output, expected.get(key), key);
+        assert.deepStrictEqual(zlib[decompress](output, options), input);
+      }
+    }
+  }
+}
+
+// An inflate stream that failed is fine to reuse.
+{
+  const compressed = zlib.deflateSync(input);
+  for (let i = 0; i < 3; i++) {
+    assert.throws(() => zlib.inflateSync(Buffer.from('garbage')),
+                  /incorrect header check/);
+    assert.deepStrictEqual(zlib.inflateSync(compressed), input);
+  }
+}
+
+// Streams are only reused with the parameters they currently have, which
+// params() may have changed.
+{
+  const level1 = zlib.deflateSync(input, { level: 1 });
+  const level9 = zlib.deflateSync(input, { level: 9 });
+  const deflate = zlib.createDeflate({ level: 1 });
+  deflate.params(9, zlib.constants.Z_DEFAULT_STRATEGY, common.mustCall(() => {
+    deflate.end(input);
+  }));
+  deflate.resume();
+  deflate.on('close', common.mustCall(() => {
+    assert.deepStrictEqual(zlib.deflateSync(input, { level: 1 }), level1);
+    assert.deepStrictEqual(zlib.deflateSync(input, { level: 9 }), level9);
+  }));
+}
+
+// Streams share equal dictionaries, but not different ones.
+{
+  const first = random(1024);
+  const second = random(1024);
+  for (let i = 0; i < 3; i++) {
+    for (const [dictionary, other] of [[first, second], [second, first]]) {
+      const compressed =
+        zlib.deflateSync(input, { dictionary: Buffer.from(dictionary) });
+      assert.deepStrictEqual(zlib.inflateSync(compressed, { dictionary }),
+                             input);
+      assert.throws(() => zlib.inflateSync(compressed, { dictionary: other }),
+                    /Bad dictionary/);
+      assert.throws(() => zlib.inflateSync(compressed),
+                    /Missing dictionary/);
+
+      const raw = zlib.deflateRawSync(input, { dictionary });
+      assert.deepStrictEqual(zlib.inflateRawSync(raw, { dictionary }), input);
+    }
+  }
+}
+
+// bytesAllocated reports what zlib holds for a stream.
+{
+  const deflate = zlib.createDeflate();
+  // 64 KiB each for the window, the hash chains, the hash heads and the
+  // pending output with the default windowBits and memLevel.
+  assert.ok(deflate.bytesAllocated > 256 * 1024, deflate.bytesAllocated);
+  deflate.close();
+  assert.strictEqual(deflate.bytesAllocated, 0);
+
+  const compressed = zlib.deflateSync(input, { windowBits: 14 });
+  const inflate = zlib.createInflate({ windowBits: 14 });
+  const initial = inflate.bytesAllocated;
+  assert.ok(initial > 0);
+  inflate.write(compressed, common.mustCall(() => {
+    // The window is allocated once there is output.
+    const used = inflate.bytesAllocated;
+    assert.ok(used >= initial + 16 * 1024, `${used} ${initial}`);
+    inflate.close(common.mustCall(() => {
+      assert.strictEqual(inflate.bytesAllocated, 0);
+      // The next stream with the same parameters gets the same state,
+      // window included.
+      const next = zlib.createInflate({ windowBits: 14 });
+      assert.strictEqual(next.bytesAllocated, used);
+      next.close();
+    }));
+  }));
+  inflate.resume();
+}
+
+{
+  const compress = zlib.createBrotliCompress();
+  assert.ok(compress.bytesAllocated > 0);
+  compress.close();
+  assert.strictEqual(compress.bytesAllocated, 0);
+}
@@ -10,6 +10,9 @@ runBenchmark('buffers',
                'args=1',
                'buffer=fast',
                'byteLength=1',
+               'constantTime=true',
+               'difference=none',
+               'direction=read',
                'encoding=utf8',
                'endian=BE',
                'len=2',
@@ -17,6 +20,7 @@ runBenchmark('buffers',
                'method=',
                'n=1',
                'noAssert=true',
+               'patternLength=1',
                'pieces=1',
                'pieceSize=1',
                'search=@',
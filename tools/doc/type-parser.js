@@ -32,6 +32,8 @@ const typeMap = {
   'AsyncHook': 'async_hooks.html#async_hooks_async_hooks_createhook_callbacks',
 
   'Buffer': 'buffer.html#buffer_class_buffer',
+  'BufferCursor': 'buffer.html#buffer_class_buffercursor',
+  'BufferSchema': 'buffer.html#buffer_class_bufferschema',
 
   'ChildProcess': 'child_process.html#child_process_class_childprocess',
 